@@ -26,4 +26,8 @@ in vec3 i_tangent;
 in vec3 i_bitangent;
 in vec4 i_jointIndices;
 in vec4 i_jointWeights;
-in vec2 i_texcoord0;
\ No newline at end of file
+in vec2 i_texcoord0;
+
+#ifdef INDIRECT_DRAW
+in uint i_drawIndex;
+#endif
\ No newline at end of file
@@ -28,6 +28,9 @@ out	vec3 f_tangent;
 out	vec3 f_bitangent;
 out	vec2 f_texCoord0;
 out float f_linear_depth;
+#ifdef INDIRECT_DRAW
+flat out int f_materialParameterIndex;
+#endif
 
 
 //Get the normals in view space.
@@ -58,6 +61,9 @@ void main()
     f_tangent = normalize(normalMatrix * i_tangent);
     f_bitangent = normalize(normalMatrix * i_bitangent);
     f_texCoord0 = i_texcoord0;
+#ifdef INDIRECT_DRAW
+    f_materialParameterIndex = u_draws[i_drawIndex].u_drawIndices.x;
+#endif
 
     vec4 viewPos = worldView * position;
     f_linear_depth = viewPos.z / u_farClip;
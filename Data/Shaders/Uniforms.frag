@@ -86,4 +86,10 @@ layout(std140) uniform u_renderTargetParameters
 };
 
 uniform int u_shadowOcclusionParameterIndex;
-uniform int u_materialParameterIndex;
\ No newline at end of file
+#ifdef INDIRECT_DRAW
+//Passed from the per-draw parameters by the vertex shader.
+flat in int f_materialParameterIndex;
+#define u_materialParameterIndex f_materialParameterIndex
+#else
+uniform int u_materialParameterIndex;
+#endif
\ No newline at end of file
@@ -35,5 +35,24 @@ layout(std140) uniform u_skinMatrixArray
     mat4 u_skinMatrices[1000];
 };
 
+#ifdef INDIRECT_DRAW
+//MAX_DRAW_COMMANDS is defined by the engine from its MaxDrawCommands.
+
+//Parameters of each draw of a multi-draw, selected with the draw index.
+struct DrawParameters
+{
+    mat4 u_drawWorldTransform;
+    ivec4 u_drawIndices; //x: material parameter index
+};
+
+layout(std140) uniform u_drawParameters
+{
+    DrawParameters u_draws[MAX_DRAW_COMMANDS];
+};
+
+#define u_worldTransform u_draws[i_drawIndex].u_drawWorldTransform
+#else
 uniform mat4 u_worldTransform;
+#endif
+
 uniform mat4 u_lightViewProjectionMatrix;
\ No newline at end of file
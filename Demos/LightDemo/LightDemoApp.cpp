@@ -26,34 +26,19 @@
 void LightDemoApp::init()
 {
     scene = engine->createScene();
-
-    FixedArray<std::string, 6> skyBoxTextureFileNames = { Engine::getAssetPath() + "Textures/Skybox/miramar_ft.tga", Engine::getAssetPath() + "Textures/Skybox/miramar_bk.tga",
-                                                          Engine::getAssetPath() + "Textures/Skybox/miramar_up.tga", Engine::getAssetPath() + "Textures/Skybox/miramar_dn.tga",
-                                                          Engine::getAssetPath() + "Textures/Skybox/miramar_rt.tga", Engine::getAssetPath() + "Textures/Skybox/miramar_lf.tga" };
-
-    scene->setGlobalAmbientLight(Vector3(0.05f, 0.05f, 0.05f));
-    SkyBox* skyBox = (SkyBox*)scene->createSceneItem("SkyBox");
-    skyBox->setTextureFiles(skyBoxTextureFileNames);
-
-    Mesh* sponza = scene->createSceneItem<Mesh>();
-    engine->getSceneImporter().importMesh(Engine::getAssetPath() + "Models/Sponza/sponza.obj", sponza);
-    sponza->scale(0.25f);
+    engine->getSceneLoader().loadScene("../../Demos/LightDemo/LightDemoScene.json", scene);
 
     float width = static_cast<float>(engine->getRenderer().getScreenViewPort().width);
     float height = static_cast<float>(engine->getRenderer().getScreenViewPort().height);
     scene->getMainCamera()->setAspectRatio(width / height);
     camera = scene->getMainCamera();
-    camera->translate(Vector3(-250.0f, 350.0f, -10.0f), FrameOfReference::World);
-    camera->setRotation(Quaternion(-90.0f, Vector3::UNIT_Y));
 
     movingPointLightCorners[0] = Vector3(175.0f, 170.0f, 25.0f);
     movingPointLightCorners[1] = Vector3(-205.0f, 170.0f, 25.0f);
     movingPointLightCorners[2] = Vector3(-205.0f, 170.0f, -40.0f);
     movingPointLightCorners[3] = Vector3(175.0f, 170.0f, -40.0f);
 
-    createDirectionalLight();
     createPointLights();
-    createSpotLights();
 }
 
 void LightDemoApp::update(float timeSinceLastUpdate)
@@ -131,30 +116,6 @@ void LightDemoApp::moveLights(float timeSinceLastUpdate)
     }
 }
 
-void LightDemoApp::createDirectionalLight()
-{
-    FixedArray<float, 4> splits = {50.0f, 150.0f, 500.0f, 1000.0f};
-    Light* lightDirectional = (Light*)scene->createSceneItem("Light");
-    lightDirectional->setLightType(LightType::Directional);
-    lightDirectional->setDirection(Vector3(0.6f, -1.0f, 0.0f));
-    lightDirectional->setColor(Vector3(1.0f, 1.0f, 1.0f));
-    lightDirectional->setCastShadow(true);
-    lightDirectional->setShadowMinDistanceOffset(400.0f);
-    lightDirectional->setCascadeSplits(splits);
-    lightDirectional->setShadowBias(0.005f);
-}
-void LightDemoApp::createSpotLights()
-{
-    createSpotLight(113.0f, 0.7f, 20.0f, 30.0f, Vector3(1.0f, 1.0f, 0.5f), Vector3(-350.0f, 100.0f, -10.0f), Vector3(0.0f, -1.0f, 0.0f), true);
-    createSpotLight(113.0f, 0.7f, 20.0f, 30.0f, Vector3(1.0f, 1.0f, 0.5f), Vector3(315.0f, 100.0f, -10.0f), Vector3(0.0f, -1.0f, 0.0f), true);
-
-    for(int i = 0; i < 5; ++i)
-    {
-        createSpotLight(110.0f, 0.7f, 20.0f, 30.0f, Vector3(1.0f, 1.0f, 0.7f), Vector3((-300.0f + float(i) * 145.0f), 100.0f, -145.0f), Vector3(0.0f, -1.0f, 0.0f), false);
-        createSpotLight(110.0f, 0.7f, 20.0f, 30.0f, Vector3(1.0f, 1.0f, 0.7f), Vector3((-300.0f + float(i) * 145.0f), 100.0f, 130.0f), Vector3(0.0f, -1.0f, 0.0f), false);
-    }
-}
-
 void LightDemoApp::createPointLights()
 {
     Vector<Mesh*> lightSpheres;
@@ -199,19 +160,4 @@ void LightDemoApp::createPointLight(Mesh* sphere, float lightScale, float radius
     light->addChild((SpatialSceneItem*)sphere);
 
     shadow ? shadowCastingPointLights.pushBack(light) : pointLights.pushBack(light);
-}
-
-void LightDemoApp::createSpotLight(float radius, float fallOff, float innerConeAngle, float outerConeAngle, const Vector3& color, const Vector3& position, Vector3& direction, bool shadow)
-{
-    Light *light = (Light*)scene->createSceneItem("Light");
-    light->setLightType(LightType::Spot);
-    light->setRadius(radius);
-    light->setFallOffExponent(fallOff);
-    light->setInnerConeAngle(innerConeAngle);
-    light->setOuterConeAngle(outerConeAngle);
-    light->setColor(color);
-    light->setPosition(position);
-    light->setDirection(direction);
-    light->setCastShadow(shadow);
-    light->setShadowBias(0.0004f);
 }
\ No newline at end of file
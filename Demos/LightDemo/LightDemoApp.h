@@ -40,11 +40,8 @@ public:
 private:
     void moveCamera(float timeSinceLastUpdate);
     void moveLights(float timeSinceLastUpdate);
-    void createDirectionalLight();
     void createPointLights();
-    void createSpotLights();
     void createPointLight(Mesh* sphere, float lightScale, float radius, float fallOff, const Vector3& color, const Vector3& position, bool shadow);
-    void createSpotLight(float radius, float fallOff, float innerConeAngle, float outerConeAngle, const Vector3& color, const Vector3& position, Vector3& direction, bool shadow);
 
     Camera* camera;
     Scene* scene;
@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 
 #include "Animation.h"
+#include "Util/Profiler.h"
 #include <iostream>
 
 namespace Huurre3D
@@ -54,6 +55,8 @@ void Animation::removeAnimationClips(Vector<AnimationClip*>& animationClips)
 
 void Animation::update(float timeStep)
 {
+    PROFILE_ZONE("Animation::update");
+
     for(unsigned int i = 0; i < animationClips.size(); ++i)
     {
         if(animationClips[i]->isPlaying())
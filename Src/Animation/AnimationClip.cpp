@@ -32,6 +32,9 @@ endPosition(animationLength),
 looped(looped),
 tracks(tracks)
 {
+    this->tracks.setMemoryTag(MemoryTag::Animation);
+    for(unsigned int i = 0; i < this->tracks.size(); ++i)
+        this->tracks[i].keyFrames.setMemoryTag(MemoryTag::Animation);
 }
 
 void AnimationClip::setSpeed(float speed)
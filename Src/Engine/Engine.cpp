@@ -27,6 +27,7 @@
 #include "Scene/SceneImporter.h"
 #include "Scene/Camera.h"
 #include "Util/JSON.h"
+#include "Util/Profiler.h"
 
 namespace Huurre3D
 {
@@ -35,7 +36,8 @@ std::string Engine::assetPath;
 
 Engine::Engine() :
 input(renderer.getGraphicWindow()),
-sceneImporter(renderer, animation)
+sceneImporter(renderer, animation),
+sceneLoader(sceneImporter)
 {}
 
 Engine::~Engine()
@@ -67,21 +69,29 @@ void Engine::run()
 
 void Engine::update()
 {
-    input.update();
+    {
+        PROFILE_ZONE("Engine::update");
+        input.update();
 
-    float currentFrame = timer.getElapsedTime();
-    float timeSinceLastUpdate = max(0.0f, (currentFrame - lastFrame));
-    lastFrame = currentFrame;
-    animation.update(timeSinceLastUpdate);
+        float currentFrame = timer.getElapsedTime();
+        float timeSinceLastUpdate = max(0.0f, (currentFrame - lastFrame));
+        lastFrame = currentFrame;
+        animation.update(timeSinceLastUpdate);
 
-    for(unsigned int i = 0; i < apps.size(); ++i)
-        apps[i]->update(timeSinceLastUpdate);
+        for(unsigned int i = 0; i < apps.size(); ++i)
+        {
+            PROFILE_ZONE("App::update");
+            apps[i]->update(timeSinceLastUpdate);
+        }
 
-    for(unsigned int i = 0; i < scenes.size(); ++i)
-    {
-        scenes[i]->update();
-        renderer.renderScene(scenes[i]);
+        for(unsigned int i = 0; i < scenes.size(); ++i)
+        {
+            scenes[i]->update();
+            renderer.renderScene(scenes[i]);
+        }
     }
+
+    PROFILE_END_FRAME();
 }
 
 void Engine::setApp(App* app)
@@ -124,6 +134,7 @@ bool Engine::init(const std::string& engineConfigFile)
         return false;
     }
 
+    PROFILE_THREAD("Main");
     if(!renderer.init(rendererJSON))
         return false;
 
@@ -134,6 +145,8 @@ bool Engine::init(const std::string& engineConfigFile)
 
 void Engine::deInit()
 {
+    renderer.flushFrames();
+
     for(unsigned int i = 0; i < apps.size(); ++i)
         apps[i]->deinit();
 }
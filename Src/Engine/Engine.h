@@ -26,6 +26,7 @@
 #include "Renderer/Renderer.h"
 #include "Input/Input.h"
 #include "Scene/SceneImporter.h"
+#include "Scene/SceneLoader.h"
 #include "Util/Vector.h"
 #include "Util/Timer.h"
 
@@ -50,6 +51,7 @@ public:
     Scene* createScene();
     Scene* getScene(unsigned int id = 0) const {return scenes[id];}
     SceneImporter& getSceneImporter() {return sceneImporter;}
+    SceneLoader& getSceneLoader() {return sceneLoader;}
     Renderer& getRenderer() {return renderer;}
     Animation& getAnimation() {return animation;}
     const Input& getInput() const {return input;}
@@ -63,6 +65,7 @@ private:
     Vector<Scene*> scenes;
     Vector<App*> apps;
     SceneImporter sceneImporter;
+    SceneLoader sceneLoader;
     Input input;
     Timer timer;
     float lastFrame = 0.0f;
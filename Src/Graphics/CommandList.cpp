@@ -0,0 +1,306 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Graphics/CommandList.h"
+#include "Graphics/ShaderParameterBlock.h"
+#include "Graphics/Texture.h"
+
+namespace Huurre3D
+{
+
+CommandList::CommandList():
+commands(MemoryTag::General)
+{
+    for(int i = 0; i < static_cast<int>(TextureSlotIndex::NumSlots); ++i)
+        currentTextures[i] = nullptr;
+}
+
+void CommandList::reset()
+{
+    commands.clearBuffer();
+    statistics = CommandListStatistics();
+    passFilteredStatistics = GraphicStatistics();
+    currentRenderTarget = nullptr;
+    currentRenderTargetLayer = 0;
+    renderTargetSet = false;
+    viewPortSet = false;
+    rasterStateSet = false;
+    depthWrite = -1;
+    colorWrite = -1;
+    currentVertexData = nullptr;
+    currentProgram = nullptr;
+    resetProgramState();
+}
+
+void CommandList::addCommand(CommandType type)
+{
+    unsigned char commandType = static_cast<unsigned char>(type);
+    commands.append(&commandType, 1);
+    ++statistics.recordedCommands;
+    statistics.sizeInBytes = commands.getSizeInBytes();
+}
+
+void CommandList::resetProgramState()
+{
+    currentBlocks.clear();
+    currentParameters.clear();
+    for(int i = 0; i < static_cast<int>(TextureSlotIndex::NumSlots); ++i)
+        currentTextures[i] = nullptr;
+}
+
+void CommandList::setOffLineRenderTarget(RenderTarget* renderTarget, unsigned int layer)
+{
+    if(!renderTarget)
+        return;
+
+    //The layer is set on replay, since the passes drawing to the layers of a render target share the target.
+    if(renderTargetSet && currentRenderTarget == renderTarget && currentRenderTargetLayer == layer)
+    {
+        ++statistics.filteredCommands;
+        return;
+    }
+
+    RenderTargetCommand command;
+    command.renderTarget = renderTarget;
+    command.layer = layer;
+    addCommand(CommandType::SetOffLineRenderTarget, command);
+    currentRenderTarget = renderTarget;
+    currentRenderTargetLayer = layer;
+    renderTargetSet = true;
+    //A texture of the previous render target may be sampled in the new one, so the textures are bound again.
+    for(int i = 0; i < static_cast<int>(TextureSlotIndex::NumSlots); ++i)
+        currentTextures[i] = nullptr;
+}
+
+void CommandList::setMainRenderTarget()
+{
+    if(renderTargetSet && !currentRenderTarget)
+    {
+        ++statistics.filteredCommands;
+        return;
+    }
+
+    addCommand(CommandType::SetMainRenderTarget);
+    currentRenderTarget = nullptr;
+    renderTargetSet = true;
+    for(int i = 0; i < static_cast<int>(TextureSlotIndex::NumSlots); ++i)
+        currentTextures[i] = nullptr;
+}
+
+void CommandList::setViewPort(const ViewPort& viewPort)
+{
+    if(viewPortSet && currentViewPort == viewPort)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredViewPortChanges;
+        return;
+    }
+
+    addCommand(CommandType::SetViewPort, viewPort);
+    currentViewPort = viewPort;
+    viewPortSet = true;
+}
+
+void CommandList::setDepthWrite(bool enable)
+{
+    if(depthWrite == static_cast<int>(enable))
+    {
+        ++statistics.filteredCommands;
+        return;
+    }
+
+    unsigned char value = enable ? 1 : 0;
+    addCommand(CommandType::SetDepthWrite, value);
+    depthWrite = value;
+}
+
+void CommandList::setColorWrite(bool enable)
+{
+    if(colorWrite == static_cast<int>(enable))
+    {
+        ++statistics.filteredCommands;
+        return;
+    }
+
+    unsigned char value = enable ? 1 : 0;
+    addCommand(CommandType::SetColorWrite, value);
+    colorWrite = value;
+}
+
+void CommandList::clear(unsigned int flags, const Vector4& color)
+{
+    ClearCommand command;
+    command.flags = flags;
+    command.color = color;
+    addCommand(CommandType::Clear, command);
+}
+
+void CommandList::setVertexData(VertexData* vertexData)
+{
+    if(!vertexData)
+        return;
+
+    if(currentVertexData == vertexData)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredVertexDataBinds;
+        return;
+    }
+
+    addCommand(CommandType::SetVertexData, vertexData);
+    currentVertexData = vertexData;
+}
+
+void CommandList::setRasterState(const RasterState& state)
+{
+    if(rasterStateSet && currentRasterState == state)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredRasterStateChanges;
+        return;
+    }
+
+    addCommand(CommandType::SetRasterState, state);
+    currentRasterState = state;
+    rasterStateSet = true;
+}
+
+void CommandList::setShaderProgram(ShaderProgram* program)
+{
+    if(!program)
+        return;
+
+    if(currentProgram == program)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredProgramBinds;
+        return;
+    }
+
+    addCommand(CommandType::SetShaderProgram, program);
+    currentProgram = program;
+    resetProgramState();
+}
+
+void CommandList::setTexture(Texture* texture)
+{
+    if(!texture)
+        return;
+
+    int textureSlot = static_cast<int>(texture->getSlotIndex());
+    if(currentTextures[textureSlot] == texture)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredTextureBinds;
+        return;
+    }
+
+    addCommand(CommandType::SetTexture, texture);
+    currentTextures[textureSlot] = texture;
+}
+
+void CommandList::setShaderParameterBlock(ShaderParameterBlock* block)
+{
+    if(!block)
+        return;
+
+    //Blocks sharing a name replace each other in the binding point.
+    int blockIndex = -1;
+    for(unsigned int i = 0; i < currentBlocks.size(); ++i)
+    {
+        if(currentBlocks[i]->getNameHash() == block->getNameHash())
+        {
+            blockIndex = i;
+            break;
+        }
+    }
+
+    if(blockIndex != -1 && currentBlocks[blockIndex] == block)
+    {
+        ++statistics.filteredCommands;
+        ++passFilteredStatistics.filteredParameterBlockBinds;
+        return;
+    }
+
+    addCommand(CommandType::SetShaderParameterBlock, block);
+    if(blockIndex == -1)
+        currentBlocks.pushBack(block);
+    else
+        currentBlocks[blockIndex] = block;
+}
+
+void CommandList::setShaderParameter(const ShaderParameter& shaderParameter)
+{
+    int parameterIndex = -1;
+    for(unsigned int i = 0; i < currentParameters.size(); ++i)
+    {
+        if(currentParameters[i].nameHash == shaderParameter.nameHash)
+        {
+            parameterIndex = i;
+            break;
+        }
+    }
+
+    if(parameterIndex != -1 && memcmp(currentParameters[parameterIndex].value, shaderParameter.value, sizeof(shaderParameter.value)) == 0)
+    {
+        ++statistics.filteredCommands;
+        return;
+    }
+
+    ShaderParameterCommand command;
+    command.nameHash = shaderParameter.nameHash;
+    memcpy(command.value, shaderParameter.value, sizeof(command.value));
+    addCommand(CommandType::SetShaderParameter, command);
+    if(parameterIndex == -1)
+        currentParameters.pushBack(command);
+    else
+        currentParameters[parameterIndex] = command;
+}
+
+void CommandList::draw(int numVertices, int vertexOffset)
+{
+    DrawCommand command;
+    command.count = numVertices;
+    command.offset = vertexOffset;
+    command.baseVertex = 0;
+    addCommand(CommandType::Draw, command);
+}
+
+void CommandList::drawIndexed(int numIndices, int indexOffset, int baseVertex)
+{
+    DrawCommand command;
+    command.count = numIndices;
+    command.offset = indexOffset;
+    command.baseVertex = baseVertex;
+    addCommand(CommandType::DrawIndexed, command);
+}
+
+void CommandList::drawIndexedIndirect(DrawCommandBuffer* drawCommands)
+{
+    addCommand(CommandType::DrawIndexedIndirect, drawCommands);
+}
+
+void CommandList::endPass()
+{
+    addCommand(CommandType::EndPass, passFilteredStatistics);
+    passFilteredStatistics = GraphicStatistics();
+}
+
+}
@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef CommandList_H
+#define CommandList_H
+
+#include "Graphics/Rasterization.h"
+#include "Graphics/GraphicStatistics.h"
+#include "Graphics/ShaderParameter.h"
+#include "Util/MemoryBuffer.h"
+#include "Util/SmallVector.h"
+
+namespace Huurre3D
+{
+
+class RenderTarget;
+class VertexData;
+class ShaderProgram;
+class ShaderParameterBlock;
+class Texture;
+class DrawCommandBuffer;
+
+enum class CommandType : unsigned char
+{
+    SetOffLineRenderTarget,
+    SetMainRenderTarget,
+    SetViewPort,
+    SetDepthWrite,
+    SetColorWrite,
+    Clear,
+    SetVertexData,
+    SetRasterState,
+    SetShaderProgram,
+    SetTexture,
+    SetShaderParameterBlock,
+    SetShaderParameter,
+    Draw,
+    DrawIndexed,
+    DrawIndexedIndirect,
+    EndPass
+};
+
+struct RenderTargetCommand
+{
+    RenderTarget* renderTarget;
+    unsigned int layer;
+};
+
+struct ClearCommand
+{
+    unsigned int flags;
+    Vector4 color;
+};
+
+//The count is the number of vertices or indices, and the offset is the first vertex or index.
+struct DrawCommand
+{
+    int count;
+    int offset;
+    int baseVertex;
+};
+
+//A shader parameter is recorded by its value, so the list does not refer to the passes it was recorded from.
+struct ShaderParameterCommand
+{
+    unsigned int nameHash;
+    unsigned char value[64];
+};
+
+struct CommandListStatistics
+{
+    unsigned int recordedCommands = 0;
+    //State changes left out at record time because the same state was already recorded.
+    unsigned int filteredCommands = 0;
+    unsigned int sizeInBytes = 0;
+};
+
+//A compact stream of the bind, clear and draw commands of a render stage. Recording needs no graphics API,
+//so the stages record their lists on the worker threads and the main thread only replays them through the GraphicSystem.
+//The commands refer to the recorded graphic objects, which have to stay alive until the list has been replayed.
+//The state before the list is unknown, so the first change of each state is always recorded and the GraphicSystem filters it on replay.
+class CommandList
+{
+public:
+    CommandList();
+    ~CommandList() = default;
+
+    //Empties the list and forgets the recorded state.
+    void reset();
+    void setOffLineRenderTarget(RenderTarget* renderTarget, unsigned int layer);
+    void setMainRenderTarget();
+    void setViewPort(const ViewPort& viewPort);
+    void setDepthWrite(bool enable);
+    void setColorWrite(bool enable);
+    void clear(unsigned int flags, const Vector4& color);
+    void setVertexData(VertexData* vertexData);
+    void setRasterState(const RasterState& state);
+    void setShaderProgram(ShaderProgram* program);
+    void setTexture(Texture* texture);
+    void setShaderParameterBlock(ShaderParameterBlock* block);
+    void setShaderParameter(const ShaderParameter& shaderParameter);
+    void draw(int numVertices, int vertexOffset);
+    void drawIndexed(int numIndices, int indexOffset, int baseVertex);
+    void drawIndexedIndirect(DrawCommandBuffer* drawCommands);
+    //Ends a render pass, the replay collects the graphic statistics of each pass.
+    void endPass();
+    bool isEmpty() const {return commands.getSizeInBytes() == 0;}
+    unsigned int getSizeInBytes() const {return commands.getSizeInBytes();}
+    const CommandListStatistics& getStatistics() const {return statistics;}
+    //Reads the command at the offset and moves the offset past it.
+    CommandType readType(unsigned int& offset) const {return static_cast<CommandType>(commands.getData()[offset++]);}
+    template<typename T> void read(unsigned int& offset, T& command) const
+    {
+        memcpy(&command, commands.getData() + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+private:
+    //The commands are packed without padding, they are copied out when read.
+    template<typename T> void addCommand(CommandType type, const T& command)
+    {
+        unsigned char commandType = static_cast<unsigned char>(type);
+        commands.append(&commandType, 1);
+        commands.append(&command, sizeof(T));
+        ++statistics.recordedCommands;
+        statistics.sizeInBytes = commands.getSizeInBytes();
+    }
+    void addCommand(CommandType type);
+    //The blocks, parameters and textures set before are forgotten when the program changes, since the program has its own bindings.
+    void resetProgramState();
+
+    MemoryBuffer commands;
+    CommandListStatistics statistics;
+    //The filtered changes of the current pass, the replay adds them to the graphic statistics of the pass.
+    GraphicStatistics passFilteredStatistics;
+    RenderTarget* currentRenderTarget = nullptr;
+    unsigned int currentRenderTargetLayer = 0;
+    bool renderTargetSet = false;
+    ViewPort currentViewPort;
+    bool viewPortSet = false;
+    RasterState currentRasterState;
+    bool rasterStateSet = false;
+    //-1 when not yet recorded.
+    int depthWrite = -1;
+    int colorWrite = -1;
+    VertexData* currentVertexData = nullptr;
+    ShaderProgram* currentProgram = nullptr;
+    //The last block recorded under each block name and the last value recorded of each parameter.
+    SmallVector<ShaderParameterBlock*, 8> currentBlocks;
+    SmallVector<ShaderParameterCommand, 8> currentParameters;
+    Texture* currentTextures[static_cast<int>(TextureSlotIndex::NumSlots)];
+};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef DrawCommandBuffer_H
+#define DrawCommandBuffer_H
+
+#include "Graphics/GraphicObject.h"
+
+namespace Huurre3D
+{
+
+//Indexed draw of a multi-draw, the layout matches the indirect draw commands of the graphics APIs.
+struct DrawIndexedCommand
+{
+    unsigned int numIndices = 0;
+    unsigned int numInstances = 1;
+    unsigned int firstIndex = 0;
+    int baseVertex = 0;
+    unsigned int baseInstance = 0;
+};
+
+//The per-draw parameters of a full command buffer must still fit into one shader parameter block. A draw takes 80 bytes
+//in the std140 layout, and 204 draws fit into the 16384 bytes every GL implementation allows for a uniform block.
+//The shaders get the value as MAX_DRAW_COMMANDS from the shader loader.
+static const unsigned int MaxDrawCommands = 204;
+
+//Draws of the active vertex data that are submitted with one multi-draw.
+class DrawCommandBuffer : public GraphicObject
+{
+public:
+    DrawCommandBuffer():
+    GraphicObject(MemoryTag::Geometry)
+    {}
+    ~DrawCommandBuffer() = default;
+
+    //The index of the draw is passed as the base instance, the shaders read the per-draw parameters with it.
+    //Returns false when the buffer is full.
+    bool addCommand(unsigned int numIndices, unsigned int firstIndex, int baseVertex)
+    {
+        if(isFull())
+            return false;
+
+        DrawIndexedCommand command;
+        command.numIndices = numIndices;
+        command.firstIndex = firstIndex;
+        command.baseVertex = baseVertex;
+        command.baseInstance = numCommands++;
+        graphicData.append(&command, sizeof(DrawIndexedCommand));
+        setWholeDataDirty();
+        return true;
+    }
+    void clearCommands()
+    {
+        graphicData.clearBuffer();
+        numCommands = 0;
+        setWholeDataDirty();
+    }
+    unsigned int getNumCommands() const {return numCommands;}
+    const DrawIndexedCommand* getCommands() const {return reinterpret_cast<const DrawIndexedCommand*>(graphicData.getData());}
+    const DrawIndexedCommand& getCommand(unsigned int index) const {return getCommands()[index];}
+    bool isFull() const {return numCommands >= MaxDrawCommands;}
+    bool isEmpty() const {return numCommands == 0;}
+
+private:
+    unsigned int numCommands = 0;
+};
+
+}
+
+#endif
@@ -28,24 +28,68 @@ namespace Huurre3D
 {
 
 class GraphicSystem;
+template <typename T> class ResourcePool;
 
 class GraphicObject
 {
 public:
     GraphicObject() = default;
+    explicit GraphicObject(MemoryTag tag):
+    graphicData(tag)
+    {}
     virtual ~GraphicObject() = default;
 
     void setId(unsigned int id) {this->id = id;}
     unsigned int getId() const {return id;}
     bool isDirty() const {return dirty;}
-    void unDirty() {dirty = false;}
+    void unDirty()
+    {
+        dirty = false;
+        dirtyRangeBegin = dirtyRangeEnd = 0;
+    }
+    //An empty dirty range means that all of the data has changed.
+    bool isWholeDataDirty() const {return dirtyRangeEnd <= dirtyRangeBegin;}
+    unsigned int getDirtyRangeBegin() const {return isWholeDataDirty() ? 0 : dirtyRangeBegin;}
+    unsigned int getDirtyRangeEnd() const {return isWholeDataDirty() ? graphicData.getSizeInBytes() : dirtyRangeEnd;}
+    //The CPU side copy of a retained object is kept after the upload, even when the GraphicSystem releases the uploaded data.
+    void setRetainData(bool retain) {retainData = retain;}
+    bool isDataRetained() const {return retainData;}
     void discardData() {graphicData.resetBuffer();}
     unsigned char* getGraphicData() const {return graphicData.getData();}
+    unsigned int getGraphicDataSize() const {return graphicData.getSizeInBytes();}
 
 protected:
+    void setWholeDataDirty()
+    {
+        dirty = true;
+        dirtyRangeBegin = dirtyRangeEnd = 0;
+    }
+    //Extends the dirty range to cover the bytes, an object whose whole data is already dirty stays so.
+    void setDataRangeDirty(unsigned int begin, unsigned int end)
+    {
+        if(!dirty)
+        {
+            dirtyRangeBegin = begin;
+            dirtyRangeEnd = end;
+        }
+        else if(!isWholeDataDirty())
+        {
+            dirtyRangeBegin = begin < dirtyRangeBegin ? begin : dirtyRangeBegin;
+            dirtyRangeEnd = end > dirtyRangeEnd ? end : dirtyRangeEnd;
+        }
+        dirty = true;
+    }
+
+    template <typename T> friend class ResourcePool;
+
     MemoryBuffer graphicData;
     unsigned int id = 0;
     bool dirty = false;
+    bool retainData = false;
+    unsigned int dirtyRangeBegin = 0;
+    unsigned int dirtyRangeEnd = 0;
+    //Slot of the object in the resource pool of the GraphicSystem.
+    unsigned int poolSlot = 0xffffffff;
 };
 
 }
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GraphicStatistics_H
+#define GraphicStatistics_H
+
+namespace Huurre3D
+{
+
+//Counters of the commands passed through the GraphicSystem.
+//Issued binds and changes reach the back-end, filtered ones are redundant and dropped before it.
+struct GraphicStatistics
+{
+    unsigned int drawCalls = 0;
+    unsigned int instancedDrawCalls = 0;
+    unsigned int drawnInstances = 0;
+    //Multi-draws and the draws submitted by them.
+    unsigned int indirectDrawCalls = 0;
+    unsigned int indirectDraws = 0;
+    unsigned int programBinds = 0;
+    unsigned int filteredProgramBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int filteredTextureBinds = 0;
+    unsigned int parameterBlockBinds = 0;
+    unsigned int filteredParameterBlockBinds = 0;
+    unsigned int rasterStateChanges = 0;
+    unsigned int filteredRasterStateChanges = 0;
+    unsigned int viewPortChanges = 0;
+    unsigned int filteredViewPortChanges = 0;
+    unsigned int vertexDataBinds = 0;
+    unsigned int filteredVertexDataBinds = 0;
+    unsigned int vertexBytesUploaded = 0;
+    unsigned int indexBytesUploaded = 0;
+    unsigned int uniformBytesUploaded = 0;
+    unsigned int textureBytesUploaded = 0;
+    //Bytes of streamed parameter blocks written to the parameter ring, and waits for the GPU to free ring space.
+    unsigned int streamedParameterBytes = 0;
+    unsigned int parameterRingStalls = 0;
+
+    GraphicStatistics& operator += (const GraphicStatistics& rhs)
+    {
+        drawCalls += rhs.drawCalls;
+        instancedDrawCalls += rhs.instancedDrawCalls;
+        drawnInstances += rhs.drawnInstances;
+        indirectDrawCalls += rhs.indirectDrawCalls;
+        indirectDraws += rhs.indirectDraws;
+        programBinds += rhs.programBinds;
+        filteredProgramBinds += rhs.filteredProgramBinds;
+        textureBinds += rhs.textureBinds;
+        filteredTextureBinds += rhs.filteredTextureBinds;
+        parameterBlockBinds += rhs.parameterBlockBinds;
+        filteredParameterBlockBinds += rhs.filteredParameterBlockBinds;
+        rasterStateChanges += rhs.rasterStateChanges;
+        filteredRasterStateChanges += rhs.filteredRasterStateChanges;
+        viewPortChanges += rhs.viewPortChanges;
+        filteredViewPortChanges += rhs.filteredViewPortChanges;
+        vertexDataBinds += rhs.vertexDataBinds;
+        filteredVertexDataBinds += rhs.filteredVertexDataBinds;
+        vertexBytesUploaded += rhs.vertexBytesUploaded;
+        indexBytesUploaded += rhs.indexBytesUploaded;
+        uniformBytesUploaded += rhs.uniformBytesUploaded;
+        textureBytesUploaded += rhs.textureBytesUploaded;
+        streamedParameterBytes += rhs.streamedParameterBytes;
+        parameterRingStalls += rhs.parameterRingStalls;
+        return *this;
+    }
+
+    GraphicStatistics operator - (const GraphicStatistics& rhs) const
+    {
+        GraphicStatistics result;
+        result.drawCalls = drawCalls - rhs.drawCalls;
+        result.instancedDrawCalls = instancedDrawCalls - rhs.instancedDrawCalls;
+        result.drawnInstances = drawnInstances - rhs.drawnInstances;
+        result.indirectDrawCalls = indirectDrawCalls - rhs.indirectDrawCalls;
+        result.indirectDraws = indirectDraws - rhs.indirectDraws;
+        result.programBinds = programBinds - rhs.programBinds;
+        result.filteredProgramBinds = filteredProgramBinds - rhs.filteredProgramBinds;
+        result.textureBinds = textureBinds - rhs.textureBinds;
+        result.filteredTextureBinds = filteredTextureBinds - rhs.filteredTextureBinds;
+        result.parameterBlockBinds = parameterBlockBinds - rhs.parameterBlockBinds;
+        result.filteredParameterBlockBinds = filteredParameterBlockBinds - rhs.filteredParameterBlockBinds;
+        result.rasterStateChanges = rasterStateChanges - rhs.rasterStateChanges;
+        result.filteredRasterStateChanges = filteredRasterStateChanges - rhs.filteredRasterStateChanges;
+        result.viewPortChanges = viewPortChanges - rhs.viewPortChanges;
+        result.filteredViewPortChanges = filteredViewPortChanges - rhs.filteredViewPortChanges;
+        result.vertexDataBinds = vertexDataBinds - rhs.vertexDataBinds;
+        result.filteredVertexDataBinds = filteredVertexDataBinds - rhs.filteredVertexDataBinds;
+        result.vertexBytesUploaded = vertexBytesUploaded - rhs.vertexBytesUploaded;
+        result.indexBytesUploaded = indexBytesUploaded - rhs.indexBytesUploaded;
+        result.uniformBytesUploaded = uniformBytesUploaded - rhs.uniformBytesUploaded;
+        result.textureBytesUploaded = textureBytesUploaded - rhs.textureBytesUploaded;
+        result.streamedParameterBytes = streamedParameterBytes - rhs.streamedParameterBytes;
+        result.parameterRingStalls = parameterRingStalls - rhs.parameterRingStalls;
+        return result;
+    }
+};
+
+}
+
+#endif
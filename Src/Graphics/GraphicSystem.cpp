@@ -20,12 +20,36 @@
 // THE SOFTWARE.
 
 #include "Graphics/GraphicSystem.h"
+#include "Util/JSONSchema.h"
 #include <iostream>
 
 namespace Huurre3D
 {
 
-GraphicSystem::GraphicSystem()
+static JSONSchema<TextureDescription> createTextureSchema(const std::string& name, bool sizeMandatory)
+{
+    JSONSchema<TextureDescription> schema(name);
+    schema.addField("targetMode", &TextureDescription::targetMode, true)
+          .addField("wrapMode", &TextureDescription::wrapMode, true)
+          .addField("filterMode", &TextureDescription::filterMode, true)
+          .addField("pixelFormat", &TextureDescription::pixelFormat, true)
+          .addField("textureSlot", &TextureDescription::slotIndex, true)
+          .addField("width", &TextureDescription::width, sizeMandatory)
+          .addField("height", &TextureDescription::height, sizeMandatory);
+    return schema;
+}
+
+static const JSONSchema<TextureDescription> textureSchema = createTextureSchema("texture", true);
+//The buffers of a render target get their size from the render target.
+static const JSONSchema<TextureDescription> renderTargetBufferSchema = createTextureSchema("renderTarget buffer", false);
+
+GraphicSystem::GraphicSystem():
+vertexStreams(MemoryTag::Geometry),
+indexBuffers(MemoryTag::Geometry),
+vertexDataComponents(MemoryTag::Geometry),
+textures(MemoryTag::Texture),
+shaderParameterBlocks(MemoryTag::ShaderParameters),
+drawCommandBuffers(MemoryTag::Geometry)
 {
     graphicSystemBackEnd = CreateGraphicSystemBackEnd();
 }
@@ -40,56 +64,52 @@ GraphicSystem::~GraphicSystem()
     clearTextures();
     clearRenderTargets();
     clearShaderParameterBlocks();
+    clearDrawCommandBuffers();
+    releaseParameterRing();
     delete  graphicSystemBackEnd; 
 }
 
 VertexData* GraphicSystem::createVertexData(PrimitiveType primitiveType, int numVertices)
 {
-    VertexData* vertexData = new VertexData(primitiveType, numVertices);
+    VertexData* vertexData = vertexDataComponents.create(primitiveType, numVertices);
     unsigned int id = graphicSystemBackEnd->createVertexData();
-    vertexDataComponents.pushBack(vertexData);
     vertexData->setId(id);
     return vertexData;
 }
 
 VertexStream* GraphicSystem::createVertexStream(int numVertices, const Vector<AttributeDescription>& descriptions)
 {
-    VertexStream* vertexStream = new VertexStream(numVertices, descriptions);
+    VertexStream* vertexStream = vertexStreams.create(numVertices, descriptions);
     unsigned int id = graphicSystemBackEnd->createVertexStream();
-    vertexStreams.pushBack(vertexStream);
     vertexStream->setId(id);
     return vertexStream;
 }
 
 IndexBuffer* GraphicSystem::createIndexBuffer(IndexType indexType, int numIndices, bool dynamic)
 {
-    IndexBuffer* indexBuffer = new IndexBuffer(indexType, numIndices, dynamic);
+    IndexBuffer* indexBuffer = indexBuffers.create(indexType, numIndices, dynamic);
     unsigned int id = graphicSystemBackEnd->createIndexBuffer();
-    indexBuffers.pushBack(indexBuffer);
     indexBuffer->setId(id);
     return indexBuffer;
 }
 
 Shader* GraphicSystem::createShader(ShaderType shaderType, const std::string& sourceFileName)
 {
-    Shader* shader = new Shader(shaderType, sourceFileName.c_str());
-    shaders.pushBack(shader);
+    Shader* shader = shaders.create(shaderType, sourceFileName.c_str());
     return shader;
 }
 
 Shader* GraphicSystem::createShader(ShaderType shaderType, const std::string& sourceFileName, const Vector<std::string>& shaderDefines)
 {
-    Shader* shader = new Shader(shaderType, sourceFileName.c_str());
+    Shader* shader = shaders.create(shaderType, sourceFileName.c_str());
     shader->setDefines(shaderDefines);
-    shaders.pushBack(shader);
     return shader;
 }
 
 ShaderProgram* GraphicSystem::createShaderProgram(Shader* vertexShader, Shader* fragmentShader)
 {
-    ShaderProgram* shaderProgram = new ShaderProgram(vertexShader, fragmentShader);
+    ShaderProgram* shaderProgram = shaderPrograms.create(vertexShader, fragmentShader);
     unsigned int id = graphicSystemBackEnd->createShaderProgram();
-    shaderPrograms.pushBack(shaderProgram);
     shaderProgram->setId(id);
 
     Vector<Shader*> shaderComp;
@@ -146,45 +166,29 @@ ShaderProgram* GraphicSystem::createShaderProgram(const JSONValue& shaderProgram
 
 Texture* GraphicSystem::createTexture(TextureTargetMode targetMode, TextureWrapMode wrapMode, TextureFilterMode filterMode, TexturePixelFormat pixelFormat, int width, int height)
 {
-    Texture* texture = new Texture(targetMode, wrapMode, filterMode, pixelFormat, width, height);
+    Texture* texture = textures.create(targetMode, wrapMode, filterMode, pixelFormat, width, height);
     unsigned int id = graphicSystemBackEnd->createTexture();
-    textures.pushBack(texture);
     texture->setId(id);
     return texture;
 }
 
-Texture* GraphicSystem::createTexture(const JSONValue& textureJSON)
+Texture* GraphicSystem::createTexture(const TextureDescription& description)
 {
-    Texture* texture = nullptr;
-    auto targetModeJSON = textureJSON.getJSONValue("targetMode");
-    auto wrapModeJSON = textureJSON.getJSONValue("wrapMode");
-    auto filterModeJSON = textureJSON.getJSONValue("filterMode");
-    auto pixelFormatJSON = textureJSON.getJSONValue("pixelFormat");
-    auto slotIndexJSON = textureJSON.getJSONValue("textureSlot");
-    auto widthJSON = textureJSON.getJSONValue("width");
-    auto heightJSON = textureJSON.getJSONValue("height");
-
-    if(targetModeJSON.isNull() || wrapModeJSON.isNull() || filterModeJSON.isNull() || pixelFormatJSON.isNull() || slotIndexJSON.isNull() || widthJSON.isNull() || heightJSON.isNull())
-        std::cout << "Failed to create texture from JSON. One of the mandatory values: targetMode, wrapMode, filterMode, pixelFormat, textureSlot, width, height is missing" << std::endl;
-    else
-    {
-        auto targetMode = enumFromString<TextureTargetMode>(targetModeJSON.getString());
-        auto wrapMode = enumFromString<TextureWrapMode>(wrapModeJSON.getString());
-        auto filterMode = enumFromString<TextureFilterMode>(filterModeJSON.getString());
-        auto pixelFormat = enumFromString<TexturePixelFormat>(pixelFormatJSON.getString());
-        auto slotIndex = enumFromString<TextureSlotIndex>(slotIndexJSON.getString());
-        texture = createTexture(targetMode, wrapMode, filterMode, pixelFormat, widthJSON.getInt(), heightJSON.getInt());
-        texture->setSlotIndex(slotIndex);
-    }
-
+    Texture* texture = createTexture(description.targetMode, description.wrapMode, description.filterMode, description.pixelFormat, description.width, description.height);
+    texture->setSlotIndex(description.slotIndex);
     return texture;
 }
 
+Texture* GraphicSystem::createTexture(const JSONValue& textureJSON)
+{
+    TextureDescription description;
+    return textureSchema.read(textureJSON, description) ? createTexture(description) : nullptr;
+}
+
 RenderTarget* GraphicSystem::createRenderTarget(int width, int height, int numBuffers, int numLayers)
 {
-    RenderTarget* renderTarget = new RenderTarget(width, height, numBuffers, numLayers);
+    RenderTarget* renderTarget = renderTargets.create(width, height, numBuffers, numLayers);
     unsigned int id = graphicSystemBackEnd->createRenderTarget(width, height, numBuffers, numLayers);
-    renderTargets.pushBack(renderTarget);
     renderTarget->setId(id);
     return renderTarget;
 }
@@ -224,46 +228,54 @@ RenderTarget* GraphicSystem::createRenderTarget(const JSONValue& renderTargetJSO
         {
             for(unsigned int i = 0; i < numBuffers; ++i)
             {
-                JSONValue colorBufferJSON = colorBuffersJSON.getJSONArrayItem(i);
-                colorBufferJSON.setJSONValue(widthJSON);
-                colorBufferJSON.setJSONValue(heightJSON);
-
-                Texture* colorBuffer = createTexture(colorBufferJSON);
+                Texture* colorBuffer = createRenderTargetBuffer(colorBuffersJSON.getJSONArrayItem(i), renderTarget);
                 if(colorBuffer)
-                {
-                    colorBuffer->setDepth(numLayers);
                     renderTarget->setColorBuffer(colorBuffer);
-                }
             }
         }
         //Create and set depth buffer.
         auto depthBufferJSON = renderTargetJSON.getJSONValue("depthBuffer");
         if(!depthBufferJSON.isNull())
         {
-            depthBufferJSON.setJSONValue(widthJSON);
-            depthBufferJSON.setJSONValue(heightJSON);
-
-            Texture* depthBuffer = createTexture(depthBufferJSON);
+            Texture* depthBuffer = createRenderTargetBuffer(depthBufferJSON, renderTarget);
             if(depthBuffer)
-            {
-                depthBuffer->setDepth(numLayers);
                 renderTarget->setDepthBuffer(depthBuffer);
-            }
         }
     }
 
     return renderTarget;
 }
 
+Texture* GraphicSystem::createRenderTargetBuffer(const JSONValue& bufferJSON, RenderTarget* renderTarget)
+{
+    TextureDescription description;
+    if(!renderTargetBufferSchema.read(bufferJSON, description))
+        return nullptr;
+
+    description.width = renderTarget->getWidth();
+    description.height = renderTarget->getHeight();
+
+    Texture* buffer = createTexture(description);
+    buffer->setDepth(renderTarget->getNumLayers());
+    return buffer;
+}
+
 ShaderParameterBlock* GraphicSystem::createShaderParameterBlock(const std::string& name)
 {
-    ShaderParameterBlock* shaderParameterBlock = new ShaderParameterBlock(name);
+    ShaderParameterBlock* shaderParameterBlock = shaderParameterBlocks.create(name);
     unsigned int id = graphicSystemBackEnd->createShaderParameterBlock(name);
-    shaderParameterBlocks.pushBack(shaderParameterBlock);
     shaderParameterBlock->setId(id);
     return shaderParameterBlock;
 }
 
+DrawCommandBuffer* GraphicSystem::createDrawCommandBuffer()
+{
+    DrawCommandBuffer* drawCommandBuffer = drawCommandBuffers.create();
+    unsigned int id = graphicSystemBackEnd->createDrawCommandBuffer();
+    drawCommandBuffer->setId(id);
+    return drawCommandBuffer;
+}
+
 ShaderParameterBlock* GraphicSystem::createShaderParameterBlock(const JSONValue& parameterBlockJSON)
 {
     ShaderParameterBlock* shaderParameterBlock = nullptr;
@@ -334,32 +346,88 @@ ShaderParameterBlock* GraphicSystem::createShaderParameterBlock(const JSONValue&
 
 void GraphicSystem::setVertexData(VertexData* vertexData)
 {
-    if(vertexData && currentVertexData != vertexData)
+    if(vertexData)
     {
+        //Geometries sharing the vertex data can add data to it between the draws, so a bound vertex data is set again when it has changed.
+        const Vector<VertexStream*>& vertexStreams = vertexData->getVertexStreams();
+        unsigned int dirtyStreamsMask = 0;
+        for(unsigned int i = 0; i < vertexStreams.size(); ++i)
+        {
+            if(vertexStreams[i]->isDirty())
+                dirtyStreamsMask |= 1 << i;
+        }
+
+        IndexBuffer* indexBuffer = vertexData->isIndexed() ? vertexData->getIndexBuffer() : nullptr;
+        bool indexBufferDirty = indexBuffer && indexBuffer->isDirty();
+
+        if(currentVertexData == vertexData && !dirtyStreamsMask && !indexBufferDirty)
+        {
+            ++statistics.filteredVertexDataBinds;
+            return;
+        }
+
+        for(unsigned int i = 0; i < vertexStreams.size(); ++i)
+        {
+            if(dirtyStreamsMask & (1 << i))
+                statistics.vertexBytesUploaded += vertexStreams[i]->getDirtyRangeEnd() - vertexStreams[i]->getDirtyRangeBegin();
+        }
+
+        if(indexBufferDirty)
+            statistics.indexBytesUploaded += indexBuffer->getDirtyRangeEnd() - indexBuffer->getDirtyRangeBegin();
+
         graphicSystemBackEnd->setVertexData(vertexData);
         currentVertexData = vertexData;
+        ++statistics.vertexDataBinds;
+
+        if(releaseUploadedData)
+        {
+            for(unsigned int i = 0; i < vertexStreams.size(); ++i)
+            {
+                if((dirtyStreamsMask & (1 << i)) && !vertexStreams[i]->isDataRetained())
+                    vertexStreams[i]->discardData();
+            }
+
+            if(indexBufferDirty && !indexBuffer->isDataRetained())
+                indexBuffer->discardData();
+        }
     }
 }
 
+void GraphicSystem::setShaderCacheDirectory(const std::string& directory)
+{
+    graphicSystemBackEnd->setShaderCacheDirectory(directory);
+}
+
 void GraphicSystem::setShaderProgram(ShaderProgram* program)
 {
     if(program && currentShaderProgram != program)
     {
         graphicSystemBackEnd->setShaderProgram(program);
         currentShaderProgram = program;
+        ++statistics.programBinds;
     }
+    else if(program)
+        ++statistics.filteredProgramBinds;
 }
 
 void GraphicSystem::setShaderParameter(const ShaderParameter& shaderParameter)
+{
+    if(currentShaderProgram && !currentShaderProgram->getShaderParameterDescription(shaderParameter.nameHash))
+        std::cout << "Currently active shader program does not have parameter name " << shaderParameter.name << std::endl;
+    else
+        setShaderParameter(shaderParameter.nameHash, shaderParameter.value);
+}
+
+void GraphicSystem::setShaderParameter(unsigned int nameHash, const unsigned char* value)
 {
     if(currentShaderProgram)
     {
-        ShaderParameterDescription* parameterDesc = currentShaderProgram->getShaderParameterDescription(shaderParameter.nameHash);
+        ShaderParameterDescription* parameterDesc = currentShaderProgram->getShaderParameterDescription(nameHash);
 
         if(parameterDesc)
-            graphicSystemBackEnd->setShaderParameter(parameterDesc, shaderParameter);
+            graphicSystemBackEnd->setShaderParameter(parameterDesc, value);
         else
-            std::cout << "Currently active shader program does not have parameter name " << shaderParameter.name << std::endl;
+            std::cout << "Currently active shader program does not have parameter of name hash " << nameHash << std::endl;
     }
 }
 
@@ -370,16 +438,134 @@ void GraphicSystem::setShaderParameterBlock(ShaderParameterBlock* block)
         ShaderParameterBlockDescription* paramBlockDesc = currentShaderProgram->getShaderParameterBlockDescription(block->getNameHash());
 
         if(paramBlockDesc)
-            graphicSystemBackEnd->setShaderParameterBlock(paramBlockDesc, block);
+        {
+            //A block which is bound to the program's binding point and has no new data needs no back-end work.
+            int boundIndex = boundShaderParameterBlocks.getIndexToItem([block](const ShaderParameterBlock* bound){return bound->getNameHash() == block->getNameHash();});
+            bool replacesBound = boundIndex == -1 || boundShaderParameterBlocks[boundIndex] != block;
+            //A streamed block written on an earlier frame may have been overwritten by now.
+            bool streamed = block->isStreamed() && parameterRing.getSize() > 0;
+            bool staleRange = streamed && block->getRingFrame() != frameIndex;
+            if(block->isDirty() || staleRange || !block->hasBindingIndex() || !paramBlockDesc->sourceBlockSetted || replacesBound)
+            {
+                if(boundIndex == -1)
+                    boundShaderParameterBlocks.pushBack(block);
+                else
+                    boundShaderParameterBlocks[boundIndex] = block;
+
+                if(!streamed || !streamShaderParameterBlock(paramBlockDesc, block))
+                {
+                    block->releaseRingRange();
+                    if(block->isDirty())
+                        statistics.uniformBytesUploaded += block->getDirtyRangeEnd() - block->getDirtyRangeBegin();
+
+                    graphicSystemBackEnd->setShaderParameterBlock(paramBlockDesc, block);
+                }
+                ++statistics.parameterBlockBinds;
+            }
+            else
+                ++statistics.filteredParameterBlockBinds;
+        }
         else
              std::cout << "Currently active shader program does not have parameter block name " << block->getName() << std::endl;
     }
 }
 
+void GraphicSystem::setParameterRingSize(unsigned int size)
+{
+    releaseParameterRing();
+
+    if(size > 0)
+    {
+        parameterRingId = graphicSystemBackEnd->createParameterRing(size);
+        parameterBlockAlignment = graphicSystemBackEnd->getParameterBlockAlignment();
+        parameterRing.reset(size);
+    }
+}
+
+void GraphicSystem::beginFrame()
+{
+    ++frameIndex;
+
+    while(parameterRing.hasFramesInFlight() && graphicSystemBackEnd->waitFence(parameterRing.getOldestFence(), false))
+    {
+        graphicSystemBackEnd->removeFence(parameterRing.getOldestFence());
+        parameterRing.releaseOldestFrame();
+    }
+}
+
+void GraphicSystem::endFrame()
+{
+    if(parameterRing.getSize() > 0)
+        parameterRing.endFrame(graphicSystemBackEnd->createFence());
+}
+
+bool GraphicSystem::streamShaderParameterBlock(ShaderParameterBlockDescription* description, ShaderParameterBlock* block)
+{
+    if(block->isDirty() || block->getRingFrame() != frameIndex)
+    {
+        unsigned int size = block->getSizeInBytes();
+        unsigned int offset = allocateParameterRange(size);
+        if(offset == InvalidRingOffset)
+            return false;
+
+        graphicSystemBackEnd->writeParameterRing(parameterRingId, offset, block->getGraphicData(), size);
+        block->setRingRange(offset, frameIndex);
+        block->unDirty();
+        statistics.uniformBytesUploaded += size;
+        statistics.streamedParameterBytes += size;
+    }
+
+    graphicSystemBackEnd->setShaderParameterBlockRange(description, block, parameterRingId, block->getRingOffset());
+    return true;
+}
+
+unsigned int GraphicSystem::allocateParameterRange(unsigned int size)
+{
+    unsigned int offset = parameterRing.allocate(size, parameterBlockAlignment);
+
+    while(offset == InvalidRingOffset && parameterRing.hasFramesInFlight())
+    {
+        graphicSystemBackEnd->waitFence(parameterRing.getOldestFence(), true);
+        graphicSystemBackEnd->removeFence(parameterRing.getOldestFence());
+        parameterRing.releaseOldestFrame();
+        ++statistics.parameterRingStalls;
+        offset = parameterRing.allocate(size, parameterBlockAlignment);
+    }
+
+    return offset;
+}
+
+void GraphicSystem::releaseParameterRing()
+{
+    while(parameterRing.hasFramesInFlight())
+    {
+        graphicSystemBackEnd->removeFence(parameterRing.getOldestFence());
+        parameterRing.releaseOldestFrame();
+    }
+
+    if(parameterRing.getSize() > 0)
+        graphicSystemBackEnd->removeBuffer(parameterRingId);
+
+    parameterRingId = 0;
+    parameterRing.reset(0);
+}
+
 void GraphicSystem::setTexture(Texture* texture)
 {
     if(texture)
-        graphicSystemBackEnd->setTexture(texture);   
+    {
+        bool dataDirty = texture->isDataDirty();
+        if(dataDirty)
+            statistics.textureBytesUploaded += texture->getGraphicDataSize();
+
+        if(graphicSystemBackEnd->setTexture(texture))
+            ++statistics.textureBinds;
+        else
+            ++statistics.filteredTextureBinds;
+
+        if(releaseUploadedData && dataDirty)
+            texture->discardData();
+    }
 }
 
 void GraphicSystem::setDepthWrite(bool enable)
@@ -406,7 +592,10 @@ void GraphicSystem::setRasterState(const RasterState& state)
     {
         graphicSystemBackEnd->setRasterState(state);
         currentRasterState = state;
+        ++statistics.rasterStateChanges;
     }
+    else
+        ++statistics.filteredRasterStateChanges;
 }
 
 void GraphicSystem::setOffLineRenderTarget(RenderTarget* renderTarget)
@@ -426,7 +615,10 @@ void GraphicSystem::setViewPort(const ViewPort& viewPort)
     {
         graphicSystemBackEnd->setViewPort(viewPort);
         currentViewPort = viewPort;
+        ++statistics.viewPortChanges;
     }
+    else
+        ++statistics.filteredViewPortChanges;
 }
 
 void GraphicSystem::clear(unsigned int flags, const Vector4& color)
@@ -437,17 +629,23 @@ void GraphicSystem::clear(unsigned int flags, const Vector4& color)
 void GraphicSystem::draw(int numVertices, int vertexOffset)
 {
     if(currentVertexData)
+    {
         graphicSystemBackEnd->draw(numVertices, vertexOffset);
+        ++statistics.drawCalls;
+    }
     else
         std::cout << "Failed to render: Active vertex data is not set" << std::endl;
 }
 
-void GraphicSystem::drawIndexed(int numIndices, int indexOffset)
+void GraphicSystem::drawIndexed(int numIndices, int indexOffset, int baseVertex)
 {
     if(currentVertexData)
     {
         if(currentVertexData->isIndexed() && currentVertexData->getIndexBuffer())
-            graphicSystemBackEnd->drawIndexed(numIndices, indexOffset);
+        {
+            graphicSystemBackEnd->drawIndexed(numIndices, indexOffset, baseVertex);
+            ++statistics.drawCalls;
+        }
         else
             std::cout << "Failed to render: Active vertex data is not indexed or index buffer is not set." << std::endl;
     }
@@ -460,6 +658,149 @@ void GraphicSystem::drawIndexed(int numIndices, int indexOffset)
 void GraphicSystem::drawInstanced(int numIndices, int indexOffset, int instancesCount)
 {
     graphicSystemBackEnd->drawInstanced(numIndices, indexOffset, instancesCount);
+    ++statistics.instancedDrawCalls;
+    statistics.drawnInstances += instancesCount;
+}
+
+void GraphicSystem::drawIndexedIndirect(DrawCommandBuffer* drawCommands)
+{
+    if(currentVertexData && currentVertexData->isIndexed() && currentVertexData->getIndexBuffer())
+    {
+        if(!drawCommands->isEmpty())
+        {
+            graphicSystemBackEnd->drawIndexedIndirect(drawCommands);
+            ++statistics.indirectDrawCalls;
+            statistics.indirectDraws += drawCommands->getNumCommands();
+        }
+    }
+    else
+        std::cout << "Failed to render: Active vertex data is not set or is not indexed." << std::endl;
+}
+
+void GraphicSystem::executeCommandList(const CommandList& commandList, Vector<GraphicStatistics>* passStatistics)
+{
+    GraphicStatistics passStartStatistics = statistics;
+    unsigned int offset = 0;
+
+    while(offset < commandList.getSizeInBytes())
+    {
+        switch(commandList.readType(offset))
+        {
+            case CommandType::SetOffLineRenderTarget:
+            {
+                RenderTargetCommand command;
+                commandList.read(offset, command);
+                command.renderTarget->setRenderLayer(command.layer);
+                setOffLineRenderTarget(command.renderTarget);
+                break;
+            }
+            case CommandType::SetMainRenderTarget:
+                setMainRenderTarget();
+                break;
+            case CommandType::SetViewPort:
+            {
+                ViewPort viewPort;
+                commandList.read(offset, viewPort);
+                setViewPort(viewPort);
+                break;
+            }
+            case CommandType::SetDepthWrite:
+            {
+                unsigned char enable;
+                commandList.read(offset, enable);
+                setDepthWrite(enable != 0);
+                break;
+            }
+            case CommandType::SetColorWrite:
+            {
+                unsigned char enable;
+                commandList.read(offset, enable);
+                setColorWrite(enable != 0);
+                break;
+            }
+            case CommandType::Clear:
+            {
+                ClearCommand command;
+                commandList.read(offset, command);
+                clear(command.flags, command.color);
+                break;
+            }
+            case CommandType::SetVertexData:
+            {
+                VertexData* vertexData;
+                commandList.read(offset, vertexData);
+                setVertexData(vertexData);
+                break;
+            }
+            case CommandType::SetRasterState:
+            {
+                RasterState state;
+                commandList.read(offset, state);
+                setRasterState(state);
+                break;
+            }
+            case CommandType::SetShaderProgram:
+            {
+                ShaderProgram* program;
+                commandList.read(offset, program);
+                setShaderProgram(program);
+                break;
+            }
+            case CommandType::SetTexture:
+            {
+                Texture* texture;
+                commandList.read(offset, texture);
+                setTexture(texture);
+                break;
+            }
+            case CommandType::SetShaderParameterBlock:
+            {
+                ShaderParameterBlock* block;
+                commandList.read(offset, block);
+                setShaderParameterBlock(block);
+                break;
+            }
+            case CommandType::SetShaderParameter:
+            {
+                ShaderParameterCommand command;
+                commandList.read(offset, command);
+                setShaderParameter(command.nameHash, command.value);
+                break;
+            }
+            case CommandType::Draw:
+            {
+                DrawCommand command;
+                commandList.read(offset, command);
+                draw(command.count, command.offset);
+                break;
+            }
+            case CommandType::DrawIndexed:
+            {
+                DrawCommand command;
+                commandList.read(offset, command);
+                drawIndexed(command.count, command.offset, command.baseVertex);
+                break;
+            }
+            case CommandType::DrawIndexedIndirect:
+            {
+                DrawCommandBuffer* drawCommands;
+                commandList.read(offset, drawCommands);
+                drawIndexedIndirect(drawCommands);
+                break;
+            }
+            case CommandType::EndPass:
+            {
+                //The changes filtered at record time are counted as filtered here, so the statistics stay comparable with direct submission.
+                GraphicStatistics filteredStatistics;
+                commandList.read(offset, filteredStatistics);
+                statistics += filteredStatistics;
+                if(passStatistics)
+                    passStatistics->pushBack(statistics - passStartStatistics);
+                passStartStatistics = statistics;
+                break;
+            }
+        }
+    }
 }
 
 void GraphicSystem::removeVertexData(VertexData* vertexData)
@@ -470,10 +811,8 @@ void GraphicSystem::removeVertexData(VertexData* vertexData)
         for(unsigned int i = 0; i < vertexStreams.size(); ++i)
             removeVertexStream(vertexStreams[i]);
 
-        vertexDataComponents.eraseUnordered(vertexData);
         graphicSystemBackEnd->removeVertexData(vertexData->getId());
-        delete vertexData;
-        vertexData = nullptr;
+        vertexDataComponents.remove(vertexData);
     }
 }
 
@@ -481,10 +820,8 @@ void GraphicSystem::removeVertexStream(VertexStream* vertexStream)
 {
     if(vertexStream)
     {
-        vertexStreams.eraseUnordered(vertexStream);
         graphicSystemBackEnd->removeBuffer(vertexStream->getId());
-        delete vertexStream;
-        vertexStream = nullptr;
+        vertexStreams.remove(vertexStream);
     }
 }
 
@@ -492,10 +829,8 @@ void GraphicSystem::removeIndexBuffer(IndexBuffer* indexBuffer)
 {
     if(indexBuffer)
     {
-        indexBuffers.eraseUnordered(indexBuffer);
         graphicSystemBackEnd->removeBuffer(indexBuffer->getId());
-        delete indexBuffer;
-        indexBuffer = nullptr;
+        indexBuffers.remove(indexBuffer);
     }
 }
 
@@ -503,10 +838,8 @@ void GraphicSystem::removeShaderProgram(ShaderProgram* program)
 {
     if(program)
     {
-        shaderPrograms.eraseUnordered(program);
         graphicSystemBackEnd->removeShaderProgram(program->getId());
-        delete program;
-        program = nullptr;
+        shaderPrograms.remove(program);
     }
 }
 
@@ -514,9 +847,7 @@ void GraphicSystem::removeShader(Shader* shader)
 {
     if(shader)
     {
-        shaders.eraseUnordered(shader);
-        delete shader;
-        shader = nullptr;
+        shaders.remove(shader);
     }
 }
 
@@ -524,10 +855,28 @@ void GraphicSystem::removeTexture(Texture* texture)
 {
     if(texture)
     {
-        textures.eraseUnordered(texture);
+        if(!texture->getAliasOwner())
+            graphicSystemBackEnd->removeTexture(texture->getId());
+        textures.remove(texture);
+    }
+}
+
+void GraphicSystem::setTextureAlias(Texture* texture, const Texture* owner)
+{
+    if(!texture || texture == owner || texture->getAliasOwner() == owner)
+        return;
+
+    if(!texture->getAliasOwner())
         graphicSystemBackEnd->removeTexture(texture->getId());
-        delete texture;
-        texture = nullptr;
+
+    texture->setId(owner ? owner->getId() : graphicSystemBackEnd->createTexture());
+    texture->setAliasOwner(owner);
+
+    //The render targets attach their buffers by id.
+    for(unsigned int i = 0; i < renderTargets.size(); ++i)
+    {
+        if(renderTargets[i]->hasBuffer(texture))
+            renderTargets[i]->setBuffersDirty();
     }
 }
 
@@ -535,10 +884,8 @@ void GraphicSystem::removeRenderTarget(RenderTarget* renderTarget)
 {
     if(renderTarget)
     {
-        renderTargets.eraseUnordered(renderTarget);
         graphicSystemBackEnd->removeRenderTarget(renderTarget->getId());
-        delete renderTarget;
-        renderTarget = nullptr;
+        renderTargets.remove(renderTarget);
     }
 }
 
@@ -546,22 +893,27 @@ void GraphicSystem::removeShaderParameterBlock(ShaderParameterBlock* shaderParam
 {
     if(shaderParameterBlock)
     {
-        shaderParameterBlocks.eraseUnordered(shaderParameterBlock);
         graphicSystemBackEnd->removeBuffer(shaderParameterBlock->getId());
-        delete shaderParameterBlock;
-        shaderParameterBlock = nullptr;
+        unbindShaderParameterBlock(shaderParameterBlock);
+        shaderParameterBlocks.remove(shaderParameterBlock);
+    }
+}
+
+void GraphicSystem::removeDrawCommandBuffer(DrawCommandBuffer* drawCommandBuffer)
+{
+    if(drawCommandBuffer)
+    {
+        graphicSystemBackEnd->removeBuffer(drawCommandBuffer->getId());
+        drawCommandBuffers.remove(drawCommandBuffer);
     }
 }
 
 void GraphicSystem::clearVertexDatas()
 {
     for(unsigned int i = 0; i < vertexDataComponents.size(); ++i)
-    {
         graphicSystemBackEnd->removeVertexData(vertexDataComponents[i]->getId());
-        delete vertexDataComponents[i];
-    }
 
-    vertexDataComponents.reset();
+    vertexDataComponents.clear();
 }
 
 void GraphicSystem::clearVertexStreams()
@@ -571,82 +923,72 @@ void GraphicSystem::clearVertexStreams()
         unsigned int id = vertexStreams[i]->getId();
         if(id != -1)
             graphicSystemBackEnd->removeBuffer(id);
-
-        delete vertexStreams[i];
     }
 
-    vertexStreams.reset();
+    vertexStreams.clear();
 }
 
 void GraphicSystem::clearIndexBuffers()
 {
     for(unsigned int i = 0; i < indexBuffers.size(); ++i)
-    {
         graphicSystemBackEnd->removeBuffer(indexBuffers[i]->getId());
-        delete indexBuffers[i];
-    }
 
-    indexBuffers.reset();
+    indexBuffers.clear();
 }
 
 void GraphicSystem::clearShaderPrograms()
 {
     for(unsigned int i = 0; i < shaderPrograms.size(); ++i)
-    {
         graphicSystemBackEnd->removeShaderProgram(shaderPrograms[i]->getId());
-        delete shaderPrograms[i];
-    }
 
-    shaderPrograms.reset();
+    shaderPrograms.clear();
 }
 
 void GraphicSystem::clearShaders()
 {
-    for(unsigned int i = 0; i < shaders.size(); ++i)
-    {
-        delete shaders[i];
-    }
-
-    shaders.reset();
+    shaders.clear();
 }
 
 void GraphicSystem::clearTextures()
 {
     for(unsigned int i = 0; i < textures.size(); ++i)
     {
-        graphicSystemBackEnd->removeTexture(textures[i]->getId());
-        delete textures[i];
+        if(!textures[i]->getAliasOwner())
+            graphicSystemBackEnd->removeTexture(textures[i]->getId());
     }
 
-    textures.reset();
+    textures.clear();
 }
 
 void GraphicSystem::clearRenderTargets()
 {
     for(unsigned int i = 0; i < renderTargets.size(); ++i)
-    {
         graphicSystemBackEnd->removeRenderTarget(renderTargets[i]->getId());
-        delete renderTargets[i];
-    }
 
-    renderTargets.reset();
+    renderTargets.clear();
 }
 
 void GraphicSystem::clearShaderParameterBlocks()
 {
     for(unsigned int i = 0; i < shaderParameterBlocks.size(); ++i)
-    {
         graphicSystemBackEnd->removeBuffer(shaderParameterBlocks[i]->getId());
-        delete shaderParameterBlocks[i];
-    }
 
-    shaderParameterBlocks.reset();
+    shaderParameterBlocks.clear();
+    boundShaderParameterBlocks.clear();
+}
+
+void GraphicSystem::clearDrawCommandBuffers()
+{
+    for(unsigned int i = 0; i < drawCommandBuffers.size(); ++i)
+        graphicSystemBackEnd->removeBuffer(drawCommandBuffers[i]->getId());
+
+    drawCommandBuffers.clear();
 }
 
 ShaderProgram* GraphicSystem::getShaderCombination(unsigned int shaderCombinationTag)
 {
     ShaderProgram* result;
-    return shaderPrograms.findItem([shaderCombinationTag](const ShaderProgram* program){return program->getShaderCombinationTag() == shaderCombinationTag;}, result) ? result : nullptr;
+    return shaderPrograms.getItems().findItem([shaderCombinationTag](const ShaderProgram* program){return program->getShaderCombinationTag() == shaderCombinationTag;}, result) ? result : nullptr;
 }
 
 ShaderProgram* GraphicSystem::getShaderCombination(const Vector<std::string>& shaderFileNames, const Vector<std::string>& shaderDefines)
@@ -657,6 +999,13 @@ ShaderProgram* GraphicSystem::getShaderCombination(const Vector<std::string>& sh
     return program ? program : nullptr;
 }
 
+void GraphicSystem::unbindShaderParameterBlock(const ShaderParameterBlock* block)
+{
+    int boundIndex = boundShaderParameterBlocks.getIndexToItem([block](const ShaderParameterBlock* bound){return bound == block;});
+    if(boundIndex != -1)
+        boundShaderParameterBlocks.eraseUnordered(static_cast<unsigned int>(boundIndex));
+}
+
 unsigned int GraphicSystem::generateShaderCombinationTag(const Vector<Shader*>& shaders)
 {
     Vector<std::string> shaderFileNames;
@@ -688,19 +1037,19 @@ unsigned int GraphicSystem::generateShaderCombinationTag(const Vector<std::strin
 Texture* GraphicSystem::getTextureBySlotIndex(TextureSlotIndex index)
 {
     Texture* result;
-    return textures.findItem([index](const Texture* texture){return texture->getSlotIndex() == index;}, result) ? result : nullptr;
+    return textures.getItems().findItem([index](const Texture* texture){return texture->getSlotIndex() == index;}, result) ? result : nullptr;
 }
 
 ShaderParameterBlock* GraphicSystem::getShaderParameterBlockByName(const std::string& name)
 {
     ShaderParameterBlock* result;
-    return shaderParameterBlocks.findItem([name](const ShaderParameterBlock* block){return block->getName().compare(name) == 0;}, result) ? result : nullptr;
+    return shaderParameterBlocks.getItems().findItem([name](const ShaderParameterBlock* block){return block->getName().compare(name) == 0;}, result) ? result : nullptr;
 }
 
 RenderTarget* GraphicSystem::getRenderTargetByName(const std::string& name)
 {
     RenderTarget* result;
-    return renderTargets.findItem([name](const RenderTarget* target){return target->getName().compare(name) == 0;}, result) ? result : nullptr;
+    return renderTargets.getItems().findItem([name](const RenderTarget* target){return target->getName().compare(name) == 0;}, result) ? result : nullptr;
 }
 
 }
\ No newline at end of file
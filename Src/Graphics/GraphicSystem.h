@@ -26,11 +26,16 @@
 #include "Graphics/VertexData.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/ShaderParameterBlock.h"
+#include "Graphics/DrawCommandBuffer.h"
+#include "Graphics/CommandList.h"
 #include "Graphics/ShaderParameter.h"
 #include "Graphics/Rasterization.h"
 #include "Graphics/RenderTarget.h"
+#include "Graphics/GraphicStatistics.h"
+#include "Graphics/ResourcePool.h"
 #include "Math/Rect.h"
 #include "Util/JSONValue.h"
+#include "Util/RingAllocator.h"
 
 #ifdef USE_OGL
 #include "Graphics/OGLGraphicsBackEnd/OGLGraphicSystemBackEnd.h"
@@ -58,15 +63,29 @@ public:
     ShaderProgram* createShaderProgram(Shader* vertexShader, Shader* fragmentShader);
     ShaderProgram* createShaderProgram(const JSONValue& shaderProgramJSON);
     Texture* createTexture(TextureTargetMode targetMode, TextureWrapMode wrapMode, TextureFilterMode filterMode, TexturePixelFormat pixelFormat, int width, int height);
+    Texture* createTexture(const TextureDescription& description);
     Texture* createTexture(const JSONValue& textureJSON);
     RenderTarget* createRenderTarget(int width, int height, int numBuffers = 1, int numLayers = 1);
     RenderTarget* createRenderTarget(const JSONValue& renderTargetJSON);
     ShaderParameterBlock* createShaderParameterBlock(const std::string& name);
     ShaderParameterBlock* createShaderParameterBlock(const JSONValue& parameterBlockJSON);
+    DrawCommandBuffer* createDrawCommandBuffer();
     void setVertexData(VertexData* vertexData);
+    //Sets the directory where the backend stores the preprocessed shader sources and linked program binaries between runs.
+    void setShaderCacheDirectory(const std::string& directory);
     void setShaderProgram(ShaderProgram* program);
     void setShaderParameter(const ShaderParameter& shaderParameter);
+    //The value is laid out as in a ShaderParameter.
+    void setShaderParameter(unsigned int nameHash, const unsigned char* value);
+    //Streamed blocks are written to the parameter ring and bound by their range, the other blocks have a buffer of their own.
     void setShaderParameterBlock(ShaderParameterBlock* block);
+    //The streamed blocks are written to a ring of the size in bytes, zero disables the ring.
+    void setParameterRingSize(unsigned int size);
+    //Frees the ring ranges of the frames the GPU has finished with.
+    void beginFrame();
+    //Fences the ring ranges written during the frame, they are not overwritten before the GPU has passed the fence.
+    void endFrame();
+    const RingAllocator& getParameterRing() const {return parameterRing;}
     void setTexture(Texture* texture);
     void setDepthWrite(bool enable);
     void setColorWrite(bool enable);
@@ -76,16 +95,25 @@ public:
     void setViewPort(const ViewPort& viewPort);
     void clear(unsigned int flags, const Vector4& color);
     void draw(int numVertices, int vertexOffset);
-    void drawIndexed(int numIndices, int indexOffset);
+    //The base vertex is added to each index, so geometries sharing a vertex data keep their indices relative to their first vertex.
+    void drawIndexed(int numIndices, int indexOffset, int baseVertex = 0);
     void drawInstanced(int numIndices, int indexOffset, int instancesCount);
+    //Draws every command of the buffer from the active vertex data with one multi-draw.
+    void drawIndexedIndirect(DrawCommandBuffer* drawCommands);
+    //Replays the recorded commands, the statistics of each ended pass are added to the pass statistics when given.
+    void executeCommandList(const CommandList& commandList, Vector<GraphicStatistics>* passStatistics = nullptr);
     void removeVertexData(VertexData* vertexData);
     void removeVertexStream(VertexStream* vertexStream);
     void removeIndexBuffer(IndexBuffer* indexBuffer);
     void removeShaderProgram(ShaderProgram* program);
     void removeShader(Shader* shader);
     void removeTexture(Texture* texture);
+    //Makes the texture use the memory of the owner, or its own memory again when the owner is null. The textures must have
+    //the same mode, format and size, and their contents must not be needed at the same time. The owner is not removed before its aliases.
+    void setTextureAlias(Texture* texture, const Texture* owner);
     void removeRenderTarget(RenderTarget* renderTarget);
     void removeShaderParameterBlock(ShaderParameterBlock* shaderParameterBlock);
+    void removeDrawCommandBuffer(DrawCommandBuffer* drawCommandBuffer);
     void clearVertexDatas();
     void clearVertexStreams();
     void clearIndexBuffers();
@@ -94,33 +122,84 @@ public:
     void clearTextures();
     void clearRenderTargets();
     void clearShaderParameterBlocks();
+    void clearDrawCommandBuffers();
     ShaderProgram* getShaderCombination(unsigned int shaderCombinationTag);
     ShaderProgram* getShaderCombination(const Vector<std::string>& shaderFileNames, const Vector<std::string>& shaderDefines);
     Texture* getTextureBySlotIndex(TextureSlotIndex index);
     ShaderParameterBlock* getShaderParameterBlockByName(const std::string& name);
     RenderTarget* getRenderTargetByName(const std::string& name);
+    //Handles stay safe to keep after the object is removed, unlike the pointers. Resolving a stale handle asserts in debug builds and returns null.
+    ResourceHandle<VertexData> getHandle(const VertexData* vertexData) const {return vertexDataComponents.getHandle(vertexData);}
+    ResourceHandle<VertexStream> getHandle(const VertexStream* vertexStream) const {return vertexStreams.getHandle(vertexStream);}
+    ResourceHandle<IndexBuffer> getHandle(const IndexBuffer* indexBuffer) const {return indexBuffers.getHandle(indexBuffer);}
+    ResourceHandle<ShaderProgram> getHandle(const ShaderProgram* program) const {return shaderPrograms.getHandle(program);}
+    ResourceHandle<Texture> getHandle(const Texture* texture) const {return textures.getHandle(texture);}
+    ResourceHandle<RenderTarget> getHandle(const RenderTarget* renderTarget) const {return renderTargets.getHandle(renderTarget);}
+    ResourceHandle<ShaderParameterBlock> getHandle(const ShaderParameterBlock* block) const {return shaderParameterBlocks.getHandle(block);}
+    ResourceHandle<DrawCommandBuffer> getHandle(const DrawCommandBuffer* drawCommandBuffer) const {return drawCommandBuffers.getHandle(drawCommandBuffer);}
+    VertexData* getResource(const ResourceHandle<VertexData>& handle) const {return vertexDataComponents.get(handle);}
+    VertexStream* getResource(const ResourceHandle<VertexStream>& handle) const {return vertexStreams.get(handle);}
+    IndexBuffer* getResource(const ResourceHandle<IndexBuffer>& handle) const {return indexBuffers.get(handle);}
+    ShaderProgram* getResource(const ResourceHandle<ShaderProgram>& handle) const {return shaderPrograms.get(handle);}
+    Texture* getResource(const ResourceHandle<Texture>& handle) const {return textures.get(handle);}
+    RenderTarget* getResource(const ResourceHandle<RenderTarget>& handle) const {return renderTargets.get(handle);}
+    ShaderParameterBlock* getResource(const ResourceHandle<ShaderParameterBlock>& handle) const {return shaderParameterBlocks.get(handle);}
+    DrawCommandBuffer* getResource(const ResourceHandle<DrawCommandBuffer>& handle) const {return drawCommandBuffers.get(handle);}
+    bool isAlive(const ResourceHandle<VertexData>& handle) const {return vertexDataComponents.isAlive(handle);}
+    bool isAlive(const ResourceHandle<VertexStream>& handle) const {return vertexStreams.isAlive(handle);}
+    bool isAlive(const ResourceHandle<IndexBuffer>& handle) const {return indexBuffers.isAlive(handle);}
+    bool isAlive(const ResourceHandle<ShaderProgram>& handle) const {return shaderPrograms.isAlive(handle);}
+    bool isAlive(const ResourceHandle<Texture>& handle) const {return textures.isAlive(handle);}
+    bool isAlive(const ResourceHandle<RenderTarget>& handle) const {return renderTargets.isAlive(handle);}
+    bool isAlive(const ResourceHandle<ShaderParameterBlock>& handle) const {return shaderParameterBlocks.isAlive(handle);}
+    bool isAlive(const ResourceHandle<DrawCommandBuffer>& handle) const {return drawCommandBuffers.isAlive(handle);}
+    //Counters of the commands since the last reset.
+    const GraphicStatistics& getStatistics() const {return statistics;}
+    void resetStatistics() {statistics = GraphicStatistics();}
+    //When enabled the CPU side copies of vertex, index and texture data are freed after their upload to the GPU.
+    void setReleaseUploadedData(bool enable) {releaseUploadedData = enable;}
+    bool getReleaseUploadedData() const {return releaseUploadedData;}
 
 private:
+    //Creates a color or depth buffer of the render target, the size and depth of the buffer come from the render target.
+    Texture* createRenderTargetBuffer(const JSONValue& bufferJSON, RenderTarget* renderTarget);
     unsigned int generateShaderCombinationTag(const Vector<Shader*>& shaders);
     unsigned int generateShaderCombinationTag(const Vector<std::string>& shaderFileNames, const Vector<std::string>& shaderDefines);
+    //Forgets the block bound under its name, so that a new block reusing the memory is not taken as bound.
+    void unbindShaderParameterBlock(const ShaderParameterBlock* block);
+    //Writes the block to the parameter ring when it has changed or was written on an earlier frame, and binds the range.
+    //Returns false when the ring has no room for the block.
+    bool streamShaderParameterBlock(ShaderParameterBlockDescription* description, ShaderParameterBlock* block);
+    //Waits for the frames in flight one by one until the range fits.
+    unsigned int allocateParameterRange(unsigned int size);
+    void releaseParameterRing();
     
     GraphicSystemBackEnd* graphicSystemBackEnd;
-    Vector<VertexStream*> vertexStreams;
-    Vector<IndexBuffer*> indexBuffers;
-    Vector<VertexData*> vertexDataComponents;
-    Vector<ShaderProgram*> shaderPrograms;
-    Vector<Shader*> shaders;
-    Vector<Texture*> textures;
-    Vector<RenderTarget*> renderTargets;
-    Vector<ShaderParameterBlock*> shaderParameterBlocks;
+    ResourcePool<VertexStream> vertexStreams;
+    ResourcePool<IndexBuffer> indexBuffers;
+    ResourcePool<VertexData> vertexDataComponents;
+    ResourcePool<ShaderProgram> shaderPrograms;
+    ResourcePool<Shader> shaders;
+    ResourcePool<Texture> textures;
+    ResourcePool<RenderTarget> renderTargets;
+    ResourcePool<ShaderParameterBlock> shaderParameterBlocks;
+    ResourcePool<DrawCommandBuffer> drawCommandBuffers;
 
     VertexData* currentVertexData = nullptr;
     ShaderProgram* currentShaderProgram = nullptr;
     ShaderParameterBlock* currentShaderParameterBlock = nullptr;
+    //The last block bound under each block name, blocks sharing a name replace each other in the binding point.
+    Vector<ShaderParameterBlock*> boundShaderParameterBlocks;
     ViewPort currentViewPort;
     RasterState currentRasterState;
     bool depthWriteEnabled = true;
     bool colorWriteEnabled = true;
+    GraphicStatistics statistics;
+    bool releaseUploadedData = true;
+    RingAllocator parameterRing;
+    unsigned int parameterRingId = 0;
+    unsigned int parameterBlockAlignment = 1;
+    unsigned int frameIndex = 0;
 
 #ifdef USE_OGL
     GraphicSystemBackEnd* CreateGraphicSystemBackEnd() const {return new OGLGraphicSystemBackEnd();}
@@ -27,25 +27,38 @@
 #include "Graphics/VertexData.h"
 #include "Graphics/ShaderParameter.h"
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/ShaderParameterBlock.h"
+#include "Graphics/DrawCommandBuffer.h"
 #include "Util/Vector.h"
 
 namespace Huurre3D
 {
 
-class ShaderParameterBlock;
 class RenderTarget;
 
 class GraphicSystemBackEnd
 {
 public:
-    GraphicSystemBackEnd(){}
+    GraphicSystemBackEnd()
+    {
+        for(int i = 0; i < static_cast<int>(TextureSlotIndex::NumSlots); ++i)
+            texturesInUse[i] = nullptr;
+    }
     virtual ~GraphicSystemBackEnd() {}
 	
+    void setShaderCacheDirectory(const std::string& directory) {}
     void setViewPort(const ViewPort& viewPort) {}
     void clear(unsigned int flags, const Vector4& color) {}
     unsigned int createVertexStream() {return graphicResourceId++;}
     unsigned int createIndexBuffer() {return graphicResourceId++;}
     unsigned int createShaderParameterBlock(const std::string& name)  { return graphicResourceId++; }
+    unsigned int createDrawCommandBuffer() {return graphicResourceId++;}
+    unsigned int createParameterRing(unsigned int size) {return graphicResourceId++;}
+    unsigned int getParameterBlockAlignment() const {return 256;}
+    //Fences are signaled right away as there is no GPU to wait for.
+    unsigned int createFence() {return graphicResourceId++;}
+    bool waitFence(unsigned int fence, bool block) {return true;}
+    void removeFence(unsigned int fence) {}
     unsigned int createVertexData() {return graphicResourceId++;}
     unsigned int createTexture() {return graphicResourceId++;}
     unsigned int createShaderProgram() {return graphicResourceId++;}
@@ -55,22 +68,72 @@ public:
     void removeTexture(unsigned int textureId) {}
     void removeShaderProgram(unsigned int shaderProgramId) {}
     void removeRenderTarget(unsigned int renderTargetId) {}
-    void setVertexData(VertexData *vertexData) {}
-    void setShaderProgram(ShaderProgram* program) {} 
-    void setShaderParameter(ShaderParameterDescription* description, const ShaderParameter& shaderParameter) {}
-    void setShaderParameterBlock(ShaderParameterBlockDescription* description, ShaderParameterBlock* block) {}
-    void setTexture(Texture* texture) {}
+    void setVertexData(VertexData *vertexData)
+    {
+        const Vector<VertexStream*>& vertexStreams = vertexData->getVertexStreams();
+        for(unsigned int i = 0; i < vertexStreams.size(); ++i)
+            vertexStreams[i]->unDirty();
+
+        if(vertexData->isIndexed() && vertexData->getIndexBuffer())
+            vertexData->getIndexBuffer()->unDirty();
+    }
+    //There is no shader reflection without a graphics API, so a program is linked as having every parameter and parameter block the engine sets.
+    void setShaderProgram(ShaderProgram* program)
+    {
+        if(!program->isLinked())
+        {
+            const std::string* names[] = {&sp_worldTransform, &sp_cameraParameters, &sp_lightParameters, &sp_lightGridParameters, &sp_materialProperties, &sp_materialParameterIndex,
+                &sp_lightViewProjectionMatrix, &sp_shadowOcclusionParameters, &sp_shadowOcclusionParameterIndex, &sp_SSAOParameters, &sp_renderTargetSize, &sp_skinMatrixArray, &sp_drawParameters};
+
+            for(unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+            {
+                ShaderParameterDescription parameterDescription;
+                parameterDescription.setName(*names[i]);
+                program->setShaderParameterDescription(parameterDescription);
+                ShaderParameterBlockDescription parameterBlockDescription;
+                parameterBlockDescription.setName(*names[i]);
+                program->setShaderParameterBlockDescription(parameterBlockDescription);
+            }
+
+            program->setLinked(true);
+        }
+    }
+    void setShaderParameter(ShaderParameterDescription* description, const unsigned char* value) {}
+    void setShaderParameterBlock(ShaderParameterBlockDescription* description, ShaderParameterBlock* block)
+    {
+        block->setBindingIndex(description->bindingPoint);
+        description->sourceBlockSetted = true;
+        block->unDirty();
+    }
+    void writeParameterRing(unsigned int ringId, unsigned int offset, const unsigned char* data, unsigned int size) {}
+    void setShaderParameterBlockRange(ShaderParameterBlockDescription* description, ShaderParameterBlock* block, unsigned int ringId, unsigned int offset)
+    {
+        block->setBindingIndex(description->bindingPoint);
+        description->sourceBlockSetted = true;
+    }
+    //Filters the binds like a real back-end does so that the statistics of the null back-end are comparable.
+    bool setTexture(Texture* texture)
+    {
+        int textureSlot = static_cast<int>(texture->getSlotIndex());
+        bool issued = texturesInUse[textureSlot] != texture || texture->isParamsDirty() || texture->isDataDirty();
+        texturesInUse[textureSlot] = texture;
+        texture->unDirtyParams();
+        texture->unDirtyData();
+        return issued;
+    }
     void setDepthWrite(bool enable) {}
     void setColorWrite(bool enable) {}
     void setRasterState(const RasterState& state) {}
     void setOffLineRenderTarget(RenderTarget* renderTarget) {}
     void setMainRenderTarget() {}
     void draw(int numVertices, int vertexOffset) {} 
-    void drawIndexed(int numIndices, int indexOffset) {}
+    void drawIndexed(int numIndices, int indexOffset, int baseVertex) {}
     void drawInstanced(int numIndices, int indexOffset, int instancesCount) {}
+    void drawIndexedIndirect(DrawCommandBuffer* drawCommands) {drawCommands->unDirty();}
 
 private:
     unsigned int graphicResourceId = 0;
+    Texture* texturesInUse[static_cast<int>(TextureSlotIndex::NumSlots)];
 };
 
 }
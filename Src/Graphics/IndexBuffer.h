@@ -31,6 +31,7 @@ class IndexBuffer : public GraphicObject
 {
 public:
     IndexBuffer(IndexType indexType, int numIndices, bool dynamic):
+    GraphicObject(MemoryTag::Geometry),
     indexType(indexType),
     numIndices(numIndices),
     dynamic(dynamic)
@@ -43,7 +44,27 @@ public:
     void setIndices(MemoryBuffer&& indices)
     {
         graphicData = std::move(indices);
-        dirty = true;
+        setWholeDataDirty();
+    }
+    //Changes the number of indices, the kept indices are preserved.
+    void setNumIndices(int numIndices)
+    {
+        this->numIndices = numIndices;
+        graphicData.resize(numIndices * indexSize[static_cast<int>(indexType)]);
+        setWholeDataDirty();
+    }
+    //Copies the indices starting from the first index, only the changed range needs to be uploaded.
+    void updateIndices(unsigned int firstIndex, const unsigned char* indices, unsigned int numUpdatedIndices)
+    {
+        unsigned int size = indexSize[static_cast<int>(indexType)];
+        memcpy(graphicData.getData() + firstIndex * size, indices, numUpdatedIndices * size);
+        setDataRangeDirty(firstIndex * size, (firstIndex + numUpdatedIndices) * size);
+    }
+    void moveIndices(unsigned int fromIndex, unsigned int toIndex, unsigned int numMovedIndices)
+    {
+        unsigned int size = indexSize[static_cast<int>(indexType)];
+        memmove(graphicData.getData() + toIndex * size, graphicData.getData() + fromIndex * size, numMovedIndices * size);
+        setDataRangeDirty(toIndex * size, (toIndex + numMovedIndices) * size);
     }
 
 private:
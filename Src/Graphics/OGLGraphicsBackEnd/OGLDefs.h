@@ -198,7 +198,8 @@ static const GLchar* glAttributeName[] =
     "i_texcoord0",
     "i_texcoord1",
     "i_texcoord2",
-    "i_texcoord3"
+    "i_texcoord3",
+    "i_drawIndex"
 };
 
 static const GLenum glUniformType[] =
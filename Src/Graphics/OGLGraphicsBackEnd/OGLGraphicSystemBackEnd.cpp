@@ -22,10 +22,10 @@
 
 #include "Graphics/OGLGraphicsBackEnd/OGLGraphicSystemBackEnd.h"
 #include "Graphics/OGLGraphicsBackEnd/OGLDefs.h"
-#include "Graphics/OGLGraphicsBackEnd/OGLShaderLoader.h"
 #include "Graphics/VertexData.h"
 #include "Graphics/ShaderParameterBlock.h"
 #include "Graphics/RenderTarget.h"
+#include "Util/Profiler.h"
 
 #include <iostream>
 
@@ -34,6 +34,11 @@ namespace Huurre3D
 
 const int uniformNameBufSize = 256;
 
+void OGLGraphicSystemBackEnd::setShaderCacheDirectory(const std::string& directory)
+{
+    shaderCache.setDirectory(directory);
+}
+
 void OGLGraphicSystemBackEnd::setViewPort(const ViewPort& viewPort)
 {
     glViewport(viewPort.x, viewPort.y, viewPort.width, viewPort.height);
@@ -70,10 +75,76 @@ unsigned int OGLGraphicSystemBackEnd::createIndexBuffer()
 
 unsigned int OGLGraphicSystemBackEnd::createShaderParameterBlock(const std::string& name)
 {
-    shaderParameterBlockNames.pushBack(name);
+    //Blocks sharing a name share the binding point.
+    if(shaderParameterBlockNames.getIndexToItem(name) == -1)
+    {
+        shaderParameterBlockNames.pushBack(name);
+        boundShaderBlockIds.pushBack(0);
+        boundShaderBlockOffsets.pushBack(0);
+    }
+    return createBuffer();
+}
+
+unsigned int OGLGraphicSystemBackEnd::createDrawCommandBuffer()
+{
     return createBuffer();
 }
 
+unsigned int OGLGraphicSystemBackEnd::createParameterRing(unsigned int size)
+{
+    unsigned int ringId = createBuffer();
+    glBindBuffer(GL_UNIFORM_BUFFER, ringId);
+    currentBindedShaderBlockId = ringId;
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    return ringId;
+}
+
+unsigned int OGLGraphicSystemBackEnd::getParameterBlockAlignment() const
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? alignment : 256;
+}
+
+unsigned int OGLGraphicSystemBackEnd::createFence()
+{
+    FenceSync fence;
+    fence.id = ++fenceId;
+    fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fences.pushBack(fence);
+    return fence.id;
+}
+
+bool OGLGraphicSystemBackEnd::waitFence(unsigned int fence, bool block)
+{
+    //Only a few frames are in flight, so the search is short.
+    for(unsigned int i = 0; i < fences.size(); ++i)
+    {
+        if(fences[i].id == fence)
+        {
+            GLenum result = glClientWaitSync(static_cast<GLsync>(fences[i].sync), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while(block && result == GL_TIMEOUT_EXPIRED)
+                result = glClientWaitSync(static_cast<GLsync>(fences[i].sync), GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+            return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED;
+        }
+    }
+    return true;
+}
+
+void OGLGraphicSystemBackEnd::removeFence(unsigned int fence)
+{
+    for(unsigned int i = 0; i < fences.size(); ++i)
+    {
+        if(fences[i].id == fence)
+        {
+            glDeleteSync(static_cast<GLsync>(fences[i].sync));
+            fences.erase(i);
+            return;
+        }
+    }
+}
+
 unsigned int OGLGraphicSystemBackEnd::createBuffer()
 {
     GLuint bufferId;
@@ -124,6 +195,9 @@ void OGLGraphicSystemBackEnd::removeBuffer(unsigned int bufferId)
 
 void OGLGraphicSystemBackEnd::removeVertexData(unsigned int vertexDataId)
 {
+    if(currentVertexData && currentVertexData->getId() == vertexDataId)
+        currentVertexData = nullptr;
+
     glDeleteVertexArrays(1, &vertexDataId);
 }
 
@@ -148,10 +222,18 @@ void OGLGraphicSystemBackEnd::updateVertexStream(VertexStream* stream)
     GLint vertexSize = stream->getVertexSize();
 
     glBindBuffer(GL_ARRAY_BUFFER, stream->getId());
-    glBufferData(GL_ARRAY_BUFFER, vertexSize * numVertices , stream->getGraphicData(), GL_STATIC_DRAW);
-    enableInterleavedAttributes(stream);
+    if(stream->isWholeDataDirty())
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertexSize * numVertices , stream->getGraphicData(), GL_STATIC_DRAW);
+        enableInterleavedAttributes(stream);
+    }
+    else
+    {
+        //Only the changed part of a shared vertex buffer is uploaded.
+        unsigned int rangeBegin = stream->getDirtyRangeBegin();
+        glBufferSubData(GL_ARRAY_BUFFER, rangeBegin, stream->getDirtyRangeEnd() - rangeBegin, stream->getGraphicData() + rangeBegin);
+    }
     stream->unDirty();
-    stream->discardData();
 }
 
 void OGLGraphicSystemBackEnd::updateIndexBuffer(IndexBuffer* buffer)
@@ -159,9 +241,14 @@ void OGLGraphicSystemBackEnd::updateIndexBuffer(IndexBuffer* buffer)
     GLint indexSize = glIndexSize[static_cast<int>(buffer->getIndexType())];
     GLenum usage = buffer->isDynamic() ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer->getId());
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * buffer->getNumIndices(), buffer->getGraphicData(), usage);
+    if(buffer->isWholeDataDirty())
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * buffer->getNumIndices(), buffer->getGraphicData(), usage);
+    else
+    {
+        unsigned int rangeBegin = buffer->getDirtyRangeBegin();
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, rangeBegin, buffer->getDirtyRangeEnd() - rangeBegin, buffer->getGraphicData() + rangeBegin);
+    }
     buffer->unDirty();
-    buffer->discardData();
 }
 
 void OGLGraphicSystemBackEnd::enableInterleavedAttributes(VertexStream* vertexStream)
@@ -183,10 +270,14 @@ void OGLGraphicSystemBackEnd::enableInterleavedAttributes(VertexStream* vertexSt
 void OGLGraphicSystemBackEnd::setVertexData(VertexData *vertexData)
 {
     glBindVertexArray(vertexData->getId());
+    currentVertexData = vertexData;
 
     auto vertexStreams = vertexData->getVertexStreams();
     for(unsigned int i = 0; i < vertexStreams.size(); ++i)
-        updateVertexStream(vertexStreams[i]);
+    {
+        if(vertexStreams[i]->isDirty())
+            updateVertexStream(vertexStreams[i]);
+    }
 
     if(vertexData->isIndexed())
     {
@@ -278,9 +369,8 @@ void OGLGraphicSystemBackEnd::updateTextureData(Texture* texture)
 
     glGenerateMipmap(target);
     texture->unDirtyData();
-
-    texture->discardData();
 }
+
 void OGLGraphicSystemBackEnd::updateCompressedTextureData(Texture* texture)
 {
     GLenum target = glTextureTarget[static_cast<int>(texture->getTargetMode())];
@@ -306,7 +396,25 @@ void OGLGraphicSystemBackEnd::updateCompressedTextureData(Texture* texture)
     }
 
     texture->unDirtyData();
-    texture->discardData();
+}
+
+static void addShaderCacheKey(const Shader* shader, std::string& keyOut)
+{
+    keyOut += shader->getSourceFileName();
+    const Vector<std::string>& defines = shader->getDefines();
+    for(unsigned int i = 0; i < defines.size(); ++i)
+        keyOut += ";" + defines[i];
+
+    keyOut += "\n";
+}
+
+static std::string getShaderCacheKey(const ShaderProgram* program)
+{
+    //The engine defines are part of the sources, a binary compiled with other engine constants is not reused.
+    std::string key = OGLShaderLoader::getEngineDefines();
+    addShaderCacheKey(program->getVertexShader(), key);
+    addShaderCacheKey(program->getFragmentShader(), key);
+    return key;
 }
 
 void OGLGraphicSystemBackEnd::updateShaderProgram(ShaderProgram* program)
@@ -317,6 +425,26 @@ void OGLGraphicSystemBackEnd::updateShaderProgram(ShaderProgram* program)
     GLuint programID = program->getId();
     Shader* vertexShader = program->getVertexShader();
     Shader* fragmentShader = program->getFragmentShader();
+    ShaderCacheEntry cacheEntry;
+    std::string cacheKey = shaderCache.isEnabled() ? getShaderCacheKey(program) : "";
+    bool cached = shaderCache.isEnabled() && shaderCache.readEntry(program->getShaderCombinationTag(), cacheKey, cacheEntry);
+    cacheEntry.key = cacheKey;
+
+    if(cached && loadShaderProgramBinary(program, cacheEntry))
+        return;
+
+    //The dependencies of a stale entry are collected again while loading the sources.
+    if(!cached)
+        cacheEntry.dependencies.clear();
+
+    {
+        PROFILE_ZONE("OGLGraphicSystemBackEnd::preprocessShaders");
+        if(!vertexShader->isCompiled())
+            cached ? vertexShader->setSource(cacheEntry.vertexSource) : loadShaderSource(vertexShader, cacheEntry.dependencies);
+
+        if(!fragmentShader->isCompiled())
+            cached ? fragmentShader->setSource(cacheEntry.fragmentSource) : loadShaderSource(fragmentShader, cacheEntry.dependencies);
+    }
 
     if(!vertexShader->isCompiled())
     {	
@@ -332,6 +460,9 @@ void OGLGraphicSystemBackEnd::updateShaderProgram(ShaderProgram* program)
         glAttachShader(programID, fragmentShader->getId());
     }
 
+    if(shaderCache.isEnabled())
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     //Bind vertex attribute locations using specified layout.
     for(int i = 0; i < static_cast<int>(AttributeSemantic::NumSemantics); ++i)
         glBindAttribLocation(programID, i, glAttributeName[i]);
@@ -359,6 +490,9 @@ void OGLGraphicSystemBackEnd::updateShaderProgram(ShaderProgram* program)
         fetchUniformBlocks(program);
         fetchUniforms(program);
         program->setLinked(true);
+
+        if(shaderCache.isEnabled())
+            storeShaderProgram(program, cacheEntry);
 		
         //Shader program is linked and ready to be used, there is no need to keep shaders in memory.
         vertexShader->getSource().clear();
@@ -380,11 +514,14 @@ void OGLGraphicSystemBackEnd::setShaderProgram(ShaderProgram* program)
     glUseProgram(currentShaderProgramId);
 }
 
-void OGLGraphicSystemBackEnd::compileShader(Shader* shader)
+void OGLGraphicSystemBackEnd::loadShaderSource(Shader* shader, Vector<ShaderCacheDependency>& dependencies)
 {
-    OGLShaderLoader shaderLoader;
     shaderLoader.load(shader);
+    shaderCache.addDependencies(shaderLoader.getSourceFiles(), dependencies);
+}
 
+void OGLGraphicSystemBackEnd::compileShader(Shader* shader)
+{
     GLuint shaderID = shader->getId();
     const GLchar *source = shader->getSource().c_str();
     glShaderSource(shaderID, 1, &source, 0);
@@ -410,6 +547,51 @@ void OGLGraphicSystemBackEnd::compileShader(Shader* shader)
         shader->setCompiled(true);
 }
 
+bool OGLGraphicSystemBackEnd::loadShaderProgramBinary(ShaderProgram* program, const ShaderCacheEntry& cacheEntry)
+{
+    if(cacheEntry.binary.isNull())
+        return false;
+
+    GLuint programID = program->getId();
+    glProgramBinary(programID, cacheEntry.binaryFormat, cacheEntry.binary.getData(), cacheEntry.binary.getSizeInBytes());
+
+    //The driver rejects the binary if it has been updated after the binary was stored.
+    GLint linked = 0;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+    if(!linked)
+        return false;
+
+    fetchUniformBlocks(program);
+    fetchUniforms(program);
+    program->setLinked(true);
+    return true;
+}
+
+void OGLGraphicSystemBackEnd::storeShaderProgram(ShaderProgram* program, ShaderCacheEntry& cacheEntry)
+{
+    //Shaders shared with an already linked program have no source left to store.
+    if(program->getVertexShader()->getSource().empty() || program->getFragmentShader()->getSource().empty())
+        return;
+
+    GLuint programID = program->getId();
+    GLint binaryLength = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+    cacheEntry.vertexSource = program->getVertexShader()->getSource();
+    cacheEntry.fragmentSource = program->getFragmentShader()->getSource();
+    cacheEntry.binary.resetBuffer();
+
+    if(binaryLength > 0)
+    {
+        GLenum binaryFormat = 0;
+        cacheEntry.binary.resize(binaryLength);
+        glGetProgramBinary(programID, binaryLength, NULL, &binaryFormat, cacheEntry.binary.getData());
+        cacheEntry.binaryFormat = binaryFormat;
+    }
+
+    shaderCache.writeEntry(program->getShaderCombinationTag(), cacheEntry);
+}
+
 void OGLGraphicSystemBackEnd::fetchUniformBlocks(ShaderProgram* program)
 {
     GLuint programId = program->getId();
@@ -497,42 +679,42 @@ void OGLGraphicSystemBackEnd::fetchUniforms(ShaderProgram* program)
     }
 }
 
-void OGLGraphicSystemBackEnd::setShaderParameter(ShaderParameterDescription* description, const ShaderParameter& shaderParameter)
+void OGLGraphicSystemBackEnd::setShaderParameter(ShaderParameterDescription* description, const unsigned char* value)
 {    
     switch(description->type)
     {
         case ShaderParameterType::Float:
-            glProgramUniform1fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)shaderParameter.value);
+            glProgramUniform1fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)value);
             break;
         case ShaderParameterType::FloatVector2:
-            glProgramUniform2fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)shaderParameter.value);
+            glProgramUniform2fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)value);
             break;
         case ShaderParameterType::FloatVector3:
-            glProgramUniform3fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)shaderParameter.value);
+            glProgramUniform3fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)value);
             break;
         case ShaderParameterType::FloatVector4:
-            glProgramUniform4fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)shaderParameter.value);
+            glProgramUniform4fv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLfloat*)value);
             break;
         case ShaderParameterType::Int:
-            glProgramUniform1iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)shaderParameter.value);
+            glProgramUniform1iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)value);
             break;
         case ShaderParameterType::IntVector2:
-            glProgramUniform2iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)shaderParameter.value);
+            glProgramUniform2iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)value);
             break;
         case ShaderParameterType::IntVector3:
-            glProgramUniform3iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)shaderParameter.value);
+            glProgramUniform3iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)value);
             break;
         case ShaderParameterType::IntVector4:
-            glProgramUniform4iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)shaderParameter.value);
+            glProgramUniform4iv(currentShaderProgramId, description->shaderIndex, description->arraySize, (const GLint*)value);
             break;
         case ShaderParameterType::FloatMatrix2:
-            glProgramUniformMatrix2fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)shaderParameter.value);
+            glProgramUniformMatrix2fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)value);
             break;
         case ShaderParameterType::FloatMatrix3:
-            glProgramUniformMatrix3fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)shaderParameter.value);
+            glProgramUniformMatrix3fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)value);
             break;
         case ShaderParameterType::FloatMatrix4:
-            glProgramUniformMatrix4fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)shaderParameter.value);
+            glProgramUniformMatrix4fv(currentShaderProgramId, description->shaderIndex, description->arraySize, false, (const GLfloat*)value);
             break;
     }
 }
@@ -547,28 +729,76 @@ void OGLGraphicSystemBackEnd::setShaderParameterBlock(ShaderParameterBlockDescri
         currentBindedShaderBlockId = blockId;
     }
 
-    if(!block->hasBindingIndex() || !description->sourceBlockSetted)
+    unsigned int bindingPoint = description->bindingPoint;
+    if(!description->sourceBlockSetted)
     {
-        unsigned int bindingPoint = description->bindingPoint;
-
-        //glBindBuffer(GL_UNIFORM_BUFFER, block->getId());
         glUniformBlockBinding(currentShaderProgramId, description->shaderIndex, bindingPoint);
+        description->sourceBlockSetted = true;
+    }
+
+    if(!block->hasBindingIndex() || boundShaderBlockIds[bindingPoint] != blockId)
+    {
         glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, blockId);
         block->setBindingIndex(bindingPoint);
-        description->sourceBlockSetted = true;
+        boundShaderBlockIds[bindingPoint] = blockId;
+        boundShaderBlockOffsets[bindingPoint] = 0;
     }
 
     if(block->isDirty())
         updateShaderParameterBlock(block);
 }
 
+void OGLGraphicSystemBackEnd::writeParameterRing(unsigned int ringId, unsigned int offset, const unsigned char* data, unsigned int size)
+{
+    if(currentBindedShaderBlockId != ringId)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ringId);
+        currentBindedShaderBlockId = ringId;
+    }
+
+    void* range = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if(range)
+    {
+        memcpy(range, data, size);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+    else
+        std::cout << "Failed to map the parameter ring range at " << offset << std::endl;
+}
+
+void OGLGraphicSystemBackEnd::setShaderParameterBlockRange(ShaderParameterBlockDescription* description, ShaderParameterBlock* block, unsigned int ringId, unsigned int offset)
+{
+    unsigned int bindingPoint = description->bindingPoint;
+    if(!description->sourceBlockSetted)
+    {
+        glUniformBlockBinding(currentShaderProgramId, description->shaderIndex, bindingPoint);
+        description->sourceBlockSetted = true;
+    }
+
+    if(boundShaderBlockIds[bindingPoint] != ringId || boundShaderBlockOffsets[bindingPoint] != offset)
+    {
+        //Binding the range also binds the ring to the generic uniform buffer target.
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ringId, offset, block->getSizeInBytes());
+        currentBindedShaderBlockId = ringId;
+        boundShaderBlockIds[bindingPoint] = ringId;
+        boundShaderBlockOffsets[bindingPoint] = offset;
+    }
+    block->setBindingIndex(bindingPoint);
+}
+
 void OGLGraphicSystemBackEnd::updateShaderParameterBlock(ShaderParameterBlock* block)
 {
-    glBufferData(GL_UNIFORM_BUFFER, block->getSizeInBytes(), block->getGraphicData(), GL_STREAM_DRAW);
+    if(block->isWholeDataDirty())
+        glBufferData(GL_UNIFORM_BUFFER, block->getSizeInBytes(), block->getGraphicData(), GL_STREAM_DRAW);
+    else
+    {
+        unsigned int rangeBegin = block->getDirtyRangeBegin();
+        glBufferSubData(GL_UNIFORM_BUFFER, rangeBegin, block->getDirtyRangeEnd() - rangeBegin, block->getGraphicData() + rangeBegin);
+    }
     block->unDirty();
 }
 
-void OGLGraphicSystemBackEnd::setTexture(Texture* texture)
+bool OGLGraphicSystemBackEnd::setTexture(Texture* texture)
 {
     int textureSlot = static_cast<int>(texture->getSlotIndex());
 
@@ -587,6 +817,7 @@ void OGLGraphicSystemBackEnd::setTexture(Texture* texture)
             updateTexture(texture);
 
         texturesInUse[textureSlot] = texture;
+        return true;
     }
     else
     {
@@ -601,8 +832,11 @@ void OGLGraphicSystemBackEnd::setTexture(Texture* texture)
             GLenum target = glTextureTarget[static_cast<int>(texture->getTargetMode())];
             glBindTexture(target, texture->getId());
             updateTexture(texture);
+            return true;
         }
     }
+
+    return false;
 }
 
 void OGLGraphicSystemBackEnd::setRasterState(const RasterState& state)
@@ -740,10 +974,13 @@ void OGLGraphicSystemBackEnd::draw(int numVertices, int vertexOffset)
     glDrawArrays(glPrimitiveType[static_cast<int>(currentPrimitiveType)], vertexOffset, numVertices);
 }
 
-void OGLGraphicSystemBackEnd::drawIndexed(int numIndices, int indexOffset)
+void OGLGraphicSystemBackEnd::drawIndexed(int numIndices, int indexOffset, int baseVertex)
 {    
     int indexType = static_cast<int>(currentIndexType);
-    glDrawElements(glPrimitiveType[static_cast<int>(currentPrimitiveType)], numIndices, glIndexType[indexType], (GLvoid*)(indexOffset * glIndexSize[indexType]));
+    if(baseVertex)
+        glDrawElementsBaseVertex(glPrimitiveType[static_cast<int>(currentPrimitiveType)], numIndices, glIndexType[indexType], (GLvoid*)(indexOffset * glIndexSize[indexType]), baseVertex);
+    else
+        glDrawElements(glPrimitiveType[static_cast<int>(currentPrimitiveType)], numIndices, glIndexType[indexType], (GLvoid*)(indexOffset * glIndexSize[indexType]));
 }
 
 void OGLGraphicSystemBackEnd::drawInstanced(int numIndices, int indexOffset, int instancesCount)
@@ -752,4 +989,63 @@ void OGLGraphicSystemBackEnd::drawInstanced(int numIndices, int indexOffset, int
     glDrawElementsInstanced(glPrimitiveType[static_cast<int>(currentPrimitiveType)], numIndices, glIndexType[indexType], (GLvoid*)(indexOffset * glIndexSize[indexType]), instancesCount);
 }
 
+void OGLGraphicSystemBackEnd::drawIndexedIndirect(DrawCommandBuffer* drawCommands)
+{
+    int indexType = static_cast<int>(currentIndexType);
+    GLenum primitiveType = glPrimitiveType[static_cast<int>(currentPrimitiveType)];
+
+    if(GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)
+    {
+        enableDrawIndexAttribute();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommands->getId());
+
+        if(drawCommands->isDirty())
+        {
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCommands->getGraphicDataSize(), drawCommands->getGraphicData(), GL_STREAM_DRAW);
+            drawCommands->unDirty();
+        }
+
+        glMultiDrawElementsIndirect(primitiveType, glIndexType[indexType], 0, drawCommands->getNumCommands(), sizeof(DrawIndexedCommand));
+    }
+    else
+    {
+        //The draw index attribute has no array here, so its constant value is read by the draws.
+        GLuint drawIndexLocation = static_cast<GLuint>(AttributeSemantic::DrawIndex);
+
+        for(unsigned int i = 0; i < drawCommands->getNumCommands(); ++i)
+        {
+            const DrawIndexedCommand& command = drawCommands->getCommand(i);
+            glVertexAttribI1ui(drawIndexLocation, command.baseInstance);
+            glDrawElementsBaseVertex(primitiveType, command.numIndices, glIndexType[indexType], (GLvoid*)(command.firstIndex * glIndexSize[indexType]), command.baseVertex);
+        }
+
+        drawCommands->unDirty();
+    }
+}
+
+void OGLGraphicSystemBackEnd::enableDrawIndexAttribute()
+{
+    if(drawIndexBufferId == 0)
+    {
+        Vector<unsigned int> drawIndices;
+        for(unsigned int i = 0; i < MaxDrawCommands; ++i)
+            drawIndices.pushBack(i);
+
+        drawIndexBufferId = createBuffer();
+        glBindBuffer(GL_ARRAY_BUFFER, drawIndexBufferId);
+        glBufferData(GL_ARRAY_BUFFER, drawIndices.size() * sizeof(unsigned int), drawIndices.begin(), GL_STATIC_DRAW);
+    }
+
+    //The flag belongs to the vertex data, so a vertex array created under the name of a removed one sets the attribute up again.
+    if(!currentVertexData->hasDrawIndexAttribute())
+    {
+        GLuint drawIndexLocation = static_cast<GLuint>(AttributeSemantic::DrawIndex);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIndexBufferId);
+        glEnableVertexAttribArray(drawIndexLocation);
+        glVertexAttribIPointer(drawIndexLocation, 1, GL_UNSIGNED_INT, 0, 0);
+        glVertexAttribDivisor(drawIndexLocation, 1);
+        currentVertexData->setDrawIndexAttribute(true);
+    }
+}
+
 }
\ No newline at end of file
@@ -23,6 +23,8 @@
 #define OGLGraphicSystemBackEnd_H
 
 #include "Graphics/GraphicSystemBackEnd.h"
+#include "Graphics/OGLGraphicsBackEnd/OGLShaderCache.h"
+#include "Graphics/OGLGraphicsBackEnd/OGLShaderLoader.h"
 
 namespace Huurre3D
 {
@@ -37,11 +39,23 @@ public:
     OGLGraphicSystemBackEnd() = default;
     ~OGLGraphicSystemBackEnd() = default;
 
+    //Enables the persistent shader program binary cache, an empty directory disables it.
+    void setShaderCacheDirectory(const std::string& directory);
     void setViewPort(const ViewPort& viewPort);
     void clear(unsigned int flags, const Vector4& color);
     unsigned int createVertexStream();
     unsigned int createIndexBuffer();
     unsigned int createShaderParameterBlock(const std::string& name);
+    unsigned int createDrawCommandBuffer();
+    //Allocates the uniform buffer the streamed parameter blocks are written to.
+    unsigned int createParameterRing(unsigned int size);
+    //Offset alignment of the uniform buffer ranges.
+    unsigned int getParameterBlockAlignment() const;
+    //Inserts a fence into the command stream.
+    unsigned int createFence();
+    //Returns true when the GPU has passed the fence, blocks until then when asked to.
+    bool waitFence(unsigned int fence, bool block);
+    void removeFence(unsigned int fence);
     //Generates a vertex array object, that is used to encapsulate the vertex data state.
     unsigned int createVertexData();
     //Generates a texture object.
@@ -60,11 +74,16 @@ public:
     //Sets the shader program as the currently active shader program.
     void setShaderProgram(ShaderProgram* program);
     //Sets the uniform (shader parameter) to the currently active shader program.
-    void setShaderParameter(ShaderParameterDescription* description, const ShaderParameter& shaderParameter);
+    void setShaderParameter(ShaderParameterDescription* description, const unsigned char* value);
     //binds the uniform buffer (shader parameter block) to the currently active shader program.
     void setShaderParameterBlock(ShaderParameterBlockDescription* description, ShaderParameterBlock* block);
+    //Writes to the ring without synchronization, the caller makes sure the GPU no longer reads the range.
+    void writeParameterRing(unsigned int ringId, unsigned int offset, const unsigned char* data, unsigned int size);
+    //binds the range of the ring holding the block to the currently active shader program.
+    void setShaderParameterBlockRange(ShaderParameterBlockDescription* description, ShaderParameterBlock* block, unsigned int ringId, unsigned int offset);
     //Sets the texture as active texture and binds it.
-    void setTexture(Texture* texture);
+    //Returns false when the texture was already bound to its slot and had nothing to update.
+    bool setTexture(Texture* texture);
     void setDepthWrite(bool enable);
     void setColorWrite(bool enable);
     //sets the cull, depth compare and blend modes
@@ -76,8 +95,10 @@ public:
     //Draws the currently active vertex buffer. 
     void draw(int numVertices, int vertexOffset);
     //Draws the currently active vertex  and index buffer. 
-    void drawIndexed(int numIndices, int indexOffset);
+    void drawIndexed(int numIndices, int indexOffset, int baseVertex);
     void drawInstanced(int numIndices, int indexOffset, int instancesCount);
+    //Uses a multi-draw when the draw indirect and base instance extensions are supported, otherwise draws the commands one by one.
+    void drawIndexedIndirect(DrawCommandBuffer* drawCommands);
 
 private:
     //Generates a buffer object for attribute, index and uniform buffers.
@@ -88,9 +109,15 @@ private:
     void updateShaderParameterBlock(ShaderParameterBlock* block);
     void updateVertexStream(VertexStream* stream);
     void updateIndexBuffer(IndexBuffer* buffer);
-    //Builds a shader program from vertex and fragment shader sources.
-    void loadShaderProgram(Shader* vertexShader, Shader* fragmentShader);
+    //Sources the draw index attribute of the current vertex array from the base instance of the draws.
+    void enableDrawIndexAttribute();
+    //Reads and preprocesses the shader source, the read files are added to the dependencies of the cache entry.
+    void loadShaderSource(Shader* shader, Vector<ShaderCacheDependency>& dependencies);
     void compileShader(Shader* shader);
+    //Links the program from the binary stored in the cache entry.
+    bool loadShaderProgramBinary(ShaderProgram* program, const ShaderCacheEntry& cacheEntry);
+    //Stores the preprocessed sources and the binary of the linked program into the shader cache.
+    void storeShaderProgram(ShaderProgram* program, ShaderCacheEntry& cacheEntry);
     //Fetches the needed information of the uniform blocks.
     void fetchUniformBlocks(ShaderProgram* program);
     //Fetches the needed information of single uniforms, when uniform buffers are not supported.
@@ -110,11 +137,27 @@ private:
     unsigned int currentShaderProgramId = 0;
     unsigned int currentFBOId = 0;
     unsigned int currentBindedShaderBlockId = 0;
+    VertexData* currentVertexData = nullptr;
+    //Holds the draw indices, an instanced attribute fetches the index at the base instance of a draw.
+    unsigned int drawIndexBufferId = 0;
     PrimitiveType currentPrimitiveType = PrimitiveType::Triangles;
     IndexType currentIndexType = IndexType::Short;
     Vector4 currentClearColor = Vector4::ZERO;
     //Used to define binding points for each different buffer.
     Vector<std::string> shaderParameterBlockNames;
+    //Buffer and the offset of the range currently bound to each binding point.
+    Vector<unsigned int> boundShaderBlockIds;
+    Vector<unsigned int> boundShaderBlockOffsets;
+    struct FenceSync
+    {
+        unsigned int id;
+        //The GLsync, the GL headers are not included here.
+        void* sync;
+    };
+    Vector<FenceSync> fences;
+    unsigned int fenceId = 0;
+    OGLShaderCache shaderCache;
+    OGLShaderLoader shaderLoader;
 };
 
 }
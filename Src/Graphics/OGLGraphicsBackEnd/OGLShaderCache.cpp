@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Graphics/OGLGraphicsBackEnd/OGLShaderCache.h"
+#include "Math/MathFunctions.h"
+#include <sys/stat.h>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace Huurre3D
+{
+
+const unsigned int shaderCacheMagic = 0x43533348; //"H3SC"
+const unsigned int shaderCacheVersion = 2;
+const std::string shaderCacheFileExtension = ".h3sc";
+
+static void writeUInt(std::ofstream& file, unsigned int value)
+{
+    file.write((const char*)&value, sizeof(unsigned int));
+}
+
+static void writeString(std::ofstream& file, const std::string& value)
+{
+    writeUInt(file, value.size());
+    file.write(value.c_str(), value.size());
+}
+
+static bool readUInt(std::ifstream& file, unsigned int& value)
+{
+    file.read((char*)&value, sizeof(unsigned int));
+    return file.good();
+}
+
+//Bytes left in the file after the read position, a size read from the file is checked against it before anything is allocated.
+static unsigned int getRemainingSize(std::ifstream& file, unsigned int fileSize)
+{
+    std::streamoff position = file.tellg();
+    return position >= 0 && position <= static_cast<std::streamoff>(fileSize) ? fileSize - static_cast<unsigned int>(position) : 0;
+}
+
+static bool readString(std::ifstream& file, unsigned int fileSize, std::string& value)
+{
+    unsigned int size = 0;
+    if(!readUInt(file, size) || size > getRemainingSize(file, fileSize))
+        return false;
+
+    value.resize(size);
+    if(size)
+        file.read(&value[0], size);
+
+    return file.good();
+}
+
+void OGLShaderCache::setDirectory(const std::string& directory)
+{
+    this->directory = directory;
+
+    if(!this->directory.empty())
+    {
+        if(this->directory.back() != '/')
+            this->directory += "/";
+
+        //Create the directory if it does not exist yet, failing here just means that the entries can not be written.
+#ifdef _WIN32
+        _mkdir(this->directory.c_str());
+#else
+        mkdir(this->directory.c_str(), 0755);
+#endif
+    }
+}
+
+bool OGLShaderCache::readEntry(unsigned int shaderCombinationTag, const std::string& key, ShaderCacheEntry& entryOut) const
+{
+    std::string fileName = getEntryFileName(shaderCombinationTag, key);
+    std::ifstream file(fileName, std::ios::binary);
+
+    if(!file)
+        return false;
+
+    file.seekg(0, std::ios::end);
+    unsigned int fileSize = static_cast<unsigned int>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    //A torn or corrupt entry is a miss, and it is removed so that it is written again.
+    auto discardEntry = [&file, &fileName]()
+    {
+        file.close();
+        std::cout << "Failed to read shader cache file: " << fileName << ", the entry is removed" << std::endl;
+        remove(fileName.c_str());
+        return false;
+    };
+
+    unsigned int magic = 0;
+    unsigned int version = 0;
+    if(!readUInt(file, magic) || !readUInt(file, version) || magic != shaderCacheMagic || version != shaderCacheVersion)
+        return discardEntry();
+
+    //The hash of the file name can collide, the key tells the entries of different programs apart.
+    if(!readString(file, fileSize, entryOut.key))
+        return discardEntry();
+    if(entryOut.key != key)
+        return false;
+
+    unsigned int numDependencies = 0;
+    if(!readUInt(file, numDependencies))
+        return discardEntry();
+
+    //The entry is stale if the contents of any of the source files have changed since it was written.
+    for(unsigned int i = 0; i < numDependencies; ++i)
+    {
+        ShaderCacheDependency dependency;
+        ShaderCacheDependency currentDependency;
+        if(!readString(file, fileSize, dependency.fileName) || !readUInt(file, dependency.size) || !readUInt(file, dependency.contentHash))
+            return discardEntry();
+
+        if(!readDependency(dependency.fileName, currentDependency) || currentDependency.size != dependency.size || currentDependency.contentHash != dependency.contentHash)
+            return false;
+
+        entryOut.dependencies.pushBack(dependency);
+    }
+
+    if(!readString(file, fileSize, entryOut.vertexSource) || !readString(file, fileSize, entryOut.fragmentSource))
+        return discardEntry();
+
+    unsigned int binarySize = 0;
+    if(!readUInt(file, entryOut.binaryFormat) || !readUInt(file, binarySize) || binarySize > getRemainingSize(file, fileSize))
+        return discardEntry();
+
+    if(binarySize)
+    {
+        entryOut.binary.resize(binarySize);
+        file.read((char*)entryOut.binary.getData(), binarySize);
+        if(!file.good())
+        {
+            entryOut.binary.resetBuffer();
+            return discardEntry();
+        }
+    }
+
+    return true;
+}
+
+bool OGLShaderCache::writeEntry(unsigned int shaderCombinationTag, const ShaderCacheEntry& entry) const
+{
+    std::string fileName = getEntryFileName(shaderCombinationTag, entry.key);
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+    if(!file)
+    {
+        std::cout << "Failed to write shader cache file: " << fileName << std::endl;
+        return false;
+    }
+
+    writeUInt(file, shaderCacheMagic);
+    writeUInt(file, shaderCacheVersion);
+    writeString(file, entry.key);
+    writeUInt(file, entry.dependencies.size());
+
+    for(unsigned int i = 0; i < entry.dependencies.size(); ++i)
+    {
+        writeString(file, entry.dependencies[i].fileName);
+        writeUInt(file, entry.dependencies[i].size);
+        writeUInt(file, entry.dependencies[i].contentHash);
+    }
+
+    writeString(file, entry.vertexSource);
+    writeString(file, entry.fragmentSource);
+    writeUInt(file, entry.binaryFormat);
+    writeUInt(file, entry.binary.getSizeInBytes());
+
+    if(!entry.binary.isNull())
+        file.write((const char*)entry.binary.getData(), entry.binary.getSizeInBytes());
+
+    return file.good();
+}
+
+void OGLShaderCache::addDependencies(const Vector<std::string>& fileNames, Vector<ShaderCacheDependency>& dependenciesOut) const
+{
+    for(unsigned int i = 0; i < fileNames.size(); ++i)
+    {
+        const std::string& fileName = fileNames[i];
+        if(dependenciesOut.getIndexToItem([&fileName](const ShaderCacheDependency& dependency){return dependency.fileName == fileName;}) == -1)
+        {
+            //A file that can not be read is stored with an empty content, the entry is then never valid.
+            ShaderCacheDependency dependency;
+            readDependency(fileName, dependency);
+            dependency.fileName = fileName;
+            dependenciesOut.pushBack(dependency);
+        }
+    }
+}
+
+std::string OGLShaderCache::getEntryFileName(unsigned int shaderCombinationTag, const std::string& key) const
+{
+    std::stringstream fileName;
+    fileName << directory << std::hex << shaderCombinationTag << "_" << generateHash((const unsigned char*)key.c_str(), key.size()) << shaderCacheFileExtension;
+    return fileName.str();
+}
+
+bool OGLShaderCache::readDependency(const std::string& fileName, ShaderCacheDependency& dependencyOut) const
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if(!file)
+        return false;
+
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string contentString = content.str();
+    dependencyOut.size = contentString.size();
+    dependencyOut.contentHash = generateHash((const unsigned char*)contentString.c_str(), contentString.size());
+    return true;
+}
+
+}
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef OGLShaderCache_H
+#define OGLShaderCache_H
+
+#include "Util/Vector.h"
+#include "Util/MemoryBuffer.h"
+#include <string>
+
+namespace Huurre3D
+{
+
+struct ShaderCacheDependency
+{
+    std::string fileName;
+    unsigned int size = 0;
+    unsigned int contentHash = 0;
+};
+
+struct ShaderCacheEntry
+{
+    //Source file names and defines of the program's shaders, the entry of another program with the same combination tag is not used.
+    std::string key;
+    //Every source file that was read when the shaders were preprocessed, including the includes.
+    Vector<ShaderCacheDependency> dependencies;
+    std::string vertexSource;
+    std::string fragmentSource;
+    unsigned int binaryFormat = 0;
+    MemoryBuffer binary;
+};
+
+//Persistent on disk cache of the preprocessed shader sources and linked program binaries.
+//One file is stored per shader combination tag and key. An entry is valid as long as its key matches and the contents of its source files
+//are the ones it was preprocessed from.
+class OGLShaderCache
+{
+public:
+    OGLShaderCache() = default;
+    ~OGLShaderCache() = default;
+
+    void setDirectory(const std::string& directory);
+    bool isEnabled() const {return !directory.empty();}
+    bool readEntry(unsigned int shaderCombinationTag, const std::string& key, ShaderCacheEntry& entryOut) const;
+    bool writeEntry(unsigned int shaderCombinationTag, const ShaderCacheEntry& entry) const;
+    void addDependencies(const Vector<std::string>& fileNames, Vector<ShaderCacheDependency>& dependenciesOut) const;
+
+private:
+    std::string getEntryFileName(unsigned int shaderCombinationTag, const std::string& key) const;
+    bool readDependency(const std::string& fileName, ShaderCacheDependency& dependencyOut) const;
+
+    std::string directory;
+};
+
+}
+
+#endif
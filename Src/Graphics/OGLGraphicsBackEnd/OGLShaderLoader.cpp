@@ -19,83 +19,177 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include "Engine/Engine.h"
 #include "Graphics/OGLGraphicsBackEnd/OGLShaderLoader.h"
 #include "Graphics/Shader.h"
+#include "Graphics/DrawCommandBuffer.h"
+#include <sys/stat.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 namespace Huurre3D
 {
 
+OGLShaderLoader::~OGLShaderLoader()
+{
+    for(auto i = sourceFileCache.begin(); i != sourceFileCache.end(); ++i)
+        delete i->second;
+}
+
 void OGLShaderLoader::load(Shader* shader)
 {
     shaderInProcess = shader;
-    loadShaderSource(shader->getSourceFileName());
+    sourceFiles.clear();
+    ++currentLoadId;
+    appendSourceFile(shader->getSourceFileName());
     shader->setSource(processedSource);
     processedSource.clear();
-    processedIncludes.clear();
-    currentDirectoryPath.clear();
     shaderInProcess = nullptr;
 }
 
-bool OGLShaderLoader::loadShaderSource(const std::string& fileName)
+bool OGLShaderLoader::appendSourceFile(const std::string& fileName)
 {
-    std::ifstream file(fileName);
+    ShaderSourceFile* sourceFile = getSourceFile(fileName);
 
-    if(!file)
-    {
-        std::cout <<"Failed to load Shader file: " << fileName << std::endl;
+    if(!sourceFile)
         return false;
-    }
 
-    currentDirectoryPath = fileName.substr(0, fileName.find_last_of("/") + 1);
-    std::string line;
-    while(file.good()) 
+    //The file has already been included into this shader.
+    if(sourceFile->loadId == currentLoadId)
+        return true;
+
+    sourceFile->loadId = currentLoadId;
+    sourceFiles.pushBack(sourceFile->fileName);
+
+    for(unsigned int i = 0; i < sourceFile->segments.size(); ++i)
     {
-        std::getline(file, line);
-        parseLine(line);
-        processedSource.append(line + "\n");
+        const std::string& segment = sourceFile->segments[i];
+
+        if(static_cast<int>(i) == sourceFile->versionSegment)
+        {
+            processedSource.append(segment, 0, sourceFile->versionEnd);
+            appendDefines();
+            processedSource.append(segment, sourceFile->versionEnd, std::string::npos);
+        }
+        else
+            processedSource.append(segment);
+
+        if(i < sourceFile->includeFileNames.size() && !appendSourceFile(sourceFile->includeFileNames[i]))
+            std::cout <<"Failed to load include file: " << sourceFile->includeFileNames[i] << std::endl;
     }
 
-    file.close();
     return true;
 }
 
-void OGLShaderLoader::parseLine(std::string& line)
+std::string OGLShaderLoader::getEngineDefines()
+{
+    return "#define MAX_DRAW_COMMANDS " + std::to_string(MaxDrawCommands) + "\n";
+}
+
+void OGLShaderLoader::appendDefines()
 {
-    if(line.find(version) == 0)
-        addDefines(line);
-    else if(line.find(include) == 0)
-        processInclude(line);
+    const Vector<std::string>& shaderDefines = shaderInProcess->getDefines();
+    for(unsigned int i = 0; i < shaderDefines.size(); ++i)
+    {
+        processedSource.append(define);
+        processedSource.append(shaderDefines[i]);
+        processedSource.append("\n");
+    }
+
+    processedSource.append(getEngineDefines());
 }
 
-void OGLShaderLoader::processInclude(std::string& line)
+ShaderSourceFile* OGLShaderLoader::getSourceFile(const std::string& fileName)
 {
-    std::string includeName = std::string(line, include.size(), std::string::npos);
-    includeName.erase(0, includeName.find_first_not_of(" \""));
-    includeName.erase(includeName.find_last_not_of(" \"") + 1);
+    long long modificationTime = getModificationTime(fileName);
+    ShaderSourceFile*& sourceFile = sourceFileCache[fileName];
+
+    if(sourceFile)
+    {
+        //A file whose modification time can't be read is parsed again, so a removed file is not taken from the cache.
+        if(modificationTime != -1 && sourceFile->modificationTime == modificationTime)
+            return sourceFile;
+    }
+    else
+    {
+        sourceFile = new ShaderSourceFile();
+        sourceFile->fileName = fileName;
+    }
 
-    if(!processedIncludes.containsItem(includeName))
+    //The file is new or it has been modified after it was parsed.
+    sourceFile->modificationTime = modificationTime;
+    if(!parseSourceFile(sourceFile))
     {
-        processedIncludes.pushBack(includeName);
-        //Remove the include definition
-        line = "";
-
-        //Get the path to the actual file.
-        std::string includeFile = currentDirectoryPath + includeName;
-        if(!loadShaderSource(includeFile.c_str()))
-            std::cout <<"Failed to load include file: " <<includeFile<<std::endl;
+        //A file which fails to parse is not cached, so every shader including it reports the failure.
+        delete sourceFile;
+        sourceFileCache.erase(fileName);
+        return nullptr;
     }
+
+    return sourceFile;
 }
 
-void OGLShaderLoader::addDefines(std::string& line)
+bool OGLShaderLoader::parseSourceFile(ShaderSourceFile* sourceFile)
 {
-    Vector<std::string> shaderDefines = shaderInProcess->getDefines();
-    for(unsigned int i = 0; i < shaderDefines.size(); ++i)
+    std::ifstream file(sourceFile->fileName);
+
+    if(!file)
+    {
+        std::cout <<"Failed to load Shader file: " << sourceFile->fileName << std::endl;
+        return false;
+    }
+
+    std::stringstream fileContent;
+    fileContent << file.rdbuf();
+    const std::string source = fileContent.str();
+    const std::string directoryPath = sourceFile->fileName.substr(0, sourceFile->fileName.find_last_of("/") + 1);
+
+    sourceFile->segments.clear();
+    sourceFile->includeFileNames.clear();
+    sourceFile->versionSegment = -1;
+    sourceFile->versionEnd = 0;
+
+    std::string::size_type segmentStart = 0;
+    std::string::size_type lineStart = 0;
+
+    while(lineStart < source.size())
     {
-        line += "\n" + define + shaderDefines[i] + "\n";
+        std::string::size_type lineEnd = source.find('\n', lineStart);
+        lineEnd = (lineEnd == std::string::npos) ? source.size() : lineEnd;
+
+        if(source.compare(lineStart, include.size(), include) == 0)
+        {
+            std::string includeName = source.substr(lineStart + include.size(), lineEnd - lineStart - include.size());
+            includeName.erase(0, includeName.find_first_not_of(" \""));
+            includeName.erase(includeName.find_last_not_of(" \"\r") + 1);
+
+            //End the segment at the include directive, the line break is kept so that the line numbers stay close to the source file.
+            sourceFile->segments.pushBack(source.substr(segmentStart, lineStart - segmentStart));
+            sourceFile->includeFileNames.pushBack(directoryPath + includeName);
+            segmentStart = lineEnd;
+        }
+        else if(sourceFile->versionSegment == -1 && source.compare(lineStart, version.size(), version) == 0)
+        {
+            sourceFile->versionSegment = sourceFile->segments.size();
+            sourceFile->versionEnd = (lineEnd < source.size() ? lineEnd + 1 : lineEnd) - segmentStart;
+        }
+
+        lineStart = lineEnd + 1;
     }
+
+    sourceFile->segments.pushBack(source.substr(segmentStart, std::string::npos));
+
+    //Terminate the last line like the rest of the lines.
+    if(!source.empty() && source.back() != '\n')
+        sourceFile->segments.back().append("\n");
+
+    return true;
 }
 
-}
\ No newline at end of file
+long long OGLShaderLoader::getModificationTime(const std::string& fileName) const
+{
+    struct stat fileStatus;
+    return stat(fileName.c_str(), &fileStatus) == 0 ? static_cast<long long>(fileStatus.st_mtime) : -1;
+}
+
+}
@@ -24,29 +24,53 @@
 
 #include "Util/Vector.h"
 #include <string>
+#include <unordered_map>
 
 namespace Huurre3D
 {
 
 class Shader;
 
+struct ShaderSourceFile
+{
+    std::string fileName;
+    long long modificationTime = -1;
+    //The source is split at the include directives, segment i is followed by the file of include i.
+    Vector<std::string> segments;
+    Vector<std::string> includeFileNames;
+    //The defines are inserted into the segment containing the #version directive, right after the directive line.
+    int versionSegment = -1;
+    unsigned int versionEnd = 0;
+    //Id of the last load this file was appended to, used to expand each include only once per shader.
+    unsigned int loadId = 0;
+};
+
+//Preprocesses the shader sources. The parsed files are kept in memory and parsed again only when the file has been modified,
+//so the includes shared by the shaders are read from the disk only once.
 class OGLShaderLoader
 {
 public:
     OGLShaderLoader() = default;
-    ~OGLShaderLoader() = default;
+    ~OGLShaderLoader();
     void load(Shader* shader);
+    //Defines of the engine constants, added to every shader after the defines of the shader.
+    static std::string getEngineDefines();
+    //Files read by the last load, the shader source file and its includes.
+    const Vector<std::string>& getSourceFiles() const {return sourceFiles;}
 
 private: 
-    bool loadShaderSource(const std::string& fileName);
-    void parseLine(std::string& line);
-    void processInclude(std::string& line);
-    void addDefines(std::string& line);
+    bool appendSourceFile(const std::string& fileName);
+    void appendDefines();
+    ShaderSourceFile* getSourceFile(const std::string& fileName);
+    bool parseSourceFile(ShaderSourceFile* sourceFile);
+    long long getModificationTime(const std::string& fileName) const;
 
     Shader* shaderInProcess = nullptr;
     std::string processedSource;
-    Vector<std::string> processedIncludes;
-    std::string currentDirectoryPath;
+    Vector<std::string> sourceFiles;
+    //Keyed by the file name, the files are found without comparing the name of every cached file.
+    std::unordered_map<std::string, ShaderSourceFile*> sourceFileCache;
+    unsigned int currentLoadId = 0;
     const std::string include = "#include";
     const std::string version = "#version";
     const std::string define = "#define ";
@@ -55,4 +79,3 @@ private:
 }
 
 #endif
-
@@ -69,4 +69,15 @@ void RenderTarget::setSize(int width, int height)
         depthBuffer->setSize(width, height);
 }
 
-}
\ No newline at end of file
+bool RenderTarget::hasBuffer(const Texture* texture) const
+{
+    for(unsigned int i = 0; i < colorBuffers.size(); ++i)
+    {
+        if(colorBuffers[i] == texture)
+            return true;
+    }
+
+    return depthBuffer == texture;
+}
+
+}
@@ -40,6 +40,9 @@ public:
     void setDepthBuffer(Texture* depthBuffer);
     void setRenderLayer(int layer);
     void setSize(int width, int height);
+    //Reattaches the buffers on the next use, after the memory of a buffer has changed.
+    void setBuffersDirty() {dirty = true;}
+    bool hasBuffer(const Texture* texture) const;
     void setName(const std::string& name) {this->name = name;}
     const Vector<Texture*>& getColorBuffers() const {return colorBuffers;}
     Texture* getDepthTexture() const {return depthBuffer;}
@@ -48,6 +51,7 @@ public:
     int getWidth() const {return width;}
     int getHeight() const {return height;}
     int getRenderLayer() const {return layer;}
+    int getNumLayers() const {return numLayers;}
     const std::string& getName() const {return name;}
 
 private:
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ResourcePool_H
+#define ResourcePool_H
+
+#include "Util/Vector.h"
+#include "Util/MemoryAllocator.h"
+#include <assert.h>
+#include <new>
+#include <utility>
+
+namespace Huurre3D
+{
+
+static const unsigned int InvalidResourceIndex = 0xffffffff;
+//Number of objects in one page of the pool, the objects of a page are next to each other in memory.
+static const unsigned int ResourcePoolPageSize = 64;
+
+//Refers to an object of a ResourcePool. The generation of the slot changes when its object is removed, 
+//so a handle to a removed object does not resolve to the object later created in the same slot.
+template <typename T> struct ResourceHandle
+{
+    ResourceHandle() = default;
+    ResourceHandle(unsigned int index, unsigned int generation):
+    index(index),
+    generation(generation)
+    {}
+
+    bool isNull() const {return index == InvalidResourceIndex;}
+    bool operator == (const ResourceHandle<T>& rhs) const {return index == rhs.index && generation == rhs.generation;}
+    bool operator != (const ResourceHandle<T>& rhs) const {return !(*this == rhs);}
+
+    unsigned int index = InvalidResourceIndex;
+    unsigned int generation = 0;
+};
+
+//Stores graphic objects of one type in pages of fixed size. Creating and removing an object are O(1): 
+//the free slots are kept in a list and the removed object is replaced by the last one in the list of alive objects.
+//The objects do not move in memory, so pointers to them stay valid until they are removed.
+template <typename T> class ResourcePool
+{
+public:
+    explicit ResourcePool(MemoryTag tag = MemoryTag::General):
+    tag(tag)
+    {
+        slots.setMemoryTag(tag);
+        freeSlots.setMemoryTag(tag);
+        items.setMemoryTag(tag);
+        pages.setMemoryTag(tag);
+    }
+
+    ~ResourcePool()
+    {
+        clear();
+        for(unsigned int i = 0; i < pages.size(); ++i)
+            Memory::deallocate(pages[i], ResourcePoolPageSize * sizeof(T), tag);
+    }
+
+    ResourcePool(const ResourcePool<T>& pool) = delete;
+    ResourcePool<T>& operator = (const ResourcePool<T>& rhs) = delete;
+
+    template <typename... Args> T* create(Args&&... args)
+    {
+        unsigned int slotIndex;
+        if(!freeSlots.empty())
+        {
+            slotIndex = freeSlots.back();
+            freeSlots.popBack();
+        }
+        else
+        {
+            slotIndex = slots.size();
+            if(slotIndex % ResourcePoolPageSize == 0)
+                pages.pushBack(Memory::allocate(ResourcePoolPageSize * sizeof(T), tag));
+
+            slots.pushBack(Slot());
+        }
+
+        T* object = new(getStorage(slotIndex)) T(std::forward<Args>(args)...);
+        object->poolSlot = slotIndex;
+        slots[slotIndex].itemIndex = items.size();
+        items.pushBack(object);
+
+        return object;
+    }
+
+    void remove(T* object)
+    {
+        unsigned int slotIndex = object->poolSlot;
+        //Catches objects of an other pool and objects which are already removed.
+        assert(slotIndex < slots.size() && getStorage(slotIndex) == reinterpret_cast<unsigned char*>(object));
+        assert(slots[slotIndex].itemIndex != InvalidResourceIndex);
+
+        Slot& slot = slots[slotIndex];
+        T* lastObject = items.back();
+        items[slot.itemIndex] = lastObject;
+        slots[lastObject->poolSlot].itemIndex = slot.itemIndex;
+        items.popBack();
+
+        slot.itemIndex = InvalidResourceIndex;
+        ++slot.generation;
+        object->~T();
+        freeSlots.pushBack(slotIndex);
+    }
+
+    //Removes all the objects. The pages are kept for the later objects and the handles to the removed objects become stale.
+    void clear()
+    {
+        while(!items.empty())
+            remove(items.back());
+    }
+
+    ResourceHandle<T> getHandle(const T* object) const
+    {
+        if(!object)
+            return ResourceHandle<T>();
+
+        unsigned int slotIndex = object->poolSlot;
+        assert(slotIndex < slots.size() && slots[slotIndex].itemIndex != InvalidResourceIndex);
+        return ResourceHandle<T>(slotIndex, slots[slotIndex].generation);
+    }
+
+    bool isAlive(const ResourceHandle<T>& handle) const
+    {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation && slots[handle.index].itemIndex != InvalidResourceIndex;
+    }
+
+    //Returns null for a null handle. A handle whose object has been removed is an error and asserts in debug builds.
+    T* get(const ResourceHandle<T>& handle) const
+    {
+        if(handle.isNull())
+            return nullptr;
+
+        bool alive = isAlive(handle);
+        assert(alive && "Stale resource handle");
+        return alive ? items[slots[handle.index].itemIndex] : nullptr;
+    }
+
+    //The alive objects, packed but in no particular order.
+    const Vector<T*>& getItems() const {return items;}
+    unsigned int size() const {return items.size();}
+    bool empty() const {return items.empty();}
+    T* operator [] (unsigned int index) const {return items[index];}
+
+private:
+    struct Slot
+    {
+        unsigned int generation = 0;
+        //Index of the object in the items, InvalidResourceIndex when the slot is free.
+        unsigned int itemIndex = InvalidResourceIndex;
+    };
+
+    unsigned char* getStorage(unsigned int slotIndex) const
+    {
+        return pages[slotIndex / ResourcePoolPageSize] + (slotIndex % ResourcePoolPageSize) * sizeof(T);
+    }
+
+    MemoryTag tag;
+    Vector<Slot> slots;
+    Vector<unsigned int> freeSlots;
+    Vector<T*> items;
+    Vector<unsigned char*> pages;
+};
+
+}
+
+#endif
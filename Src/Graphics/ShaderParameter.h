@@ -33,25 +33,29 @@ struct ShaderParameter
 {
     std::string name;
     unsigned int nameHash;
+    //The unused bytes of the value are zero, so that parameters can be compared by their value.
     unsigned char value[64];
     ShaderParameter() = default;
 
     ShaderParameter(const std::string& name, const Matrix4x4& parameter):
-    name(name)
+    name(name),
+    value()
     {
         nameHash = generateHash((unsigned char*)name.c_str(), name.size());
         memcpy(value, parameter.toArray(), 64);
     }
 
     ShaderParameter(const std::string& name, const Vector4& parameter):
-    name(name)
+    name(name),
+    value()
     {
         nameHash = generateHash((unsigned char*)name.c_str(), name.size());
         memcpy(value, parameter.toArray(), 16);
     }
 
     ShaderParameter(const std::string& name, int parameter):
-    name(name)
+    name(name),
+    value()
     {
         nameHash = generateHash((unsigned char*)name.c_str(), name.size());
         memcpy(value, &parameter, 4);
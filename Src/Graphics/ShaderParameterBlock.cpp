@@ -26,6 +26,7 @@ namespace Huurre3D
 {
 
 ShaderParameterBlock::ShaderParameterBlock(const std::string& name):
+GraphicObject(MemoryTag::ShaderParameters),
 name(name)
 {
     nameHash = generateHash((unsigned char*)name.c_str(), name.size());
@@ -82,16 +83,23 @@ void ShaderParameterBlock::addParameter(const Matrix4x4& parameter)
     appendParameterBlock(parameter.toArray(), 16 * sizeof(float));
 }
 
+void ShaderParameterBlock::setParameter(unsigned int offset, const Matrix4x4& parameter)
+{
+    memcpy(graphicData.getData() + offset, parameter.toArray(), sizeof(Matrix4x4));
+    setDataRangeDirty(offset, offset + sizeof(Matrix4x4));
+}
+
 void ShaderParameterBlock::appendParameterBlock(const float* parameter, unsigned int size)
 {
+    //The size of the data changes, so the buffer of the block is created again.
     graphicData.append(parameter, size);
-    dirty = true;
+    setWholeDataDirty();
 }
 
 void ShaderParameterBlock::appendParameterBlock(const int* parameter, unsigned int size)
 {
     graphicData.append(parameter, size);
-    dirty = true;
+    setWholeDataDirty();
 }
 
 }
\ No newline at end of file
@@ -36,6 +36,23 @@ public:
     ~ShaderParameterBlock() = default;
 	
     void setBindingIndex(unsigned int bindingIndex);
+    //A streamed block is rebuilt every frame, its data is written to the parameter ring of the frame instead of a buffer of its own.
+    void setStreamed(bool streamed) {this->streamed = streamed;}
+    //The range of the parameter ring the data was written to on the frame.
+    void setRingRange(unsigned int offset, unsigned int frame)
+    {
+        ringOffset = offset;
+        ringFrame = frame;
+    }
+    //The data written to the ring has not been uploaded to the buffer of the block, so all of it is dirty again.
+    void releaseRingRange()
+    {
+        if(ringFrame != 0xffffffff)
+        {
+            ringFrame = 0xffffffff;
+            setWholeDataDirty();
+        }
+    }
     void addParameter(int parameter);
     void addParameter(const FixedArray<int, 2>& parameter);
     void addParameter(const FixedArray<int, 3>& parameter);
@@ -45,21 +62,26 @@ public:
     void addParameter(const Vector3& parameter);
     void addParameter(const Vector4& parameter);
     void addParameter(const Matrix4x4& parameter);
+    //Overwrites the parameter at the byte offset of the data, only the changed range needs to be uploaded.
+    void setParameter(unsigned int offset, const Matrix4x4& parameter);
     const std::string& getName() const {return name;}
     const unsigned int getNameHash() const {return nameHash;}
     int getBindingIndex() const {return bindingIndex;}
     bool hasBindingIndex() const {return binded;}
+    bool isStreamed() const {return streamed;}
+    unsigned int getRingOffset() const {return ringOffset;}
+    unsigned int getRingFrame() const {return ringFrame;}
     void clearParameters() {graphicData.clearBuffer();}
     unsigned int getSizeInBytes() const {return graphicData.getSizeInBytes();}
     void setParameterData(MemoryBuffer&& parameterData)
     {
         graphicData = std::move(parameterData);
-        dirty = true;
+        setWholeDataDirty();
     }
     void setParameterData(const MemoryBuffer& parameterData)
     {
         graphicData = parameterData;
-        dirty = true;
+        setWholeDataDirty();
     }
 
 private:
@@ -69,6 +91,9 @@ private:
     unsigned int nameHash;
     unsigned int bindingIndex = 0;
     bool binded = false;
+    bool streamed = false;
+    unsigned int ringOffset = 0;
+    unsigned int ringFrame = 0xffffffff;
 };
 
 }
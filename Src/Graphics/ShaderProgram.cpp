@@ -32,12 +32,12 @@ fragmentShader(fragmentShader)
 
 void ShaderProgram::setShaderParameterDescription(ShaderParameterDescription& parameter)
 {
-    parameterDescriptions.pushBack(parameter);
+    parameterDescriptions.insert(parameter);
 }
 
 void ShaderProgram::setShaderParameterBlockDescription(ShaderParameterBlockDescription& parameterBlock)
 {
-    parameterBlockDescriptions.pushBack(parameterBlock);
+    parameterBlockDescriptions.insert(parameterBlock);
 }
 
 void ShaderProgram::setShaderCombinationTag(int shaderCombinationTag)
@@ -47,26 +47,24 @@ void ShaderProgram::setShaderCombinationTag(int shaderCombinationTag)
 
 ShaderParameterDescription* ShaderProgram::getShaderParameterDescription(const std::string& name)
 {
-    int index = parameterDescriptions.getIndexToItem([name](const ShaderParameterDescription description){return description.name.compare(name) == 0;});
-    return index != -1 ? &parameterDescriptions[index] : nullptr;
+    ShaderParameterDescription* description = parameterDescriptions.findItem(generateHash((unsigned char*)name.c_str(), name.size()));
+    return description && description->name == name ? description : nullptr;
 }
 
 ShaderParameterBlockDescription* ShaderProgram::getShaderParameterBlockDescription(const std::string& name)
 {
-    int index = parameterBlockDescriptions.getIndexToItem([name](const ShaderParameterBlockDescription description){return description.name.compare(name) == 0;});
-    return index != -1 ? &parameterBlockDescriptions[index] : nullptr;
+    ShaderParameterBlockDescription* description = parameterBlockDescriptions.findItem(generateHash((unsigned char*)name.c_str(), name.size()));
+    return description && description->name == name ? description : nullptr;
 }
 
 ShaderParameterDescription* ShaderProgram::getShaderParameterDescription(const unsigned int nameHash)
 {
-    int index = parameterDescriptions.getIndexToItem([nameHash](const ShaderParameterDescription description){return description.nameHash == nameHash;});
-    return index != -1 ? &parameterDescriptions[index] : nullptr;
+    return parameterDescriptions.findItem(nameHash);
 }
 
 ShaderParameterBlockDescription* ShaderProgram::getShaderParameterBlockDescription(unsigned int nameHash)
 {
-    int index = parameterBlockDescriptions.getIndexToItem([nameHash](const ShaderParameterBlockDescription description){return description.nameHash == nameHash;});
-    return index != -1 ? &parameterBlockDescriptions[index] : nullptr;
+    return parameterBlockDescriptions.findItem(nameHash);
 }
 
 }
\ No newline at end of file
@@ -23,7 +23,7 @@
 #define ShaderProgram_H
 
 #include "Graphics/Shader.h"
-#include "Util/Vector.h"
+#include "Util/SortedVector.h"
 #include "Math/MathFunctions.h"
 
 namespace Huurre3D
@@ -63,6 +63,14 @@ struct ShaderParameterBlockDescription
     }
 };
 
+//Orders the descriptions by their name hash and compares them with hashes for the lookups.
+struct NameHashLess
+{
+    template<class T> bool operator()(const T& lhs, const T& rhs) const {return lhs.nameHash < rhs.nameHash;}
+    template<class T> bool operator()(const T& lhs, unsigned int rhs) const {return lhs.nameHash < rhs;}
+    template<class T> bool operator()(unsigned int lhs, const T& rhs) const {return lhs < rhs.nameHash;}
+};
+
 class ShaderProgram : public GraphicObject
 {
 public:
@@ -87,8 +95,9 @@ private:
     Shader* fragmentShader;
     bool linked = false;
     int shaderCombinationTag = 0;
-    Vector<ShaderParameterDescription> parameterDescriptions;
-    Vector<ShaderParameterBlockDescription> parameterBlockDescriptions;
+    //Sorted by the name hash, the descriptions are looked up by it for every parameter set.
+    SortedVector<ShaderParameterDescription, NameHashLess> parameterDescriptions;
+    SortedVector<ShaderParameterBlockDescription, NameHashLess> parameterBlockDescriptions;
 };
 
 }
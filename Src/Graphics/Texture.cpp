@@ -25,6 +25,7 @@ namespace Huurre3D
 {
 
 Texture::Texture(TextureTargetMode targetMode, TextureWrapMode wrapMode, TextureFilterMode filterMode, TexturePixelFormat pixelFormat, int width, int height) :
+GraphicObject(MemoryTag::Texture),
 targetMode(targetMode),
 wrapMode(wrapMode),
 filterMode(filterMode),
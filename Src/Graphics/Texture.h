@@ -30,6 +30,17 @@
 namespace Huurre3D
 {
 
+struct TextureDescription
+{
+    TextureTargetMode targetMode = TextureTargetMode::Texture2D;
+    TextureWrapMode wrapMode = TextureWrapMode::ClampEdge;
+    TextureFilterMode filterMode = TextureFilterMode::Nearest;
+    TexturePixelFormat pixelFormat = TexturePixelFormat::Rgba8;
+    TextureSlotIndex slotIndex = TextureSlotIndex::Diffuse;
+    int width = 0;
+    int height = 0;
+};
+
 class Texture : public GraphicObject
 {
 public:
@@ -44,6 +55,12 @@ public:
     void setNumMipMaps(int numMipMaps);
     void setSlotIndex(TextureSlotIndex slotIndex) {this->slotIndex = slotIndex;}
     void setData(TextureLoadResult& resultData);
+    //The texture whose memory the texture uses instead of its own, set by the graphic system.
+    void setAliasOwner(const Texture* owner)
+    {
+        aliasOwner = owner;
+        dataDirty = true;
+    }
     TextureTargetMode getTargetMode() const {return targetMode;}
     TextureWrapMode getWrapMode() const {return wrapMode;}
     TextureFilterMode getFilterMode() const {return filterMode;}
@@ -53,6 +70,13 @@ public:
     int getHeight() const {return height;}
     int getDepth() const {return depth;}
     int getNumMipMaps() const {return numMipMaps;}
+    const Texture* getAliasOwner() const {return aliasOwner;}
+    //Size of the texture memory of all the layers and faces, the mipmaps are not counted.
+    unsigned int getMemorySize() const
+    {
+        unsigned int numFaces = targetMode == TextureTargetMode::TextureCubeMap ? NumCubeMapFaces : depth;
+        return width * height * numFaces * pixelFormatSizeInBytes[static_cast<int>(pixelFormat)];
+    }
     bool isParamsDirty() const {return paramsDirty;}
     bool isDataDirty() const {return dataDirty;}
     bool isCompressed() const { return pixelFormat == TexturePixelFormat::DXT1 || pixelFormat == TexturePixelFormat::DXT3 || pixelFormat == TexturePixelFormat::DXT5; }
@@ -80,6 +104,7 @@ private:
     int height;
     int depth = 1;
     int numMipMaps = 0;
+    const Texture* aliasOwner = nullptr;
     bool paramsDirty = true;
     bool dataDirty = true;
 };
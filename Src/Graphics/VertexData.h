@@ -48,12 +48,17 @@ public:
     const Vector<VertexStream*>& getVertexStreams() const {return vertexStreams;}
     IndexBuffer* getIndexBuffer() const {return indexBuffer;}
     int getNumVertices() const {return numVertices;}
+    void setNumVertices(int numVertices) {this->numVertices = numVertices;}
+    //Set by the back-end when it has added the per-instance draw index attribute of the multi-draws to the vertex array.
+    void setDrawIndexAttribute(bool enabled) {drawIndexAttribute = enabled;}
+    bool hasDrawIndexAttribute() const {return drawIndexAttribute;}
 
 private:
     PrimitiveType primitiveType;
     Vector<VertexStream*> vertexStreams;
     IndexBuffer* indexBuffer = nullptr;
     bool indexed = false;
+    bool drawIndexAttribute = false;
     int numVertices;
 };
 
@@ -41,6 +41,7 @@ class VertexStream : public GraphicObject
 {
 public:
     VertexStream::VertexStream(int numVertices, const Vector<AttributeDescription>& descriptions) :
+    GraphicObject(MemoryTag::Geometry),
     numVertices(numVertices),
     attributeDescriptions(descriptions)
     {
@@ -56,7 +57,25 @@ public:
     void setAttributes(MemoryBuffer&& attributeData)
     {
         graphicData = std::move(attributeData);
-        dirty = true;
+        setWholeDataDirty();
+    }
+    //Changes the number of vertices, the attributes of the kept vertices are preserved.
+    void setNumVertices(unsigned int numVertices)
+    {
+        this->numVertices = numVertices;
+        graphicData.resize(numVertices * vertexSize);
+        setWholeDataDirty();
+    }
+    //Copies the attributes of the vertices starting from the first vertex, only the changed range needs to be uploaded.
+    void updateAttributes(unsigned int firstVertex, const unsigned char* attributeData, unsigned int numUpdatedVertices)
+    {
+        memcpy(graphicData.getData() + firstVertex * vertexSize, attributeData, numUpdatedVertices * vertexSize);
+        setDataRangeDirty(firstVertex * vertexSize, (firstVertex + numUpdatedVertices) * vertexSize);
+    }
+    void moveAttributes(unsigned int fromVertex, unsigned int toVertex, unsigned int numMovedVertices)
+    {
+        memmove(graphicData.getData() + toVertex * vertexSize, graphicData.getData() + fromVertex * vertexSize, numMovedVertices * vertexSize);
+        setDataRangeDirty(toVertex * vertexSize, (toVertex + numMovedVertices) * vertexSize);
     }
 
 private:
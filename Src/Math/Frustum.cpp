@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 
 #include "Math/Frustum.h"
+#include <limits>
 
 namespace Huurre3D
 {
@@ -44,6 +45,8 @@ void Frustum::set(const Matrix4x4& matrix, bool normalize)
             planes[i].normalize();
     }
 
+    updatePlaneArrays();
+
     //calculateCorners();
 }
 
@@ -61,16 +64,16 @@ Intersection Frustum::isInside(const Vector3& point) const
 Intersection Frustum::isInside(const Sphere& sphere) const
 {
     Intersection result = Intersection::Inside;
-    float dist = 0;
-    float radius = sphere.getRadius();
     Vector3 center = sphere.getCenter();
+    SimdFloat4 radius = simdSplat(sphere.getRadius());
+    SimdFloat4 negativeRadius = simdSplat(-sphere.getRadius());
 
-    for(unsigned int i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    for(unsigned int i = 0; i < NumFrustumPlaneBatches; ++i)
     {
-        dist = planes[i].distance(center);
-        if(dist < -radius)
+        SimdFloat4 dist = planeBatchDistance(i, center);
+        if(simdAnyLess(dist, negativeRadius))
             return Intersection::Outside;
-        else if(dist < radius)
+        else if(simdAnyLess(dist, radius))
             result = Intersection::Intersects;
     }
 
@@ -83,14 +86,14 @@ Intersection Frustum::isInside(const BoundingBox& box) const
     Vector3 center = box.getCenter();
     Vector3 edge = center - box.getMin();
         
-    for(unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    for(unsigned int i = 0; i < NumFrustumPlaneBatches; ++i)
     {
-        float dist = planes[i].distance(center);
-        float absDist = planes[i].getNormal().absDot(edge);
+        SimdFloat4 dist = planeBatchDistance(i, center);
+        SimdFloat4 absDist = planeBatchAbsDot(i, edge);
             
-        if(dist < -absDist)
+        if(simdAnyLess(dist, simdNegate(absDist)))
             return Intersection::Outside;
-        else if(dist < absDist)
+        else if(simdAnyLess(dist, absDist))
             result = Intersection::Intersects;
     }
         
@@ -99,12 +102,12 @@ Intersection Frustum::isInside(const BoundingBox& box) const
 
 bool Frustum::isInsideNoIntersection(const Sphere& sphere) const
 {
-    float radius = sphere.getRadius();
     Vector3 center = sphere.getCenter();
+    SimdFloat4 negativeRadius = simdSplat(-sphere.getRadius());
 
-    for(unsigned int i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    for(unsigned int i = 0; i < NumFrustumPlaneBatches; ++i)
     {
-        if(planes[i].distance(center) < -radius)
+        if(simdAnyLess(planeBatchDistance(i, center), negativeRadius))
             return false;
     }
 
@@ -116,15 +119,53 @@ bool Frustum::isInsideNoIntersection(const BoundingBox& box) const
     Vector3 center = box.getCenter();
     Vector3 edge = center - box.getMin();
         
-    for(unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    for(unsigned int i = 0; i < NumFrustumPlaneBatches; ++i)
     {       
-        if(planes[i].distance(center) < -planes[i].getNormal().absDot(edge))
+        if(simdAnyLess(planeBatchDistance(i, center), simdNegate(planeBatchAbsDot(i, edge))))
             return false;
     }
         
     return true;
 }
 
+void Frustum::updatePlaneArrays()
+{
+    for(unsigned int i = 0; i < NumFrustumPlaneBatches * 4; ++i)
+    {
+        if(i < NUM_FRUSTUM_PLANES)
+        {
+            const Vector3& normal = planes[i].getNormal();
+            planeNormalsX[i] = normal.x;
+            planeNormalsY[i] = normal.y;
+            planeNormalsZ[i] = normal.z;
+            planeOffsets[i] = planes[i].getOffset();
+        }
+        else
+        {
+            planeNormalsX[i] = 0.0f;
+            planeNormalsY[i] = 0.0f;
+            planeNormalsZ[i] = 0.0f;
+            planeOffsets[i] = std::numeric_limits<float>::max();
+        }
+    }
+}
+
+SimdFloat4 Frustum::planeBatchDistance(unsigned int batch, const Vector3& point) const
+{
+    unsigned int first = batch * 4;
+    SimdFloat4 dist = simdMulAdd(simdLoad(&planeNormalsX[first]), simdSplat(point.x), simdLoad(&planeOffsets[first]));
+    dist = simdMulAdd(simdLoad(&planeNormalsY[first]), simdSplat(point.y), dist);
+    return simdMulAdd(simdLoad(&planeNormalsZ[first]), simdSplat(point.z), dist);
+}
+
+SimdFloat4 Frustum::planeBatchAbsDot(unsigned int batch, const Vector3& vector) const
+{
+    unsigned int first = batch * 4;
+    SimdFloat4 absDot = simdAbs(simdMul(simdLoad(&planeNormalsX[first]), simdSplat(vector.x)));
+    absDot = simdAdd(absDot, simdAbs(simdMul(simdLoad(&planeNormalsY[first]), simdSplat(vector.y))));
+    return simdAdd(absDot, simdAbs(simdMul(simdLoad(&planeNormalsZ[first]), simdSplat(vector.z))));
+}
+
 const FixedArray<Vector3, 8>& Frustum::getCorners()
 {
     calculateCorners();
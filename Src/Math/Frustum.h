@@ -27,6 +27,7 @@
 #include "Math/Matrix4x4.h"
 #include "Math/BoundingBox.h"
 #include "Math/Sphere.h"
+#include "Math/SIMD.h"
 #include "Util/FixedArray.h"
 
 namespace Huurre3D
@@ -43,6 +44,8 @@ enum FrustumPlane
     NUM_FRUSTUM_PLANES
 };
 
+static const unsigned int NumFrustumPlaneBatches = 2;
+
 class Frustum
 {
 public:
@@ -61,7 +64,18 @@ public:
 private:
     void calculateCorners();
     Vector3 getIntersectionPoint(const Plane& plane1, const Plane& plane2, const Plane& plane3);
+    void updatePlaneArrays();
+    //Signed distances of a point to the four planes of a batch.
+    SimdFloat4 planeBatchDistance(unsigned int batch, const Vector3& point) const;
+    //Absolute dot products of a vector with the four plane normals of a batch.
+    SimdFloat4 planeBatchAbsDot(unsigned int batch, const Vector3& vector) const;
     Plane planes[NUM_FRUSTUM_PLANES];
+    //The planes in structure of arrays layout for testing four planes at once.
+    //Padded to two batches with planes which have every point on their positive side.
+    float planeNormalsX[NumFrustumPlaneBatches * 4];
+    float planeNormalsY[NumFrustumPlaneBatches * 4];
+    float planeNormalsZ[NumFrustumPlaneBatches * 4];
+    float planeOffsets[NumFrustumPlaneBatches * 4];
     FixedArray<Vector3, 8> corners;
 };
 
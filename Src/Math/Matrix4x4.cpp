@@ -22,6 +22,7 @@
 #include "Math/Matrix4x4.h"
 #include "Math/Quaternion.h"
 #include "Math/MathFunctions.h"
+#include "Math/SIMD.h"
 
 namespace Huurre3D
 {
@@ -110,12 +111,35 @@ Matrix4x4 Matrix4x4::operator -() const
 
 Vector4 Matrix4x4::operator * (const Vector4& rhs) const
 {
-    return Vector4(cols[0] * rhs.x + cols[1] * rhs.y + cols[2] * rhs.z + cols[3] * rhs.w);
+    SimdFloat4 result = simdMul(simdLoad(cols[0].toArray()), simdSplat(rhs.x));
+    result = simdMulAdd(simdLoad(cols[1].toArray()), simdSplat(rhs.y), result);
+    result = simdMulAdd(simdLoad(cols[2].toArray()), simdSplat(rhs.z), result);
+    result = simdMulAdd(simdLoad(cols[3].toArray()), simdSplat(rhs.w), result);
+
+    Vector4 resultVector;
+    simdStore(resultVector.toArray(), result);
+    return resultVector;
 }
 
 Matrix4x4 Matrix4x4::operator * (const Matrix4x4& rhs) const
 {
-    return Matrix4x4(*this * rhs.cols[0], *this * rhs.cols[1], *this * rhs.cols[2], *this * rhs.cols[3]);
+    SimdFloat4 col0 = simdLoad(cols[0].toArray());
+    SimdFloat4 col1 = simdLoad(cols[1].toArray());
+    SimdFloat4 col2 = simdLoad(cols[2].toArray());
+    SimdFloat4 col3 = simdLoad(cols[3].toArray());
+
+    Matrix4x4 result;
+    for(int i = 0; i < 4; ++i)
+    {
+        const Vector4& rhsCol = rhs.cols[i];
+        SimdFloat4 resultCol = simdMul(col0, simdSplat(rhsCol.x));
+        resultCol = simdMulAdd(col1, simdSplat(rhsCol.y), resultCol);
+        resultCol = simdMulAdd(col2, simdSplat(rhsCol.z), resultCol);
+        resultCol = simdMulAdd(col3, simdSplat(rhsCol.w), resultCol);
+        simdStore(result.cols[i].toArray(), resultCol);
+    }
+
+    return result;
 }
 
 Matrix4x4 Matrix4x4::operator * (float scalar) const
@@ -140,10 +164,18 @@ float Matrix4x4::determinant() const
 
 Matrix4x4 Matrix4x4::transpose() const
 {
-    return Matrix4x4(Vector4(cols[0].x, cols[1].x, cols[2].x, cols[3].x),
-                     Vector4(cols[0].y, cols[1].y, cols[2].y, cols[3].y),
-                     Vector4(cols[0].z, cols[1].z, cols[2].z, cols[3].z),
-                     Vector4(cols[0].w, cols[1].w, cols[2].w, cols[3].w));
+    SimdFloat4 col0 = simdLoad(cols[0].toArray());
+    SimdFloat4 col1 = simdLoad(cols[1].toArray());
+    SimdFloat4 col2 = simdLoad(cols[2].toArray());
+    SimdFloat4 col3 = simdLoad(cols[3].toArray());
+    simdTranspose(col0, col1, col2, col3);
+
+    Matrix4x4 result;
+    simdStore(result.cols[0].toArray(), col0);
+    simdStore(result.cols[1].toArray(), col1);
+    simdStore(result.cols[2].toArray(), col2);
+    simdStore(result.cols[3].toArray(), col3);
+    return result;
 }
 
 Matrix4x4 Matrix4x4::inverse() const
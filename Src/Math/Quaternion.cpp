@@ -21,6 +21,7 @@
 
 #include "Math/Quaternion.h"
 #include "Math/MathFunctions.h"
+#include "Math/SIMD.h"
 
 namespace Huurre3D
 {
@@ -56,10 +57,7 @@ Quaternion::Quaternion(const Matrix3x3& matrix)
 
 Quaternion& Quaternion::operator = (const Quaternion& rhs)
 {
-    w = rhs.w;
-    x = rhs.x;
-    y = rhs.y;
-    z = rhs.z;
+    simdStore(&w, simdLoad(&rhs.w));
     return *this;
 }
 
@@ -70,48 +68,55 @@ bool Quaternion::operator == (const Quaternion& rhs) const
 
 bool Quaternion::operator != (const Quaternion& rhs) const
 {
-    return !equals(w, rhs.w) && !equals(x, rhs.x) || !equals(y, rhs.y) || !equals(z, rhs.z);
+    return !equals(w, rhs.w) || !equals(x, rhs.x) || !equals(y, rhs.y) || !equals(z, rhs.z);
 }
 
 Quaternion Quaternion::operator + (const Quaternion& rhs) const
 {
-    return Quaternion(w + rhs.w, x + rhs.x, y + rhs.y, z + rhs.z);
+    Quaternion result;
+    simdStore(&result.w, simdAdd(simdLoad(&w), simdLoad(&rhs.w)));
+    return result;
 }
 
 Quaternion& Quaternion::operator += (const Quaternion& rhs)
 {
-	 w += rhs.w;
-     x += rhs.x;
-     y += rhs.y;
-     z += rhs.z;
-     return *this;
+    simdStore(&w, simdAdd(simdLoad(&w), simdLoad(&rhs.w)));
+    return *this;
 }
 
 Quaternion Quaternion::operator - (const Quaternion& rhs) const
 {
-    return Quaternion(w - rhs.w, x - rhs.x, y - rhs.y, z - rhs.z);
+    Quaternion result;
+    simdStore(&result.w, simdSub(simdLoad(&w), simdLoad(&rhs.w)));
+    return result;
 }
 
 Quaternion Quaternion::operator * (float scalar) const
 {
-    return Quaternion(w * scalar, x * scalar, y * scalar, z * scalar);
+    Quaternion result;
+    simdStore(&result.w, simdMul(simdLoad(&w), simdSplat(scalar)));
+    return result;
 }
 
 Quaternion&  Quaternion::operator *= (float scalar)
 {
-    w *= scalar;
-    x *= scalar;
-    y *= scalar;
-    z *= scalar;
+    simdStore(&w, simdMul(simdLoad(&w), simdSplat(scalar)));
     return *this;
 }
 
 Quaternion Quaternion::operator * (const Quaternion& rhs) const
 {
-    return Quaternion(w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
-                      w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,  
-                      w * rhs.y + y * rhs.w + z * rhs.x - x * rhs.z, 
-                      w * rhs.z + z * rhs.w + x * rhs.y - y * rhs.x);
+    //Hamilton product with the lanes in (w, x, y, z) order. Each component of this quaternion
+    //multiplies a permuted and sign flipped rhs.
+    SimdFloat4 rhsValues = simdLoad(&rhs.w);
+    SimdFloat4 result = simdMul(simdSplat(w), rhsValues);
+    result = simdMulAdd(simdSplat(x), simdMul(simdShuffle<1, 0, 3, 2>(rhsValues), simdSet(-1.0f, 1.0f, -1.0f, 1.0f)), result);
+    result = simdMulAdd(simdSplat(y), simdMul(simdShuffle<2, 3, 0, 1>(rhsValues), simdSet(-1.0f, 1.0f, 1.0f, -1.0f)), result);
+    result = simdMulAdd(simdSplat(z), simdMul(simdShuffle<3, 2, 1, 0>(rhsValues), simdSet(-1.0f, -1.0f, 1.0f, 1.0f)), result);
+
+    Quaternion resultQuaternion;
+    simdStore(&resultQuaternion.w, result);
+    return resultQuaternion;
 }
 
 void Quaternion::set(float angle, const Vector3& axis)
@@ -189,12 +194,13 @@ Matrix3x3 Quaternion::rotationMatrix3x3() const
 
 float Quaternion::length() const
 {
-    return sqrt(w * w + x * x + y * y + z * z);
+    return sqrt(lengthSquared());
 }
 
 float Quaternion::lengthSquared() const
 {
-    return w * w + x * x + y * y + z * z;
+    SimdFloat4 values = simdLoad(&w);
+    return simdDot4(values, values);
 }
 
 float Quaternion::normalize()
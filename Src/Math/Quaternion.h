@@ -74,6 +74,9 @@ public:
     float z;
 };
 
+//The SIMD implementation loads the components as one 4-wide vector.
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be four tightly packed floats");
+
 }
 
 #endif
\ No newline at end of file
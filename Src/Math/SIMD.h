@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SIMD_H
+#define SIMD_H
+
+//Thin abstraction of 4-wide float SIMD used by the math types. SSE2 is used on x86, NEON on ARM,
+//and the scalar fallback everywhere else or when USE_SCALAR_MATH is defined.
+//Loads and stores are unaligned, so an object does not need to be 16-byte aligned to be used with these,
+//but the engine's own allocations are 16-byte aligned so the bulk data is.
+#if defined(USE_SCALAR_MATH)
+#define SIMD_SCALAR
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM)
+#define SIMD_NEON
+#include <arm_neon.h>
+#else
+#define SIMD_SCALAR
+#endif
+
+namespace Huurre3D
+{
+
+#if defined(SIMD_SSE)
+
+typedef __m128 SimdFloat4;
+
+inline SimdFloat4 simdLoad(const float* data) {return _mm_loadu_ps(data);}
+inline void simdStore(float* data, SimdFloat4 v) {_mm_storeu_ps(data, v);}
+inline SimdFloat4 simdSet(float x, float y, float z, float w) {return _mm_set_ps(w, z, y, x);}
+inline SimdFloat4 simdSplat(float value) {return _mm_set1_ps(value);}
+inline SimdFloat4 simdAdd(SimdFloat4 a, SimdFloat4 b) {return _mm_add_ps(a, b);}
+inline SimdFloat4 simdSub(SimdFloat4 a, SimdFloat4 b) {return _mm_sub_ps(a, b);}
+inline SimdFloat4 simdMul(SimdFloat4 a, SimdFloat4 b) {return _mm_mul_ps(a, b);}
+inline SimdFloat4 simdDiv(SimdFloat4 a, SimdFloat4 b) {return _mm_div_ps(a, b);}
+//a * b + c
+inline SimdFloat4 simdMulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) {return _mm_add_ps(_mm_mul_ps(a, b), c);}
+inline SimdFloat4 simdMin(SimdFloat4 a, SimdFloat4 b) {return _mm_min_ps(a, b);}
+inline SimdFloat4 simdMax(SimdFloat4 a, SimdFloat4 b) {return _mm_max_ps(a, b);}
+inline SimdFloat4 simdAbs(SimdFloat4 v) {return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);}
+inline SimdFloat4 simdNegate(SimdFloat4 v) {return _mm_xor_ps(_mm_set1_ps(-0.0f), v);}
+inline float simdGetX(SimdFloat4 v) {return _mm_cvtss_f32(v);}
+template<int X, int Y, int Z, int W> inline SimdFloat4 simdShuffle(SimdFloat4 v) {return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));}
+//Returns true if any lane of a is less than the same lane of b.
+inline bool simdAnyLess(SimdFloat4 a, SimdFloat4 b) {return _mm_movemask_ps(_mm_cmplt_ps(a, b)) != 0;}
+//Mask of the lanes where a is greater than or equal to b, only used with simdSelect.
+inline SimdFloat4 simdGreaterEqual(SimdFloat4 a, SimdFloat4 b) {return _mm_cmpge_ps(a, b);}
+//Lanes of a where the mask is set, lanes of b elsewhere.
+inline SimdFloat4 simdSelect(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b) {return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));}
+inline void simdTranspose(SimdFloat4& row0, SimdFloat4& row1, SimdFloat4& row2, SimdFloat4& row3) {_MM_TRANSPOSE4_PS(row0, row1, row2, row3);}
+
+#elif defined(SIMD_NEON)
+
+typedef float32x4_t SimdFloat4;
+
+inline SimdFloat4 simdLoad(const float* data) {return vld1q_f32(data);}
+inline void simdStore(float* data, SimdFloat4 v) {vst1q_f32(data, v);}
+inline SimdFloat4 simdSet(float x, float y, float z, float w) {float data[4] = {x, y, z, w}; return vld1q_f32(data);}
+inline SimdFloat4 simdSplat(float value) {return vdupq_n_f32(value);}
+inline SimdFloat4 simdAdd(SimdFloat4 a, SimdFloat4 b) {return vaddq_f32(a, b);}
+inline SimdFloat4 simdSub(SimdFloat4 a, SimdFloat4 b) {return vsubq_f32(a, b);}
+inline SimdFloat4 simdMul(SimdFloat4 a, SimdFloat4 b) {return vmulq_f32(a, b);}
+//ARMv7 NEON has no division, the reciprocal estimate is refined with two Newton-Raphson steps.
+inline SimdFloat4 simdDiv(SimdFloat4 a, SimdFloat4 b)
+{
+    SimdFloat4 reciprocal = vrecpeq_f32(b);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    return vmulq_f32(a, reciprocal);
+}
+inline SimdFloat4 simdMulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) {return vmlaq_f32(c, a, b);}
+inline SimdFloat4 simdMin(SimdFloat4 a, SimdFloat4 b) {return vminq_f32(a, b);}
+inline SimdFloat4 simdMax(SimdFloat4 a, SimdFloat4 b) {return vmaxq_f32(a, b);}
+inline SimdFloat4 simdAbs(SimdFloat4 v) {return vabsq_f32(v);}
+inline SimdFloat4 simdNegate(SimdFloat4 v) {return vnegq_f32(v);}
+inline float simdGetX(SimdFloat4 v) {return vgetq_lane_f32(v, 0);}
+template<int X, int Y, int Z, int W> inline SimdFloat4 simdShuffle(SimdFloat4 v)
+{
+    float data[4];
+    vst1q_f32(data, v);
+    return simdSet(data[X], data[Y], data[Z], data[W]);
+}
+inline bool simdAnyLess(SimdFloat4 a, SimdFloat4 b)
+{
+    uint32x4_t mask = vcltq_f32(a, b);
+    uint32x2_t half = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+    return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+}
+inline SimdFloat4 simdGreaterEqual(SimdFloat4 a, SimdFloat4 b) {return vreinterpretq_f32_u32(vcgeq_f32(a, b));}
+inline SimdFloat4 simdSelect(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b) {return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);}
+inline void simdTranspose(SimdFloat4& row0, SimdFloat4& row1, SimdFloat4& row2, SimdFloat4& row3)
+{
+    float32x4x2_t row01 = vtrnq_f32(row0, row1);
+    float32x4x2_t row23 = vtrnq_f32(row2, row3);
+    row0 = vcombine_f32(vget_low_f32(row01.val[0]), vget_low_f32(row23.val[0]));
+    row1 = vcombine_f32(vget_low_f32(row01.val[1]), vget_low_f32(row23.val[1]));
+    row2 = vcombine_f32(vget_high_f32(row01.val[0]), vget_high_f32(row23.val[0]));
+    row3 = vcombine_f32(vget_high_f32(row01.val[1]), vget_high_f32(row23.val[1]));
+}
+
+#else
+
+struct SimdFloat4
+{
+    float v[4];
+};
+
+inline SimdFloat4 simdSet(float x, float y, float z, float w) {SimdFloat4 result = {{x, y, z, w}}; return result;}
+inline SimdFloat4 simdLoad(const float* data) {return simdSet(data[0], data[1], data[2], data[3]);}
+inline void simdStore(float* data, SimdFloat4 v) {data[0] = v.v[0]; data[1] = v.v[1]; data[2] = v.v[2]; data[3] = v.v[3];}
+inline SimdFloat4 simdSplat(float value) {return simdSet(value, value, value, value);}
+inline SimdFloat4 simdAdd(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);}
+inline SimdFloat4 simdSub(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]);}
+inline SimdFloat4 simdMul(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]);}
+inline SimdFloat4 simdDiv(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]);}
+inline SimdFloat4 simdMulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) {return simdAdd(simdMul(a, b), c);}
+inline SimdFloat4 simdMin(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]);}
+inline SimdFloat4 simdMax(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1], a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]);}
+inline SimdFloat4 simdAbs(SimdFloat4 v) {return simdMax(v, simdSet(-v.v[0], -v.v[1], -v.v[2], -v.v[3]));}
+inline SimdFloat4 simdNegate(SimdFloat4 v) {return simdSet(-v.v[0], -v.v[1], -v.v[2], -v.v[3]);}
+inline float simdGetX(SimdFloat4 v) {return v.v[0];}
+template<int X, int Y, int Z, int W> inline SimdFloat4 simdShuffle(SimdFloat4 v) {return simdSet(v.v[X], v.v[Y], v.v[Z], v.v[W]);}
+inline bool simdAnyLess(SimdFloat4 a, SimdFloat4 b) {return a.v[0] < b.v[0] || a.v[1] < b.v[1] || a.v[2] < b.v[2] || a.v[3] < b.v[3];}
+//The scalar mask lanes are one or zero.
+inline SimdFloat4 simdGreaterEqual(SimdFloat4 a, SimdFloat4 b) {return simdSet(a.v[0] >= b.v[0] ? 1.0f : 0.0f, a.v[1] >= b.v[1] ? 1.0f : 0.0f, a.v[2] >= b.v[2] ? 1.0f : 0.0f, a.v[3] >= b.v[3] ? 1.0f : 0.0f);}
+inline SimdFloat4 simdSelect(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b) {return simdSet(mask.v[0] != 0.0f ? a.v[0] : b.v[0], mask.v[1] != 0.0f ? a.v[1] : b.v[1], mask.v[2] != 0.0f ? a.v[2] : b.v[2], mask.v[3] != 0.0f ? a.v[3] : b.v[3]);}
+inline void simdTranspose(SimdFloat4& row0, SimdFloat4& row1, SimdFloat4& row2, SimdFloat4& row3)
+{
+    SimdFloat4 col0 = simdSet(row0.v[0], row1.v[0], row2.v[0], row3.v[0]);
+    SimdFloat4 col1 = simdSet(row0.v[1], row1.v[1], row2.v[1], row3.v[1]);
+    SimdFloat4 col2 = simdSet(row0.v[2], row1.v[2], row2.v[2], row3.v[2]);
+    SimdFloat4 col3 = simdSet(row0.v[3], row1.v[3], row2.v[3], row3.v[3]);
+    row0 = col0;
+    row1 = col1;
+    row2 = col2;
+    row3 = col3;
+}
+
+#endif
+
+//Sum of all four lanes.
+inline float simdHorizontalAdd(SimdFloat4 v)
+{
+    SimdFloat4 sum = simdAdd(v, simdShuffle<2, 3, 0, 1>(v));
+    sum = simdAdd(sum, simdShuffle<1, 0, 3, 2>(sum));
+    return simdGetX(sum);
+}
+
+inline float simdDot4(SimdFloat4 a, SimdFloat4 b)
+{
+    return simdHorizontalAdd(simdMul(a, b));
+}
+
+}
+
+#endif
@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Math/TransformKernels.h"
+#include "Math/SIMD.h"
+
+namespace Huurre3D
+{
+
+static const unsigned int BatchWidth = 4;
+
+//Gathers the components of four consecutive vectors into lanes.
+static void loadVector3Lanes(const Vector3* vectors, SimdFloat4& x, SimdFloat4& y, SimdFloat4& z)
+{
+    x = simdSet(vectors[0].x, vectors[1].x, vectors[2].x, vectors[3].x);
+    y = simdSet(vectors[0].y, vectors[1].y, vectors[2].y, vectors[3].y);
+    z = simdSet(vectors[0].z, vectors[1].z, vectors[2].z, vectors[3].z);
+}
+
+//Gathers the components of four consecutive quaternions into lanes.
+static void loadQuaternionLanes(const Quaternion* rotations, SimdFloat4& w, SimdFloat4& x, SimdFloat4& y, SimdFloat4& z)
+{
+    w = simdLoad(&rotations[0].w);
+    x = simdLoad(&rotations[1].w);
+    y = simdLoad(&rotations[2].w);
+    z = simdLoad(&rotations[3].w);
+    simdTranspose(w, x, y, z);
+}
+
+//Gathers the upper 3x4 part of four consecutive matrices into lanes, element[row + col * 3] holds the lanes of the element at row, col.
+static void loadMatrixLanes(const Matrix4x4* matrices, SimdFloat4* elements)
+{
+    SimdFloat4 unused;
+    for(unsigned int col = 0; col < 4; ++col)
+    {
+        SimdFloat4 x = simdLoad(matrices[0].toArray() + col * 4);
+        SimdFloat4 y = simdLoad(matrices[1].toArray() + col * 4);
+        SimdFloat4 z = simdLoad(matrices[2].toArray() + col * 4);
+        unused = simdLoad(matrices[3].toArray() + col * 4);
+        simdTranspose(x, y, z, unused);
+        elements[col * 3] = x;
+        elements[col * 3 + 1] = y;
+        elements[col * 3 + 2] = z;
+    }
+}
+
+//Scatters the lanes back to four consecutive affine matrices, the layout of elements is the same as in loadMatrixLanes.
+static void storeMatrixLanes(const SimdFloat4* elements, Matrix4x4* matrices)
+{
+    for(unsigned int col = 0; col < 4; ++col)
+    {
+        SimdFloat4 x = elements[col * 3];
+        SimdFloat4 y = elements[col * 3 + 1];
+        SimdFloat4 z = elements[col * 3 + 2];
+        SimdFloat4 w = simdSplat(col == 3 ? 1.0f : 0.0f);
+        simdTranspose(x, y, z, w);
+        simdStore(matrices[0].toArray() + col * 4, x);
+        simdStore(matrices[1].toArray() + col * 4, y);
+        simdStore(matrices[2].toArray() + col * 4, z);
+        simdStore(matrices[3].toArray() + col * 4, w);
+    }
+}
+
+//Rotation matrix elements of four quaternions, laid out as in loadMatrixLanes. Matches Quaternion::rotationMatrix3x3.
+static void rotationMatrixLanes(const SimdFloat4& w, const SimdFloat4& x, const SimdFloat4& y, const SimdFloat4& z, SimdFloat4* elements)
+{
+    SimdFloat4 one = simdSplat(1.0f);
+    SimdFloat4 two = simdSplat(2.0f);
+    SimdFloat4 xx = simdMul(x, x);
+    SimdFloat4 yy = simdMul(y, y);
+    SimdFloat4 zz = simdMul(z, z);
+    SimdFloat4 xy = simdMul(x, y);
+    SimdFloat4 xz = simdMul(x, z);
+    SimdFloat4 yz = simdMul(y, z);
+    SimdFloat4 wx = simdMul(w, x);
+    SimdFloat4 wy = simdMul(w, y);
+    SimdFloat4 wz = simdMul(w, z);
+
+    elements[0] = simdSub(one, simdMul(two, simdAdd(yy, zz)));
+    elements[1] = simdMul(two, simdAdd(xy, wz));
+    elements[2] = simdMul(two, simdSub(xz, wy));
+    elements[3] = simdMul(two, simdSub(xy, wz));
+    elements[4] = simdSub(one, simdMul(two, simdAdd(xx, zz)));
+    elements[5] = simdMul(two, simdAdd(yz, wx));
+    elements[6] = simdMul(two, simdAdd(xz, wy));
+    elements[7] = simdMul(two, simdSub(yz, wx));
+    elements[8] = simdSub(one, simdMul(two, simdAdd(xx, yy)));
+}
+
+void composeTransforms(const Vector3* positions, const Quaternion* rotations, const Vector3* scales, Matrix4x4* transformsOut, unsigned int count)
+{
+    unsigned int i = 0;
+    SimdFloat4 elements[12];
+    for(; i + BatchWidth <= count; i += BatchWidth)
+    {
+        SimdFloat4 w, x, y, z;
+        loadQuaternionLanes(rotations + i, w, x, y, z);
+        rotationMatrixLanes(w, x, y, z, elements);
+
+        SimdFloat4 scaleX, scaleY, scaleZ;
+        loadVector3Lanes(scales + i, scaleX, scaleY, scaleZ);
+        const SimdFloat4 colScales[3] = {scaleX, scaleY, scaleZ};
+        for(unsigned int j = 0; j < 9; ++j)
+            elements[j] = simdMul(elements[j], colScales[j / 3]);
+
+        loadVector3Lanes(positions + i, elements[9], elements[10], elements[11]);
+        storeMatrixLanes(elements, transformsOut + i);
+    }
+
+    for(; i < count; ++i)
+        transformsOut[i].setTransform(positions[i], rotations[i], scales[i]);
+}
+
+void composeInverseTransforms(const Vector3* positions, const Quaternion* rotations, const Vector3* scales, Matrix4x4* inverseTransformsOut, unsigned int count)
+{
+    unsigned int i = 0;
+    SimdFloat4 elements[12];
+    SimdFloat4 one = simdSplat(1.0f);
+    SimdFloat4 epsilon = simdSplat(EPSILON);
+    for(; i + BatchWidth <= count; i += BatchWidth)
+    {
+        SimdFloat4 w, x, y, z;
+        loadQuaternionLanes(rotations + i, w, x, y, z);
+
+        //Quaternion::inverse returns the identity for degenerate rotations, leave those batches to the per-item path.
+        SimdFloat4 lengthSquared = simdMulAdd(w, w, simdMulAdd(x, x, simdMulAdd(y, y, simdMul(z, z))));
+        if(simdAnyLess(lengthSquared, epsilon))
+            break;
+
+        //Rotation matrix of the inverse rotation, conjugate divided by the squared length.
+        SimdFloat4 invLengthSquared = simdDiv(one, lengthSquared);
+        w = simdMul(w, invLengthSquared);
+        x = simdNegate(simdMul(x, invLengthSquared));
+        y = simdNegate(simdMul(y, invLengthSquared));
+        z = simdNegate(simdMul(z, invLengthSquared));
+        rotationMatrixLanes(w, x, y, z, elements);
+
+        //Scale the rows by the inverse scale.
+        SimdFloat4 scaleX, scaleY, scaleZ;
+        loadVector3Lanes(scales + i, scaleX, scaleY, scaleZ);
+        const SimdFloat4 invScales[3] = {simdDiv(one, scaleX), simdDiv(one, scaleY), simdDiv(one, scaleZ)};
+
+        //The translation is the negated position rotated by the inverse rotation and scaled by the inverse scale.
+        SimdFloat4 positionX, positionY, positionZ;
+        loadVector3Lanes(positions + i, positionX, positionY, positionZ);
+        for(unsigned int row = 0; row < 3; ++row)
+        {
+            SimdFloat4 translation = simdMulAdd(elements[row], positionX, simdMulAdd(elements[3 + row], positionY, simdMul(elements[6 + row], positionZ)));
+            elements[9 + row] = simdNegate(simdMul(translation, invScales[row]));
+            elements[row] = simdMul(elements[row], invScales[row]);
+            elements[3 + row] = simdMul(elements[3 + row], invScales[row]);
+            elements[6 + row] = simdMul(elements[6 + row], invScales[row]);
+        }
+
+        storeMatrixLanes(elements, inverseTransformsOut + i);
+    }
+
+    for(; i < count; ++i)
+        inverseTransformsOut[i].setInverseTransform(positions[i], rotations[i], scales[i]);
+}
+
+void multiplyTransforms(const Matrix4x4* parents, const Matrix4x4* children, Matrix4x4* transformsOut, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; ++i)
+        transformsOut[i] = parents[i] * children[i];
+}
+
+void invertAffineTransforms(const Matrix4x4* transforms, Matrix4x4* inverseTransformsOut, unsigned int count)
+{
+    unsigned int i = 0;
+    SimdFloat4 a[12];
+    SimdFloat4 inv[12];
+    SimdFloat4 one = simdSplat(1.0f);
+    SimdFloat4 epsilon = simdSplat(EPSILON);
+    for(; i + BatchWidth <= count; i += BatchWidth)
+    {
+        loadMatrixLanes(transforms + i, a);
+
+        //Cofactors of the first row give the determinant of the 3x3 part.
+        SimdFloat4 cofactor00 = simdSub(simdMul(a[4], a[8]), simdMul(a[7], a[5]));
+        SimdFloat4 cofactor01 = simdSub(simdMul(a[7], a[2]), simdMul(a[1], a[8]));
+        SimdFloat4 cofactor02 = simdSub(simdMul(a[1], a[5]), simdMul(a[4], a[2]));
+        SimdFloat4 determinant = simdMulAdd(a[0], cofactor00, simdMulAdd(a[3], cofactor01, simdMul(a[6], cofactor02)));
+        if(simdAnyLess(simdAbs(determinant), epsilon))
+            break;
+
+        //The inverse of the 3x3 part is the adjugate divided by the determinant, elements are indexed by row + col * 3.
+        SimdFloat4 invDeterminant = simdDiv(one, determinant);
+        inv[0] = simdMul(cofactor00, invDeterminant);
+        inv[1] = simdMul(cofactor01, invDeterminant);
+        inv[2] = simdMul(cofactor02, invDeterminant);
+        inv[3] = simdMul(simdSub(simdMul(a[6], a[5]), simdMul(a[3], a[8])), invDeterminant);
+        inv[4] = simdMul(simdSub(simdMul(a[0], a[8]), simdMul(a[6], a[2])), invDeterminant);
+        inv[5] = simdMul(simdSub(simdMul(a[3], a[2]), simdMul(a[0], a[5])), invDeterminant);
+        inv[6] = simdMul(simdSub(simdMul(a[3], a[7]), simdMul(a[6], a[4])), invDeterminant);
+        inv[7] = simdMul(simdSub(simdMul(a[6], a[1]), simdMul(a[0], a[7])), invDeterminant);
+        inv[8] = simdMul(simdSub(simdMul(a[0], a[4]), simdMul(a[3], a[1])), invDeterminant);
+
+        //The translation is the negated translation transformed by the inverse 3x3 part.
+        for(unsigned int row = 0; row < 3; ++row)
+            inv[9 + row] = simdNegate(simdMulAdd(inv[row], a[9], simdMulAdd(inv[3 + row], a[10], simdMul(inv[6 + row], a[11]))));
+
+        storeMatrixLanes(inv, inverseTransformsOut + i);
+    }
+
+    for(; i < count; ++i)
+        inverseTransformsOut[i] = transforms[i].inverse();
+}
+
+//Transforms four boxes by four consecutive matrices, or all of them by the first matrix when sharedTransform is true.
+static void transformBoundingBoxBatch(const BoundingBox* boxes, const Matrix4x4* transforms, bool sharedTransform, BoundingBox* boxesOut)
+{
+    SimdFloat4 m[12];
+    if(!sharedTransform)
+        loadMatrixLanes(transforms, m);
+    else
+    {
+        for(unsigned int col = 0; col < 4; ++col)
+        {
+            m[col * 3] = simdSplat(transforms->toArray()[col * 4]);
+            m[col * 3 + 1] = simdSplat(transforms->toArray()[col * 4 + 1]);
+            m[col * 3 + 2] = simdSplat(transforms->toArray()[col * 4 + 2]);
+        }
+    }
+
+    Vector3 minimums[BatchWidth];
+    Vector3 maximums[BatchWidth];
+    for(unsigned int i = 0; i < BatchWidth; ++i)
+    {
+        minimums[i] = boxes[i].getMin();
+        maximums[i] = boxes[i].getMax();
+    }
+
+    SimdFloat4 minX, minY, minZ, maxX, maxY, maxZ;
+    loadVector3Lanes(minimums, minX, minY, minZ);
+    loadVector3Lanes(maximums, maxX, maxY, maxZ);
+    SimdFloat4 half = simdSplat(0.5f);
+    SimdFloat4 centerX = simdMul(simdAdd(maxX, minX), half);
+    SimdFloat4 centerY = simdMul(simdAdd(maxY, minY), half);
+    SimdFloat4 centerZ = simdMul(simdAdd(maxZ, minZ), half);
+    SimdFloat4 halfSizeX = simdMul(simdSub(maxX, minX), half);
+    SimdFloat4 halfSizeY = simdMul(simdSub(maxY, minY), half);
+    SimdFloat4 halfSizeZ = simdMul(simdSub(maxZ, minZ), half);
+
+    //The new half size is the half size transformed by the absolute values of the 3x3 part.
+    float newMinimums[3][BatchWidth];
+    float newMaximums[3][BatchWidth];
+    for(unsigned int row = 0; row < 3; ++row)
+    {
+        SimdFloat4 newCenter = simdMulAdd(m[row], centerX, simdMulAdd(m[3 + row], centerY, simdMulAdd(m[6 + row], centerZ, m[9 + row])));
+        SimdFloat4 newHalfSize = simdMulAdd(simdAbs(m[row]), halfSizeX, simdMulAdd(simdAbs(m[3 + row]), halfSizeY, simdMul(simdAbs(m[6 + row]), halfSizeZ)));
+        simdStore(newMinimums[row], simdSub(newCenter, newHalfSize));
+        simdStore(newMaximums[row], simdAdd(newCenter, newHalfSize));
+    }
+
+    for(unsigned int i = 0; i < BatchWidth; ++i)
+        boxesOut[i].set(Vector3(newMinimums[0][i], newMinimums[1][i], newMinimums[2][i]), Vector3(newMaximums[0][i], newMaximums[1][i], newMaximums[2][i]));
+}
+
+void transformBoundingBoxes(const BoundingBox* boxes, const Matrix4x4* transforms, BoundingBox* boxesOut, unsigned int count)
+{
+    unsigned int i = 0;
+    for(; i + BatchWidth <= count; i += BatchWidth)
+        transformBoundingBoxBatch(boxes + i, transforms + i, false, boxesOut + i);
+
+    for(; i < count; ++i)
+        boxesOut[i] = boxes[i].transformed(transforms[i]);
+}
+
+void transformBoundingBoxes(const BoundingBox* boxes, const Matrix4x4& transform, BoundingBox* boxesOut, unsigned int count)
+{
+    unsigned int i = 0;
+    for(; i + BatchWidth <= count; i += BatchWidth)
+        transformBoundingBoxBatch(boxes + i, &transform, true, boxesOut + i);
+
+    for(; i < count; ++i)
+        boxesOut[i] = boxes[i].transformed(transform);
+}
+
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef TransformKernels_H
+#define TransformKernels_H
+
+#include "Math/Matrix4x4.h"
+#include "Math/Quaternion.h"
+#include "Math/BoundingBox.h"
+
+namespace Huurre3D
+{
+
+//Batched transform kernels working on contiguous arrays of count items. Except for multiplyTransforms,
+//which uses the SIMD lanes for the rows of each product, the work is vectorized across items:
+//four items are processed at a time in structure-of-arrays form and the remainder one by one.
+//The results equal the per-item Matrix4x4 and BoundingBox functions within rounding.
+
+//Same as Matrix4x4::setTransform for each position, rotation and scale.
+void composeTransforms(const Vector3* positions, const Quaternion* rotations, const Vector3* scales, Matrix4x4* transformsOut, unsigned int count);
+//Same as Matrix4x4::setInverseTransform for each position, rotation and scale.
+void composeInverseTransforms(const Vector3* positions, const Quaternion* rotations, const Vector3* scales, Matrix4x4* inverseTransformsOut, unsigned int count);
+//transformsOut[i] = parents[i] * children[i]. The output may alias either input.
+void multiplyTransforms(const Matrix4x4* parents, const Matrix4x4* children, Matrix4x4* transformsOut, unsigned int count);
+//Inverts affine transforms, the bottom row of the input is assumed to be (0, 0, 0, 1). Singular transforms are inverted with Matrix4x4::inverse.
+void invertAffineTransforms(const Matrix4x4* transforms, Matrix4x4* inverseTransformsOut, unsigned int count);
+//Same as BoundingBox::transformed for each box and its transform.
+void transformBoundingBoxes(const BoundingBox* boxes, const Matrix4x4* transforms, BoundingBox* boxesOut, unsigned int count);
+//Transforms all the boxes with the same transform.
+void transformBoundingBoxes(const BoundingBox* boxes, const Matrix4x4& transform, BoundingBox* boxesOut, unsigned int count);
+
+}
+
+#endif
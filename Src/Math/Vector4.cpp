@@ -21,6 +21,7 @@
 
 #include "Math/Vector4.h"
 #include "Math/MathFunctions.h"
+#include "Math/SIMD.h"
 
 namespace Huurre3D
 {
@@ -60,10 +61,7 @@ x(data[0]), y(data[1]), z(data[2]), w(data[3])
 
 Vector4& Vector4::operator = (const Vector4& rhs)
 {
-    x = rhs.x;
-    y = rhs.y;
-    z = rhs.z;
-    w = rhs.w;
+    simdStore(&x, simdLoad(&rhs.x));
     return *this;
 }
 
@@ -79,66 +77,58 @@ bool Vector4::operator != (const Vector4& rhs) const
 
 Vector4 Vector4::operator + (const Vector4& rhs) const
 {
-    return Vector4(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+    Vector4 result;
+    simdStore(&result.x, simdAdd(simdLoad(&x), simdLoad(&rhs.x)));
+    return result;
 }
 
 Vector4& Vector4::operator += (const Vector4& rhs)
 {
-	 x += rhs.x;
-     y += rhs.y;
-     z += rhs.z;
-	 w += rhs.w;
-     return *this;
+    simdStore(&x, simdAdd(simdLoad(&x), simdLoad(&rhs.x)));
+    return *this;
 }
 
 Vector4 Vector4::operator - (const Vector4& rhs) const
 {
-    return Vector4(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+    Vector4 result;
+    simdStore(&result.x, simdSub(simdLoad(&x), simdLoad(&rhs.x)));
+    return result;
 }
 
 Vector4& Vector4::operator -= (const Vector4& rhs)
 {
-	 x -= rhs.x;
-     y -= rhs.y;
-     z -= rhs.z;
-	 w -= rhs.w;
-     return *this;
+    simdStore(&x, simdSub(simdLoad(&x), simdLoad(&rhs.x)));
+    return *this;
 }
 
 Vector4 Vector4::operator -() const
 {
-    return Vector4(-x, -y, -z, -w);
+    Vector4 result;
+    simdStore(&result.x, simdNegate(simdLoad(&x)));
+    return result;
 }
 
 Vector4 Vector4::operator * (float scalar) const
 {
-    return Vector4(x * scalar, y * scalar, z * scalar, w * scalar);
+    Vector4 result;
+    simdStore(&result.x, simdMul(simdLoad(&x), simdSplat(scalar)));
+    return result;
 }
 
 Vector4& Vector4::operator *= (float scalar)
 {
-    x *= scalar;
-    y *= scalar;
-    z *= scalar;
-    w *= scalar;
+    simdStore(&x, simdMul(simdLoad(&x), simdSplat(scalar)));
     return *this;
 }
 
 Vector4 Vector4::operator / (float scalar) const
 {
-    float invScalar = 1.f / scalar;
-    return Vector4(x * invScalar, y * invScalar, z * invScalar, w * invScalar);
+    return *this * (1.f / scalar);
 }
 
 Vector4& Vector4::operator /= (float scalar)
 {
-    float invScalar = 1.f / scalar;
-
-    x *= invScalar;
-    y *= invScalar;
-    z *= invScalar;
-    w *= invScalar;
-    return *this;
+    return *this *= (1.f / scalar);
 }
 
 void Vector4::set(float x, float y, float z, float w)
@@ -151,17 +141,19 @@ void Vector4::set(float x, float y, float z, float w)
 
 Vector4 Vector4::absolute() const
 {
-    return Vector4(abs(x), abs(y), abs(z), abs(w));
+    Vector4 result;
+    simdStore(&result.x, simdAbs(simdLoad(&x)));
+    return result;
 }
 
 float Vector4::dot(const Vector4& rhs) const
 {
-    return x * rhs.x + y * rhs.y + z * rhs.z + w * rhs.w;
+    return simdDot4(simdLoad(&x), simdLoad(&rhs.x));
 }
 
 float Vector4::absDot(const Vector4& rhs) const
 {
-    return abs(x * rhs.x) + abs(y * rhs.y) + abs(z * rhs.z) + abs(w * rhs.w);
+    return simdHorizontalAdd(simdAbs(simdMul(simdLoad(&x), simdLoad(&rhs.x))));
 }
 
 Vector4 Vector4::cross(const Vector4& rhs1, const Vector4& rhs2) const
@@ -201,12 +193,13 @@ Vector3 Vector4::project3D() const
 
 float Vector4::length() const
 {
-    return sqrt(x * x + y * y + z * z + w * w);
+    return sqrt(lengthSquared());
 }
 
 float Vector4::lengthSquared() const
 {
-    return x * x + y * y + z * z + w * w;
+    SimdFloat4 v = simdLoad(&x);
+    return simdDot4(v, v);
 }
 
 float Vector4::normalize()
@@ -234,7 +227,9 @@ Vector4 Vector4::normalized() const
 
 Vector4 Vector4::lerp(const Vector4& rhs, float weight) const
 {
-    return *this * (1.0f - weight) + rhs * weight;
+    Vector4 result;
+    simdStore(&result.x, simdMulAdd(simdLoad(&rhs.x), simdSplat(weight), simdMul(simdLoad(&x), simdSplat(1.0f - weight))));
+    return result;
 }
 
 }
\ No newline at end of file
@@ -85,6 +85,9 @@ public:
     static const Vector4 ONE;
 };
 
+//The SIMD implementation loads the components as one 4-wide vector.
+static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be four tightly packed floats");
+
 }
 
 #endif
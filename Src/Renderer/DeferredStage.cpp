@@ -24,13 +24,46 @@
 #include "Renderer/Material.h"
 #include "Renderer/Geometry.h"
 #include "Scene/Mesh.h"
+#include "Util/Profiler.h"
+#include <algorithm>
 
 namespace Huurre3D
 {
 
+//Orders the items so that the ones a multi-draw can merge are next to each other.
+static bool compareMaterialDrawOrder(const RenderItem& lhs, const RenderItem& rhs)
+{
+    unsigned int lhsTag = lhs.material->getIndirectShaderCombinationTag();
+    unsigned int rhsTag = rhs.material->getIndirectShaderCombinationTag();
+    if(lhsTag != rhsTag)
+        return lhsTag < rhsTag;
+
+    const VertexData* lhsVertexData = lhs.geometry->getVertexData();
+    const VertexData* rhsVertexData = rhs.geometry->getVertexData();
+    if(lhsVertexData != rhsVertexData)
+        return lhsVertexData < rhsVertexData;
+
+    return lhs.material < rhs.material;
+}
+
+//The range is set on every draw, since defragmenting the geometries moves it.
+static void setDrawRecordGeometry(ShaderPass& pass, const Geometry* geometry)
+{
+    pass.vertexData = geometry->getVertexData();
+    pass.firstIndex = geometry->getFirstIndex();
+    pass.numIndices = geometry->getNumIndices();
+    pass.baseVertex = geometry->getBaseVertex();
+}
+
 DeferredStage::DeferredStage(Renderer& renderer):
-RenderStage(renderer)
+RenderStage(renderer),
+indirectDrawBatcher(renderer.getGraphicSystem())
+{
+}
+
+DeferredStage::~DeferredStage()
 {
+    delete rasterizeWorkQueue;
 }
 
 void DeferredStage::init(const JSONValue& deferredgStageJSON)
@@ -38,42 +71,177 @@ void DeferredStage::init(const JSONValue& deferredgStageJSON)
     auto gbufferRenderPassJSON = deferredgStageJSON.getJSONValue("GbufferRenderPass");
     if(!gbufferRenderPassJSON.isNull())
         renderPasses.pushBack(createRenderPassFromJson(gbufferRenderPassJSON));
+
+    //The world transforms and material indices are drawn from per-draw parameters with multi-draws.
+    auto indirectDrawsJSON = deferredgStageJSON.getJSONValue("indirectDraws");
+    if(!indirectDrawsJSON.isNull() && indirectDrawsJSON.getBool())
+    {
+        indirectDraws = true;
+        renderer.enableIndirectMaterialPrograms();
+        indirectDrawBatcher.reserve(InitialIndirectDrawBatches);
+    }
+
+    //The items hidden behind the occluder meshes are culled before the draws are built.
+    auto occlusionCullingJSON = deferredgStageJSON.getJSONValue("occlusionCulling");
+    if(!occlusionCullingJSON.isNull())
+    {
+        auto widthJSON = occlusionCullingJSON.getJSONValue("width");
+        auto heightJSON = occlusionCullingJSON.getJSONValue("height");
+        auto maxOccludersJSON = occlusionCullingJSON.getJSONValue("maxOccluders");
+        occlusionCulling = true;
+        if(!rasterizeWorkQueue)
+            rasterizeWorkQueue = new WorkQueue<OcclusionRasterizeWorkers>();
+        occlusionCuller.setResolution(widthJSON.isNull() ? 256 : widthJSON.getInt(), heightJSON.isNull() ? 128 : heightJSON.getInt());
+        if(!maxOccludersJSON.isNull())
+            occlusionCuller.setMaxOccluders(maxOccludersJSON.getInt());
+    }
+
+    //The items too small on the screen or too far from the camera are culled before the occlusion culling.
+    auto contributionCullingJSON = deferredgStageJSON.getJSONValue("contributionCulling");
+    if(!contributionCullingJSON.isNull())
+    {
+        contributionCulling = true;
+        initContributionCuller(contributionCullingJSON, contributionCuller);
+    }
+
+    //The visible items are drawn from the levels of detail of their geometries selected by the projected size.
+    auto lodJSON = deferredgStageJSON.getJSONValue("lod");
+    if(!lodJSON.isNull())
+    {
+        lodSelection = true;
+        initLodSelector(lodJSON, lodSelector);
+    }
 }
 
 void DeferredStage::clearStage()
 {
     deferredRenderItems.clear();
     renderPasses[0].shaderPasses.clear();
+    renderPasses[0].stageShaderPasses.clear();
+
+    if(indirectDraws)
+        indirectDrawBatcher.reset();
 }
 
-void DeferredStage::update(const Scene& scene)
+void DeferredStage::update(const RenderView& view)
 {
-    Frustum worldSpaceCameraViewFrustum = scene.getMainCamera()->getViewFrustumInWorldSpace();
-    cullRenderItems(scene, deferredRenderItems, worldSpaceCameraViewFrustum);
+    Frustum worldSpaceCameraViewFrustum = view.camera.getViewFrustumInWorldSpace();
+    //While the camera stays still only the moved meshes are culled again.
+    visibilityCache.cullRenderItems(view, worldSpaceCameraViewFrustum, view.camera.getViewProjectionMatrix(), deferredRenderItems, &statistics.culling);
+    if(contributionCulling)
+    {
+        contributionCuller.setCamera(view.camera);
+        contributionCuller.cullRenderItems(deferredRenderItems, 1.0f, &statistics.culling);
+    }
+    if(occlusionCulling)
+        cullOccludedItems(view);
 
-    Vector<unsigned int> materialBufferIndicies = renderer.getMaterialBufferIndicies();
-    GraphicSystem& graphicSystem = renderer.getGraphicSystem();
-    ShaderParameterBlock* cameraShaderParameterBlock = graphicSystem.getShaderParameterBlockByName(sp_cameraParameters);
-    ShaderParameterBlock* skinMatrixShaderParameterBlock = graphicSystem.getShaderParameterBlockByName(sp_skinMatrixArray);
+    if(lodSelection)
+    {
+        lodSelector.setCamera(view.camera);
+        lodSelector.selectLods(deferredRenderItems, &statistics.lods);
+    }
+
+    if(indirectDraws)
+        std::sort(deferredRenderItems.begin(), deferredRenderItems.end(), compareMaterialDrawOrder);
 
-    //Create a shader pass for each material.
+    //The records are referenced by the render pass, so they are resized before the first one is added.
+    unsigned int numRecords = drawRecords.size();
     for(unsigned int i = 0; i < deferredRenderItems.size(); ++i)
+        numRecords = std::max(numRecords, deferredRenderItems[i].id + 1);
+    drawRecords.resize(numRecords);
+
+    //Add the pass of each item from its draw record, with multi-draws the passes of the same state are merged.
+    DrawRecordStatistics& recordStatistics = statistics.drawRecords;
+    for(unsigned int i = 0; i < deferredRenderItems.size(); ++i)
+    {
+        const RenderItem& item = deferredRenderItems[i];
+        DrawRecord& record = drawRecords[item.id];
+        ++recordStatistics.recordsDrawn;
+        if(record.material != item.material || record.materialVersion != item.material->getChangeVersion())
+        {
+            buildDrawRecord(record, item);
+            ++recordStatistics.recordsRebuilt;
+        }
+
+        if(record.indirectPass.program)
+        {
+            setDrawRecordGeometry(record.indirectPass, item.geometry);
+            if(indirectDrawBatcher.addDraw(renderPasses[0].shaderPasses, record.indirectPass, item.worldTransform, record.materialParameterSlot))
+                continue;
+        }
+
+        setDrawRecordGeometry(record.pass, item.geometry);
+        unsigned char* worldTransform = record.pass.shaderParameters[0].value;
+        if(memcmp(worldTransform, item.worldTransform.toArray(), sizeof(Matrix4x4)) != 0)
+        {
+            memcpy(worldTransform, item.worldTransform.toArray(), sizeof(Matrix4x4));
+            ++recordStatistics.transformsUpdated;
+        }
+
+        renderPasses[0].stageShaderPasses.pushBack(&record.pass);
+    }
+}
+
+void DeferredStage::buildDrawRecord(DrawRecord& record, const RenderItem& item)
+{
+    Material* material = item.material;
+    GraphicSystem& graphicSystem = renderer.getGraphicSystem();
+    record.material = material;
+    record.materialVersion = material->getChangeVersion();
+    record.materialParameterSlot = material->getParameterSlot();
+
+    ShaderPass& pass = record.pass;
+    pass.textures.clear();
+    material->getTextures(pass.textures);
+    pass.rasterState = material->getRasterState();
+    pass.shaderParameterBlocks.clear();
+    pass.shaderParameterBlocks.pushBack(graphicSystem.getShaderParameterBlockByName(sp_cameraParameters));
+    pass.shaderParameterBlocks.pushBack(graphicSystem.getShaderParameterBlockByName(sp_skinMatrixArray));
+    pass.shaderParameters.clear();
+    pass.shaderParameters.pushBack(ShaderParameter(sp_worldTransform, item.worldTransform));
+    pass.shaderParameters.pushBack(ShaderParameter(sp_materialParameterIndex, record.materialParameterSlot));
+    pass.program = graphicSystem.getShaderCombination(material->getCurrentShaderCombinationTag());
+
+    //A material created before the multi-draws were enabled has no program for them.
+    record.indirectPass.program = nullptr;
+    if(indirectDraws)
     {
-        ShaderPass materialPass;
-        deferredRenderItems[i].material->getTextures(materialPass.textures);
-        materialPass.rasterState = deferredRenderItems[i].material->getRasterState();
-        materialPass.vertexData = deferredRenderItems[i].geometry->getVertexData();
-        materialPass.shaderParameters.pushBack(ShaderParameter(sp_worldTransform, deferredRenderItems[i].geometry->getWorldTransform()));
-
-        unsigned int materialParameterId = deferredRenderItems[i].material->getParameterId();
-        int materialBufferIndex = materialBufferIndicies.getIndexToItem(materialParameterId);
-        materialPass.shaderParameters.pushBack(ShaderParameter(sp_materialParameterIndex, materialBufferIndex));
-        materialPass.shaderParameterBlocks.pushBack(cameraShaderParameterBlock);
-        materialPass.shaderParameterBlocks.pushBack(skinMatrixShaderParameterBlock);
-
-        materialPass.program = graphicSystem.getShaderCombination(deferredRenderItems[i].material->getCurrentShaderCombinationTag());
-        renderPasses[0].shaderPasses.pushBack(materialPass);
+        record.indirectPass = pass;
+        record.indirectPass.shaderParameters.clear();
+        record.indirectPass.program = graphicSystem.getShaderCombination(material->getIndirectShaderCombinationTag());
     }
 }
 
+void DeferredStage::cullOccludedItems(const RenderView& view)
+{
+    PROFILE_ZONE("DeferredStage::cullOccludedItems");
+    statistics.culling.occluders = occlusionCuller.setupOccluders(view);
+    if(statistics.culling.occluders == 0)
+        return;
+
+    //The bands are shared by the tasks in turns, this stage rasterizes the share of the first task.
+    unsigned int numBands = occlusionCuller.getNumBands();
+    unsigned int numTasks = std::min(numBands, OcclusionRasterizeWorkers + 1);
+    OcclusionCuller* culler = &occlusionCuller;
+    for(unsigned int i = 1; i < numTasks; ++i)
+    {
+        rasterizeResults[i - 1] = rasterizeWorkQueue->submitTask([culler, i, numBands, numTasks]()
+        {
+            PROFILE_ZONE("OcclusionCuller::rasterizeBand");
+            for(unsigned int band = i; band < numBands; band += numTasks)
+                culler->rasterizeBand(band);
+        });
+    }
+
+    for(unsigned int band = 0; band < numBands; band += numTasks)
+        occlusionCuller.rasterizeBand(band);
+
+    for(unsigned int i = 1; i < numTasks; ++i)
+        rasterizeResults[i - 1].wait();
+
+    occlusionCuller.buildHierarchy();
+    occlusionCuller.cullRenderItems(deferredRenderItems, &statistics.culling);
+}
+
 }
\ No newline at end of file
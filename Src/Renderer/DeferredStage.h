@@ -23,24 +23,66 @@
 #define DeferredStage_H
 
 #include "Renderer/RenderStage.h"
+#include "Renderer/IndirectDrawBatcher.h"
+#include "Scene/OcclusionCuller.h"
+#include "Scene/VisibilityCache.h"
+#include "Util/WorkQueue.h"
 
 namespace Huurre3D
 {
 
+//The passes of a render item, built once and rebuilt only when the material of the item changes.
+//Workers of the occlusion band rasterization, the stage rasterizes a share of the bands too.
+static const unsigned int OcclusionRasterizeWorkers = WorkQueueSize - 1;
+
+struct DrawRecord
+{
+    const Material* material = nullptr;
+    unsigned int materialVersion = 0;
+    int materialParameterSlot = -1;
+    //The pass of a single draw, with the world transform and the material index as its parameters.
+    ShaderPass pass;
+    //The pass added to the multi-draws, it has no parameters and no program when the material has no multi-draw program.
+    ShaderPass indirectPass;
+};
+
 class DeferredStage : public RenderStage
 {
     RENDERSTAGE_TYPE(DeferredStage);
 
 public:
     DeferredStage(Renderer& renderer);
-    ~DeferredStage() = default;
+    ~DeferredStage();
     
     void init(const JSONValue& deferredgStageJSON) override;
     void clearStage() override;
-    void update(const Scene& scene) override;
+    void update(const RenderView& view) override;
+    //Ids of the items which became visible or hidden in the view frustum since the previous frame.
+    const Vector<unsigned int>& getItemsBecameVisible() const {return visibilityCache.getItemsBecameVisible();}
+    const Vector<unsigned int>& getItemsBecameHidden() const {return visibilityCache.getItemsBecameHidden();}
 
 private:
     Vector<RenderItem> deferredRenderItems;
+    void cullOccludedItems(const RenderView& view);
+    void buildDrawRecord(DrawRecord& record, const RenderItem& item);
+
+    //Indexed by the ids of the render items. The scene reuses the ids of removed items, a record left by a removed item
+    //is rebuilt unless the new item has the same material, in which case the record is already valid for it.
+    Vector<DrawRecord> drawRecords;
+
+    IndirectDrawBatcher indirectDrawBatcher;
+    OcclusionCuller occlusionCuller;
+    VisibilityCache visibilityCache;
+    LodSelector lodSelector;
+    ContributionCuller contributionCuller;
+    //The stage is updated on a worker of the renderer's work queue, so the bands have workers of their own. Waiting for tasks
+    //queued behind the other stages on the same queue could leave every worker waiting.
+    WorkQueue<OcclusionRasterizeWorkers>* rasterizeWorkQueue = nullptr;
+    FixedArray<std::future<void>, OcclusionRasterizeWorkers> rasterizeResults;
+    bool indirectDraws = false;
+    bool occlusionCulling = false;
+    bool lodSelection = false;
+    bool contributionCulling = false;
 };
 
 }
@@ -29,15 +29,20 @@ void Geometry::setVertexData(VertexData* vertexData)
     this->vertexData = vertexData;
 }
 
+void Geometry::setAllocation(GeometryAllocation* allocation)
+{
+    this->allocation = allocation;
+    vertexData = allocation->buffer->vertexData;
+}
+
 void Geometry::setBoundingBox(const BoundingBox& boundingBox)
 {
     this->boundingBox = boundingBox;
 }
 
-void Geometry::setWorldTransform(const Matrix4x4& worldTransform)
+void Geometry::addLod(Geometry* lod, float screenSize)
 {
-    this->worldTransform = worldTransform;
-    worldBoundingBox = boundingBox.transformed(worldTransform);
+    lods.pushBack({lod, screenSize});
 }
 
-}
\ No newline at end of file
+}
@@ -23,11 +23,22 @@
 #define Geometry_H
 
 #include "Graphics/VertexData.h"
+#include "Renderer/GeometryAllocator.h"
 #include "Math/BoundingBox.h"
+#include "Util/Vector.h"
 
 namespace Huurre3D
 {
 
+class Geometry;
+
+//A coarser level of a geometry and the projected size of the bounding sphere, relative to the view height, below which the level is drawn.
+struct GeometryLod
+{
+    Geometry* geometry;
+    float screenSize;
+};
+
 class Geometry
 {
 public:
@@ -35,18 +46,34 @@ public:
     ~Geometry() = default;
 	
     void setVertexData(VertexData* vertexData);
+    //Draws the geometry from its allocation in the shared buffers of its vertex layout.
+    void setAllocation(GeometryAllocation* allocation);
     void setBoundingBox(const BoundingBox& boundingBox);
-    void setWorldTransform(const Matrix4x4& worldTransform);
     VertexData* getVertexData() const {return vertexData;}
+    GeometryAllocation* getAllocation() const {return allocation;}
+    //The range of the vertex data the geometry is drawn from, the whole vertex data when the geometry has no allocation.
+    unsigned int getBaseVertex() const {return allocation ? allocation->baseVertex : 0;}
+    unsigned int getFirstIndex() const {return allocation ? allocation->firstIndex : 0;}
+    unsigned int getNumIndices() const
+    {
+        if(allocation)
+            return allocation->numIndices;
+
+        return vertexData->isIndexed() ? vertexData->getIndexBuffer()->getNumIndices() : 0;
+    }
     const BoundingBox& getBoundingBox() const {return boundingBox;}
-    const BoundingBox& getWorldBoundingBox() const {return worldBoundingBox; }
-    const Matrix4x4& getWorldTransform() const {return worldTransform;}
+    //The levels are added in the order of decreasing screen size, the copies of a geometry share the level geometries.
+    void addLod(Geometry* lod, float screenSize);
+    //Number of levels including the geometry itself, which is the level zero.
+    unsigned int getNumLods() const {return lods.size() + 1;}
+    const Geometry* getLod(unsigned int level) const {return level == 0 ? this : lods[level - 1].geometry;}
+    float getLodScreenSize(unsigned int level) const {return level == 0 ? 0.0f : lods[level - 1].screenSize;}
 
 private:
     BoundingBox boundingBox;
-    BoundingBox worldBoundingBox;
-    Matrix4x4 worldTransform = Matrix4x4::IDENTITY;
     VertexData* vertexData = nullptr;
+    GeometryAllocation* allocation = nullptr;
+    Vector<GeometryLod> lods;
 
 };
 
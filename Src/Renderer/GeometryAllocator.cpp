@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/GeometryAllocator.h"
+#include "Graphics/GraphicSystem.h"
+#include "Math/MathFunctions.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Huurre3D
+{
+
+static unsigned int generateLayoutHash(PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, IndexType indexType)
+{
+    Vector<unsigned int> layout;
+    layout.pushBack(static_cast<unsigned int>(primitiveType));
+    layout.pushBack(static_cast<unsigned int>(indexType));
+
+    for(unsigned int i = 0; i < attributeDescriptions.size(); ++i)
+    {
+        const AttributeDescription& description = attributeDescriptions[i];
+        layout.pushBack(static_cast<unsigned int>(description.type));
+        layout.pushBack(static_cast<unsigned int>(description.semantic));
+        layout.pushBack(description.numComponentsPerVertex);
+        layout.pushBack(description.stride);
+        layout.pushBack(description.normalized ? 1 : 0);
+    }
+
+    return generateHash(reinterpret_cast<const unsigned char*>(layout.getData()), layout.getSizeInBytes());
+}
+
+static bool isSameLayout(const GeometryBuffer* buffer, PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, IndexType indexType)
+{
+    if(buffer->primitiveType != primitiveType || buffer->indexType != indexType || buffer->attributeDescriptions.size() != attributeDescriptions.size())
+        return false;
+
+    for(unsigned int i = 0; i < attributeDescriptions.size(); ++i)
+    {
+        const AttributeDescription& lhs = buffer->attributeDescriptions[i];
+        const AttributeDescription& rhs = attributeDescriptions[i];
+        if(lhs.type != rhs.type || lhs.semantic != rhs.semantic || lhs.numComponentsPerVertex != rhs.numComponentsPerVertex || lhs.stride != rhs.stride || lhs.normalized != rhs.normalized)
+            return false;
+    }
+
+    return true;
+}
+
+GeometryAllocator::GeometryAllocator(GraphicSystem& graphicSystem):
+graphicSystem(graphicSystem)
+{
+}
+
+GeometryAllocator::~GeometryAllocator()
+{
+    //The vertex data, streams and index buffers are owned by the GraphicSystem.
+    for(unsigned int i = 0; i < buffers.size(); ++i)
+    {
+        for(unsigned int j = 0; j < buffers[i]->allocations.size(); ++j)
+            delete buffers[i]->allocations[j];
+
+        delete buffers[i];
+    }
+}
+
+GeometryAllocation* GeometryAllocator::allocate(PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, const MemoryBuffer& vertexData, unsigned int numVertices,
+    IndexType indexType, const MemoryBuffer& indices, unsigned int numIndices)
+{
+    if(numVertices == 0 || numIndices == 0)
+    {
+        std::cout << "Failed to allocate geometry. Geometries in the shared buffers need both vertices and indices" << std::endl;
+        return nullptr;
+    }
+
+    GeometryBuffer* buffer = getBuffer(primitiveType, attributeDescriptions, indexType);
+    unsigned int vertexSize = buffer->vertexStream->getVertexSize();
+    unsigned int indexBytes = indexSize[static_cast<int>(indexType)];
+
+    if(vertexData.getSizeInBytes() < numVertices * vertexSize || indices.getSizeInBytes() < numIndices * indexBytes)
+    {
+        std::cout << "Failed to allocate geometry. The vertex or index data is smaller than the number of vertices or indices" << std::endl;
+        return nullptr;
+    }
+
+    GeometryAllocation* allocation = new GeometryAllocation();
+    allocation->buffer = buffer;
+    allocation->numVertices = numVertices;
+    allocation->numIndices = numIndices;
+
+    if(!allocateRanges(buffer, allocation))
+    {
+        //Compacting the buffer is cheaper than growing it, when there is enough free space in total.
+        if(buffer->vertexRanges.getNumFreeUnits() >= numVertices && buffer->indexRanges.getNumFreeUnits() >= numIndices)
+            defragment(buffer);
+
+        if(!allocateRanges(buffer, allocation))
+        {
+            grow(buffer, numVertices, numIndices);
+            allocateRanges(buffer, allocation);
+        }
+    }
+
+    buffer->vertexStream->updateAttributes(allocation->baseVertex, vertexData.getData(), numVertices);
+    buffer->indexBuffer->updateIndices(allocation->firstIndex, indices.getData(), numIndices);
+    allocation->bufferIndex = buffer->allocations.size();
+    buffer->allocations.pushBack(allocation);
+
+    return allocation;
+}
+
+void GeometryAllocator::release(GeometryAllocation* allocation)
+{
+    if(allocation && --allocation->numReferences == 0)
+    {
+        GeometryBuffer* buffer = allocation->buffer;
+        buffer->vertexRanges.free(allocation->baseVertex, allocation->numVertices);
+        buffer->indexRanges.free(allocation->firstIndex, allocation->numIndices);
+
+        GeometryAllocation* lastAllocation = buffer->allocations.back();
+        buffer->allocations[allocation->bufferIndex] = lastAllocation;
+        lastAllocation->bufferIndex = allocation->bufferIndex;
+        buffer->allocations.popBack();
+
+        delete allocation;
+    }
+}
+
+void GeometryAllocator::defragment()
+{
+    for(unsigned int i = 0; i < buffers.size(); ++i)
+    {
+        if(buffers[i]->vertexRanges.getNumFreeRanges() > 1 || buffers[i]->indexRanges.getNumFreeRanges() > 1)
+            defragment(buffers[i]);
+    }
+}
+
+void GeometryAllocator::setInitialCapacity(unsigned int numVertices, unsigned int numIndices)
+{
+    initialNumVertices = numVertices;
+    initialNumIndices = numIndices;
+}
+
+GeometryBuffer* GeometryAllocator::getBuffer(PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, IndexType indexType)
+{
+    unsigned int layoutHash = generateLayoutHash(primitiveType, attributeDescriptions, indexType);
+    GeometryBuffer* buffer = nullptr;
+    auto sameLayout = [&](const GeometryBuffer* buffer){return buffer->layoutHash == layoutHash && isSameLayout(buffer, primitiveType, attributeDescriptions, indexType);};
+    if(buffers.findItem(sameLayout, buffer))
+        return buffer;
+
+    buffer = new GeometryBuffer();
+    buffer->layoutHash = layoutHash;
+    buffer->primitiveType = primitiveType;
+    buffer->indexType = indexType;
+    buffer->attributeDescriptions = attributeDescriptions;
+    buffer->vertexData = graphicSystem.createVertexData(primitiveType, 0);
+    buffer->vertexStream = graphicSystem.createVertexStream(0, attributeDescriptions);
+    buffer->vertexStream->setRetainData(true);
+    buffer->vertexData->setVertexStream(buffer->vertexStream);
+    buffer->indexBuffer = graphicSystem.createIndexBuffer(indexType, 0, false);
+    buffer->indexBuffer->setRetainData(true);
+    buffer->vertexData->setIndexBuffer(buffer->indexBuffer);
+    buffers.pushBack(buffer);
+
+    return buffer;
+}
+
+bool GeometryAllocator::allocateRanges(GeometryBuffer* buffer, GeometryAllocation* allocation)
+{
+    unsigned int baseVertex = buffer->vertexRanges.allocate(allocation->numVertices);
+    if(baseVertex == InvalidRangeOffset)
+        return false;
+
+    unsigned int firstIndex = buffer->indexRanges.allocate(allocation->numIndices);
+    if(firstIndex == InvalidRangeOffset)
+    {
+        buffer->vertexRanges.free(baseVertex, allocation->numVertices);
+        return false;
+    }
+
+    allocation->baseVertex = baseVertex;
+    allocation->firstIndex = firstIndex;
+    return true;
+}
+
+void GeometryAllocator::defragment(GeometryBuffer* buffer)
+{
+    Vector<GeometryAllocation*>& allocations = buffer->allocations;
+
+    //Moving the allocations in the order of their offsets never overwrites an allocation that has not been moved yet.
+    std::sort(allocations.begin(), allocations.end(), [](const GeometryAllocation* lhs, const GeometryAllocation* rhs){return lhs->baseVertex < rhs->baseVertex;});
+    unsigned int nextVertex = 0;
+    for(unsigned int i = 0; i < allocations.size(); ++i)
+    {
+        GeometryAllocation* allocation = allocations[i];
+        if(allocation->baseVertex != nextVertex)
+        {
+            buffer->vertexStream->moveAttributes(allocation->baseVertex, nextVertex, allocation->numVertices);
+            allocation->baseVertex = nextVertex;
+        }
+        nextVertex += allocation->numVertices;
+    }
+    buffer->vertexRanges.reset(nextVertex);
+
+    std::sort(allocations.begin(), allocations.end(), [](const GeometryAllocation* lhs, const GeometryAllocation* rhs){return lhs->firstIndex < rhs->firstIndex;});
+    unsigned int nextIndex = 0;
+    for(unsigned int i = 0; i < allocations.size(); ++i)
+    {
+        GeometryAllocation* allocation = allocations[i];
+        if(allocation->firstIndex != nextIndex)
+        {
+            buffer->indexBuffer->moveIndices(allocation->firstIndex, nextIndex, allocation->numIndices);
+            allocation->firstIndex = nextIndex;
+        }
+        nextIndex += allocation->numIndices;
+        allocation->bufferIndex = i;
+    }
+    buffer->indexRanges.reset(nextIndex);
+}
+
+void GeometryAllocator::grow(GeometryBuffer* buffer, unsigned int numVertices, unsigned int numIndices)
+{
+    auto newCapacity = [](unsigned int capacity, unsigned int initialCapacity, unsigned int numNeeded)
+    {
+        unsigned int doubled = capacity * 2 > initialCapacity ? capacity * 2 : initialCapacity;
+        return doubled > capacity + numNeeded ? doubled : capacity + numNeeded;
+    };
+
+    //The whole buffer is uploaded again after it has grown.
+    unsigned int vertexCapacity = buffer->vertexRanges.getSize();
+    if(buffer->vertexRanges.getLargestFreeRange() < numVertices)
+    {
+        vertexCapacity = newCapacity(vertexCapacity, initialNumVertices, numVertices);
+        buffer->vertexStream->setNumVertices(vertexCapacity);
+        buffer->vertexData->setNumVertices(vertexCapacity);
+        buffer->vertexRanges.grow(vertexCapacity);
+    }
+
+    unsigned int indexCapacity = buffer->indexRanges.getSize();
+    if(buffer->indexRanges.getLargestFreeRange() < numIndices)
+    {
+        indexCapacity = newCapacity(indexCapacity, initialNumIndices, numIndices);
+        buffer->indexBuffer->setNumIndices(indexCapacity);
+        buffer->indexRanges.grow(indexCapacity);
+    }
+}
+
+}
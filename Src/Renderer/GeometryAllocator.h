@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GeometryAllocator_H
+#define GeometryAllocator_H
+
+#include "Graphics/VertexData.h"
+#include "Util/RangeAllocator.h"
+
+namespace Huurre3D
+{
+
+class GraphicSystem;
+struct GeometryBuffer;
+
+//Place of one geometry in the shared buffers of its vertex layout. Defragmentation moves the ranges, so they are read at draw time.
+struct GeometryAllocation
+{
+    GeometryBuffer* buffer = nullptr;
+    unsigned int baseVertex = 0;
+    unsigned int numVertices = 0;
+    unsigned int firstIndex = 0;
+    unsigned int numIndices = 0;
+    //Number of geometries drawn from the allocation, the ranges are freed when the last one is released.
+    unsigned int numReferences = 1;
+    //Index of the allocation in the allocations of its buffer.
+    unsigned int bufferIndex = 0;
+};
+
+//Vertex and index buffers shared by the geometries of one vertex layout, primitive type and index type.
+struct GeometryBuffer
+{
+    //The hash rejects the other layouts quickly, the layout itself is compared on a hash hit.
+    unsigned int layoutHash = 0;
+    PrimitiveType primitiveType = PrimitiveType::Triangles;
+    IndexType indexType = IndexType::Int;
+    Vector<AttributeDescription> attributeDescriptions;
+    VertexData* vertexData = nullptr;
+    VertexStream* vertexStream = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+    Vector<GeometryAllocation*> allocations;
+};
+
+//Packs the geometries with the same vertex layout into large shared vertex and index buffers, so the geometries of a layout 
+//are drawn with one vertex data bind. The buffers grow when they run out of space and a fragmented buffer is compacted before it grows.
+//The CPU side copies of the shared buffers are retained for the partial uploads and the compaction.
+class GeometryAllocator
+{
+public:
+    GeometryAllocator(GraphicSystem& graphicSystem);
+    ~GeometryAllocator();
+
+    //Copies the vertices and indices into the shared buffers of the layout. The indices are relative to the first vertex of the geometry.
+    GeometryAllocation* allocate(PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, const MemoryBuffer& vertexData, unsigned int numVertices,
+        IndexType indexType, const MemoryBuffer& indices, unsigned int numIndices);
+    void addReference(GeometryAllocation* allocation) {++allocation->numReferences;}
+    void release(GeometryAllocation* allocation);
+    //Compacts the allocations of every buffer to the beginning of the buffer.
+    void defragment();
+    //Capacity of a new buffer, a geometry larger than this gets a buffer of its own size.
+    void setInitialCapacity(unsigned int numVertices, unsigned int numIndices);
+    const Vector<GeometryBuffer*>& getBuffers() const {return buffers;}
+
+private:
+    GeometryBuffer* getBuffer(PrimitiveType primitiveType, const Vector<AttributeDescription>& attributeDescriptions, IndexType indexType);
+    bool allocateRanges(GeometryBuffer* buffer, GeometryAllocation* allocation);
+    void defragment(GeometryBuffer* buffer);
+    void grow(GeometryBuffer* buffer, unsigned int numVertices, unsigned int numIndices);
+
+    GraphicSystem& graphicSystem;
+    Vector<GeometryBuffer*> buffers;
+    unsigned int initialNumVertices = 65536;
+    unsigned int initialNumIndices = 196608;
+};
+
+}
+
+#endif
@@ -0,0 +1,415 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/GeometrySimplifier.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Huurre3D
+{
+
+static const float FirstLodScreenSize = 0.25f;
+//Smaller levels than this aren't worth the draw of their own geometry.
+static const unsigned int MinLodIndices = 3 * 8;
+static const unsigned int NoVertex = 0xffffffff;
+
+//Exact comparison, in the same way the positions are sorted.
+static bool samePosition(const Vector3& lhs, const Vector3& rhs)
+{
+    return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+static void addPlaneToQuadric(GeometryQuadric& quadric, const Vector3& normal, float distance, float weight)
+{
+    double x = normal.x, y = normal.y, z = normal.z, d = distance, w = weight;
+    quadric.a00 += w * x * x;
+    quadric.a01 += w * x * y;
+    quadric.a02 += w * x * z;
+    quadric.a11 += w * y * y;
+    quadric.a12 += w * y * z;
+    quadric.a22 += w * z * z;
+    quadric.b0 += w * x * d;
+    quadric.b1 += w * y * d;
+    quadric.b2 += w * z * d;
+    quadric.c += w * d * d;
+}
+
+static void addQuadric(GeometryQuadric& quadric, const GeometryQuadric& rhs)
+{
+    quadric.a00 += rhs.a00;
+    quadric.a01 += rhs.a01;
+    quadric.a02 += rhs.a02;
+    quadric.a11 += rhs.a11;
+    quadric.a12 += rhs.a12;
+    quadric.a22 += rhs.a22;
+    quadric.b0 += rhs.b0;
+    quadric.b1 += rhs.b1;
+    quadric.b2 += rhs.b2;
+    quadric.c += rhs.c;
+}
+
+static float evaluateQuadric(const GeometryQuadric& lhs, const GeometryQuadric& rhs, const Vector3& position)
+{
+    double x = position.x, y = position.y, z = position.z;
+    double error = (lhs.a00 + rhs.a00) * x * x + (lhs.a11 + rhs.a11) * y * y + (lhs.a22 + rhs.a22) * z * z +
+        2.0 * ((lhs.a01 + rhs.a01) * x * y + (lhs.a02 + rhs.a02) * x * z + (lhs.a12 + rhs.a12) * y * z) +
+        2.0 * ((lhs.b0 + rhs.b0) * x + (lhs.b1 + rhs.b1) * y + (lhs.b2 + rhs.b2) * z) + lhs.c + rhs.c;
+
+    //Rounding can make the error of a collapse along a flat surface slightly negative.
+    return error > 0.0 ? static_cast<float>(error) : 0.0f;
+}
+
+bool GeometrySimplifier::simplify(const GeometryDescription& source, unsigned int targetNumIndices, GeometryDescription& result)
+{
+    if(!readGeometry(source))
+        return false;
+
+    lockBorderAndSeamVertices();
+    computeQuadrics();
+    collapseEdges(targetNumIndices - targetNumIndices % 3);
+    writeGeometry(source, result);
+
+    return true;
+}
+
+void GeometrySimplifier::generateLods(const GeometryDescription& source, unsigned int maxLods, Vector<GeometryDescription>& lodsOut)
+{
+    unsigned int firstLod = lodsOut.size();
+    unsigned int numIndices = source.numIndices;
+    float screenSize = FirstLodScreenSize;
+
+    for(unsigned int i = 0; i < maxLods; ++i)
+    {
+        unsigned int targetNumIndices = numIndices / 2;
+        if(targetNumIndices < MinLodIndices)
+            break;
+
+        //Each level is simplified from the previous one, which has already removed the cheapest collapses.
+        GeometryDescription lod;
+        const GeometryDescription& previous = lodsOut.size() > firstLod ? lodsOut.back() : source;
+        if(!simplify(previous, targetNumIndices, lod) || static_cast<unsigned int>(lod.numIndices) > numIndices * 3 / 4)
+            break;
+
+        numIndices = lod.numIndices;
+        lod.lodScreenSize = screenSize;
+        screenSize *= 0.5f;
+        lodsOut.pushBack(std::move(lod));
+    }
+}
+
+bool GeometrySimplifier::readGeometry(const GeometryDescription& source)
+{
+    if(source.primitiveType != PrimitiveType::Triangles || source.numIndices < 3 || source.numVertices == 0)
+        return false;
+
+    unsigned int vertexSize = 0;
+    unsigned int positionOffset = NoVertex;
+    for(unsigned int i = 0; i < source.attributeDescriptions.size(); ++i)
+    {
+        const AttributeDescription& description = source.attributeDescriptions[i];
+        if(description.semantic == AttributeSemantic::Position && description.type == AttributeType::Float && description.numComponentsPerVertex >= 3)
+            positionOffset = vertexSize;
+        vertexSize += description.stride;
+    }
+
+    if(positionOffset == NoVertex || source.vertexData.getSizeInBytes() < source.numVertices * vertexSize)
+        return false;
+
+    unsigned int numVertices = source.numVertices;
+    positions.resize(numVertices);
+    const unsigned char* vertexData = source.vertexData.getData();
+    for(unsigned int i = 0; i < numVertices; ++i)
+        memcpy(&positions[i].x, vertexData + i * vertexSize + positionOffset, 3 * sizeof(float));
+
+    unsigned int numIndices = source.numIndices - source.numIndices % 3;
+    indices.resize(numIndices);
+    if(source.indexType == IndexType::Short)
+    {
+        const unsigned short* sourceIndices = reinterpret_cast<const unsigned short*>(source.indices.getData());
+        for(unsigned int i = 0; i < numIndices; ++i)
+            indices[i] = sourceIndices[i];
+    }
+    else
+        memcpy(indices.begin(), source.indices.getData(), numIndices * sizeof(unsigned int));
+
+    for(unsigned int i = 0; i < numIndices; ++i)
+    {
+        if(indices[i] >= numVertices)
+            return false;
+    }
+
+    return true;
+}
+
+void GeometrySimplifier::lockBorderAndSeamVertices()
+{
+    unsigned int numVertices = positions.size();
+    positionVertices.resize(numVertices);
+    lockedVertices.resize(numVertices);
+    lockedVertices.fill(0);
+
+    //The vertices with the same position are next to each other in the order of the positions.
+    Vector<unsigned int> order(numVertices);
+    for(unsigned int i = 0; i < numVertices; ++i)
+        order[i] = i;
+
+    const Vector<Vector3>& vertexPositions = positions;
+    std::sort(order.begin(), order.end(), [&vertexPositions](unsigned int lhs, unsigned int rhs)
+    {
+        const Vector3& a = vertexPositions[lhs];
+        const Vector3& b = vertexPositions[rhs];
+        if(a.x != b.x)
+            return a.x < b.x;
+        if(a.y != b.y)
+            return a.y < b.y;
+        return a.z < b.z;
+    });
+
+    for(unsigned int i = 0; i < numVertices;)
+    {
+        unsigned int end = i + 1;
+        while(end < numVertices && samePosition(positions[order[end]], positions[order[i]]))
+            ++end;
+
+        unsigned int positionVertex = order[i];
+        for(unsigned int j = i; j < end; ++j)
+            positionVertices[order[j]] = positionVertex;
+        if(end - i > 1)
+            lockedVertices[positionVertex] = 1;
+
+        i = end;
+    }
+
+    //An edge shared by other than two triangles is on a border or is non-manifold.
+    Vector<unsigned long long> edges;
+    edges.reserve(indices.size());
+    for(unsigned int i = 0; i < indices.size(); i += 3)
+    {
+        for(unsigned int j = 0; j < 3; ++j)
+        {
+            unsigned long long v0 = positionVertices[indices[i + j]];
+            unsigned long long v1 = positionVertices[indices[i + (j + 1) % 3]];
+            if(v0 != v1)
+                edges.pushBack(v0 < v1 ? (v0 << 32) | v1 : (v1 << 32) | v0);
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    for(unsigned int i = 0; i < edges.size();)
+    {
+        unsigned int end = i + 1;
+        while(end < edges.size() && edges[end] == edges[i])
+            ++end;
+
+        if(end - i != 2)
+        {
+            lockedVertices[static_cast<unsigned int>(edges[i] >> 32)] = 1;
+            lockedVertices[static_cast<unsigned int>(edges[i] & 0xffffffff)] = 1;
+        }
+
+        i = end;
+    }
+}
+
+void GeometrySimplifier::computeQuadrics()
+{
+    quadrics.clear();
+    quadrics.resize(positions.size());
+
+    for(unsigned int i = 0; i < indices.size(); i += 3)
+    {
+        const Vector3& p0 = positions[indices[i]];
+        Vector3 normal = (positions[indices[i + 1]] - p0).cross(positions[indices[i + 2]] - p0);
+        float doubleArea = normal.length();
+        if(doubleArea <= 0.0f)
+            continue;
+
+        normal = normal * (1.0f / doubleArea);
+        float distance = -normal.dot(p0);
+        for(unsigned int j = 0; j < 3; ++j)
+            addPlaneToQuadric(quadrics[positionVertices[indices[i + j]]], normal, distance, doubleArea * 0.5f);
+    }
+}
+
+void GeometrySimplifier::collapseEdges(unsigned int targetNumIndices)
+{
+    unsigned int numVertices = positions.size();
+    remap.resize(numVertices);
+    collapsedVertices.resize(numVertices);
+    vertexTriangleOffsets.resize(numVertices + 1);
+
+    while(indices.size() > targetNumIndices)
+    {
+        for(unsigned int i = 0; i < numVertices; ++i)
+            remap[i] = i;
+        collapsedVertices.fill(0);
+
+        vertexTriangleOffsets.fill(0);
+        for(unsigned int i = 0; i < indices.size(); ++i)
+            ++vertexTriangleOffsets[indices[i] + 1];
+        for(unsigned int i = 0; i < numVertices; ++i)
+            vertexTriangleOffsets[i + 1] += vertexTriangleOffsets[i];
+
+        vertexTriangles.resize(indices.size());
+        for(unsigned int i = 0; i < indices.size(); ++i)
+            vertexTriangles[vertexTriangleOffsets[indices[i]]++] = i / 3;
+        for(unsigned int i = numVertices; i > 0; --i)
+            vertexTriangleOffsets[i] = vertexTriangleOffsets[i - 1];
+        vertexTriangleOffsets[0] = 0;
+
+        //Both directions of every edge are candidates, a locked vertex can still be collapsed onto.
+        collapses.clear();
+        for(unsigned int i = 0; i < indices.size(); i += 3)
+        {
+            for(unsigned int j = 0; j < 3; ++j)
+            {
+                unsigned int v0 = indices[i + j];
+                unsigned int v1 = indices[i + (j + 1) % 3];
+                unsigned int p0 = positionVertices[v0];
+                unsigned int p1 = positionVertices[v1];
+                if(p0 == p1)
+                    continue;
+                if(!lockedVertices[p0])
+                    collapses.pushBack({v0, v1, evaluateQuadric(quadrics[p0], quadrics[p1], positions[v1])});
+                if(!lockedVertices[p1])
+                    collapses.pushBack({v1, v0, evaluateQuadric(quadrics[p1], quadrics[p0], positions[v0])});
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& lhs, const EdgeCollapse& rhs) {return lhs.error < rhs.error;});
+
+        //A collapse removes the triangles on the edge, usually two.
+        unsigned int numTrianglesToRemove = (indices.size() - targetNumIndices) / 3;
+        unsigned int numRemovedTriangles = 0;
+        for(unsigned int i = 0; i < collapses.size() && numRemovedTriangles < numTrianglesToRemove; ++i)
+        {
+            const EdgeCollapse& collapse = collapses[i];
+            if(collapsedVertices[collapse.vertex] || collapsedVertices[collapse.targetVertex] || collapseFlipsTriangles(collapse.vertex, collapse.targetVertex))
+                continue;
+
+            for(unsigned int j = vertexTriangleOffsets[collapse.vertex]; j < vertexTriangleOffsets[collapse.vertex + 1]; ++j)
+            {
+                const unsigned int* triangle = &indices[vertexTriangles[j] * 3];
+                if(triangle[0] == collapse.targetVertex || triangle[1] == collapse.targetVertex || triangle[2] == collapse.targetVertex)
+                    ++numRemovedTriangles;
+            }
+
+            remap[collapse.vertex] = collapse.targetVertex;
+            collapsedVertices[collapse.vertex] = 1;
+            collapsedVertices[collapse.targetVertex] = 1;
+            addQuadric(quadrics[positionVertices[collapse.targetVertex]], quadrics[positionVertices[collapse.vertex]]);
+        }
+
+        if(numRemovedTriangles == 0)
+            break;
+
+        //Remove the triangles which became degenerate.
+        unsigned int numIndices = 0;
+        for(unsigned int i = 0; i < indices.size(); i += 3)
+        {
+            unsigned int v0 = remap[indices[i]];
+            unsigned int v1 = remap[indices[i + 1]];
+            unsigned int v2 = remap[indices[i + 2]];
+            if(v0 != v1 && v1 != v2 && v0 != v2)
+            {
+                indices[numIndices++] = v0;
+                indices[numIndices++] = v1;
+                indices[numIndices++] = v2;
+            }
+        }
+
+        while(indices.size() > numIndices)
+            indices.popBack();
+    }
+}
+
+bool GeometrySimplifier::collapseFlipsTriangles(unsigned int vertex, unsigned int targetVertex) const
+{
+    //The vertices already collapsed in this pass are read from their new positions.
+    for(unsigned int i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex + 1]; ++i)
+    {
+        const unsigned int* triangle = &indices[vertexTriangles[i] * 3];
+        unsigned int v0 = remap[triangle[0]];
+        unsigned int v1 = remap[triangle[1]];
+        unsigned int v2 = remap[triangle[2]];
+        if(v0 == targetVertex || v1 == targetVertex || v2 == targetVertex || v0 == v1 || v1 == v2 || v0 == v2)
+            continue;
+
+        Vector3 normal = (positions[v1] - positions[v0]).cross(positions[v2] - positions[v0]);
+        const Vector3& p0 = positions[v0 == vertex ? targetVertex : v0];
+        const Vector3& p1 = positions[v1 == vertex ? targetVertex : v1];
+        const Vector3& p2 = positions[v2 == vertex ? targetVertex : v2];
+        Vector3 collapsedNormal = (p1 - p0).cross(p2 - p0);
+        if(normal.dot(collapsedNormal) <= 0.0f)
+            return true;
+    }
+
+    return false;
+}
+
+void GeometrySimplifier::writeGeometry(const GeometryDescription& source, GeometryDescription& result) const
+{
+    unsigned int vertexSize = 0;
+    for(unsigned int i = 0; i < source.attributeDescriptions.size(); ++i)
+        vertexSize += source.attributeDescriptions[i].stride;
+
+    //The vertices are written in the order of their first use.
+    Vector<unsigned int> newVertices(positions.size());
+    newVertices.fill(NoVertex);
+    unsigned int numVertices = 0;
+    result.vertexData.clearBuffer();
+    result.vertexData.reserve(indices.size() * vertexSize);
+    result.boundingBox = BoundingBox();
+
+    for(unsigned int i = 0; i < indices.size(); ++i)
+    {
+        unsigned int vertex = indices[i];
+        if(newVertices[vertex] == NoVertex)
+        {
+            newVertices[vertex] = numVertices++;
+            result.vertexData.append(source.vertexData.getData() + vertex * vertexSize, vertexSize);
+            result.boundingBox.mergePoint(positions[vertex]);
+        }
+    }
+
+    result.primitiveType = source.primitiveType;
+    result.attributeDescriptions = source.attributeDescriptions;
+    result.numVertices = numVertices;
+    result.numIndices = indices.size();
+    result.indexType = source.indexType;
+    result.indices.clearBuffer();
+
+    if(source.indexType == IndexType::Short)
+    {
+        for(unsigned int i = 0; i < indices.size(); ++i)
+        {
+            unsigned short index = static_cast<unsigned short>(newVertices[indices[i]]);
+            result.indices.append(&index, sizeof(unsigned short));
+        }
+    }
+    else
+    {
+        for(unsigned int i = 0; i < indices.size(); ++i)
+            result.indices.append(&newVertices[indices[i]], sizeof(unsigned int));
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GeometrySimplifier_H
+#define GeometrySimplifier_H
+
+#include "Renderer/Renderer.h"
+#include "Math/Vector3.h"
+
+namespace Huurre3D
+{
+
+//Sum of the squared distances to the planes of the triangles around a vertex, weighted by the areas of the triangles.
+struct GeometryQuadric
+{
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+};
+
+//Collapse of a vertex onto a neighbouring vertex, with the quadric error at the position of the neighbour.
+struct EdgeCollapse
+{
+    unsigned int vertex;
+    unsigned int targetVertex;
+    float error;
+};
+
+//Reduces the triangles of an indexed triangle list by collapsing its edges in the order of their quadric error. A vertex is collapsed onto 
+//one of its neighbours, so the remaining vertices keep all their attributes. The vertices on the open borders of the geometry and on the 
+//attribute seams, where the vertices with the same position differ in their other attributes, are never moved.
+class GeometrySimplifier
+{
+public:
+    GeometrySimplifier() = default;
+    ~GeometrySimplifier() = default;
+
+    //The result has the vertex layout and index type of the source with the unused vertices removed.
+    //Returns false when the source isn't an indexed triangle list with float positions.
+    bool simplify(const GeometryDescription& source, unsigned int targetNumIndices, GeometryDescription& result);
+    //Each level has about half of the triangles of the previous one and half of its screen size, the first level is drawn below a quarter of the view height.
+    //The levels stop when a level can't be reduced to three quarters of the previous one.
+    void generateLods(const GeometryDescription& source, unsigned int maxLods, Vector<GeometryDescription>& lodsOut);
+
+private:
+    bool readGeometry(const GeometryDescription& source);
+    void lockBorderAndSeamVertices();
+    void computeQuadrics();
+    //Collapses the edges in passes, each vertex moves or is moved onto at most once in a pass. Stops when no edge can be collapsed.
+    void collapseEdges(unsigned int targetNumIndices);
+    bool collapseFlipsTriangles(unsigned int vertex, unsigned int targetVertex) const;
+    void writeGeometry(const GeometryDescription& source, GeometryDescription& result) const;
+
+    Vector<Vector3> positions;
+    Vector<unsigned int> indices;
+    //The first vertex with the same position, the quadrics and the locks are kept for it.
+    Vector<unsigned int> positionVertices;
+    Vector<unsigned char> lockedVertices;
+    Vector<GeometryQuadric> quadrics;
+    //The vertex each vertex has been collapsed onto in the current pass.
+    Vector<unsigned int> remap;
+    //Triangles around each vertex at the beginning of the pass.
+    Vector<unsigned int> vertexTriangleOffsets;
+    Vector<unsigned int> vertexTriangles;
+    Vector<EdgeCollapse> collapses;
+    Vector<unsigned char> collapsedVertices;
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Renderer/IndirectDrawBatcher.h"
+#include "Graphics/GraphicSystem.h"
+
+namespace Huurre3D
+{
+
+IndirectDrawBatcher::IndirectDrawBatcher(GraphicSystem& graphicSystem):
+graphicSystem(graphicSystem)
+{
+}
+
+IndirectDrawBatcher::~IndirectDrawBatcher()
+{
+    for(unsigned int i = 0; i < batches.size(); ++i)
+    {
+        graphicSystem.removeDrawCommandBuffer(batches[i].drawCommands);
+        graphicSystem.removeShaderParameterBlock(batches[i].drawParameters);
+    }
+}
+
+void IndirectDrawBatcher::reserve(unsigned int numBatches)
+{
+    while(batches.size() < numBatches)
+    {
+        IndirectDrawBatch batch;
+        batch.drawCommands = graphicSystem.createDrawCommandBuffer();
+        batch.drawParameters = graphicSystem.createShaderParameterBlock(sp_drawParameters);
+        batch.drawParameters->setStreamed(true);
+        batches.pushBack(batch);
+    }
+}
+
+void IndirectDrawBatcher::reset()
+{
+    //The batches are at least doubled, so that a frame with many state changes doesn't take many frames to get its batches.
+    if(numMissingDraws > 0)
+    {
+        unsigned int numNeededBatches = (numMissingDraws + MaxDrawCommands - 1) / MaxDrawCommands;
+        reserve(batches.size() + (numNeededBatches > batches.size() ? numNeededBatches : batches.size()));
+        numMissingDraws = 0;
+    }
+
+    for(unsigned int i = 0; i < numUsedBatches; ++i)
+    {
+        batches[i].drawCommands->clearCommands();
+        batches[i].drawParameters->clearParameters();
+    }
+
+    numUsedBatches = 0;
+}
+
+bool IndirectDrawBatcher::addDraw(Vector<ShaderPass>& shaderPasses, const ShaderPass& drawPass, const Matrix4x4& worldTransform, int materialParameterIndex)
+{
+    if(shaderPasses.empty() || !canMerge(shaderPasses.back(), drawPass))
+    {
+        if(numUsedBatches == batches.size())
+        {
+            ++numMissingDraws;
+            return false;
+        }
+
+        const IndirectDrawBatch& batch = batches[numUsedBatches++];
+        shaderPasses.pushBack(drawPass);
+        shaderPasses.back().drawCommands = batch.drawCommands;
+        shaderPasses.back().shaderParameterBlocks.pushBack(batch.drawParameters);
+    }
+
+    ShaderPass& batchPass = shaderPasses.back();
+    batchPass.drawCommands->addCommand(drawPass.numIndices, drawPass.firstIndex, drawPass.baseVertex);
+
+    //Laid out as the DrawParameters struct of the shaders.
+    ShaderParameterBlock* drawParameters = batchPass.shaderParameterBlocks.back();
+    drawParameters->addParameter(worldTransform);
+    drawParameters->addParameter(FixedArray<int, 4>{materialParameterIndex, 0, 0, 0});
+    return true;
+}
+
+bool IndirectDrawBatcher::canMerge(const ShaderPass& batchPass, const ShaderPass& drawPass) const
+{
+    if(!batchPass.drawCommands || batchPass.drawCommands->isFull())
+        return false;
+
+    if(batchPass.program != drawPass.program || batchPass.vertexData != drawPass.vertexData || batchPass.rasterState != drawPass.rasterState)
+        return false;
+
+    //The batch pass has the per-draw parameters as its last block.
+    if(batchPass.textures.size() != drawPass.textures.size() || batchPass.shaderParameterBlocks.size() != drawPass.shaderParameterBlocks.size() + 1)
+        return false;
+
+    for(unsigned int i = 0; i < drawPass.textures.size(); ++i)
+    {
+        if(batchPass.textures[i] != drawPass.textures[i])
+            return false;
+    }
+
+    for(unsigned int i = 0; i < drawPass.shaderParameterBlocks.size(); ++i)
+    {
+        if(batchPass.shaderParameterBlocks[i] != drawPass.shaderParameterBlocks[i])
+            return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef IndirectDrawBatcher_H
+#define IndirectDrawBatcher_H
+
+#include "Renderer/RenderPasses.h"
+#include "Math/Matrix4x4.h"
+
+namespace Huurre3D
+{
+
+class GraphicSystem;
+class DrawCommandBuffer;
+
+//Defined for the program variants which read the world transform and material index from the per-draw parameters.
+static const std::string sd_indirectDraw = "INDIRECT_DRAW";
+//Batches a stage reserves when it enables the multi-draws, so that the first frames need not draw without them.
+static const unsigned int InitialIndirectDrawBatches = 16;
+
+//Draw commands of a multi-draw and the per-draw parameters of the commands.
+struct IndirectDrawBatch
+{
+    DrawCommandBuffer* drawCommands = nullptr;
+    ShaderParameterBlock* drawParameters = nullptr;
+};
+
+//Merges the draws of shader passes with the same program, vertex data, raster state, textures and parameter blocks into multi-draws.
+//The world transform and the material index of each draw go to the per-draw parameters of the batch instead of the pass parameters.
+//The batches are created on the main thread and filled by the stage update on a worker thread. When an update runs out of batches,
+//the rest of its draws get a pass each and the missing batches are created on the next reset.
+class IndirectDrawBatcher
+{
+public:
+    IndirectDrawBatcher(GraphicSystem& graphicSystem);
+    ~IndirectDrawBatcher();
+
+    //Creates batches until there are at least the given number of them.
+    void reserve(unsigned int numBatches);
+    //Empties the batches for a new frame and creates the ones the last frame ran short of.
+    void reset();
+    //Adds the draw to the last pass of the passes if the pass is a batch with the same state and room for the draw, otherwise opens a new batch
+    //from the draw pass. The shader parameters of a batch are the ones of the pass which opened it.
+    //Returns false when all the batches are in use, the draw is then left for the caller.
+    bool addDraw(Vector<ShaderPass>& shaderPasses, const ShaderPass& drawPass, const Matrix4x4& worldTransform, int materialParameterIndex);
+    unsigned int getNumBatches() const {return batches.size();}
+    unsigned int getNumUsedBatches() const {return numUsedBatches;}
+
+private:
+    bool canMerge(const ShaderPass& batchPass, const ShaderPass& drawPass) const;
+    GraphicSystem& graphicSystem;
+    Vector<IndirectDrawBatch> batches;
+    unsigned int numUsedBatches = 0;
+    //Draws of the frame which found no free batch.
+    unsigned int numMissingDraws = 0;
+};
+
+}
+
+#endif
@@ -54,7 +54,7 @@ void LightTileGrid::setGridDimensions(int tileWidth, int tileHeight, int screenW
     }
 }
 
-void LightTileGrid::binLightsToTiles(const Vector<Light*>& lights, Camera* camera)
+void LightTileGrid::binLightsToTiles(const Vector<const Light*>& lights, const Camera* camera)
 {
     lightParameterBlockValues.clear();
     tileLightInfo.fill(-1);
@@ -130,4 +130,25 @@ void LightTileGrid::binLightsToTiles(const Vector<Light*>& lights, Camera* camer
     }
 }
 
-}
\ No newline at end of file
+LightTileStatistics LightTileGrid::getTileStatistics() const
+{
+    LightTileStatistics statistics;
+    statistics.numTiles = numTiles;
+
+    if(numTiles == 0)
+        return statistics;
+
+    int totalLights = 0;
+    statistics.minLights = tiles[0].numLights;
+    for(int i = 0; i < numTiles; ++i)
+    {
+        statistics.minLights = tiles[i].numLights < statistics.minLights ? tiles[i].numLights : statistics.minLights;
+        statistics.maxLights = tiles[i].numLights > statistics.maxLights ? tiles[i].numLights : statistics.maxLights;
+        totalLights += tiles[i].numLights;
+    }
+
+    statistics.averageLights = static_cast<float>(totalLights) / static_cast<float>(numTiles);
+    return statistics;
+}
+
+}
@@ -50,17 +50,31 @@ struct Tile
     int numLights;
 };
 
+//Distribution of the binned lights over the tiles.
+struct LightTileStatistics
+{
+    int numTiles = 0;
+    int minLights = 0;
+    int maxLights = 0;
+    float averageLights = 0.0f;
+};
+
 class LightTileGrid
 {
 public:
-    LightTileGrid() = default;
+    LightTileGrid():
+    tiles(MemoryTag::LightGrid),
+    lightParameterBlockValues(MemoryTag::LightGrid),
+    tileLightInfo(MemoryTag::LightGrid)
+    {}
     ~LightTileGrid() = default;
 	
     void setGridDimensions(int tileWidth, int tileHeight, int screenWidth, int screenHeight);
-    void binLightsToTiles(const Vector<Light*>& lights, Camera* camera);
+    void binLightsToTiles(const Vector<const Light*>& lights, const Camera* camera);
     MemoryBuffer& getTileLightInfo() { return tileLightInfo.getMemoryBuffer(); }
     const Vector<Vector4>& getLightParameterBlockValues() const {return lightParameterBlockValues;}
     const GridDimensions& getGridDimensions() const {return gridDimensions;}
+    LightTileStatistics getTileStatistics() const;
 
 private:
     GridDimensions gridDimensions;
@@ -48,6 +48,11 @@ void LightingStage::init(const JSONValue& lightingStageJSON)
     ViewPort screenViewPort = renderer.getScreenViewPort();
     GraphicSystem& graphicSystem = renderer.getGraphicSystem();
 
+    //The light parameters are rebuilt every frame.
+    ShaderParameterBlock* lightParameters = graphicSystem.getShaderParameterBlockByName(sp_lightParameters);
+    if(lightParameters)
+        lightParameters->setStreamed(true);
+
     tileGrid.setGridDimensions(lightTileWidthJSON.getInt(), lightTileHeightJSON.getInt(), screenViewPort.width, screenViewPort.height);
     auto gridDimensions = tileGrid.getGridDimensions();
     MemoryBuffer gridDimensionsData;
@@ -79,15 +84,16 @@ void LightingStage::resizeResources()
     lightGridParametersBlock->setParameterData(std::move(newGridDimensionsData));
 }
 
-void LightingStage::update(const Scene& scene)
+void LightingStage::update(const RenderView& view)
 {
-    Camera* camera = scene.getMainCamera();
+    const Camera* camera = &view.camera;
     Frustum worldSpaceCameraViewFrustum = camera->getViewFrustumInWorldSpace();
-    cullLights(scene, frustumLights, worldSpaceCameraViewFrustum);
-    Vector3 globalAmbientLight = scene.getGlobalAmbientLight();
+    cullLights(view, frustumLights, worldSpaceCameraViewFrustum, &statistics.culling);
+    Vector3 globalAmbientLight = view.globalAmbientLight;
 
     //Bin lights to tiles.
     tileGrid.binLightsToTiles(frustumLights, camera);
+    statistics.lightTiles = tileGrid.getTileStatistics();
     
     auto gridDimensions = tileGrid.getGridDimensions();
     auto lightParameterBlock = tileGrid.getLightParameterBlockValues();
@@ -42,11 +42,11 @@ public:
     void init(const JSONValue& lightingStageJSON) override;
     void resizeResources() override;
     void clearStage() override;
-    void update(const Scene& scene) override;
+    void update(const RenderView& view) override;
 
 private:
     LightTileGrid tileGrid;
-    Vector<Light*> frustumLights;
+    Vector<const Light*> frustumLights;
 };
 
 }
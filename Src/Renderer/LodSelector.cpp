@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/LodSelector.h"
+#include "Renderer/Geometry.h"
+#include "Scene/SceneCuller.h"
+#include "Math/MathFunctions.h"
+
+namespace Huurre3D
+{
+
+//The level of a geometry for the projected size, the levels are in the order of decreasing switch size.
+static unsigned int getGeometryLod(const Geometry* geometry, float projectedSize)
+{
+    unsigned int lod = 0;
+    while(lod + 1 < geometry->getNumLods() && projectedSize < geometry->getLodScreenSize(lod + 1))
+        ++lod;
+
+    return lod;
+}
+
+void LodSelector::setCamera(const Camera& camera)
+{
+    cameraPosition = camera.getPosition(FrameOfReference::World);
+    projectionScale = 1.0f / tan(camera.getFov() * DEGTORAD * 0.5f);
+}
+
+void LodSelector::selectLods(Vector<RenderItem>& items, LodStatistics* statistics)
+{
+    for(unsigned int i = 0; i < items.size(); ++i)
+    {
+        RenderItem& item = items[i];
+        unsigned int previousLod = item.id < itemLods.size() ? itemLods[item.id] : 0;
+        unsigned int lod = selectLod(item);
+        const Geometry* geometry = item.geometry->getLod(lod);
+
+        if(statistics)
+        {
+            ++statistics->itemsSelected;
+            statistics->itemsReduced += lod > 0 ? 1 : 0;
+            statistics->levelChanges += lod != previousLod ? 1 : 0;
+            statistics->sourceIndices += item.geometry->getNumIndices();
+            statistics->selectedIndices += geometry->getNumIndices();
+        }
+
+        item.geometry = const_cast<Geometry*>(geometry);
+    }
+}
+
+unsigned int LodSelector::selectLod(const RenderItem& item)
+{
+    const Geometry* geometry = item.geometry;
+    if(geometry->getNumLods() == 1)
+        return 0;
+
+    while(itemLods.size() <= item.id)
+        itemLods.pushBack(0);
+
+    unsigned int currentLod = min(int(itemLods[item.id]), int(geometry->getNumLods() - 1));
+    float projectedSize = getProjectedSize(item.worldBoundingBox, cameraPosition, projectionScale) * bias;
+    unsigned int lod = getGeometryLod(geometry, projectedSize);
+
+    //Moving to a coarser level needs the size to be below the switch size by the hysteresis, and moving to a finer level above it.
+    if(lod > currentLod)
+        lod = max(int(currentLod), int(getGeometryLod(geometry, projectedSize * (1.0f + hysteresis))));
+    else if(lod < currentLod)
+        lod = min(int(currentLod), int(getGeometryLod(geometry, projectedSize * (1.0f - hysteresis))));
+
+    itemLods[item.id] = static_cast<unsigned char>(lod);
+    return lod;
+}
+
+}
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef LodSelector_H
+#define LodSelector_H
+
+#include "Renderer/RenderItem.h"
+#include "Scene/Camera.h"
+#include "Util/Vector.h"
+
+namespace Huurre3D
+{
+
+//Counts of the items whose level was selected on the last update.
+struct LodStatistics
+{
+    unsigned int itemsSelected = 0;
+    //Items drawn from a coarser level than the geometry itself, and items whose level changed since the previous selection.
+    unsigned int itemsReduced = 0;
+    unsigned int levelChanges = 0;
+    //Indices of the selected items at the full detail and at the selected levels.
+    unsigned int sourceIndices = 0;
+    unsigned int selectedIndices = 0;
+};
+
+//Selects the level of detail of the render items of a view from the size of their bounding sphere projected to the view, relative to the 
+//view height. The level of each item is kept between the selections, it changes only when the size has moved past the switch size by
+//the hysteresis fraction, so an item at the switch distance doesn't change its level back and forth.
+class LodSelector
+{
+public:
+    LodSelector() = default;
+    ~LodSelector() = default;
+
+    //Scales the projected sizes, a bias below one selects coarser levels.
+    void setBias(float bias) {this->bias = bias;}
+    void setHysteresis(float hysteresis) {this->hysteresis = hysteresis;}
+    //The sizes are projected to the camera until it is set again.
+    void setCamera(const Camera& camera);
+    //Replaces the geometries of the items with their selected levels.
+    void selectLods(Vector<RenderItem>& items, LodStatistics* statistics = nullptr);
+    unsigned int selectLod(const RenderItem& item);
+    float getBias() const {return bias;}
+    float getHysteresis() const {return hysteresis;}
+
+private:
+    //Level of each item by the item id.
+    Vector<unsigned char> itemLods;
+    Vector3 cameraPosition;
+    //Inverse of the tangent of the half of the vertical field of view.
+    float projectionScale = 1.0f;
+    float bias = 1.0f;
+    float hysteresis = 0.1f;
+};
+
+}
+
+#endif
@@ -26,6 +26,8 @@
 namespace Huurre3D
 {
 
+static unsigned int materialChangeCounter = 0;
+
 Material::Material():
 Material(Matrix4x4(Vector4(DefaultColor, DefaultRoughness), Vector4(DefaultColor, DefaultSpecularPower), Vector4(Vector3::ZERO, DefaultReflectance), Vector4(DefaultColor, DefaultAlpha)), 
          RasterState(BlendState(false, BlendFunction::Replace), CompareState(true, CompareFunction::Less), CullState(true, CullFace::Back)), false)
@@ -38,7 +40,9 @@ rasterState(rasterState),
 skinned(skinned)
 {
     if(skinned)
-        vertexShaderDefines.pushBack("SKINNED");
+        vertexShaderDefines.pushBack(sd_skinned);
+
+    markChanged();
 }
 
 void Material::setAmbientColor(const Vector3& ambient)
@@ -120,40 +124,53 @@ void Material::setReflectance(float reflectance)
 void Material::setDiffuseTexture(Texture* texture)
 {
     diffuseTexture = texture;
-    fragmentShaderDefines.pushBack("DIFFUSE_TEXTURE");
+    fragmentShaderDefines.pushBack(sd_diffuseTexture);
+    markChanged();
 }
 
 void Material::setSpecularTexture(Texture* texture)
 {
     specularTexture = texture;
-    fragmentShaderDefines.pushBack("SPECULAR_TEXTURE");
+    fragmentShaderDefines.pushBack(sd_specularTexture);
+    markChanged();
 }
 
 void Material::setNormalMap(Texture* texture)
 {
     normalMap = texture;
-    fragmentShaderDefines.pushBack("NORMAL_TEXTURE");
+    fragmentShaderDefines.pushBack(sd_normalTexture);
+    markChanged();
 }
 
 void Material::setAlphaTexture(Texture* texture)
 {
     alphaTexture = texture;
-    fragmentShaderDefines.pushBack("ALPHA_MASK");
+    fragmentShaderDefines.pushBack(sd_alphaMask);
+    markChanged();
+}
+
+void Material::setName(const std::string& name)
+{
+    this->name = name;
+    nameHash = name.empty() ? 0 : generateHash(reinterpret_cast<const unsigned char*>(name.c_str()), name.size());
 }
 
 void Material::setCurrentShaderCombinationTag(unsigned int shaderCombinationTag)
 {
     currentShaderCombinationTag = shaderCombinationTag;
+    markChanged();
 }
 
 void Material::setRasterState(const RasterState& state)
 {
     rasterState = state;
+    markChanged();
 }
 
 void Material::addShaderDefines(const Vector<std::string>& shaderDefines, ShaderType shaderType)
 {
     shaderType == ShaderType::Vertex ? vertexShaderDefines.pushBack(shaderDefines) : fragmentShaderDefines.pushBack(shaderDefines);
+    markChanged();
 }
 
 void Material::getTextures(Vector<Texture*>& texturesOut)
@@ -168,15 +185,20 @@ void Material::getTextures(Vector<Texture*>& texturesOut)
         texturesOut.pushBack(alphaTexture);
 }
 
-unsigned int Material::getParameterId()
+void Material::setParameterSlot(int slot)
 {
-    return !parametersDirty ? parameterId : generateParameterId();
+    //The passes built from the material have the slot as their parameter, the parameters alone are read from the slot.
+    if(slot != parameterSlot)
+    {
+        parameterSlot = slot;
+        markChanged();
+    }
+    parametersDirty = false;
 }
 
-unsigned int Material::generateParameterId()
+void Material::markChanged()
 {
-    parameterId = generateHash((unsigned char*)parameters.toArray(), 64);
-    return parameterId;
+    changeVersion = ++materialChangeCounter;
 }
 
 const Vector<std::string>& Material::getShaderDefines(ShaderType shaderType) const
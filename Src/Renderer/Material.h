@@ -37,6 +37,13 @@ const float DefaultReflectance = 0.25f;
 const float DefaultSpecularPower = 0.0f;
 const float DefaultAlpha = 1.0f;
 
+//Shader defines enabled by the material.
+static const std::string sd_skinned = "SKINNED";
+static const std::string sd_diffuseTexture = "DIFFUSE_TEXTURE";
+static const std::string sd_specularTexture = "SPECULAR_TEXTURE";
+static const std::string sd_normalTexture = "NORMAL_TEXTURE";
+static const std::string sd_alphaMask = "ALPHA_MASK";
+
 class Material
 {
 public:
@@ -61,11 +68,18 @@ public:
     void setSpecularTexture(Texture* texture);
     void setNormalMap(Texture* texture);
     void setAlphaTexture(Texture* texture);
+    //The stages can have settings of their own for the materials of a name.
+    void setName(const std::string& name);
     void setCurrentShaderCombinationTag(unsigned int shaderCombinationTag);
+    //Tag of the program variant which reads the per-draw parameters of a multi-draw.
+    void setIndirectShaderCombinationTag(unsigned int shaderCombinationTag) {indirectShaderCombinationTag = shaderCombinationTag; markChanged();}
     void addShaderDefines(const Vector<std::string>& shaderDefines, ShaderType shaderType);
     void getTextures(Vector<Texture*>& texturesOut);
-    unsigned int getParameterId();
+    //Set by the renderer when the parameters have been written to the slot of the material parameter table.
+    void setParameterSlot(int slot);
     const Vector<std::string>& getShaderDefines(ShaderType shaderType) const;
+    const std::string& getName() const {return name;}
+    unsigned int getNameHash() const {return nameHash;}
     Vector3 getAmbientColor() const {return parameters[3].xyz();}
     Vector3 getSpecularColor() const {return parameters[1].xyz();}
     Vector3 getDiffuseColor() const {return parameters[0].xyz();}
@@ -73,13 +87,20 @@ public:
     float getRoughness() const {return parameters[0].w;}
     float getReflectance() const {return parameters[2].w;}
     unsigned int getCurrentShaderCombinationTag() const {return currentShaderCombinationTag;}
+    unsigned int getIndirectShaderCombinationTag() const {return indirectShaderCombinationTag;}
     RasterState getRasterState() const {return rasterState;}
     const Matrix4x4& getParameters() const {return parameters;}
+    //Index of the parameters in the material parameter block, -1 when the material has no slot.
+    int getParameterSlot() const {return parameterSlot;}
+    //The parameters have changed since they were written to the slot.
+    bool areParametersDirty() const {return parametersDirty;}
     bool isTransparent() const {return parameters[3].w < 1.0f;}
     bool isSkinned() const {return skinned;}
+    //Taken from a counter shared by all the materials on each change, so the stages can tell a changed or a new material from the one they have built their state from.
+    unsigned int getChangeVersion() const {return changeVersion;}
 
 private:
-    unsigned int generateParameterId();
+    void markChanged();
     //col1: diffuse + roughness
     //col2: specular + specularPower
     //col3: emissive + reflectance
@@ -87,15 +108,19 @@ private:
     Matrix4x4 parameters; 
     RasterState rasterState;
     unsigned int currentShaderCombinationTag = 0;
+    unsigned int indirectShaderCombinationTag = 0;
     Texture* diffuseTexture = nullptr;
     Texture* specularTexture = nullptr;
     Texture* normalMap = nullptr;
     Texture* alphaTexture = nullptr;
     Vector<std::string> vertexShaderDefines;
     Vector<std::string> fragmentShaderDefines;
+    std::string name;
+    unsigned int nameHash = 0;
     bool parametersDirty = true;
     bool skinned = false;
-    unsigned int parameterId = 0;
+    int parameterSlot = -1;
+    unsigned int changeVersion = 0;
 };
 
 }
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Renderer/MaterialParameterTable.h"
+#include <iostream>
+
+namespace Huurre3D
+{
+
+void MaterialParameterTable::setParameterBlock(ShaderParameterBlock* block)
+{
+    //The slots are found by comparing the parameters to the data of the block, so the data is kept after the upload.
+    this->block = block;
+    block->setRetainData(true);
+    block->clearParameters();
+    for(unsigned int i = 0; i < MaxMaterialParameterSlots; ++i)
+        block->addParameter(Matrix4x4::ZERO);
+
+    numSlotReferences.clear();
+    freeSlots.clear();
+    numUsedSlots = 0;
+}
+
+int MaterialParameterTable::acquireSlot(const Matrix4x4& parameters)
+{
+    int slot = findSlot(parameters);
+    if(slot == -1)
+    {
+        slot = createSlot(parameters);
+        if(slot != -1)
+            return slot;
+
+        //All the slots are in use, so the parameters are drawn from the first slot.
+        slot = 0;
+    }
+
+    ++numSlotReferences[slot];
+    return slot;
+}
+
+void MaterialParameterTable::releaseSlot(int slot)
+{
+    if(slot < 0 || static_cast<unsigned int>(slot) >= numSlotReferences.size() || numSlotReferences[slot] == 0)
+        return;
+
+    //The data of a released slot is left in the block, it is overwritten when the slot is reused.
+    if(--numSlotReferences[slot] == 0)
+    {
+        freeSlots.pushBack(slot);
+        --numUsedSlots;
+    }
+}
+
+int MaterialParameterTable::updateSlot(int slot, const Matrix4x4& parameters)
+{
+    int sharedSlot = findSlot(parameters);
+    if(sharedSlot == slot && slot != -1)
+        return slot;
+
+    if(sharedSlot != -1)
+    {
+        ++numSlotReferences[sharedSlot];
+        releaseSlot(slot);
+        return sharedSlot;
+    }
+
+    if(slot != -1 && numSlotReferences[slot] == 1)
+    {
+        block->setParameter(slot * sizeof(Matrix4x4), parameters);
+        return slot;
+    }
+
+    //The slot is released only after the new slot is created, so when all the slots are in use the old parameters are kept.
+    int newSlot = createSlot(parameters);
+    if(newSlot == -1)
+        return slot;
+
+    releaseSlot(slot);
+    return newSlot;
+}
+
+int MaterialParameterTable::findSlot(const Matrix4x4& parameters) const
+{
+    const unsigned char* slotData = block->getGraphicData();
+    for(unsigned int i = 0; i < numSlotReferences.size(); ++i)
+    {
+        if(numSlotReferences[i] > 0 && memcmp(slotData + i * sizeof(Matrix4x4), parameters.toArray(), sizeof(Matrix4x4)) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+int MaterialParameterTable::createSlot(const Matrix4x4& parameters)
+{
+    unsigned int slot = numSlotReferences.size();
+    if(!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.popBack();
+    }
+    else if(slot == MaxMaterialParameterSlots)
+    {
+        std::cout << "Failed to create a material parameter slot, all the " << MaxMaterialParameterSlots << " slots are in use." << std::endl;
+        return -1;
+    }
+    else
+        numSlotReferences.pushBack(0);
+
+    numSlotReferences[slot] = 1;
+    ++numUsedSlots;
+    block->setParameter(slot * sizeof(Matrix4x4), parameters);
+    return slot;
+}
+
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef MaterialParameterTable_H
+#define MaterialParameterTable_H
+
+#include "Graphics/ShaderParameterBlock.h"
+#include "Util/Vector.h"
+
+namespace Huurre3D
+{
+
+//Matches MAX_NUM_MATERIALS of the material shaders, the G-buffer stores the slot of a material in 8 bits.
+const unsigned int MaxMaterialParameterSlots = 255;
+
+//Slots of the material parameters in the material parameter block. The materials with the same parameters share a slot.
+//A slot keeps its index while it is referenced, and the released slots are reused before the unused ones.
+//The block is allocated for all the slots up front, so a written slot uploads only its own range.
+class MaterialParameterTable
+{
+public:
+    MaterialParameterTable() = default;
+    ~MaterialParameterTable() = default;
+
+    void setParameterBlock(ShaderParameterBlock* block);
+    //Returns the slot of the parameters with a new reference to it. When all the slots are in use the first slot is shared.
+    int acquireSlot(const Matrix4x4& parameters);
+    void releaseSlot(int slot);
+    //Moves the reference of the slot to the slot of the changed parameters. A slot with no other references is written in place.
+    //When all the slots are in use the reference stays in the old slot.
+    int updateSlot(int slot, const Matrix4x4& parameters);
+    unsigned int getNumUsedSlots() const {return numUsedSlots;}
+    unsigned int getNumFreeSlots() const {return freeSlots.size();}
+
+private:
+    int findSlot(const Matrix4x4& parameters) const;
+    //Returns -1 when all the slots are in use.
+    int createSlot(const Matrix4x4& parameters);
+
+    ShaderParameterBlock* block = nullptr;
+    Vector<unsigned int> numSlotReferences;
+    //Released slots, reused before the table takes an unused slot.
+    Vector<unsigned int> freeSlots;
+    unsigned int numUsedSlots = 0;
+};
+
+}
+
+#endif
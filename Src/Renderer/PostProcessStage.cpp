@@ -31,26 +31,23 @@ RenderStage(renderer)
 {
 }
 
-void PostProcessStage::update(const Scene& scene)
+void PostProcessStage::update(const RenderView& view)
 {
     Texture* skyBoxTexture = renderer.getGraphicSystem().getTextureBySlotIndex(TextureSlotIndex::SkyBoxTex);
 
     if(skyBoxTexture)
     {
-        Vector<SkyBox*> skyBoxes;
-        scene.getSceneItemsByType<SkyBox>(skyBoxes);
-
-        if(currentSkyBox != skyBoxes[0])
+        if(view.skyBox && currentSkyBox != view.skyBox)
         {
             TextureLoadResult result;
-            if(renderer.getTextureLoader().loadCubeMapFromFile(skyBoxes[0]->getTextureFiles(), false, result))
+            if(renderer.getTextureLoader().loadCubeMapFromFile(view.skyBoxTextureFiles, false, result))
             {
                 skyBoxTexture->setPixelFormat(result.format);
                 skyBoxTexture->setWidth(result.width);
                 skyBoxTexture->setHeight(result.height);
                 skyBoxTexture->setData(result);
             }
-            currentSkyBox = skyBoxes[0];
+            currentSkyBox = view.skyBox;
         }
     }
 }
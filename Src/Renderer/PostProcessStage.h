@@ -36,10 +36,10 @@ public:
     PostProcessStage(Renderer& renderer);
     ~PostProcessStage() = default;
 
-    void update(const Scene& scene) override;
+    void update(const RenderView& view) override;
 
 private:
-    SkyBox* currentSkyBox = nullptr;
+    const SkyBox* currentSkyBox = nullptr;
 };
 
 }
@@ -0,0 +1,332 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/RenderGraph.h"
+#include "Graphics/GraphicSystem.h"
+#include "Graphics/RenderTarget.h"
+#include "Graphics/Texture.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Huurre3D
+{
+
+static bool areAliasCompatible(const Texture* lhs, const Texture* rhs)
+{
+    return lhs->getTargetMode() == rhs->getTargetMode() && lhs->getPixelFormat() == rhs->getPixelFormat() &&
+        lhs->getWrapMode() == rhs->getWrapMode() && lhs->getFilterMode() == rhs->getFilterMode() &&
+        lhs->getWidth() == rhs->getWidth() && lhs->getHeight() == rhs->getHeight() && lhs->getDepth() == rhs->getDepth();
+}
+
+static std::string getResourceName(const RenderGraphResource& resource)
+{
+    return EnumStrings<TextureSlotIndex>::strings[static_cast<int>(resource.texture->getSlotIndex())];
+}
+
+RenderGraph::RenderGraph(GraphicSystem& graphicSystem):
+graphicSystem(graphicSystem)
+{
+}
+
+void RenderGraph::clear()
+{
+    removeAliases();
+    passes.clear();
+    resources.clear();
+    statistics = RenderGraphStatistics();
+}
+
+void RenderGraph::addPass(const std::string& name, RenderPass* pass)
+{
+    RenderGraphPass graphPass;
+    graphPass.name = name;
+    graphPass.pass = pass;
+    passes.pushBack(graphPass);
+}
+
+void RenderGraph::compile()
+{
+    removeAliases();
+    resolveResources();
+    cullPasses();
+    computeLifetimes();
+
+    statistics = RenderGraphStatistics();
+    statistics.numPasses = passes.size();
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        if(passes[i].pass->culled)
+            ++statistics.numCulledPasses;
+        if(!passes[i].pass->readsDeclared)
+            ++statistics.numUndeclaredPasses;
+    }
+
+    if(statistics.numUndeclaredPasses)
+    {
+        std::cout << "Render graph: " << statistics.numUndeclaredPasses << " passes do not declare their reads, they read every buffer written before them"
+            << " and the buffers are not aliased" << std::endl;
+    }
+    else
+        aliasResources();
+
+    statistics.numResources = resources.size();
+    for(unsigned int i = 0; i < resources.size(); ++i)
+    {
+        if(resources[i].firstPass < 0)
+            continue;
+
+        unsigned int size = resources[i].texture->getMemorySize();
+        statistics.renderTargetBytes += size;
+        if(resources[i].aliasOf < 0)
+            statistics.aliasedRenderTargetBytes += size;
+        else
+            ++statistics.numAliasedResources;
+    }
+}
+
+void RenderGraph::logRenderGraph() const
+{
+    std::cout << "Render graph: passes " << statistics.numPasses - statistics.numCulledPasses << "/" << statistics.numPasses
+        << ", buffers " << statistics.numResources << ", aliased buffers " << statistics.numAliasedResources << std::endl;
+
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        const RenderGraphPass& pass = passes[i];
+        std::cout << "    pass " << i << " " << pass.name << (pass.pass->culled ? " (culled)" : "") << (pass.pass->readsDeclared ? "" : " (undeclared reads)") << ": reads";
+        for(unsigned int j = 0; j < pass.reads.size(); ++j)
+            std::cout << " " << getResourceName(resources[pass.reads[j]]);
+        std::cout << ", writes";
+        for(unsigned int j = 0; j < pass.writes.size(); ++j)
+            std::cout << " " << getResourceName(resources[pass.writes[j]]);
+        if(pass.writesMainTarget)
+            std::cout << " mainRenderTarget";
+        std::cout << std::endl;
+    }
+
+    for(unsigned int i = 0; i < resources.size(); ++i)
+    {
+        const RenderGraphResource& resource = resources[i];
+        const Texture* texture = resource.texture;
+        std::cout << "    buffer " << getResourceName(resource) << " " << EnumStrings<TexturePixelFormat>::strings[static_cast<int>(texture->getPixelFormat())]
+            << " " << texture->getWidth() << "x" << texture->getHeight() << "x" << texture->getDepth() << ", " << texture->getMemorySize() << " bytes";
+
+        if(resource.firstPass < 0)
+            std::cout << ", unused";
+        else
+        {
+            std::cout << ", passes " << resource.firstPass << "-" << resource.lastPass;
+            if(resource.persistent)
+                std::cout << ", persistent";
+            else if(resource.aliasOf >= 0)
+                std::cout << ", aliases " << getResourceName(resources[resource.aliasOf]);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "    render target memory " << statistics.renderTargetBytes << " bytes, with aliasing " << statistics.aliasedRenderTargetBytes << " bytes" << std::endl;
+}
+
+unsigned int RenderGraph::getResourceIndex(Texture* texture)
+{
+    for(unsigned int i = 0; i < resources.size(); ++i)
+    {
+        if(resources[i].texture == texture)
+            return i;
+    }
+
+    RenderGraphResource resource;
+    resource.texture = texture;
+    resources.pushBack(resource);
+    return resources.size() - 1;
+}
+
+void RenderGraph::resolveResources()
+{
+    resources.clear();
+
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        RenderGraphPass& graphPass = passes[i];
+        const RenderPass* pass = graphPass.pass;
+        graphPass.reads.clear();
+        graphPass.writes.clear();
+        graphPass.writesMainTarget = pass->renderTarget == nullptr;
+
+        if(pass->renderTarget)
+        {
+            if(pass->colorWrite)
+            {
+                const Vector<Texture*>& colorBuffers = pass->renderTarget->getColorBuffers();
+                for(unsigned int j = 0; j < colorBuffers.size(); ++j)
+                    graphPass.writes.pushBack(getResourceIndex(colorBuffers[j]));
+            }
+
+            //A depth buffer which is only tested is read.
+            Texture* depthBuffer = pass->renderTarget->getDepthTexture();
+            if(depthBuffer)
+            {
+                if(pass->depthWrite || (pass->flags & CLEAR_DEPTH))
+                    graphPass.writes.pushBack(getResourceIndex(depthBuffer));
+                else
+                    graphPass.reads.pushBack(getResourceIndex(depthBuffer));
+            }
+        }
+    }
+
+    //The slots no pass writes are the textures of the materials and the stages, they are not part of the graph.
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        RenderGraphPass& graphPass = passes[i];
+        if(!graphPass.pass->readsDeclared)
+        {
+            for(unsigned int j = 0; j < i; ++j)
+            {
+                for(unsigned int k = 0; k < passes[j].writes.size(); ++k)
+                {
+                    if(!graphPass.reads.containsItem(passes[j].writes[k]))
+                        graphPass.reads.pushBack(passes[j].writes[k]);
+                }
+            }
+            continue;
+        }
+
+        const SmallVector<TextureSlotIndex, 8>& slotReads = graphPass.pass->reads;
+        for(unsigned int j = 0; j < slotReads.size(); ++j)
+        {
+            for(unsigned int k = 0; k < resources.size(); ++k)
+            {
+                if(resources[k].texture->getSlotIndex() == slotReads[j] && !graphPass.reads.containsItem(k))
+                    graphPass.reads.pushBack(k);
+            }
+        }
+    }
+}
+
+void RenderGraph::cullPasses()
+{
+    //A buffer read before it is written keeps the contents of the previous frame, so its writers are always needed.
+    Vector<bool> written(resources.size());
+    for(unsigned int i = 0; i < resources.size(); ++i)
+        written[i] = false;
+
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        for(unsigned int j = 0; j < passes[i].reads.size(); ++j)
+        {
+            if(!written[passes[i].reads[j]])
+                resources[passes[i].reads[j]].persistent = true;
+        }
+
+        for(unsigned int j = 0; j < passes[i].writes.size(); ++j)
+            written[passes[i].writes[j]] = true;
+    }
+
+    Vector<bool> needed(resources.size());
+    for(unsigned int i = 0; i < resources.size(); ++i)
+        needed[i] = resources[i].persistent;
+
+    for(int i = passes.size() - 1; i >= 0; --i)
+    {
+        RenderGraphPass& graphPass = passes[i];
+        bool live = graphPass.writesMainTarget;
+        for(unsigned int j = 0; j < graphPass.writes.size() && !live; ++j)
+            live = needed[graphPass.writes[j]];
+
+        graphPass.pass->culled = !live;
+        if(live)
+        {
+            for(unsigned int j = 0; j < graphPass.reads.size(); ++j)
+                needed[graphPass.reads[j]] = true;
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for(unsigned int i = 0; i < passes.size(); ++i)
+    {
+        if(passes[i].pass->culled)
+            continue;
+
+        for(unsigned int j = 0; j < passes[i].reads.size() + passes[i].writes.size(); ++j)
+        {
+            RenderGraphResource& resource = resources[j < passes[i].reads.size() ? passes[i].reads[j] : passes[i].writes[j - passes[i].reads.size()]];
+            if(resource.firstPass < 0)
+                resource.firstPass = i;
+            resource.lastPass = i;
+        }
+    }
+}
+
+void RenderGraph::aliasResources()
+{
+    Vector<unsigned int> transientResources;
+    for(unsigned int i = 0; i < resources.size(); ++i)
+    {
+        if(resources[i].firstPass >= 0 && !resources[i].persistent)
+            transientResources.pushBack(i);
+    }
+
+    std::sort(transientResources.begin(), transientResources.end(), [this](unsigned int lhs, unsigned int rhs)
+    {
+        return resources[lhs].firstPass < resources[rhs].firstPass;
+    });
+
+    //Each owner has its own memory, which is free after the last pass of the last resource placed in it.
+    Vector<unsigned int> owners;
+    Vector<int> ownerLastPasses;
+    for(unsigned int i = 0; i < transientResources.size(); ++i)
+    {
+        RenderGraphResource& resource = resources[transientResources[i]];
+        unsigned int j = 0;
+        for(; j < owners.size(); ++j)
+        {
+            if(ownerLastPasses[j] < resource.firstPass && areAliasCompatible(resources[owners[j]].texture, resource.texture))
+                break;
+        }
+
+        if(j < owners.size())
+        {
+            resource.aliasOf = owners[j];
+            ownerLastPasses[j] = resource.lastPass;
+            graphicSystem.setTextureAlias(resource.texture, resources[owners[j]].texture);
+        }
+        else
+        {
+            owners.pushBack(transientResources[i]);
+            ownerLastPasses.pushBack(resource.lastPass);
+        }
+    }
+}
+
+void RenderGraph::removeAliases()
+{
+    for(unsigned int i = 0; i < resources.size(); ++i)
+    {
+        if(resources[i].aliasOf >= 0)
+        {
+            graphicSystem.setTextureAlias(resources[i].texture, nullptr);
+            resources[i].aliasOf = -1;
+        }
+    }
+}
+
+}
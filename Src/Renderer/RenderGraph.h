@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RenderGraph_H
+#define RenderGraph_H
+
+#include "Renderer/RenderPasses.h"
+#include "Graphics/GraphicDefs.h"
+#include "Util/Vector.h"
+#include <string>
+
+namespace Huurre3D
+{
+
+class GraphicSystem;
+class Texture;
+
+//A buffer of the render targets the passes write, identified by its texture.
+struct RenderGraphResource
+{
+    Texture* texture = nullptr;
+    //The first and the last live pass which reads or writes the resource, -1 when no live pass uses it.
+    int firstPass = -1;
+    int lastPass = -1;
+    //Read before it is written in the frame, so the contents of the previous frame are kept.
+    bool persistent = false;
+    //Index of the resource whose memory the resource uses, -1 when it has its own.
+    int aliasOf = -1;
+};
+
+struct RenderGraphPass
+{
+    std::string name;
+    RenderPass* pass = nullptr;
+    Vector<unsigned int> reads;
+    Vector<unsigned int> writes;
+    bool writesMainTarget = false;
+};
+
+struct RenderGraphStatistics
+{
+    unsigned int numPasses = 0;
+    unsigned int numCulledPasses = 0;
+    //Passes which do not declare their reads. The buffers are not aliased while there are any.
+    unsigned int numUndeclaredPasses = 0;
+    unsigned int numResources = 0;
+    unsigned int numAliasedResources = 0;
+    //Memory of the resources used by the live passes, without and with the aliasing.
+    unsigned int renderTargetBytes = 0;
+    unsigned int aliasedRenderTargetBytes = 0;
+};
+
+//Collects the render passes of the stages of a frame and derives the render target buffers each pass reads and writes.
+//Passes whose writes no later pass reads are culled, and the buffers whose lifetimes do not overlap share the memory of a
+//compatible buffer. The writes are the buffers of the render target of a pass, the reads are declared in the pass since the
+//shaders sample the buffers from fixed texture slots. A pass which does not declare its reads is taken to read every buffer written
+//before it, and the buffers are then not aliased, since the pass may sample a buffer of the previous frame.
+//The graph does not order the passes by their reads and writes. The stages execute their own passes, so the passes run in the
+//order they are added, and a buffer read before the pass which writes it is kept from the previous frame.
+class RenderGraph
+{
+public:
+    RenderGraph(GraphicSystem& graphicSystem);
+    ~RenderGraph() = default;
+
+    //Removes the passes and gives the aliased buffers their own memory back.
+    void clear();
+    //Adds the pass after the passes added before it, the pass is kept until the graph is cleared. The order is the execution order.
+    void addPass(const std::string& name, RenderPass* pass);
+    //Culls the passes, computes the lifetimes of the buffers and aliases the transient ones. Compiled again after the buffers are resized.
+    void compile();
+    void logRenderGraph() const;
+    const Vector<RenderGraphPass>& getPasses() const {return passes;}
+    const Vector<RenderGraphResource>& getResources() const {return resources;}
+    const RenderGraphStatistics& getStatistics() const {return statistics;}
+
+private:
+    unsigned int getResourceIndex(Texture* texture);
+    void resolveResources();
+    void cullPasses();
+    void computeLifetimes();
+    void aliasResources();
+    void removeAliases();
+
+    GraphicSystem& graphicSystem;
+    Vector<RenderGraphPass> passes;
+    Vector<RenderGraphResource> resources;
+    RenderGraphStatistics statistics;
+};
+
+}
+
+#endif
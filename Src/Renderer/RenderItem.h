@@ -23,6 +23,7 @@
 #define RenderItem_H
 
 #include "Math/Matrix4x4.h"
+#include "Math/BoundingBox.h"
 
 namespace Huurre3D
 {
@@ -34,6 +35,11 @@ struct RenderItem
 {
     Material* material = nullptr;
     Geometry* geometry = nullptr;
+    //Set by the mesh of the item, a geometry can be shared by the items of several meshes.
+    Matrix4x4 worldTransform = Matrix4x4::IDENTITY;
+    BoundingBox worldBoundingBox;
+    //Unique in the scene of the item, set when the item is added to a mesh. The stages key the state they keep per item with it.
+    unsigned int id = 0;
 
     RenderItem(Material* material, Geometry* geometry):
     material(material),
@@ -22,7 +22,7 @@
 #ifndef RenderPasses_H
 #define RenderPasses_H
 
-#include "Util/Vector.h"
+#include "Util/SmallVector.h"
 #include "Graphics/ShaderParameter.h"
 #include "Graphics/Rasterization.h"
 
@@ -34,15 +34,23 @@ class VertexData;
 class ShaderParameterBlock;
 class Texture;
 class RenderTarget;
+class DrawCommandBuffer;
 
 struct ShaderPass
 {
     ShaderProgram* program = nullptr;
     VertexData* vertexData = nullptr;;
+    //Range of an indexed vertex data drawn by the pass, the base vertex is added to each index.
+    unsigned int firstIndex = 0;
+    unsigned int numIndices = 0;
+    unsigned int baseVertex = 0;
+    //When set the pass draws the commands of the buffer with one multi-draw instead of the range.
+    DrawCommandBuffer* drawCommands = nullptr;
     RasterState rasterState;
     Vector<ShaderParameter> shaderParameters;
-    Vector<ShaderParameterBlock*> shaderParameterBlocks;
-    Vector<Texture*> textures;
+    //Passes bind a handful of blocks and textures, which are kept inside the pass to avoid heap allocations when passes are built or copied.
+    SmallVector<ShaderParameterBlock*, 4> shaderParameterBlocks;
+    SmallVector<Texture*, 8> textures;
 };
 
 struct RenderPass
@@ -55,6 +63,15 @@ struct RenderPass
     ViewPort viewPort;
     RenderTarget* renderTarget = nullptr;
     Vector<ShaderPass> shaderPasses;
+    //Passes kept by the stage from frame to frame, drawn after the shader passes. They are referenced to not copy them each frame
+    //and must stay in place until the pass has been recorded.
+    Vector<const ShaderPass*> stageShaderPasses;
+    //Slots of the render target buffers the shaders of the pass sample, the render graph culls the passes by them.
+    SmallVector<TextureSlotIndex, 8> reads;
+    //False when the pass does not list its reads, the render graph then takes the pass to read every buffer written before it.
+    bool readsDeclared = false;
+    //Set by the render graph when nothing reads the writes of the pass, a culled pass is not recorded.
+    bool culled = false;
 };
 
 }
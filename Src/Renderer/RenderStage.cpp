@@ -21,11 +21,62 @@
 
 #include "Renderer/RenderStage.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/RenderGraph.h"
 #include "Graphics/GraphicSystem.h"
+#include "Util/JSONSchema.h"
+#include "Util/Profiler.h"
+#include <iostream>
 
 namespace Huurre3D
 {
 
+static const JSONSchema<RenderStageDescription> renderStageSchema = JSONSchema<RenderStageDescription>("renderStage")
+    .addField("name", &RenderStageDescription::name, true)
+    .addField("implementation", &RenderStageDescription::implementation, true);
+
+static const JSONSchema<RenderPassDescription> renderPassSchema = JSONSchema<RenderPassDescription>("renderPass")
+    .addField("renderTargetLayer", &RenderPassDescription::renderTargetLayer)
+    .addField("flags", &RenderPassDescription::flags)
+    .addField("colorWrite", &RenderPassDescription::colorWrite)
+    .addField("depthWrite", &RenderPassDescription::depthWrite)
+    .addField("clearColor", &RenderPassDescription::clearColor)
+    .addField("viewPort", &RenderPassDescription::viewPort)
+    .addField("renderTarget", &RenderPassDescription::renderTarget)
+    .addField("shaderPasses", &RenderPassDescription::shaderPasses)
+    .addField("reads", &RenderPassDescription::reads);
+
+static const JSONSchema<ShaderPassDescription> shaderPassSchema = JSONSchema<ShaderPassDescription>("shaderPass")
+    .addField("shaderProgram", &ShaderPassDescription::shaderProgram)
+    .addField("vertexData", &ShaderPassDescription::vertexData)
+    .addField("rasterState", &ShaderPassDescription::rasterState)
+    .addField("shaderParameterBlocks", &ShaderPassDescription::shaderParameterBlocks)
+    .addField("textures", &ShaderPassDescription::textures);
+
+static const JSONSchema<RasterStateDescription> rasterStateSchema = JSONSchema<RasterStateDescription>("rasterState")
+    .addField("blendFunction", &RasterStateDescription::blendFunction)
+    .addField("compareFunction", &RasterStateDescription::compareFunction)
+    .addField("cullFace", &RasterStateDescription::cullFace);
+
+bool readRenderStageDescription(const JSONValue& renderStageJSON, RenderStageDescription& descriptionOut)
+{
+    return renderStageSchema.read(renderStageJSON, descriptionOut);
+}
+
+bool readRenderPassDescription(const JSONValue& renderPassJSON, RenderPassDescription& descriptionOut)
+{
+    return renderPassSchema.read(renderPassJSON, descriptionOut);
+}
+
+bool readShaderPassDescription(const JSONValue& shaderPassJSON, ShaderPassDescription& descriptionOut)
+{
+    return shaderPassSchema.read(shaderPassJSON, descriptionOut);
+}
+
+bool readRasterStateDescription(const JSONValue& rasterStateJSON, RasterStateDescription& descriptionOut)
+{
+    return rasterStateSchema.read(rasterStateJSON, descriptionOut);
+}
+
 RenderStage::RenderStage(Renderer& renderer):
 renderer(renderer)
 {
@@ -54,50 +105,121 @@ void RenderStage::resizeResources()
     }
 }
 
-void RenderStage::drawRenderPasses(const Vector<RenderPass>& renderPasses) const
+void RenderStage::setName(const std::string& name)
 {
-    GraphicSystem& graphicSystem = renderer.getGraphicSystem();
+    this->name = name;
+    updateZoneName = name + "::update";
+    executeZoneName = name + "::execute";
+}
+
+void RenderStage::addRenderPasses(RenderGraph& renderGraph)
+{
+    for(unsigned int i = 0; i < renderPasses.size(); ++i)
+        renderGraph.addPass(name + "[" + std::to_string(i) + "]", &renderPasses[i]);
+}
+
+static void recordShaderPass(CommandList& commandList, const ShaderPass& shaderPass)
+{
+    commandList.setVertexData(shaderPass.vertexData);
+    commandList.setRasterState(shaderPass.rasterState);
+    commandList.setShaderProgram(shaderPass.program);
+
+    for(unsigned int k = 0; k < shaderPass.textures.size(); ++k)
+        commandList.setTexture(shaderPass.textures[k]);
+
+    for(unsigned int n = 0; n < shaderPass.shaderParameterBlocks.size(); ++n)
+        commandList.setShaderParameterBlock(shaderPass.shaderParameterBlocks[n]);
+
+    for(unsigned int m = 0; m < shaderPass.shaderParameters.size(); ++m)
+        commandList.setShaderParameter(shaderPass.shaderParameters[m]);
+
+    if(shaderPass.drawCommands)
+        commandList.drawIndexedIndirect(shaderPass.drawCommands);
+    else if(shaderPass.vertexData)
+        shaderPass.vertexData->isIndexed() ? commandList.drawIndexed(shaderPass.numIndices, shaderPass.firstIndex, shaderPass.baseVertex) :
+            commandList.draw(shaderPass.vertexData->getNumVertices(), 0);
+}
+
+void RenderStage::recordRenderPasses(const Vector<RenderPass>& renderPasses)
+{
+    PROFILE_ZONE("RenderStage::recordRenderPasses");
+    commandList.reset();
 
     for(unsigned int i = 0; i < renderPasses.size(); ++i)
     {
-        RenderPass pass = renderPasses[i];
+        const RenderPass& pass = renderPasses[i];
+        if(pass.culled)
+            continue;
 
         if(pass.renderTarget)
-        {
-            pass.renderTarget->setRenderLayer(pass.renderTargetLayer); 
-            graphicSystem.setOffLineRenderTarget(pass.renderTarget);
-        }
+            commandList.setOffLineRenderTarget(pass.renderTarget, pass.renderTargetLayer);
         else
-        {
-            graphicSystem.setMainRenderTarget();
-        }
+            commandList.setMainRenderTarget();
 
-        graphicSystem.setViewPort(pass.viewPort);
-        graphicSystem.setDepthWrite(pass.depthWrite);
-        graphicSystem.setColorWrite(pass.colorWrite);
+        commandList.setViewPort(pass.viewPort);
+        commandList.setDepthWrite(pass.depthWrite);
+        commandList.setColorWrite(pass.colorWrite);
 
         if(pass.flags != 0)
-            graphicSystem.clear(pass.flags, pass.clearColor);
+            commandList.clear(pass.flags, pass.clearColor);
 
-        for(unsigned int j = 0; j < renderPasses[i].shaderPasses.size(); ++j)
-        {
-            ShaderPass shaderPass = renderPasses[i].shaderPasses[j];
-            graphicSystem.setVertexData(shaderPass.vertexData);
-            graphicSystem.setRasterState(shaderPass.rasterState);
-            graphicSystem.setShaderProgram(shaderPass.program);
+        for(unsigned int j = 0; j < pass.shaderPasses.size(); ++j)
+            recordShaderPass(commandList, pass.shaderPasses[j]);
 
-            for(unsigned int k = 0; k < shaderPass.textures.size(); ++k)
-                graphicSystem.setTexture(shaderPass.textures[k]);
+        for(unsigned int j = 0; j < pass.stageShaderPasses.size(); ++j)
+            recordShaderPass(commandList, *pass.stageShaderPasses[j]);
 
-            for(unsigned int n = 0; n < shaderPass.shaderParameterBlocks.size(); ++n)
-                graphicSystem.setShaderParameterBlock(shaderPass.shaderParameterBlocks[n]);
+        commandList.endPass();
+    }
+
+    statistics.commands = commandList.getStatistics();
+}
+
+void RenderStage::execute() const
+{
+    PROFILE_ZONE("RenderStage::execute");
+    renderer.getGraphicSystem().executeCommandList(commandList, &statistics.passes);
+}
+
+void RenderStage::initLodSelector(const JSONValue& lodJSON, LodSelector& lodSelector) const
+{
+    auto biasJSON = lodJSON.getJSONValue("bias");
+    auto hysteresisJSON = lodJSON.getJSONValue("hysteresis");
+    if(!biasJSON.isNull())
+        lodSelector.setBias(biasJSON.getFloat());
+    if(!hysteresisJSON.isNull())
+        lodSelector.setHysteresis(hysteresisJSON.getFloat());
+}
 
-            for(unsigned int m = 0; m < shaderPass.shaderParameters.size(); ++m)
-                graphicSystem.setShaderParameter(shaderPass.shaderParameters[m]);
+static ContributionThresholds readContributionThresholds(const JSONValue& thresholdsJSON)
+{
+    ContributionThresholds thresholds;
+    auto minScreenSizeJSON = thresholdsJSON.getJSONValue("minScreenSize");
+    auto maxDistanceJSON = thresholdsJSON.getJSONValue("maxDistance");
+    if(!minScreenSizeJSON.isNull())
+        thresholds.minScreenSize = minScreenSizeJSON.getFloat();
+    if(!maxDistanceJSON.isNull())
+        thresholds.maxDistance = maxDistanceJSON.getFloat();
+
+    return thresholds;
+}
+
+void RenderStage::initContributionCuller(const JSONValue& contributionCullingJSON, ContributionCuller& contributionCuller) const
+{
+    contributionCuller.setThresholds(readContributionThresholds(contributionCullingJSON));
 
-            shaderPass.vertexData->isIndexed() ? graphicSystem.drawIndexed(shaderPass.vertexData->getIndexBuffer()->getNumIndices(), 0) :
-                graphicSystem.draw(shaderPass.vertexData->getNumVertices(), 0);
+    auto materialsJSON = contributionCullingJSON.getJSONValue("materials");
+    for(unsigned int i = 0; !materialsJSON.isNull() && i < materialsJSON.getSize(); ++i)
+    {
+        auto materialJSON = materialsJSON.getJSONArrayItem(i);
+        auto nameJSON = materialJSON.getJSONValue("name");
+        if(nameJSON.isNull())
+        {
+            std::cout << "Failed to read the contribution culling thresholds of a material in " << name << ", the material has no name" << std::endl;
+            continue;
         }
+
+        contributionCuller.setMaterialThresholds(nameJSON.getString(), readContributionThresholds(materialJSON));
     }
 }
 
@@ -106,100 +228,82 @@ RenderPass RenderStage::createRenderPassFromJson(const JSONValue& renderPassJSON
     GraphicSystem& graphicSystem = renderer.getGraphicSystem();
 
     RenderPass renderPass;
-    auto clearColorJSON = renderPassJSON.getJSONValue("clearColor");
-    auto colorWriteJSON = renderPassJSON.getJSONValue("colorWrite");
-    auto depthWriteJSON = renderPassJSON.getJSONValue("depthWrite");
-    auto renderTargetLayerJSON = renderPassJSON.getJSONValue("renderTargetLayer");
-    auto flagsJSON = renderPassJSON.getJSONValue("flags");
-
-    if(!clearColorJSON.isNull())
-        renderPass.clearColor = clearColorJSON.getVector4();
-    if(!colorWriteJSON.isNull())
-        renderPass.colorWrite = colorWriteJSON.getBool();
-    if(!depthWriteJSON.isNull())
-        renderPass.depthWrite = depthWriteJSON.getBool();
-    if(!renderTargetLayerJSON.isNull())
-        renderPass.renderTargetLayer = renderTargetLayerJSON.getInt();
-    if(!flagsJSON.isNull())
+    RenderPassDescription renderPassDescription;
+    readRenderPassDescription(renderPassJSON, renderPassDescription);
+
+    renderPass.clearColor = renderPassDescription.clearColor;
+    renderPass.colorWrite = renderPassDescription.colorWrite;
+    renderPass.depthWrite = renderPassDescription.depthWrite;
+    renderPass.renderTargetLayer = renderPassDescription.renderTargetLayer;
+
+    for(unsigned int i = 0; i < renderPassDescription.flags.size(); ++i)
     {
-        unsigned int flags = 0;
-        for(unsigned int i = 0; i < flagsJSON.getSize(); ++i)
-        {
-            if(flagsJSON.getJSONArrayItem(i).getString().compare("CLEAR_COLOR") == 0)
-                flags |= CLEAR_COLOR;
-            if(flagsJSON.getJSONArrayItem(i).getString().compare("CLEAR_DEPTH") == 0)
-                flags |= CLEAR_DEPTH;
-        }
-        renderPass.flags = flags;
+        if(renderPassDescription.flags[i].compare("CLEAR_COLOR") == 0)
+            renderPass.flags |= CLEAR_COLOR;
+        if(renderPassDescription.flags[i].compare("CLEAR_DEPTH") == 0)
+            renderPass.flags |= CLEAR_DEPTH;
     }
 
-    auto viewPortJSON = renderPassJSON.getJSONValue("viewPort");
-    if(!viewPortJSON.isNull())
+    renderPass.readsDeclared = !renderPassJSON.getJSONValue("reads").isNull();
+    for(unsigned int i = 0; i < renderPassDescription.reads.size(); ++i)
     {
-        FixedArray<int, 4> viewPort = viewPortJSON.getInt4();
-        renderPass.viewPort.set(viewPort[0], viewPort[1], viewPort[2], viewPort[3]);
+        if(EnumStrings<TextureSlotIndex>::strings.getIndexToItem(renderPassDescription.reads[i]) >= 0)
+            renderPass.reads.pushBack(enumFromString<TextureSlotIndex>(renderPassDescription.reads[i]));
+        else
+            std::cout << "Failed to add the read " << renderPassDescription.reads[i] << " of a render pass, no texture slot with that name" << std::endl;
     }
+
+    const FixedArray<int, 4>& viewPort = renderPassDescription.viewPort;
+    if(viewPort[2] > 0)
+        renderPass.viewPort.set(viewPort[0], viewPort[1], viewPort[2], viewPort[3]);
     else
         renderPass.viewPort = renderer.getScreenViewPort();
 
-    auto renderTargetJSON = renderPassJSON.getJSONValue("renderTarget");
-    renderPass.renderTarget = graphicSystem.createRenderTarget(renderTargetJSON);
+    renderPass.renderTarget = graphicSystem.createRenderTarget(renderPassDescription.renderTarget);
 
-    auto shaderPasses = renderPassJSON.getJSONValue("shaderPasses");
+    const JSONValue& shaderPasses = renderPassDescription.shaderPasses;
 
-    if(!shaderPasses.isNull())
+    for(unsigned int i = 0; i < shaderPasses.getSize(); ++i)
     {
-        for(unsigned int i = 0; i < shaderPasses.getSize(); ++i)
+        ShaderPassDescription shaderPassDescription;
+        readShaderPassDescription(shaderPasses.getJSONArrayItem(i), shaderPassDescription);
+        ShaderPass shaderPass;
+
+        if(shaderPassDescription.vertexData.compare("fullScreenQuad") == 0)
+            shaderPass.vertexData = renderer.getFullScreenQuad();
+
+        if(!shaderPassDescription.rasterState.isNull())
         {
-            auto shaderPassJSON = shaderPasses.getJSONArrayItem(i);
-            auto programJSON = shaderPassJSON.getJSONValue("shaderProgram");
-            auto vertexDataJSON = shaderPassJSON.getJSONValue("vertexData");
-            auto rasterStateJSON = shaderPassJSON.getJSONValue("rasterState");
-            auto shaderParameterBlocksJSON = shaderPassJSON.getJSONValue("shaderParameterBlocks");
-            auto texturesJSON = shaderPassJSON.getJSONValue("textures");
-            ShaderPass shaderPass;
-
-            if(!vertexDataJSON.isNull())
-            {
-                if(vertexDataJSON.getString().compare("fullScreenQuad") == 0)
-                    shaderPass.vertexData = renderer.getFullScreenQuad();
-            }
-            if(!rasterStateJSON.isNull())
-            {
-                auto blendFunctionJSON = rasterStateJSON.getJSONValue("blendFunction");
-                auto compareFunctionJSON = rasterStateJSON.getJSONValue("compareFunction");
-                auto cullFaceJSON = rasterStateJSON.getJSONValue("cullFace");
-                auto blendState = !blendFunctionJSON.isNull() ? BlendState(true, enumFromString<BlendFunction>(blendFunctionJSON.getString())) : BlendState(false, BlendFunction::Replace);
-                auto compareState = !compareFunctionJSON.isNull() ? CompareState(true, enumFromString<CompareFunction>(compareFunctionJSON.getString())) : CompareState(false, CompareFunction::Never);
-                auto cullState = !cullFaceJSON.isNull() ? CullState(true, enumFromString<CullFace>(cullFaceJSON.getString())) : CullState(false, CullFace::Back);
-                shaderPass.rasterState = RasterState(blendState, compareState, cullState);
-            }
-
-            if(!shaderParameterBlocksJSON.isNull())
-            {
-                for(unsigned int j = 0; j < shaderParameterBlocksJSON.getSize(); ++j)
-                {
-                    ShaderParameterBlock* block = graphicSystem.createShaderParameterBlock(shaderParameterBlocksJSON.getJSONArrayItem(j));
-                    if(block)
-                        shaderPass.shaderParameterBlocks.pushBack(block);
-                }
-            }
-            if(!texturesJSON.isNull())
-            {
-                for(unsigned int j = 0; j < texturesJSON.getSize(); ++j)
-                {
-                    Texture* texture = graphicSystem.createTexture(texturesJSON.getJSONArrayItem(j));
-                    if(texture)
-                        shaderPass.textures.pushBack(texture);
-                }
-            }
-
-            if(!programJSON.isNull())
-                shaderPass.program = graphicSystem.createShaderProgram(programJSON);
-
-            renderPass.shaderPasses.pushBack(shaderPass);
+            RasterStateDescription rasterStateDescription;
+            readRasterStateDescription(shaderPassDescription.rasterState, rasterStateDescription);
+            auto blendState = !rasterStateDescription.blendFunction.empty() ? BlendState(true, enumFromString<BlendFunction>(rasterStateDescription.blendFunction)) : BlendState(false, BlendFunction::Replace);
+            auto compareState = !rasterStateDescription.compareFunction.empty() ? CompareState(true, enumFromString<CompareFunction>(rasterStateDescription.compareFunction)) : CompareState(false, CompareFunction::Never);
+            auto cullState = !rasterStateDescription.cullFace.empty() ? CullState(true, enumFromString<CullFace>(rasterStateDescription.cullFace)) : CullState(false, CullFace::Back);
+            shaderPass.rasterState = RasterState(blendState, compareState, cullState);
         }
+
+        const JSONValue& shaderParameterBlocksJSON = shaderPassDescription.shaderParameterBlocks;
+        for(unsigned int j = 0; j < shaderParameterBlocksJSON.getSize(); ++j)
+        {
+            ShaderParameterBlock* block = graphicSystem.createShaderParameterBlock(shaderParameterBlocksJSON.getJSONArrayItem(j));
+            if(block)
+                shaderPass.shaderParameterBlocks.pushBack(block);
+        }
+
+        const JSONValue& texturesJSON = shaderPassDescription.textures;
+        for(unsigned int j = 0; j < texturesJSON.getSize(); ++j)
+        {
+            Texture* texture = graphicSystem.createTexture(texturesJSON.getJSONArrayItem(j));
+            if(texture)
+                shaderPass.textures.pushBack(texture);
+        }
+
+        if(!shaderPassDescription.shaderProgram.isNull())
+            shaderPass.program = graphicSystem.createShaderProgram(shaderPassDescription.shaderProgram);
+
+        renderPass.shaderPasses.pushBack(shaderPass);
     }
+
     return renderPass;
 }
 
@@ -26,7 +26,10 @@
 #include "Renderer/Renderer.h"
 #include "Renderer/RenderItem.h"
 #include "Renderer/RenderPasses.h"
+#include "Renderer/RenderView.h"
 #include "Renderer/RenderStageFactory.h"
+#include "Renderer/RenderStatistics.h"
+#include "Scene/ContributionCuller.h"
 #include "Util/JSONValue.h"
 
 namespace Huurre3D
@@ -37,6 +40,51 @@ class ShaderParameterBlock;
 class VertexData;
 
 class Renderer;
+class RenderGraph;
+
+struct RenderStageDescription
+{
+    std::string name;
+    JSONValue implementation;
+};
+
+struct RenderPassDescription
+{
+    unsigned int renderTargetLayer = 0;
+    Vector<std::string> flags;
+    bool colorWrite = true;
+    bool depthWrite = true;
+    Vector4 clearColor = Vector4::ZERO;
+    //Zero width means the screen view port.
+    FixedArray<int, 4> viewPort = {0, 0, 0, 0};
+    JSONValue renderTarget;
+    JSONValue shaderPasses;
+    //Texture slots of the render target buffers the pass samples.
+    Vector<std::string> reads;
+};
+
+struct ShaderPassDescription
+{
+    JSONValue shaderProgram;
+    std::string vertexData;
+    JSONValue rasterState;
+    JSONValue shaderParameterBlocks;
+    JSONValue textures;
+};
+
+//The states without a function are disabled.
+struct RasterStateDescription
+{
+    std::string blendFunction;
+    std::string compareFunction;
+    std::string cullFace;
+};
+
+//Typed bindings of the render stage, render pass and shader pass JSON objects.
+bool readRenderStageDescription(const JSONValue& renderStageJSON, RenderStageDescription& descriptionOut);
+bool readRenderPassDescription(const JSONValue& renderPassJSON, RenderPassDescription& descriptionOut);
+bool readShaderPassDescription(const JSONValue& shaderPassJSON, ShaderPassDescription& descriptionOut);
+bool readRasterStateDescription(const JSONValue& rasterStateJSON, RasterStateDescription& descriptionOut);
 
 class RenderStage
 {
@@ -46,14 +94,46 @@ public:
     virtual void init(const JSONValue& renderStageJSON);
     virtual void resizeResources();
     virtual void clearStage() {}
-    virtual void update(const Scene& scene) {}
-    virtual void execute() const { drawRenderPasses(renderPasses); }
+    //Runs on the main thread before the stage updates, for the view state that the other stages read in their update.
+    virtual void prepare(RenderView& view) {}
+    virtual void update(const RenderView& view) {}
+    //Records the commands of the stage after its update, on the same worker thread.
+    virtual void record() {recordRenderPasses(renderPasses);}
+    //Adds the passes of the stage to the render graph of the renderer in their execution order.
+    virtual void addRenderPasses(RenderGraph& renderGraph);
+    //Replays the recorded commands on the main thread.
+    void execute() const;
+    void setName(const std::string& name);
+    const std::string& getName() const {return name;}
+    //Profiler zone names of the update and execute of the stage.
+    const char* getUpdateZoneName() const {return updateZoneName.c_str();}
+    const char* getExecuteZoneName() const {return executeZoneName.c_str();}
+    //Statistics of the last executed frame, the statistics of the frame in flight are filled meanwhile.
+    const RenderStageStatistics& getStatistics() const {return frameStatistics;}
+    void resetStatistics() {statistics.reset();}
+    //The renderer sets the graphic totals of the whole execute, the stage itself fills the rest.
+    void finishStatistics(const GraphicStatistics& graphicStatistics)
+    {
+        statistics.graphics = graphicStatistics;
+        frameStatistics = statistics;
+    }
 
 protected:
     RenderPass createRenderPassFromJson(const JSONValue& renderPassJSON);
-    void drawRenderPasses(const Vector<RenderPass>& renderPasses) const;
+    void recordRenderPasses(const Vector<RenderPass>& renderPasses);
+    //Reads the "bias" and "hysteresis" of the level of detail selection, the missing ones keep their defaults.
+    void initLodSelector(const JSONValue& lodJSON, LodSelector& lodSelector) const;
+    //Reads the "minScreenSize" and "maxDistance" of the pass, and of the material names in the "materials" array.
+    void initContributionCuller(const JSONValue& contributionCullingJSON, ContributionCuller& contributionCuller) const;
     Renderer& renderer;
     Vector<RenderPass> renderPasses;
+    CommandList commandList;
+    std::string name;
+    std::string updateZoneName;
+    std::string executeZoneName;
+    //Mutable since the passes are counted in the const execute.
+    mutable RenderStageStatistics statistics;
+    RenderStageStatistics frameStatistics;
 };
 
 }
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/RenderStatistics.h"
+#include <iostream>
+
+namespace Huurre3D
+{
+
+void logGraphicStatistics(const std::string& name, const GraphicStatistics& statistics)
+{
+    std::cout << name << ": draws " << statistics.drawCalls << ", instanced draws " << statistics.instancedDrawCalls << " (" << statistics.drawnInstances << " instances)"
+        << ", multi-draws " << statistics.indirectDrawCalls << " (" << statistics.indirectDraws << " draws)"
+        << ", program binds " << statistics.programBinds << "/" << statistics.programBinds + statistics.filteredProgramBinds
+        << ", texture binds " << statistics.textureBinds << "/" << statistics.textureBinds + statistics.filteredTextureBinds
+        << ", block binds " << statistics.parameterBlockBinds << "/" << statistics.parameterBlockBinds + statistics.filteredParameterBlockBinds
+        << ", raster states " << statistics.rasterStateChanges << "/" << statistics.rasterStateChanges + statistics.filteredRasterStateChanges
+        << ", view ports " << statistics.viewPortChanges << "/" << statistics.viewPortChanges + statistics.filteredViewPortChanges
+        << ", vertex data binds " << statistics.vertexDataBinds << "/" << statistics.vertexDataBinds + statistics.filteredVertexDataBinds
+        << ", uploaded bytes vertex " << statistics.vertexBytesUploaded << " index " << statistics.indexBytesUploaded
+        << " uniform " << statistics.uniformBytesUploaded << " texture " << statistics.textureBytesUploaded
+        << ", streamed parameter bytes " << statistics.streamedParameterBytes << " (" << statistics.parameterRingStalls << " ring stalls)" << std::endl;
+}
+
+void logRenderStageStatistics(const std::string& stageName, const RenderStageStatistics& statistics)
+{
+    logGraphicStatistics(stageName, statistics.graphics);
+
+    for(unsigned int i = 0; i < statistics.passes.size(); ++i)
+        logGraphicStatistics("    pass " + std::to_string(i), statistics.passes[i]);
+
+    const CommandListStatistics& commands = statistics.commands;
+    if(commands.recordedCommands > 0)
+    {
+        std::cout << "    commands: recorded " << commands.recordedCommands << ", filtered " << commands.filteredCommands
+            << ", " << commands.sizeInBytes << " bytes" << std::endl;
+    }
+
+    const CullingStatistics& culling = statistics.culling;
+    if(culling.itemsTested > 0 || culling.lightsTested > 0)
+    {
+        std::cout << "    culling: items " << culling.itemsVisible << "/" << culling.itemsTested
+            << ", lights " << culling.lightsVisible << "/" << culling.lightsTested << std::endl;
+    }
+
+    if(culling.itemsBecameVisible > 0 || culling.itemsBecameHidden > 0)
+        std::cout << "    visibility changes: items became visible " << culling.itemsBecameVisible << ", hidden " << culling.itemsBecameHidden << std::endl;
+
+    if(culling.occluders > 0)
+        std::cout << "    occlusion culling: items occluded " << culling.itemsOccluded << " by " << culling.occluders << " occluders" << std::endl;
+
+    if(culling.itemsTooSmall > 0 || culling.itemsTooFar > 0)
+    {
+        std::cout << "    contribution culling: draws removed " << culling.itemsTooSmall + culling.itemsTooFar << " (" << culling.itemsTooSmall << " too small, "
+            << culling.itemsTooFar << " too far)" << std::endl;
+    }
+
+    const LodStatistics& lods = statistics.lods;
+    if(lods.itemsSelected > 0)
+    {
+        std::cout << "    lods: items reduced " << lods.itemsReduced << "/" << lods.itemsSelected << ", level changes " << lods.levelChanges
+            << ", indices " << lods.selectedIndices << "/" << lods.sourceIndices << std::endl;
+    }
+
+    const DrawRecordStatistics& drawRecords = statistics.drawRecords;
+    if(drawRecords.recordsDrawn > 0)
+    {
+        std::cout << "    draw records: drawn " << drawRecords.recordsDrawn << ", rebuilt " << drawRecords.recordsRebuilt
+            << ", transforms updated " << drawRecords.transformsUpdated << std::endl;
+    }
+
+    const LightTileStatistics& lightTiles = statistics.lightTiles;
+    if(lightTiles.numTiles > 0)
+    {
+        std::cout << "    lights per tile: min " << lightTiles.minLights << ", avg " << lightTiles.averageLights
+            << ", max " << lightTiles.maxLights << " (" << lightTiles.numTiles << " tiles)" << std::endl;
+    }
+}
+
+}
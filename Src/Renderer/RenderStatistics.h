@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RenderStatistics_H
+#define RenderStatistics_H
+
+#include "Graphics/GraphicStatistics.h"
+#include "Graphics/CommandList.h"
+#include "Renderer/LightTileGrid.h"
+#include "Renderer/LodSelector.h"
+#include "Scene/SceneCuller.h"
+#include "Util/Vector.h"
+#include <string>
+
+namespace Huurre3D
+{
+
+//Work done on the draw records a stage keeps for its render items between the frames.
+struct DrawRecordStatistics
+{
+    unsigned int recordsDrawn = 0;
+    //Rebuilt because the record was new or the material of the item had changed.
+    unsigned int recordsRebuilt = 0;
+    unsigned int transformsUpdated = 0;
+};
+
+//Statistics of a render stage on the last rendered frame.
+struct RenderStageStatistics
+{
+    //Totals of the stage execute.
+    GraphicStatistics graphics;
+    //Each render pass the stage has drawn, in draw order.
+    Vector<GraphicStatistics> passes;
+    CullingStatistics culling;
+    //The command list recorded on the last update.
+    CommandListStatistics commands;
+    //Only filled by the stages that bin lights to tiles.
+    LightTileStatistics lightTiles;
+    //Only filled by the stages that select the levels of detail.
+    LodStatistics lods;
+    //Only filled by the stages that keep draw records.
+    DrawRecordStatistics drawRecords;
+
+    void reset()
+    {
+        graphics = GraphicStatistics();
+        passes.clear();
+        culling = CullingStatistics();
+        commands = CommandListStatistics();
+        lightTiles = LightTileStatistics();
+        lods = LodStatistics();
+        drawRecords = DrawRecordStatistics();
+    }
+};
+
+void logGraphicStatistics(const std::string& name, const GraphicStatistics& statistics);
+void logRenderStageStatistics(const std::string& stageName, const RenderStageStatistics& statistics);
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/RenderView.h"
+#include "Scene/Scene.h"
+#include "Scene/Mesh.h"
+#include "Scene/Joint.h"
+#include "Scene/SkyBox.h"
+
+namespace Huurre3D
+{
+
+void RenderView::capture(const Scene& scene)
+{
+    camera = *scene.getMainCamera();
+    globalAmbientLight = scene.getGlobalAmbientLight();
+    sceneVersion = scene.getChangeVersion();
+
+    auto sceneLights = scene.getSceneItems<Light>();
+    lights.clear();
+    lights.reserve(sceneLights.size());
+    for(unsigned int i = 0; i < sceneLights.size(); ++i)
+        lights.pushBack(*sceneLights[i]);
+
+    renderItems.clear();
+    renderItemGroups.clear();
+    occluders.clear();
+    auto meshes = scene.getSceneItems<Mesh>();
+    for(unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        const Vector<RenderItem>& meshItems = meshes[i]->getRenderItems();
+        RenderItemGroup group;
+        group.worldBoundingBox = meshes[i]->getWorldBoundingBox();
+        group.firstItem = renderItems.size();
+        group.numItems = meshItems.size();
+        group.meshId = meshes[i]->getId();
+        group.updateVersion = meshes[i]->getUpdateVersion();
+        renderItems.pushBack(meshItems);
+        renderItemGroups.pushBack(group);
+
+        if(meshes[i]->isOccluder())
+        {
+            OccluderBox occluder;
+            occluder.worldTransform = meshes[i]->getWorldTransform4x4();
+            occluder.boundingBox = meshes[i]->getBoundingBox();
+            occluders.pushBack(occluder);
+        }
+    }
+
+    skinMatrices.clear();
+    auto joints = scene.getSceneItems<Joint>();
+    for(unsigned int i = 0; i < joints.size(); ++i)
+        skinMatrices.pushBack(joints[i]->getSkinMatrix());
+
+    auto skyBoxes = scene.getSceneItems<SkyBox>();
+    skyBox = skyBoxes.empty() ? nullptr : skyBoxes[0];
+    if(skyBox)
+        skyBoxTextureFiles = skyBox->getTextureFiles();
+}
+
+}
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RenderView_H
+#define RenderView_H
+
+#include "Scene/Camera.h"
+#include "Scene/Light.h"
+#include "Renderer/RenderItem.h"
+#include "Graphics/GraphicDefs.h"
+#include "Util/FixedArray.h"
+
+namespace Huurre3D
+{
+
+class Scene;
+class SkyBox;
+
+//The render items of one mesh, with the box of the whole mesh for culling the items at once.
+struct RenderItemGroup
+{
+    BoundingBox worldBoundingBox;
+    unsigned int firstItem = 0;
+    unsigned int numItems = 0;
+    //Scene id and the update version of the mesh, the cached visibility of the items is valid while they stay the same.
+    unsigned int meshId = 0;
+    unsigned int updateVersion = 0;
+};
+
+//Box of an occluder mesh in the local space of the mesh.
+struct OccluderBox
+{
+    Matrix4x4 worldTransform;
+    BoundingBox boundingBox;
+};
+
+//Copy of the scene state the render stages read, captured on the main thread after the scene update.
+//The stages update from the view on the worker threads while the simulation of the next frame changes the scene.
+struct RenderView
+{
+    Camera camera;
+    Vector<Light> lights;
+    Vector<RenderItem> renderItems;
+    Vector<RenderItemGroup> renderItemGroups;
+    Vector<OccluderBox> occluders;
+    Vector<Matrix4x4> skinMatrices;
+    Vector3 globalAmbientLight = Vector3::ZERO;
+    //Only compared for a change of the sky box, the texture files are copied.
+    const SkyBox* skyBox = nullptr;
+    //Change version of the scene when the view was captured.
+    unsigned int sceneVersion = 0;
+    FixedArray<std::string, NumCubeMapFaces> skyBoxTextureFiles;
+
+    RenderView():
+    lights(MemoryTag::Scene),
+    renderItems(MemoryTag::Scene),
+    renderItemGroups(MemoryTag::Scene),
+    occluders(MemoryTag::Scene),
+    skinMatrices(MemoryTag::Scene)
+    {}
+    void capture(const Scene& scene);
+};
+
+}
+
+#endif
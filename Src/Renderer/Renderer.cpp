@@ -27,6 +27,7 @@
 #include "Renderer/PostProcessStage.h"
 #include "Renderer/Renderer.h"
 #include "Renderer/Geometry.h"
+#include "Renderer/IndirectDrawBatcher.h"
 #include "Graphics/GraphicSystem.h"
 #include "Scene/Scene.h"
 #include "Scene/Camera.h"
@@ -35,6 +36,8 @@
 #include "Scene/Joint.h"
 #include "Scene/SkyBox.h"
 #include "Math/Frustum.h"
+#include "Util/Timer.h"
+#include "Util/Profiler.h"
 #include <iostream>
 
 namespace Huurre3D
@@ -45,7 +48,9 @@ RENDERSTAGE_TYPE_IMPL(ShadowStage);
 RENDERSTAGE_TYPE_IMPL(LightingStage);
 RENDERSTAGE_TYPE_IMPL(PostProcessStage);
 
-Renderer::Renderer()
+Renderer::Renderer():
+geometryAllocator(graphicSystem),
+renderGraph(graphicSystem)
 {
     //graphicWindow = new GraphicWindow();
     //graphicSystem = new GraphicSystem();
@@ -53,6 +58,8 @@ Renderer::Renderer()
 
 Renderer::~Renderer()
 {
+    waitStageUpdates();
+
     for(unsigned int i = 0; i < renderStages.size(); ++i)
         delete renderStages[i];
 
@@ -80,6 +87,9 @@ bool Renderer::init(const JSONValue& rendererJSON)
         materialParameterBlock = graphicSystem.createShaderParameterBlock(sp_materialProperties);
         renderTargetSizeBlock = graphicSystem.createShaderParameterBlock(sp_renderTargetSize);
         skinMatrixArray = graphicSystem.createShaderParameterBlock(sp_skinMatrixArray);
+        cameraShaderParameterBlock->setStreamed(true);
+        skinMatrixArray->setStreamed(true);
+        materialParameterTable.setParameterBlock(materialParameterBlock);
         Vector4 renderTargetSizeValue = Vector4(float(width), float(height), (1.0f / float(width)), (1.0f / float(height)));
         renderTargetSizeBlock->addParameter(renderTargetSizeValue);
 
@@ -95,6 +105,31 @@ bool Renderer::init(const JSONValue& rendererJSON)
         if(!materialFragmentShaderJSON.isNull())
             materialFragmentShader = materialFragmentShaderJSON.getString();
 
+        auto releaseUploadedDataJSON = rendererJSON.getJSONValue("releaseUploadedData");
+        if(!releaseUploadedDataJSON.isNull())
+            graphicSystem.setReleaseUploadedData(releaseUploadedDataJSON.getBool());
+
+        //The blocks rebuilt every frame are streamed through a ring of the size in bytes.
+        auto parameterRingSizeJSON = rendererJSON.getJSONValue("parameterRingSize");
+        if(!parameterRingSizeJSON.isNull())
+            graphicSystem.setParameterRingSize(parameterRingSizeJSON.getInt());
+
+        auto frameLatencyJSON = rendererJSON.getJSONValue("frameLatency");
+        if(!frameLatencyJSON.isNull())
+            setFrameLatency(frameLatencyJSON.getInt());
+
+        auto statisticsLogIntervalJSON = rendererJSON.getJSONValue("statisticsLogInterval");
+        if(!statisticsLogIntervalJSON.isNull())
+            statisticsLogInterval = statisticsLogIntervalJSON.getInt();
+
+        auto logRenderGraphJSON = rendererJSON.getJSONValue("logRenderGraph");
+        if(!logRenderGraphJSON.isNull())
+            logRenderGraph = logRenderGraphJSON.getBool();
+
+        auto shaderCacheDirectoryJSON = rendererJSON.getJSONValue("shaderCacheDirectory");
+        if(!shaderCacheDirectoryJSON.isNull())
+            graphicSystem.setShaderCacheDirectory(shaderCacheDirectoryJSON.getString());
+
         auto renderStagesJSON = rendererJSON.getJSONValue("renderStages");
         if(renderStagesJSON.isNull())
         {
@@ -104,26 +139,28 @@ bool Renderer::init(const JSONValue& rendererJSON)
         {
             for(unsigned int i = 0; i < renderStagesJSON.getSize(); ++i)
             {
-                auto renderStageJSON = renderStagesJSON.getJSONArrayItem(i);
-                auto renderStageNameJSON = renderStageJSON.getJSONValue("name");
-                auto renderTargetImplementationJSON = renderStageJSON.getJSONValue("implementation");
-
-                if(renderStageNameJSON.isNull() || renderTargetImplementationJSON.isNull())
+                RenderStageDescription renderStageDescription;
+                if(!readRenderStageDescription(renderStagesJSON.getJSONArrayItem(i), renderStageDescription))
                 {
-                    std::cout << "Failed to create renderStage " << i << ". One of the mandatory values: name, implementation is missing" << std::endl;
+                    std::cout << "Failed to create renderStage " << i << std::endl;
                 }
                 else
                 {
-                    RenderStage* renderStage = RenderStageFactory::createRenderStage(*this, renderStageNameJSON.getString());
+                    RenderStage* renderStage = RenderStageFactory::createRenderStage(*this, renderStageDescription.name);
                     if(renderStage)
                     {
-                        renderStage->init(renderTargetImplementationJSON);
+                        renderStage->setName(renderStageDescription.name);
+                        renderStage->init(renderStageDescription.implementation);
                         renderStages.pushBack(renderStage);
+                        renderStageTimings.pushBack(RenderStageTiming());
+                        stageUpdateTimings.pushBack(RenderStageTiming());
                     }
                     else
-                        std::cout << "RenderStage " << renderStageNameJSON.getString()<<" have not been registered." << std::endl;
+                        std::cout << "RenderStage " << renderStageDescription.name <<" have not been registered." << std::endl;
                 }
             }
+
+            compileRenderGraph();
         }
     }
 
@@ -158,6 +195,7 @@ bool Renderer::createRenderWindow(int width, int height, const std::string& wind
 
 void Renderer::resizeRenderWindow(int width, int height)
 {
+    flushFrames();
     screenViewPort.set(0, 0, width, height);
     Vector4 renderTargetSizeValue = Vector4(float(width), float(height), (1.0f / float(width)), (1.0f / float(height)));
     renderTargetSizeBlock->clearParameters();
@@ -165,41 +203,171 @@ void Renderer::resizeRenderWindow(int width, int height)
 
     for(unsigned int i = 0; i < renderStages.size(); ++i)
         renderStages[i]->resizeResources();
+
+    //The sizes of the buffers changed, so the aliased buffers are compatible only after the graph is compiled again.
+    compileRenderGraph();
 }
 
 void Renderer::renderScene(Scene* scene)
 {
+    PROFILE_ZONE("Renderer::renderScene");
+    //The view is captured into a free slot of the ring while the workers may still update the stages from an older view.
+    {
+        PROFILE_ZONE("RenderView::capture");
+        renderViews[(firstRenderView + numRenderViews) % renderViews.size()].capture(*scene);
+        ++numRenderViews;
+    }
+
+    executeFrames(frameLatency);
+
+    if(numRenderViews > 0 && !stageUpdatesInFlight)
+        submitFrame();
+}
+
+void Renderer::flushFrames()
+{
+    executeFrames(0);
+}
+
+void Renderer::setFrameLatency(unsigned int latency)
+{
+    if(latency > MaxFrameLatency)
+    {
+        std::cout << "Frame latency " << latency << " is larger than the maximum " << MaxFrameLatency << ", using the maximum." << std::endl;
+        latency = MaxFrameLatency;
+    }
+
+    if(latency < frameLatency)
+        executeFrames(latency);
+
+    frameLatency = latency;
+}
+
+void Renderer::submitFrame()
+{
+    const RenderView* view = &renderViews[firstRenderView];
+    updateMaterialParameters();
     cameraShaderParameterBlock->clearParameters();
-    scene->getMainCamera()->getCameraShaderParameterBlock(cameraShaderParameterBlock);
+    view->camera.getCameraShaderParameterBlock(cameraShaderParameterBlock);
     skinMatrixArray->clearParameters();
 
-    Vector<Joint*> joints;
-    scene->getSceneItemsByType<Joint>(joints);
+    for(unsigned int i = 0; i < view->skinMatrices.size(); ++i)
+        skinMatrixArray->addParameter(view->skinMatrices[i]);
 
-    for(unsigned int i = 0; i < joints.size(); ++i)
+    for(unsigned int i = 0; i < renderStages.size(); ++i)
     {
-        Matrix4x4 skinMatrix = joints[i]->getSkinMatrix();
-        skinMatrixArray->addParameter(skinMatrix);
+        renderStages[i]->clearStage();
+        renderStages[i]->resetStatistics();
     }
 
     for(unsigned int i = 0; i < renderStages.size(); ++i)
-        renderStages[i]->clearStage();
+        renderStages[i]->prepare(renderViews[firstRenderView]);
 
     for(unsigned int i = 0; i < renderStages.size(); ++i)
     {
         RenderStage* renderStage = renderStages[i];
-        stageupdateResults[i] = workQueue.submitTask([renderStage, scene](){renderStage->update(*scene); });
+        RenderStageTiming* timing = &stageUpdateTimings[i];
+        stageupdateResults[i] = workQueue.submitTask([renderStage, timing, view]()
+        {
+            PROFILE_ZONE(renderStage->getUpdateZoneName());
+            Timer timer;
+            timer.start();
+            renderStage->update(*view);
+            timing->updateTime = timer.getElapsedTime();
+            timer.start();
+            renderStage->record();
+            timing->recordTime = timer.getElapsedTime();
+        });
     }
-   
+
+    stageUpdatesInFlight = true;
+}
+
+void Renderer::executeFrame()
+{
+    graphicSystem.resetStatistics();
+    graphicSystem.beginFrame();
+
+    Timer executeTimer;
     for(unsigned int i = 0; i < renderStages.size(); ++i)
     {
         stageupdateResults[i].wait();
+        PROFILE_ZONE(renderStages[i]->getExecuteZoneName());
+        GraphicStatistics stageStartStatistics = graphicSystem.getStatistics();
+        executeTimer.start();
         renderStages[i]->execute();
+        renderStageTimings[i].updateTime = stageUpdateTimings[i].updateTime;
+        renderStageTimings[i].recordTime = stageUpdateTimings[i].recordTime;
+        renderStageTimings[i].executeTime = executeTimer.getElapsedTime();
+        renderStages[i]->finishStatistics(graphicSystem.getStatistics() - stageStartStatistics);
     }
 
+    stageUpdatesInFlight = false;
+    firstRenderView = (firstRenderView + 1) % renderViews.size();
+    --numRenderViews;
+
+    graphicSystem.endFrame();
+    frameStatistics = graphicSystem.getStatistics();
+    ++numRenderedFrames;
+    if(statisticsLogInterval > 0 && numRenderedFrames % statisticsLogInterval == 0)
+        logRenderStatistics();
+
+    PROFILE_ZONE("GraphicWindow::swapBuffers");
     graphicWindow.swapBuffers();
 }
 
+void Renderer::executeFrames(unsigned int numFramesLeft)
+{
+    while(numRenderViews > numFramesLeft)
+    {
+        if(!stageUpdatesInFlight)
+            submitFrame();
+
+        executeFrame();
+    }
+}
+
+void Renderer::waitStageUpdates()
+{
+    if(stageUpdatesInFlight)
+    {
+        for(unsigned int i = 0; i < renderStages.size(); ++i)
+            stageupdateResults[i].wait();
+    }
+}
+
+void Renderer::updateMaterialParameters()
+{
+    for(unsigned int i = 0; i < materials.size(); ++i)
+    {
+        if(materials[i]->areParametersDirty())
+            materials[i]->setParameterSlot(materialParameterTable.updateSlot(materials[i]->getParameterSlot(), materials[i]->getParameters()));
+    }
+}
+
+void Renderer::compileRenderGraph()
+{
+    PROFILE_ZONE("Renderer::compileRenderGraph");
+    renderGraph.clear();
+    for(unsigned int i = 0; i < renderStages.size(); ++i)
+        renderStages[i]->addRenderPasses(renderGraph);
+
+    renderGraph.compile();
+    if(logRenderGraph)
+        renderGraph.logRenderGraph();
+}
+
+void Renderer::logRenderStatistics() const
+{
+    std::cout << "Render statistics of frame " << numRenderedFrames << std::endl;
+    logGraphicStatistics("Frame", frameStatistics);
+
+    for(unsigned int i = 0; i < renderStages.size(); ++i)
+        logRenderStageStatistics(renderStages[i]->getName(), renderStages[i]->getStatistics());
+
+    Memory::logStatistics();
+}
+
 void Renderer::createRenderItems(const Vector<MaterialDescription>& materialDescriptions, const Vector<GeometryDescription>& geometryDescriptions, Vector<RenderItem>& renderItemsOut)
 {
     if(materialDescriptions.size() == geometryDescriptions.size())
@@ -244,12 +412,15 @@ void Renderer::createRenderItems(const Vector<MaterialDescription>& materialDesc
 
 Material* Renderer::createMaterial(const MaterialDescription& materialDescription)
 {
+    waitStageUpdates();
+
     Matrix4x4 parameters(Vector4(materialDescription.diffuseColor, materialDescription.roughness),
                          Vector4(materialDescription.specularColor, 0.0f),
                          Vector4(materialDescription.emissiveColor, materialDescription.reflectance),
                          Vector4(materialDescription.ambientColor, materialDescription.alpha));
 
     Material* material = new Material(parameters, materialDescription.rasterState, materialDescription.skinned);
+    material->setName(materialDescription.name);
 
     if(!materialDescription.diffuseTextureFile.empty())
         material->setDiffuseTexture(createMaterialTexture(materialDescription.diffuseTextureFile, TextureSlotIndex::Diffuse));
@@ -263,41 +434,15 @@ Material* Renderer::createMaterial(const MaterialDescription& materialDescriptio
     if(!materialDescription.alphaTextureFile.empty())
         material->setAlphaTexture(createMaterialTexture(materialDescription.alphaTextureFile, TextureSlotIndex::Alpha));
 
-    //Create the needed graphic resources
-    unsigned int materialParameterId = material->getParameterId();
-    int materialBufferIndex = materialBufferIndicies.getIndexToItem(materialParameterId);
-
-    //Check if the material parameters are already in the buffer, if not, add the parameters to the buffer.
-    if(materialBufferIndex == -1)
-    {
-        ShaderParameterBlock* materialParameterBlock = graphicSystem.getShaderParameterBlockByName(sp_materialProperties);
-        materialParameterBlock->addParameter(material->getParameters());
-        materialBufferIndicies.pushBack(materialParameterId);
-        materialBufferIndex = materialBufferIndicies.size() - 1;
-    }
-
-    //The material has no program set, try if the shader program exist.
-    Vector<std::string> shaderFileNames = {materialVertexShader, materialFragmentShader};
-    Vector<std::string> fragmentShaderDefines = material->getShaderDefines(ShaderType::Fragment);
-    Vector<std::string> vertexShaderDefines = material->getShaderDefines(ShaderType::Vertex);
-    Vector<std::string> combinedDefines = vertexShaderDefines;
-    combinedDefines.pushBack(fragmentShaderDefines);
-
-    ShaderProgram* program = graphicSystem.getShaderCombination(shaderFileNames, combinedDefines);
-
-    //If the program dont exist, create one.
-    if(!program)
-    {
-        Shader* vShader = graphicSystem.createShader(ShaderType::Vertex, materialVertexShader);
-        Shader* fShader = graphicSystem.createShader(ShaderType::Fragment, materialFragmentShader);
-        vShader->setDefines(vertexShaderDefines);
-        fShader->setDefines(fragmentShaderDefines);
-        program = graphicSystem.createShaderProgram(vShader, fShader);
-        graphicSystem.setShaderProgram(program);
-    }
+    //The materials with the same parameters share a slot of the material parameter block.
+    material->setParameterSlot(materialParameterTable.acquireSlot(material->getParameters()));
 
+    ShaderProgram* program = getMaterialShaderProgram(material->getShaderDefines(ShaderType::Vertex), material->getShaderDefines(ShaderType::Fragment));
     material->setCurrentShaderCombinationTag(program->getShaderCombinationTag());
 
+    if(indirectMaterialPrograms)
+        material->setIndirectShaderCombinationTag(getShaderProgramVariant(program, sd_indirectDraw)->getShaderCombinationTag());
+
     materials.pushBack(material);
     return material;
 }
@@ -310,6 +455,7 @@ void Renderer::createMaterials(const MaterialDescription& materialDescription, V
     for(unsigned int i = 1; i < numMaterials; ++i)
     {
         Material* copy = new Material(*material);
+        copy->setParameterSlot(materialParameterTable.acquireSlot(copy->getParameters()));
         materials.pushBack(copy);
         materialsOut.pushBack(copy);
     }
@@ -317,21 +463,35 @@ void Renderer::createMaterials(const MaterialDescription& materialDescription, V
 
 Geometry* Renderer::createGeometry(const GeometryDescription& geometryDescription)
 {
+    waitStageUpdates();
+
     Geometry* geometry = new Geometry();
-    VertexData* vd = graphicSystem.createVertexData(geometryDescription.primitiveType, geometryDescription.numVertices);
+    //Indexed geometries are packed into the shared buffers of their vertex layout.
+    GeometryAllocation* allocation = geometryDescription.numIndices > 0 ? geometryAllocator.allocate(geometryDescription.primitiveType, geometryDescription.attributeDescriptions,
+        geometryDescription.vertexData, geometryDescription.numVertices, geometryDescription.indexType, geometryDescription.indices, geometryDescription.numIndices) : nullptr;
 
-    VertexStream* vertexStream = graphicSystem.createVertexStream(geometryDescription.numVertices, geometryDescription.attributeDescriptions);
-    vertexStream->setAttributes(std::move(const_cast<MemoryBuffer&>(geometryDescription.vertexData)));
-    vd->setVertexStream(vertexStream);
+    if(allocation)
+        geometry->setAllocation(allocation);
+    else
+    {
+        VertexData* vd = graphicSystem.createVertexData(geometryDescription.primitiveType, geometryDescription.numVertices);
 
-    IndexBuffer* indexBuffer = graphicSystem.createIndexBuffer(geometryDescription.indexType, geometryDescription.numIndices, false);
-    indexBuffer->setIndices(std::move(const_cast<MemoryBuffer&>(geometryDescription.indices)));
-    vd->setIndexBuffer(indexBuffer);
+        VertexStream* vertexStream = graphicSystem.createVertexStream(geometryDescription.numVertices, geometryDescription.attributeDescriptions);
+        vertexStream->setAttributes(std::move(const_cast<MemoryBuffer&>(geometryDescription.vertexData)));
+        vd->setVertexStream(vertexStream);
 
-    graphicSystem.setVertexData(vd);
-    geometry->setBoundingBox(geometryDescription.boundingBox);
-    geometry->setVertexData(vd);
+        if(geometryDescription.numIndices > 0)
+        {
+            IndexBuffer* indexBuffer = graphicSystem.createIndexBuffer(geometryDescription.indexType, geometryDescription.numIndices, false);
+            indexBuffer->setIndices(std::move(const_cast<MemoryBuffer&>(geometryDescription.indices)));
+            vd->setIndexBuffer(indexBuffer);
+        }
+
+        graphicSystem.setVertexData(vd);
+        geometry->setVertexData(vd);
+    }
 
+    geometry->setBoundingBox(geometryDescription.boundingBox);
     geometries.pushBack(geometry);
     return geometry;
 }
@@ -344,16 +504,67 @@ void Renderer::createGeometries(const GeometryDescription& geometryDescription,
     for(unsigned int i = 1; i < numGeometries; ++i)
     { 
         Geometry* copy = new Geometry(*geometry);
+        if(copy->getAllocation())
+            geometryAllocator.addReference(copy->getAllocation());
         geometries.pushBack(copy);
         geometriesOut.pushBack(copy);
     }
 }
 
+void Renderer::createGeometryLods(const Vector<GeometryDescription>& lodDescriptions, const Vector<Geometry*>& geometries)
+{
+    for(unsigned int i = 0; i < lodDescriptions.size(); ++i)
+    {
+        Geometry* lod = createGeometry(lodDescriptions[i]);
+        for(unsigned int j = 0; j < geometries.size(); ++j)
+            geometries[j]->addLod(lod, lodDescriptions[i].lodScreenSize);
+    }
+}
+
+unsigned int Renderer::precompileMaterialShaders()
+{
+    waitStageUpdates();
+
+    //The texture defines are listed in the same order as createMaterial sets the textures, so that the combination tags match.
+    const Vector<std::string> textureDefines = {sd_diffuseTexture, sd_specularTexture, sd_normalTexture, sd_alphaMask};
+    unsigned int numPermutations = 1 << textureDefines.size();
+    unsigned int numLinkedPrograms = 0;
+
+    for(int skinned = 0; skinned < 2; ++skinned)
+    {
+        Vector<std::string> vertexShaderDefines;
+        if(skinned)
+            vertexShaderDefines.pushBack(sd_skinned);
+
+        for(unsigned int permutation = 0; permutation < numPermutations; ++permutation)
+        {
+            Vector<std::string> fragmentShaderDefines;
+            for(unsigned int i = 0; i < textureDefines.size(); ++i)
+            {
+                if(permutation & (1 << i))
+                    fragmentShaderDefines.pushBack(textureDefines[i]);
+            }
+
+            ShaderProgram* program = getMaterialShaderProgram(vertexShaderDefines, fragmentShaderDefines);
+            if(program->isLinked())
+                ++numLinkedPrograms;
+
+            if(indirectMaterialPrograms && getShaderProgramVariant(program, sd_indirectDraw)->isLinked())
+                ++numLinkedPrograms;
+        }
+    }
+
+    return numLinkedPrograms;
+}
+
 void Renderer::removeMaterial(Material* material)
 {
+    flushFrames();
+
     if(material)
     {
         materials.eraseUnordered(material);
+        materialParameterTable.releaseSlot(material->getParameterSlot());
         delete material;
         material = nullptr;
     }
@@ -361,14 +572,23 @@ void Renderer::removeMaterial(Material* material)
 
 void Renderer::removeGeometry(Geometry* geometry)
 {
+    flushFrames();
+
     if(geometry)
     {
         geometries.eraseUnordered(geometry);
+        geometryAllocator.release(geometry->getAllocation());
         delete geometry;
         geometry = nullptr;
     }
 }
 
+void Renderer::defragmentGeometries()
+{
+    flushFrames();
+    geometryAllocator.defragment();
+}
+
 Texture* Renderer::createMaterialTexture(const std::string& texFileName, TextureSlotIndex slotIndex)
 {
     unsigned int fileNameHash = generateHash((unsigned char*)texFileName.c_str(), texFileName.size());
@@ -400,6 +620,56 @@ Texture* Renderer::createMaterialTexture(const std::string& texFileName, Texture
     return texture;
 }
 
+ShaderProgram* Renderer::getMaterialShaderProgram(const Vector<std::string>& vertexShaderDefines, const Vector<std::string>& fragmentShaderDefines)
+{
+    //Try if the shader program exist.
+    Vector<std::string> shaderFileNames = {materialVertexShader, materialFragmentShader};
+    Vector<std::string> combinedDefines = vertexShaderDefines;
+    combinedDefines.pushBack(fragmentShaderDefines);
+
+    ShaderProgram* program = graphicSystem.getShaderCombination(shaderFileNames, combinedDefines);
+
+    //If the program dont exist, create one.
+    if(!program)
+    {
+        Shader* vShader = graphicSystem.createShader(ShaderType::Vertex, materialVertexShader);
+        Shader* fShader = graphicSystem.createShader(ShaderType::Fragment, materialFragmentShader);
+        vShader->setDefines(vertexShaderDefines);
+        fShader->setDefines(fragmentShaderDefines);
+        program = graphicSystem.createShaderProgram(vShader, fShader);
+        graphicSystem.setShaderProgram(program);
+    }
+
+    return program;
+}
+
+ShaderProgram* Renderer::getShaderProgramVariant(const ShaderProgram* program, const std::string& shaderDefine)
+{
+    waitStageUpdates();
+
+    Shader* vertexShader = program->getVertexShader();
+    Shader* fragmentShader = program->getFragmentShader();
+    Vector<std::string> vertexShaderDefines = vertexShader->getDefines();
+    Vector<std::string> fragmentShaderDefines = fragmentShader->getDefines();
+    vertexShaderDefines.pushBack(shaderDefine);
+    fragmentShaderDefines.pushBack(shaderDefine);
+
+    Vector<std::string> shaderFileNames = {vertexShader->getSourceFileName(), fragmentShader->getSourceFileName()};
+    Vector<std::string> combinedDefines = vertexShaderDefines;
+    combinedDefines.pushBack(fragmentShaderDefines);
+    ShaderProgram* variant = graphicSystem.getShaderCombination(shaderFileNames, combinedDefines);
+
+    if(!variant)
+    {
+        Shader* vShader = graphicSystem.createShader(ShaderType::Vertex, vertexShader->getSourceFileName(), vertexShaderDefines);
+        Shader* fShader = graphicSystem.createShader(ShaderType::Fragment, fragmentShader->getSourceFileName(), fragmentShaderDefines);
+        variant = graphicSystem.createShaderProgram(vShader, fShader);
+        graphicSystem.setShaderProgram(variant);
+    }
+
+    return variant;
+}
+
 void Renderer::createFullScreenQuad()
 {
     float verticesData[] = { -1.0f, 1.0f, 0.0f, -1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, -1.0f, 0.0f };
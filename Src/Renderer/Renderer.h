@@ -25,7 +25,12 @@
 #include "Graphics/GraphicWindow.h"
 #include "Graphics/GraphicSystem.h"
 #include "Renderer/Material.h"
+#include "Renderer/MaterialParameterTable.h"
+#include "Renderer/GeometryAllocator.h"
 #include "Renderer/TextureLoader.h"
+#include "Renderer/RenderStatistics.h"
+#include "Renderer/RenderView.h"
+#include "Renderer/RenderGraph.h"
 #include "Util/WorkQueue.h"
 #include "Scene/SceneCuller.h"
 
@@ -33,6 +38,7 @@ namespace Huurre3D
 {
 
 static const unsigned int WorkQueueSize = 4; //static_cast<int>(std::thread::hardware_concurrency());
+static const unsigned int MaxFrameLatency = 2;
 
 class RenderStage;
 class Scene;
@@ -49,6 +55,7 @@ struct MaterialDescription
     float reflectance = DefaultReflectance;
     float alpha = DefaultAlpha;
     bool skinned = false;
+    std::string name;
     std::string diffuseTextureFile;
     std::string specularTextureFile;
     std::string normalMapTextureFile;
@@ -71,8 +78,15 @@ struct GeometryDescription
     int numIndices = 0;
     IndexType indexType;
     MemoryBuffer indices;
-    GeometryDescription() = default;
-    GeometryDescription(GeometryDescription&& geometryDescription)
+    //Screen size below which the geometry is drawn, when it is a coarser level of another geometry.
+    float lodScreenSize = 0.0f;
+    GeometryDescription():
+    vertexData(MemoryTag::Geometry),
+    indices(MemoryTag::Geometry)
+    {}
+    GeometryDescription(GeometryDescription&& geometryDescription):
+    vertexData(MemoryTag::Geometry),
+    indices(MemoryTag::Geometry)
     {
         boundingBox = geometryDescription.boundingBox;
         primitiveType = geometryDescription.primitiveType;
@@ -82,9 +96,19 @@ struct GeometryDescription
         numIndices = geometryDescription.numIndices;
         indexType = geometryDescription.indexType;
         indices = std::move(geometryDescription.indices);
+        lodScreenSize = geometryDescription.lodScreenSize;
     }
 };
 
+//CPU time in seconds spent in a render stage on the last rendered frame.
+struct RenderStageTiming
+{
+    float updateTime = 0.0f;
+    //Recording of the command list on the worker thread after the update.
+    float recordTime = 0.0f;
+    float executeTime = 0.0f;
+};
+
 struct TextureCacheItem
 {
     unsigned int fileNameHash;
@@ -102,7 +126,14 @@ public:
     bool createRenderWindow(int width, int height, const std::string& windowTitle, bool fullscreen = false, bool vsync = true);
     //Resizes all the needed graphics resources allocated by the renderstages.
     void resizeRenderWindow(int width, int height);
+    //Captures the view of the scene and renders it once the frame latency is reached, the stage updates
+    //of the frame run on the worker threads while the simulation of the next frame changes the scene.
     void renderScene(Scene* scene);
+    //Renders the frames whose views are captured but not yet rendered.
+    void flushFrames();
+    //Number of frames the rendering runs behind the scene update, zero renders each frame before renderScene returns.
+    void setFrameLatency(unsigned int latency);
+    unsigned int getFrameLatency() const {return frameLatency;}
     //Creates as many render items as the number of descriptions.
     void createRenderItems(const Vector<MaterialDescription>& materialDescriptions, const Vector<GeometryDescription>& geometryDescriptions, Vector<RenderItem>& renderItemsOut);
     //Creates multiple render items from one material and geometry description.
@@ -111,21 +142,71 @@ public:
     void createMaterials(const MaterialDescription& materialDescription, Vector<Material*>& materialsOut, unsigned int numMaterials);
     Geometry* createGeometry(const GeometryDescription& geometryDescription);
     void createGeometries(const GeometryDescription& geometryDescription, Vector<Geometry*>& geometriesOut, unsigned int numGeometries);
+    //Creates the level geometries once and adds them to each of the geometries, which are the copies of the geometry the levels were simplified from.
+    void createGeometryLods(const Vector<GeometryDescription>& lodDescriptions, const Vector<Geometry*>& geometries);
+    //Creates the material shader program of every shader define permutation a material can have.
+    //With the shader cache enabled this pre-warms the cache, so the programs are not compiled at load time. Returns the number of linked programs.
+    unsigned int precompileMaterialShaders();
+    //Makes the materials created from now on also have the program variant of the multi-draws, a stage drawing the materials with multi-draws enables this on init.
+    void enableIndirectMaterialPrograms() {indirectMaterialPrograms = true;}
+    bool hasIndirectMaterialPrograms() const {return indirectMaterialPrograms;}
+    //Returns the program built from the same shaders with the define added to both, the program is created when it doesn't exist.
+    ShaderProgram* getShaderProgramVariant(const ShaderProgram* program, const std::string& shaderDefine);
     void removeMaterial(Material* material);
     void removeGeometry(Geometry* geometry);
+    //Compacts the shared vertex and index buffers after geometries have been removed.
+    void defragmentGeometries();
+    const GeometryAllocator& getGeometryAllocator() const {return geometryAllocator;}
     VertexData* getFullScreenQuad() const {return fullScreenQuad;}
     const ViewPort& getScreenViewPort() const {return screenViewPort;}
     GraphicSystem& getGraphicSystem() {return graphicSystem;}
     const GraphicWindow& getGraphicWindow() const {return graphicWindow;}
-    const Vector<unsigned int>& getMaterialBufferIndicies() const {return materialBufferIndicies;}
+    const MaterialParameterTable& getMaterialParameterTable() const {return materialParameterTable;}
     const TextureLoader& getTextureLoader() const {return textureLoader;}
+    //A stage can split its update into tasks, the stage runs a share of them itself while it waits for the rest.
+    WorkQueue<WorkQueueSize>& getWorkQueue() {return workQueue;}
+    const Vector<RenderStage*>& getRenderStages() const {return renderStages;}
+    const RenderGraph& getRenderGraph() const {return renderGraph;}
+    const Vector<RenderStageTiming>& getRenderStageTimings() const {return renderStageTimings;}
+    //Graphic statistics of the last rendered frame, the per stage statistics are in the render stages.
+    const GraphicStatistics& getFrameStatistics() const {return frameStatistics;}
+    //Logs the statistics every interval frames, zero disables the logging.
+    void setStatisticsLogInterval(unsigned int interval) {statisticsLogInterval = interval;}
+    void logRenderStatistics() const;
    
 private:
     Texture* createMaterialTexture(const std::string& texFileName, TextureSlotIndex slotIndex);
+    ShaderProgram* getMaterialShaderProgram(const Vector<std::string>& vertexShaderDefines, const Vector<std::string>& fragmentShaderDefines);
     void createFullScreenQuad();
+    //Starts the stage updates of the oldest captured view on the worker threads.
+    void submitFrame();
+    //Waits for the stage updates of the submitted view and executes the stages.
+    void executeFrame();
+    //Renders the oldest views until at most the given number of captured views are left.
+    void executeFrames(unsigned int numFramesLeft);
+    //Waits for the stage updates, so the resources the stages read can be changed.
+    void waitStageUpdates();
+    //Writes the changed parameters of the materials to their slots, before the stages read the slots.
+    void updateMaterialParameters();
+    //Rebuilds the render graph from the passes of the stages, which culls the unused passes and aliases the render target buffers.
+    void compileRenderGraph();
 
     FixedArray<std::future<void>, 4> stageupdateResults;
     Vector<RenderStage*> renderStages;
+    Vector<RenderStageTiming> renderStageTimings;
+    //The timings the workers write on the frame in flight.
+    Vector<RenderStageTiming> stageUpdateTimings;
+    //Ring of the captured views, the first view is the oldest one not yet executed.
+    FixedArray<RenderView, MaxFrameLatency + 1> renderViews;
+    unsigned int firstRenderView = 0;
+    unsigned int numRenderViews = 0;
+    unsigned int frameLatency = 0;
+    bool stageUpdatesInFlight = false;
+    GraphicStatistics frameStatistics;
+    unsigned int statisticsLogInterval = 0;
+    unsigned int numRenderedFrames = 0;
+    bool indirectMaterialPrograms = false;
+    bool logRenderGraph = false;
     ViewPort screenViewPort;
     VertexData* fullScreenQuad;
     ShaderParameterBlock* cameraShaderParameterBlock;
@@ -135,10 +216,12 @@ private:
 
     Vector<Material*> materials;
     Vector<Geometry*> geometries;
-    Vector<unsigned int> materialBufferIndicies;
+    MaterialParameterTable materialParameterTable;
     Vector<TextureCacheItem> materialTextureCache;
 
     GraphicSystem graphicSystem;
+    GeometryAllocator geometryAllocator;
+    RenderGraph renderGraph;
     GraphicWindow graphicWindow;
     WorkQueue<WorkQueueSize> workQueue;
     TextureLoader textureLoader;
@@ -22,17 +22,31 @@
 #include "Engine/Engine.h"
 #include "Renderer/ShadowStage.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/RenderGraph.h"
 #include "Renderer/Geometry.h"
 #include "Graphics/ShaderParameterBlock.h"
 #include "Scene/Light.h"
 #include "Scene/Camera.h"
 #include "Scene/SceneCuller.h"
+#include <algorithm>
 
 namespace Huurre3D
 {
 
+//Orders the items so that the ones a multi-draw can merge are next to each other.
+static bool compareDepthDrawOrder(const RenderItem& lhs, const RenderItem& rhs)
+{
+    bool lhsSkinned = lhs.material->isSkinned();
+    bool rhsSkinned = rhs.material->isSkinned();
+    if(lhsSkinned != rhsSkinned)
+        return rhsSkinned;
+
+    return lhs.geometry->getVertexData() < rhs.geometry->getVertexData();
+}
+
 ShadowStage::ShadowStage(Renderer& renderer):
-RenderStage(renderer)
+RenderStage(renderer),
+indirectDrawBatcher(renderer.getGraphicSystem())
 {
 }
 
@@ -45,12 +59,42 @@ void ShadowStage::init(const JSONValue& shadowStageJSON)
     {
         shadowDepthRenderPass = createRenderPassFromJson(shadowDepthRenderPassJSON);
         shadowProjector.setShadowMapSize(static_cast<float>(shadowDepthRenderPass.renderTarget->getWidth()));
+
+        //The world transforms are drawn from per-draw parameters with multi-draws.
+        auto indirectDrawsJSON = shadowStageJSON.getJSONValue("indirectDraws");
+        if(!indirectDrawsJSON.isNull() && indirectDrawsJSON.getBool() && shadowDepthRenderPass.shaderPasses.size() > 1)
+        {
+            indirectDraws = true;
+            for(unsigned int i = 0; i < indirectDepthPrograms.size(); ++i)
+                indirectDepthPrograms[i] = renderer.getShaderProgramVariant(shadowDepthRenderPass.shaderPasses[i].program, sd_indirectDraw);
+            indirectDrawBatcher.reserve(InitialIndirectDrawBatches);
+        }
+    }
+
+    //The casters are culled by their size projected to the main camera, a caster too small to see casts too small a shadow to see.
+    auto contributionCullingJSON = shadowStageJSON.getJSONValue("contributionCulling");
+    if(!contributionCullingJSON.isNull())
+    {
+        contributionCulling = true;
+        initContributionCuller(contributionCullingJSON, contributionCuller);
+        auto splitScreenSizeScaleJSON = contributionCullingJSON.getJSONValue("splitScreenSizeScale");
+        if(!splitScreenSizeScaleJSON.isNull())
+            splitScreenSizeScale = splitScreenSizeScaleJSON.getFloat();
+    }
+
+    //The levels are selected by the size projected to the main camera, a bias of its own lets the shadows use coarser levels than the view.
+    auto lodJSON = shadowStageJSON.getJSONValue("lod");
+    if(!lodJSON.isNull())
+    {
+        lodSelection = true;
+        initLodSelector(lodJSON, lodSelector);
     }
 
     if(!shadowOcclusionRenderPassJSON.isNull())
     {
         shadowOcllusionRenderPass = createRenderPassFromJson(shadowOcclusionRenderPassJSON);
         shadowOcllusionRenderPass.shaderPasses[0].shaderParameters.pushBack(ShaderParameter(sp_shadowOcclusionParameterIndex, 0));
+        shadowOcllusionRenderPass.shaderPasses[0].shaderParameterBlocks[0]->setStreamed(true);
     }
 }
 
@@ -61,40 +105,63 @@ void ShadowStage::resizeResources()
     shadowOcllusionRenderPass.renderTarget->setSize(screenViewPort.width, screenViewPort.height);
 }
 
-void ShadowStage::update(const Scene& scene)
+void ShadowStage::prepare(RenderView& view)
 {
-    scene.getAllRenderItems(shadowRenderItems);
-    Camera* camera = scene.getMainCamera();
-    Frustum worldSpaceCameraViewFrustum = camera->getViewFrustumInWorldSpace();
-    Vector<Light*> lights;
-    cullLights(scene, lights, worldSpaceCameraViewFrustum);
-    lights.findItems([](const Light* light) {return light->getCastShadow(); }, shadowLights);
+    Frustum worldSpaceCameraViewFrustum = view.camera.getViewFrustumInWorldSpace();
+    Vector<const Light*> lights;
+    cullLights(view, lights, worldSpaceCameraViewFrustum, &statistics.culling);
 
-    if(!shadowLights.empty())
+    //The masks are set to the lights of the view, which the lighting stage reads in its update.
+    for(unsigned int i = 0; i < lights.size(); ++i)
     {
-        for(unsigned int i = 0; i < shadowLights.size(); ++i)
-        {
-            int mask = 1 << i;
-            shadowLights[i]->setShadowOcclusionMask(mask);
-        }
+        if(lights[i]->getCastShadow())
+            shadowLights.pushBack(view.lights.begin() + (lights[i] - view.lights.begin()));
+    }
+
+    for(unsigned int i = 0; i < shadowLights.size(); ++i)
+    {
+        int mask = 1 << i;
+        shadowLights[i]->setShadowOcclusionMask(mask);
+    }
+}
+
+void ShadowStage::update(const RenderView& view)
+{
+    const Camera* camera = &view.camera;
 
+    if(!shadowLights.empty())
+    {
         calculateShadowCameraViewProjections(shadowLights, camera);
-        createLightShadowPasses(shadowRenderItems);
+        if(lodSelection)
+            lodSelector.setCamera(view.camera);
+        if(contributionCulling)
+            contributionCuller.setCamera(view.camera);
+        createLightShadowPasses(view);
         shadowOcllusionRenderPass.shaderPasses[0].shaderParameterBlocks[0]->setParameterData(shadowOcclusionData.getMemoryBuffer());
     }
 }
 
+void ShadowStage::addRenderPasses(RenderGraph& renderGraph)
+{
+    if(shadowDepthRenderPass.renderTarget)
+        renderGraph.addPass(name + "[shadowDepth]", &shadowDepthRenderPass);
+    if(shadowOcllusionRenderPass.renderTarget)
+        renderGraph.addPass(name + "[shadowOcclusion]", &shadowOcllusionRenderPass);
+}
+
 void ShadowStage::clearStage()
 {
-    shadowRenderItems.clear();
     shadowLights.clear();
     renderPasses.clear();
     shadowDepthData.clear();
     shadowOcclusionData.clear();
     shadowOcllusionRenderPass.shaderPasses[0].shaderParameterBlocks[0]->clearParameters();
+
+    if(indirectDraws)
+        indirectDrawBatcher.reset();
 }
 
-void ShadowStage::calculateShadowCameraViewProjections(const Vector<Light*>& lights, Camera* camera)
+void ShadowStage::calculateShadowCameraViewProjections(const Vector<Light*>& lights, const Camera* camera)
 {
     Vector<Light*> pointLights;
     Vector<Light*> spotLights;
@@ -115,18 +182,30 @@ void ShadowStage::calculateShadowCameraViewProjections(const Vector<Light*>& lig
 
 }
 
-void ShadowStage::createLightShadowPasses(const Vector<RenderItem>& renderItems)
+void ShadowStage::createLightShadowPasses(const RenderView& view)
 {
     Frustum shadowFrustum;
+    unsigned int numSplits = 0;
     
     for(unsigned int i = 0; i < shadowDepthData.size(); ++i)
     {
-        for(int j = 0; j < shadowDepthData[i].numSplits; ++j)
+        float screenSizeScale = 1.0f;
+        for(int j = 0; j < shadowDepthData[i].numSplits; ++j, screenSizeScale *= splitScreenSizeScale)
         {
             //Cull the items which are in the shadow light's frustum.
             itemsInShadowfrustum.clear();
-            shadowFrustum.set(shadowDepthData[i].shadowViewProjectionMatrices[j].transpose());
-            cullRenderItems(renderItems, itemsInShadowfrustum, shadowFrustum);
+            const Matrix4x4& shadowViewProjection = shadowDepthData[i].shadowViewProjectionMatrices[j];
+            shadowFrustum.set(shadowViewProjection.transpose());
+            while(shadowVisibilityCaches.size() <= numSplits)
+                shadowVisibilityCaches.pushBack(VisibilityCache());
+            shadowVisibilityCaches[numSplits++].cullRenderItems(view, shadowFrustum, shadowViewProjection, itemsInShadowfrustum, &statistics.culling);
+            if(contributionCulling)
+                contributionCuller.cullRenderItems(itemsInShadowfrustum, screenSizeScale, &statistics.culling);
+            if(lodSelection)
+                lodSelector.selectLods(itemsInShadowfrustum, &statistics.lods);
+
+            if(indirectDraws)
+                std::sort(itemsInShadowfrustum.begin(), itemsInShadowfrustum.end(), compareDepthDrawOrder);
 
             shadowDepthRenderPass.renderTargetLayer = j;
             renderPasses.pushBack(shadowDepthRenderPass);
@@ -134,14 +213,25 @@ void ShadowStage::createLightShadowPasses(const Vector<RenderItem>& renderItems)
             ShaderPass depthShaderPass;
             for(unsigned int k = 0; k < itemsInShadowfrustum.size(); ++k)
             {
-                if(!itemsInShadowfrustum[k].material->isSkinned())
-                    depthShaderPass = shadowDepthRenderPass.shaderPasses[0];
-                else
-                    depthShaderPass = shadowDepthRenderPass.shaderPasses[1];
-
-                depthShaderPass.vertexData = itemsInShadowfrustum[k].geometry->getVertexData();
-                depthShaderPass.shaderParameters.pushBack(ShaderParameter(sp_worldTransform, itemsInShadowfrustum[k].geometry->getWorldTransform()));
+                unsigned int depthPassIndex = itemsInShadowfrustum[k].material->isSkinned() ? 1 : 0;
+                depthShaderPass = shadowDepthRenderPass.shaderPasses[depthPassIndex];
+
+                const Geometry* geometry = itemsInShadowfrustum[k].geometry;
+                depthShaderPass.vertexData = geometry->getVertexData();
+                depthShaderPass.firstIndex = geometry->getFirstIndex();
+                depthShaderPass.numIndices = geometry->getNumIndices();
+                depthShaderPass.baseVertex = geometry->getBaseVertex();
                 depthShaderPass.shaderParameters.pushBack(ShaderParameter(sp_lightViewProjectionMatrix, shadowDepthData[i].shadowViewProjectionMatrices[j]));
+
+                if(indirectDraws)
+                {
+                    depthShaderPass.program = indirectDepthPrograms[depthPassIndex];
+                    if(indirectDrawBatcher.addDraw(renderPasses.back().shaderPasses, depthShaderPass, itemsInShadowfrustum[k].worldTransform, 0))
+                        continue;
+                    depthShaderPass.program = shadowDepthRenderPass.shaderPasses[depthPassIndex].program;
+                }
+
+                depthShaderPass.shaderParameters.pushBack(ShaderParameter(sp_worldTransform, itemsInShadowfrustum[k].worldTransform));
                 renderPasses.back().shaderPasses.pushBack(depthShaderPass);
             }
         }
@@ -24,6 +24,8 @@
 
 #include "Renderer/RenderStage.h"
 #include "Renderer/ShadowProjector.h"
+#include "Renderer/IndirectDrawBatcher.h"
+#include "Scene/VisibilityCache.h"
 
 namespace Huurre3D
 {
@@ -42,20 +44,35 @@ public:
     void clearStage() override;
     void init(const JSONValue& shadowStageJSON) override;
     void resizeResources() override;
-    void update(const Scene& scene) override;
+    //Assigns the shadow occlusion masks of the lights, which the lighting stage reads in its update.
+    void prepare(RenderView& view) override;
+    void update(const RenderView& view) override;
+    //The passes of each frame are copies of the depth and occlusion passes, so the graph culls the templates.
+    void addRenderPasses(RenderGraph& renderGraph) override;
 
 private:
-    void calculateShadowCameraViewProjections(const Vector<Light*>& lights, Camera* camera);
+    void calculateShadowCameraViewProjections(const Vector<Light*>& lights, const Camera* camera);
     void drawShadowDepthPasses();
-    void createLightShadowPasses(const Vector<RenderItem>& renderItems);
+    void createLightShadowPasses(const RenderView& view);
     Vector<Light*> shadowLights;
-    Vector<RenderItem> shadowRenderItems;
     RenderPass shadowOcllusionRenderPass;
     RenderPass shadowDepthRenderPass;
     ShadowProjector shadowProjector;
     Vector<RenderItem> itemsInShadowfrustum;
+    //One for each split of each shadow light in the order they are culled, a split whose light and camera stay still culls only the moved meshes.
+    Vector<VisibilityCache> shadowVisibilityCaches;
     Vector<ShadowDepthData> shadowDepthData;
     Vector<ShadowOcclusionData> shadowOcclusionData;
+    IndirectDrawBatcher indirectDrawBatcher;
+    LodSelector lodSelector;
+    ContributionCuller contributionCuller;
+    //Multiplies the minimum screen size of the contribution culling on each split after the first, the farther splits have coarser texels.
+    float splitScreenSizeScale = 1.0f;
+    //Multi-draw variants of the non-skinned and skinned depth pass programs.
+    FixedArray<ShaderProgram*, 2> indirectDepthPrograms;
+    bool indirectDraws = false;
+    bool lodSelection = false;
+    bool contributionCulling = false;
 };
 
 }
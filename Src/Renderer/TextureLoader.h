@@ -31,6 +31,10 @@ namespace Huurre3D
 
 struct TextureLoadResult
 {
+    TextureLoadResult():
+    pixelData(MemoryTag::Texture)
+    {}
+
     TextureTargetMode targetMode;
     int width;
     int height;
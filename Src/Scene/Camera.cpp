@@ -67,12 +67,12 @@ void Camera::setProjectionType(ProjectionType projectionType)
         setDirty();
 }
 
-Matrix4x4 Camera::getViewProjectionMatrix()
+Matrix4x4 Camera::getViewProjectionMatrix() const
 { 
     return projectionMatrix * getViewMatrix(); 
 }
 
-Frustum Camera::getViewFrustumInWorldSpace()
+Frustum Camera::getViewFrustumInWorldSpace() const
 {
     //ViewProjection -> frustum planes in world sapce.
     return Frustum(getViewProjectionMatrix().transpose());
@@ -56,8 +56,8 @@ public:
     void setAspectRatio(float aspectRatio);
     void setProjectionType(ProjectionType projectionType);
     void setShaderParameterBlock(ShaderParameterBlock* shaderParameterBlock);
-    Matrix4x4 getViewProjectionMatrix();
-    Frustum getViewFrustumInWorldSpace();
+    Matrix4x4 getViewProjectionMatrix() const;
+    Frustum getViewFrustumInWorldSpace() const;
     void getCameraShaderParameterBlock(ShaderParameterBlock* cameraShaderParameterBlock) const;
     void updateItem() override;
     const Frustum& getViewFrustum() const {return viewFrustum;}
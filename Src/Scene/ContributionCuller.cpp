@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Scene/ContributionCuller.h"
+#include "Renderer/Material.h"
+#include "Math/MathFunctions.h"
+
+namespace Huurre3D
+{
+
+void ContributionCuller::setMaterialThresholds(const std::string& materialName, const ContributionThresholds& thresholds)
+{
+    unsigned int nameHash = generateHash(reinterpret_cast<const unsigned char*>(materialName.c_str()), materialName.size());
+    for(unsigned int i = 0; i < materialThresholds.size(); ++i)
+    {
+        if(materialThresholds[i].materialNameHash == nameHash)
+        {
+            materialThresholds[i].thresholds = thresholds;
+            return;
+        }
+    }
+
+    materialThresholds.pushBack({nameHash, thresholds});
+}
+
+void ContributionCuller::setCamera(const Camera& camera)
+{
+    cameraPosition = camera.getPosition(FrameOfReference::World);
+    projectionScale = 1.0f / tan(camera.getFov() * DEGTORAD * 0.5f);
+}
+
+void ContributionCuller::cullRenderItems(Vector<RenderItem>& items, float sizeScale, CullingStatistics* statistics) const
+{
+    unsigned int numItems = 0;
+    unsigned int numTooSmall = 0;
+    unsigned int numTooFar = 0;
+
+    for(unsigned int i = 0; i < items.size(); ++i)
+    {
+        const RenderItem& item = items[i];
+        const ContributionThresholds& itemThresholds = getItemThresholds(item);
+
+        if(itemThresholds.maxDistance > 0.0f)
+        {
+            Vector3 offset = item.worldBoundingBox.getCenter() - cameraPosition;
+            float maxDistance = itemThresholds.maxDistance + item.worldBoundingBox.getHalfSize().length();
+            if(offset.lengthSquared() > maxDistance * maxDistance)
+            {
+                ++numTooFar;
+                continue;
+            }
+        }
+
+        if(itemThresholds.minScreenSize > 0.0f && getProjectedSize(item.worldBoundingBox, cameraPosition, projectionScale) < itemThresholds.minScreenSize * sizeScale)
+        {
+            ++numTooSmall;
+            continue;
+        }
+
+        if(numItems != i)
+            items[numItems] = item;
+        ++numItems;
+    }
+
+    while(items.size() > numItems)
+        items.popBack();
+
+    if(statistics)
+    {
+        statistics->itemsTooSmall += numTooSmall;
+        statistics->itemsTooFar += numTooFar;
+    }
+}
+
+const ContributionThresholds& ContributionCuller::getItemThresholds(const RenderItem& item) const
+{
+    if(!materialThresholds.empty())
+    {
+        unsigned int nameHash = item.material->getNameHash();
+        for(unsigned int i = 0; i < materialThresholds.size(); ++i)
+        {
+            if(materialThresholds[i].materialNameHash == nameHash)
+                return materialThresholds[i].thresholds;
+        }
+    }
+
+    return thresholds;
+}
+
+}
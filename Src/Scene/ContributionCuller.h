@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ContributionCuller_H
+#define ContributionCuller_H
+
+#include "Scene/SceneCuller.h"
+
+namespace Huurre3D
+{
+
+//Zero disables the threshold.
+struct ContributionThresholds
+{
+    //Projected diameter of the bounding sphere relative to the view height.
+    float minScreenSize = 0.0f;
+    float maxDistance = 0.0f;
+};
+
+struct MaterialContributionThresholds
+{
+    unsigned int materialNameHash;
+    ContributionThresholds thresholds;
+};
+
+//Culls the render items which contribute too little to a view, the ones whose bounding sphere projects smaller than the minimum 
+//screen size and the ones farther than the maximum distance. The materials of a name can have thresholds of their own instead of
+//the thresholds of the pass.
+class ContributionCuller
+{
+public:
+    ContributionCuller() = default;
+    ~ContributionCuller() = default;
+
+    void setThresholds(const ContributionThresholds& thresholds) {this->thresholds = thresholds;}
+    void setMaterialThresholds(const std::string& materialName, const ContributionThresholds& thresholds);
+    //The sizes and distances are measured from the camera until it is set again.
+    void setCamera(const Camera& camera);
+    //The minimum screen sizes are multiplied by the size scale, so the passes drawing a coarser view can cull more.
+    void cullRenderItems(Vector<RenderItem>& items, float sizeScale = 1.0f, CullingStatistics* statistics = nullptr) const;
+    const ContributionThresholds& getThresholds() const {return thresholds;}
+
+private:
+    const ContributionThresholds& getItemThresholds(const RenderItem& item) const;
+
+    ContributionThresholds thresholds;
+    Vector<MaterialContributionThresholds> materialThresholds;
+    Vector3 cameraPosition;
+    //Inverse of the tangent of the half of the vertical field of view.
+    float projectionScale = 1.0f;
+};
+
+}
+
+#endif
@@ -64,8 +64,8 @@ public:
     void setInnerConeAngle(float angle);
     void setCascadeSplits(const FixedArray<float, 4>& splits);
     LightType getLightType() const {return lightType;}
-    float getRadius() {return radius;}
-    float getFallOffExponent() {return fallOffExponent;}
+    float getRadius() const {return radius;}
+    float getFallOffExponent() const {return fallOffExponent;}
     const Vector3& getDirection() const {return direction;}
     const Sphere& getBoundingSphere() const {return boundingSphere;}
     const Vector3& getColor() const {return color;}
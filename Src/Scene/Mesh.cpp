@@ -22,6 +22,7 @@
 #include "Scene/Mesh.h"
 #include "Scene/Joint.h"
 #include "Renderer/Geometry.h"
+#include "Math/TransformKernels.h"
 
 namespace Huurre3D
 {
@@ -30,12 +31,16 @@ SCENEITEM_TYPE_IMPL(Mesh);
 
 Mesh::~Mesh()
 {
+    for(unsigned int i = 0; i < renderItems.size(); ++i)
+        scene->releaseRenderItemId(renderItems[i].id);
+
 //    scene->removeSceneItems(skeleton);
 }
 
 void Mesh::addRenderItem(const RenderItem& renderItem)
 {
     renderItems.pushBack(renderItem);
+    renderItems.back().id = scene->createRenderItemId();
 
     if(!dirty)
         setDirty();
@@ -43,7 +48,10 @@ void Mesh::addRenderItem(const RenderItem& renderItem)
 
 void Mesh::addRenderItems(const Vector<RenderItem>& renderItems)
 {
+    unsigned int firstItem = this->renderItems.size();
     this->renderItems.pushBack(renderItems);
+    for(unsigned int i = firstItem; i < this->renderItems.size(); ++i)
+        this->renderItems[i].id = scene->createRenderItemId();
 
     if(!dirty)
         setDirty();
@@ -52,6 +60,7 @@ void Mesh::addRenderItems(const Vector<RenderItem>& renderItems)
 void Mesh::addRenderItem(Geometry *geometry, Material* material)
 {
     renderItems.pushBack(RenderItem(material, geometry));
+    renderItems.back().id = scene->createRenderItemId();
 		
     if(!dirty)
         setDirty();
@@ -66,13 +75,33 @@ void Mesh::updateItem()
     {
         for(unsigned int i = 0; i < renderItems.size(); ++i)
             boundingBox.mergeBoundingBox(renderItems[i].geometry->getBoundingBox());
+
+        //The first box is the box of the whole mesh, followed by the boxes of the render items.
+        boundingBoxes.clear();
+        boundingBoxes.pushBack(boundingBox);
+        for(unsigned int i = 0; i < renderItems.size(); ++i)
+            boundingBoxes.pushBack(renderItems[i].geometry->getBoundingBox());
+
+        while(worldBoundingBoxes.size() < boundingBoxes.size())
+            worldBoundingBoxes.pushBack(BoundingBox());
 		
         dirty = false;
     }
 
-    for(unsigned int i = 0; i < renderItems.size(); ++i)
-        renderItems[i].geometry->setWorldTransform(getWorldTransform4x4());
+    if(!boundingBoxes.empty())
+    {
+        const Matrix4x4& worldTransform = getWorldTransform4x4();
+        transformBoundingBoxes(boundingBoxes.begin(), worldTransform, worldBoundingBoxes.begin(), boundingBoxes.size());
+        worldBoundingBox = worldBoundingBoxes[0];
+
+        for(unsigned int i = 0; i < renderItems.size(); ++i)
+        {
+            renderItems[i].worldTransform = worldTransform;
+            renderItems[i].worldBoundingBox = worldBoundingBoxes[i + 1];
+        }
+    }
 
+    updateVersion = scene->createChangeVersion();
     settedForUpdate = false;
 }
 
@@ -53,12 +53,23 @@ public:
     AnimationClip* getAnimationClip(unsigned int index) const;
     const Vector<RenderItem>& getRenderItems() const {return renderItems;}
     const BoundingBox& getBoundingBox() const {return boundingBox;}
+    const BoundingBox& getWorldBoundingBox() const {return worldBoundingBox;}
+    //The box of an occluder is rasterized by the occlusion culling, so the mesh has to cover its whole box, like walls and buildings do.
+    void setOccluder(bool occluder) {this->occluder = occluder;}
+    bool isOccluder() const {return occluder;}
+    //Change version of the scene on the last update of the mesh, when its transform or items changed.
+    unsigned int getUpdateVersion() const {return updateVersion;}
 
 private:
     Vector<RenderItem> renderItems;
     BoundingBox boundingBox;
+    BoundingBox worldBoundingBox;
+    Vector<BoundingBox> boundingBoxes;
+    Vector<BoundingBox> worldBoundingBoxes;
     Vector<Joint*> skeleton;
     Vector<AnimationClip*> animationClips;
+    bool occluder = false;
+    unsigned int updateVersion = 0;
 };
 
 }
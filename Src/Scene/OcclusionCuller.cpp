@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Scene/OcclusionCuller.h"
+#include "Math/Frustum.h"
+#include "Math/SIMD.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Huurre3D
+{
+
+//Two triangles for each face of a box, the corner index has x in bit 0, y in bit 1 and z in bit 2.
+static const unsigned int boxTriangleIndices[36] =
+{
+    0, 2, 1, 1, 2, 3,
+    4, 5, 6, 5, 7, 6,
+    0, 1, 4, 1, 5, 4,
+    2, 6, 3, 3, 6, 7,
+    0, 4, 2, 2, 4, 6,
+    1, 3, 5, 3, 7, 5
+};
+
+static float simdHorizontalMin(SimdFloat4 v)
+{
+    SimdFloat4 result = simdMin(v, simdShuffle<2, 3, 0, 1>(v));
+    result = simdMin(result, simdShuffle<1, 0, 3, 2>(result));
+    return simdGetX(result);
+}
+
+static float simdHorizontalMax(SimdFloat4 v)
+{
+    SimdFloat4 result = simdMax(v, simdShuffle<2, 3, 0, 1>(v));
+    result = simdMax(result, simdShuffle<1, 0, 3, 2>(result));
+    return simdGetX(result);
+}
+
+//Clips the triangle in the clip space against the plane w = nearW, the result has up to four vertices.
+static unsigned int clipTriangleToNearPlane(const Vector4* vertices, float nearW, Vector4* verticesOut)
+{
+    unsigned int numVertices = 0;
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        const Vector4& a = vertices[i];
+        const Vector4& b = vertices[(i + 1) % 3];
+        bool aInside = a.w >= nearW;
+        bool bInside = b.w >= nearW;
+
+        if(aInside)
+            verticesOut[numVertices++] = a;
+        if(aInside != bInside)
+            verticesOut[numVertices++] = a + (b - a) * ((nearW - a.w) / (b.w - a.w));
+    }
+
+    return numVertices;
+}
+
+void OcclusionCuller::setResolution(unsigned int width, unsigned int height)
+{
+    this->width = (std::max(width, 4u) + 3) & ~3u;
+    this->height = std::max(height, 1u);
+    depthBuffer.resize(this->width * this->height);
+    depthBuffer.fill(0.0f);
+
+    minLevels.clear();
+    maxLevels.clear();
+    levelWidths.clear();
+    levelHeights.clear();
+    unsigned int levelWidth = this->width;
+    unsigned int levelHeight = this->height;
+    levelWidths.pushBack(levelWidth);
+    levelHeights.pushBack(levelHeight);
+
+    while(levelWidth > 1 || levelHeight > 1)
+    {
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+        levelWidths.pushBack(levelWidth);
+        levelHeights.pushBack(levelHeight);
+        minLevels.pushBack(Vector<float>(levelWidth * levelHeight));
+        maxLevels.pushBack(Vector<float>(levelWidth * levelHeight));
+        minLevels.back().fill(0.0f);
+        maxLevels.back().fill(0.0f);
+    }
+}
+
+unsigned int OcclusionCuller::setupOccluders(const RenderView& view)
+{
+    triangles.clear();
+    candidates.clear();
+    if(width == 0)
+        return 0;
+
+    viewProjection = view.camera.getViewProjectionMatrix();
+    nearClipDistance = view.camera.getNearClipDistance();
+    Frustum frustum = view.camera.getViewFrustumInWorldSpace();
+    Vector3 cameraPosition = view.camera.getPosition(FrameOfReference::World);
+
+    //The squared size of the box over the squared distance to it estimates the screen area.
+    for(unsigned int i = 0; i < view.occluders.size(); ++i)
+    {
+        BoundingBox worldBoundingBox = view.occluders[i].boundingBox.transformed(view.occluders[i].worldTransform);
+        if(frustum.isInsideNoIntersection(worldBoundingBox))
+        {
+            float distanceSquared = (worldBoundingBox.getCenter() - cameraPosition).lengthSquared();
+            OccluderCandidate candidate = {worldBoundingBox.getSize().lengthSquared() / std::max(distanceSquared, 0.0001f), i};
+            candidates.pushBack(candidate);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const OccluderCandidate& lhs, const OccluderCandidate& rhs){return lhs.screenArea > rhs.screenArea;});
+    unsigned int numOccluders = std::min(candidates.size(), maxOccluders);
+
+    for(unsigned int i = 0; i < numOccluders; ++i)
+    {
+        const OccluderBox& occluder = view.occluders[candidates[i].occluderIndex];
+        Matrix4x4 transform = viewProjection * occluder.worldTransform;
+        const Vector3& min = occluder.boundingBox.getMin();
+        const Vector3& max = occluder.boundingBox.getMax();
+
+        Vector4 corners[8];
+        for(unsigned int j = 0; j < 8; ++j)
+            corners[j] = transform * Vector4((j & 1) ? max.x : min.x, (j & 2) ? max.y : min.y, (j & 4) ? max.z : min.z, 1.0f);
+
+        for(unsigned int j = 0; j < 36; j += 3)
+        {
+            Vector4 vertices[3] = {corners[boxTriangleIndices[j]], corners[boxTriangleIndices[j + 1]], corners[boxTriangleIndices[j + 2]]};
+            Vector4 clippedVertices[4];
+            unsigned int numClippedVertices = clipTriangleToNearPlane(vertices, nearClipDistance, clippedVertices);
+            for(unsigned int k = 2; k < numClippedVertices; ++k)
+                addOccluderTriangle(clippedVertices[0], clippedVertices[k - 1], clippedVertices[k]);
+        }
+    }
+
+    return numOccluders;
+}
+
+void OcclusionCuller::rasterizeBand(unsigned int band)
+{
+    int firstRow = band * OcclusionBandHeight;
+    int lastRow = std::min(firstRow + static_cast<int>(OcclusionBandHeight), static_cast<int>(height)) - 1;
+    std::fill(depthBuffer.begin() + firstRow * width, depthBuffer.begin() + (lastRow + 1) * width, 0.0f);
+
+    const SimdFloat4 zero = simdSplat(0.0f);
+    const SimdFloat4 pixelCenters = simdSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+    for(unsigned int i = 0; i < triangles.size(); ++i)
+    {
+        const OcclusionTriangle& triangle = triangles[i];
+        int minY = std::max(triangle.minY, firstRow);
+        int maxY = std::min(triangle.maxY, lastRow);
+        if(minY > maxY)
+            continue;
+
+        //Four texels are covered at a time from a multiple of four, the width is a multiple of four too.
+        int minX = triangle.minX & ~3;
+        SimdFloat4 x = simdAdd(simdSplat(static_cast<float>(minX)), pixelCenters);
+        SimdFloat4 edgeA0 = simdSplat(triangle.edgeA[0]);
+        SimdFloat4 edgeA1 = simdSplat(triangle.edgeA[1]);
+        SimdFloat4 edgeA2 = simdSplat(triangle.edgeA[2]);
+        SimdFloat4 depthA = simdSplat(triangle.depthA);
+        SimdFloat4 edgeStep0 = simdSplat(triangle.edgeA[0] * 4.0f);
+        SimdFloat4 edgeStep1 = simdSplat(triangle.edgeA[1] * 4.0f);
+        SimdFloat4 edgeStep2 = simdSplat(triangle.edgeA[2] * 4.0f);
+        SimdFloat4 depthStep = simdSplat(triangle.depthA * 4.0f);
+
+        for(int y = minY; y <= maxY; ++y)
+        {
+            float pixelY = static_cast<float>(y) + 0.5f;
+            SimdFloat4 edge0 = simdMulAdd(edgeA0, x, simdSplat(triangle.edgeB[0] * pixelY + triangle.edgeC[0]));
+            SimdFloat4 edge1 = simdMulAdd(edgeA1, x, simdSplat(triangle.edgeB[1] * pixelY + triangle.edgeC[1]));
+            SimdFloat4 edge2 = simdMulAdd(edgeA2, x, simdSplat(triangle.edgeB[2] * pixelY + triangle.edgeC[2]));
+            SimdFloat4 depth = simdMulAdd(depthA, x, simdSplat(triangle.depthB * pixelY + triangle.depthC));
+            float* row = depthBuffer.begin() + y * width;
+
+            for(int blockX = minX; blockX <= triangle.maxX; blockX += 4)
+            {
+                SimdFloat4 inside = simdGreaterEqual(simdMin(edge0, simdMin(edge1, edge2)), zero);
+                SimdFloat4 current = simdLoad(row + blockX);
+                simdStore(row + blockX, simdSelect(inside, simdMax(current, depth), current));
+                edge0 = simdAdd(edge0, edgeStep0);
+                edge1 = simdAdd(edge1, edgeStep1);
+                edge2 = simdAdd(edge2, edgeStep2);
+                depth = simdAdd(depth, depthStep);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildHierarchy()
+{
+    for(unsigned int level = 1; level < levelWidths.size(); ++level)
+    {
+        const float* sourceMin = level == 1 ? depthBuffer.begin() : minLevels[level - 2].begin();
+        const float* sourceMax = level == 1 ? depthBuffer.begin() : maxLevels[level - 2].begin();
+        float* levelMin = minLevels[level - 1].begin();
+        float* levelMax = maxLevels[level - 1].begin();
+        unsigned int sourceWidth = levelWidths[level - 1];
+        unsigned int sourceHeight = levelHeights[level - 1];
+
+        for(unsigned int y = 0; y < levelHeights[level]; ++y)
+        {
+            unsigned int row0 = 2 * y * sourceWidth;
+            unsigned int row1 = std::min(2 * y + 1, sourceHeight - 1) * sourceWidth;
+            for(unsigned int x = 0; x < levelWidths[level]; ++x)
+            {
+                unsigned int x0 = 2 * x;
+                unsigned int x1 = std::min(2 * x + 1, sourceWidth - 1);
+                unsigned int index = y * levelWidths[level] + x;
+                levelMin[index] = std::min(std::min(sourceMin[row0 + x0], sourceMin[row0 + x1]), std::min(sourceMin[row1 + x0], sourceMin[row1 + x1]));
+                levelMax[index] = std::max(std::max(sourceMax[row0 + x0], sourceMax[row0 + x1]), std::max(sourceMax[row1 + x0], sourceMax[row1 + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isOccluded(const BoundingBox& worldBoundingBox) const
+{
+    if(triangles.empty())
+        return false;
+
+    //The corners are the sums of the columns scaled by the minimum or maximum of each axis.
+    const Vector3& min = worldBoundingBox.getMin();
+    const Vector3& max = worldBoundingBox.getMax();
+    SimdFloat4 column3 = simdLoad(viewProjection[3].toArray());
+    SimdFloat4 minX = simdMul(simdLoad(viewProjection[0].toArray()), simdSplat(min.x));
+    SimdFloat4 maxX = simdMul(simdLoad(viewProjection[0].toArray()), simdSplat(max.x));
+    SimdFloat4 minY = simdMul(simdLoad(viewProjection[1].toArray()), simdSplat(min.y));
+    SimdFloat4 maxY = simdMul(simdLoad(viewProjection[1].toArray()), simdSplat(max.y));
+    SimdFloat4 minZ = simdMulAdd(simdLoad(viewProjection[2].toArray()), simdSplat(min.z), column3);
+    SimdFloat4 maxZ = simdMulAdd(simdLoad(viewProjection[2].toArray()), simdSplat(max.z), column3);
+
+    //Transposed, the rows are the x, y, z and w of four corners.
+    SimdFloat4 cornersXY[4] = {simdAdd(minX, minY), simdAdd(maxX, minY), simdAdd(minX, maxY), simdAdd(maxX, maxY)};
+    SimdFloat4 corners0[4] = {simdAdd(cornersXY[0], minZ), simdAdd(cornersXY[1], minZ), simdAdd(cornersXY[2], minZ), simdAdd(cornersXY[3], minZ)};
+    SimdFloat4 corners1[4] = {simdAdd(cornersXY[0], maxZ), simdAdd(cornersXY[1], maxZ), simdAdd(cornersXY[2], maxZ), simdAdd(cornersXY[3], maxZ)};
+    simdTranspose(corners0[0], corners0[1], corners0[2], corners0[3]);
+    simdTranspose(corners1[0], corners1[1], corners1[2], corners1[3]);
+
+    //A box crossing the near plane is treated as visible.
+    SimdFloat4 nearW = simdSplat(nearClipDistance);
+    if(simdAnyLess(corners0[3], nearW) || simdAnyLess(corners1[3], nearW))
+        return false;
+
+    SimdFloat4 one = simdSplat(1.0f);
+    SimdFloat4 inverseW0 = simdDiv(one, corners0[3]);
+    SimdFloat4 inverseW1 = simdDiv(one, corners1[3]);
+    SimdFloat4 screenX0 = simdMul(corners0[0], inverseW0);
+    SimdFloat4 screenX1 = simdMul(corners1[0], inverseW1);
+    SimdFloat4 screenY0 = simdMul(corners0[1], inverseW0);
+    SimdFloat4 screenY1 = simdMul(corners1[1], inverseW1);
+    float nearestDepth = simdHorizontalMax(simdMax(inverseW0, inverseW1));
+
+    float screenMinX = (simdHorizontalMin(simdMin(screenX0, screenX1)) * 0.5f + 0.5f) * width;
+    float screenMaxX = (simdHorizontalMax(simdMax(screenX0, screenX1)) * 0.5f + 0.5f) * width;
+    float screenMinY = (simdHorizontalMin(simdMin(screenY0, screenY1)) * 0.5f + 0.5f) * height;
+    float screenMaxY = (simdHorizontalMax(simdMax(screenY0, screenY1)) * 0.5f + 0.5f) * height;
+
+    //The frustum culling decides for the boxes outside the screen.
+    if(screenMaxX < 0.0f || screenMaxY < 0.0f || screenMinX >= width || screenMinY >= height)
+        return false;
+
+    //A texel is covered by an occluder when its center is, so a texel on the edge of an occluder can be partly uncovered.
+    //The rectangle is grown by a texel to reach the uncovered neighbour of such a texel, which keeps the test conservative.
+    int rectMinX = std::max(static_cast<int>(std::max(screenMinX, 0.0f)) - 1, 0);
+    int rectMinY = std::max(static_cast<int>(std::max(screenMinY, 0.0f)) - 1, 0);
+    int rectMaxX = std::min(static_cast<int>(std::min(screenMaxX, static_cast<float>(width - 1))) + 1, static_cast<int>(width) - 1);
+    int rectMaxY = std::min(static_cast<int>(std::min(screenMaxY, static_cast<float>(height - 1))) + 1, static_cast<int>(height) - 1);
+
+    //The test starts from the level where the rectangle covers at most two by two texels.
+    unsigned int level = 0;
+    while((rectMaxX >> level) - (rectMinX >> level) > 1 || (rectMaxY >> level) - (rectMinY >> level) > 1)
+        ++level;
+
+    return isRegionOccluded(level, rectMinX, rectMinY, rectMaxX, rectMaxY, nearestDepth);
+}
+
+void OcclusionCuller::cullRenderItems(Vector<RenderItem>& items, CullingStatistics* statistics) const
+{
+    unsigned int numVisible = 0;
+    for(unsigned int i = 0; i < items.size(); ++i)
+    {
+        if(!isOccluded(items[i].worldBoundingBox))
+            items[numVisible++] = items[i];
+    }
+
+    if(statistics)
+        statistics->itemsOccluded += items.size() - numVisible;
+
+    while(items.size() > numVisible)
+        items.popBack();
+}
+
+void OcclusionCuller::addOccluderTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+{
+    const Vector4* vertices[3] = {&v0, &v1, &v2};
+    float x[3];
+    float y[3];
+    float depth[3];
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        depth[i] = 1.0f / vertices[i]->w;
+        x[i] = (vertices[i]->x * depth[i] * 0.5f + 0.5f) * width;
+        y[i] = (vertices[i]->y * depth[i] * 0.5f + 0.5f) * height;
+    }
+
+    float minX = std::max(std::floor(std::min(x[0], std::min(x[1], x[2]))), 0.0f);
+    float minY = std::max(std::floor(std::min(y[0], std::min(y[1], y[2]))), 0.0f);
+    float maxX = std::min(std::ceil(std::max(x[0], std::max(x[1], x[2]))), static_cast<float>(width - 1));
+    float maxY = std::min(std::ceil(std::max(y[0], std::max(y[1], y[2]))), static_cast<float>(height - 1));
+    //Twice the signed area, the edges are flipped for the clockwise triangles so that the inside is always positive.
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if(minX > maxX || minY > maxY || std::abs(area) < 0.0001f)
+        return;
+
+    float sign = area < 0.0f ? -1.0f : 1.0f;
+    OcclusionTriangle triangle;
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        unsigned int j = (i + 1) % 3;
+        triangle.edgeA[i] = (y[i] - y[j]) * sign;
+        triangle.edgeB[i] = (x[j] - x[i]) * sign;
+        triangle.edgeC[i] = (x[i] * y[j] - x[j] * y[i]) * sign;
+    }
+
+    //The edge from a vertex to the next one weights the remaining vertex.
+    float inverseArea = 1.0f / (area * sign);
+    triangle.depthA = (triangle.edgeA[1] * depth[0] + triangle.edgeA[2] * depth[1] + triangle.edgeA[0] * depth[2]) * inverseArea;
+    triangle.depthB = (triangle.edgeB[1] * depth[0] + triangle.edgeB[2] * depth[1] + triangle.edgeB[0] * depth[2]) * inverseArea;
+    triangle.depthC = (triangle.edgeC[1] * depth[0] + triangle.edgeC[2] * depth[1] + triangle.edgeC[0] * depth[2]) * inverseArea;
+    triangle.minX = static_cast<int>(minX);
+    triangle.minY = static_cast<int>(minY);
+    triangle.maxX = static_cast<int>(maxX);
+    triangle.maxY = static_cast<int>(maxY);
+    triangles.pushBack(triangle);
+}
+
+bool OcclusionCuller::isRegionOccluded(unsigned int level, int minX, int minY, int maxX, int maxY, float nearestDepth) const
+{
+    const float* levelMin = level == 0 ? depthBuffer.begin() : minLevels[level - 1].begin();
+    const float* levelMax = level == 0 ? depthBuffer.begin() : maxLevels[level - 1].begin();
+    int levelWidth = levelWidths[level];
+
+    for(int y = minY >> level; y <= maxY >> level; ++y)
+    {
+        for(int x = minX >> level; x <= maxX >> level; ++x)
+        {
+            int index = y * levelWidth + x;
+            //Behind the farthest occluder of the texel.
+            if(nearestDepth < levelMin[index])
+                continue;
+
+            //In front of the nearest occluder of the texel, or of the only one on the level zero.
+            if(level == 0 || nearestDepth >= levelMax[index])
+                return false;
+
+            int childMinX = std::max(minX, x << level);
+            int childMinY = std::max(minY, y << level);
+            int childMaxX = std::min(maxX, ((x + 1) << level) - 1);
+            int childMaxY = std::min(maxY, ((y + 1) << level) - 1);
+            if(!isRegionOccluded(level - 1, childMinX, childMinY, childMaxX, childMaxY, nearestDepth))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+}
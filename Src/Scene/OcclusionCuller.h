@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef OcclusionCuller_H
+#define OcclusionCuller_H
+
+#include "Scene/SceneCuller.h"
+#include "Math/Matrix4x4.h"
+#include "Math/BoundingBox.h"
+
+namespace Huurre3D
+{
+
+//Rows of the depth buffer in one band.
+static const unsigned int OcclusionBandHeight = 16;
+
+//Screen space triangle of an occluder, the edge functions and the depth plane are set up once for all the bands.
+struct OcclusionTriangle
+{
+    //Edge functions a * x + b * y + c, positive inside.
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    //Plane of the inverse depth, a * x + b * y + c.
+    float depthA;
+    float depthB;
+    float depthC;
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+};
+
+//Occluder of a view in the frustum, with the estimated screen area by which the occluders are picked.
+struct OccluderCandidate
+{
+    float screenArea;
+    unsigned int occluderIndex;
+};
+
+//Culls the render items hidden behind occluders, without the GPU. The boxes of the occluder meshes of a view are rasterized
+//into a small depth buffer, from which a hierarchy of the minimum and maximum depths of the texel blocks is built. The box of
+//an item is occluded when its nearest point is behind the farthest occluder in every texel its screen rectangle covers.
+//The depth buffer stores the inverse of the clip space w, which interpolates linearly over the screen, so larger is nearer
+//and the cleared value zero is infinitely far. The bands of rows are rasterized independently, on separate threads if wanted.
+class OcclusionCuller
+{
+public:
+    OcclusionCuller() = default;
+    ~OcclusionCuller() = default;
+
+    //The width is rounded up to a multiple of four, the rasterizer writes four texels at a time.
+    void setResolution(unsigned int width, unsigned int height);
+    //Only the occluders covering the most of the screen are rasterized.
+    void setMaxOccluders(unsigned int maxOccluders) {this->maxOccluders = maxOccluders;}
+    //Picks the occluders of the view and sets up their triangles, returns the number of picked occluders.
+    unsigned int setupOccluders(const RenderView& view);
+    unsigned int getNumBands() const {return (height + OcclusionBandHeight - 1) / OcclusionBandHeight;}
+    //Clears and rasterizes the rows of the band, the bands can be rasterized at the same time.
+    void rasterizeBand(unsigned int band);
+    //Builds the hierarchy after all the bands are rasterized.
+    void buildHierarchy();
+    bool isOccluded(const BoundingBox& worldBoundingBox) const;
+    //Removes the occluded items, the order of the rest is kept.
+    void cullRenderItems(Vector<RenderItem>& items, CullingStatistics* statistics = nullptr) const;
+    unsigned int getWidth() const {return width;}
+    unsigned int getHeight() const {return height;}
+    const Vector<float>& getDepthBuffer() const {return depthBuffer;}
+
+private:
+    void addOccluderTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2);
+    bool isRegionOccluded(unsigned int level, int minX, int minY, int maxX, int maxY, float nearestDepth) const;
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int maxOccluders = 32;
+    float nearClipDistance = 0.0f;
+    Matrix4x4 viewProjection;
+    Vector<OccluderCandidate> candidates;
+    Vector<OcclusionTriangle> triangles;
+    Vector<float> depthBuffer;
+    //Levels from the half resolution on, the depth buffer is the level zero of both.
+    Vector<Vector<float>> minLevels;
+    Vector<Vector<float>> maxLevels;
+    Vector<unsigned int> levelWidths;
+    Vector<unsigned int> levelHeights;
+};
+
+}
+
+#endif
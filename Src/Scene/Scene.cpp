@@ -23,23 +23,41 @@
 #include "Scene/SceneItemFactory.h"
 #include "Scene/Camera.h"
 #include "Scene/Mesh.h"
+#include "Math/TransformKernels.h"
+#include "Util/Profiler.h"
 #include <iostream>
 
 namespace Huurre3D
 {
 
-Scene::Scene()
+Scene::Scene():
+dirtyTransformItems(MemoryTag::Scene),
+transformItems(MemoryTag::Scene),
+worldPositions(MemoryTag::Scene),
+worldRotations(MemoryTag::Scene),
+worldScales(MemoryTag::Scene),
+worldTransforms(MemoryTag::Scene),
+inverseWorldTransforms(MemoryTag::Scene)
 {
-    mainCamera = static_cast<Camera*>(createSceneItem("Camera"));
+    mainCamera = createSceneItem<Camera>();
 }
 
 Scene::~Scene()
 {
     removeAllSceneItem();
+
+    for(unsigned int i = 0; i < sceneItemPools.size(); ++i)
+        delete sceneItemPools[i];
 }
 
 void Scene::update()
 {
+    PROFILE_ZONE("Scene::update");
+
+    //The world transforms of the moved items are composed in one batch before the items are updated,
+    //so updateItem() finds them up to date.
+    updateTransforms();
+
     for(unsigned int i = 0; i < dirtySceneItems.size(); ++i)
         dirtySceneItems[i]->updateItem();
 
@@ -48,24 +66,14 @@ void Scene::update()
 
 SceneItem* Scene::createSceneItem(const std::string& sceneItemType)
 {
-    unsigned int id = getUniqueId();
-    SceneItem* sceneItem = SceneItemFactory::createSceneItem(sceneItemType);
-    if(sceneItem)
+    SceneItemCreator* creator = SceneItemFactory::getCreator(sceneItemType);
+    if(!creator)
     {
-        sceneItem->setId(id);
-        sceneItem->setScene(this);
-        sceneItem->setSceneItemType(sceneItemType);
-        int index = sceneItems.getIndexToItem([sceneItemType](Vector<SceneItem*>& items){return items[0]->getSceneItemType().compare(sceneItemType) == 0; });
-        if(index == -1)
-        {
-            Vector<SceneItem*> itemTypeArray;
-            itemTypeArray.pushBack(sceneItem);
-            sceneItems.pushBack(itemTypeArray);
-        }
-        else
-            sceneItems[index].pushBack(sceneItem);
+        std::cout << "Failed to create scene item. Scene item type " << sceneItemType << " have not been registered." << std::endl;
+        return nullptr;
     }
-    return sceneItem;
+
+    return createSceneItem(creator->sceneItemTypeId);
 }
 
 void Scene::createSceneItems(const Vector<const std::string>& sceneItemTypes, Vector<SceneItem*>& itemsOut)
@@ -74,25 +82,52 @@ void Scene::createSceneItems(const Vector<const std::string>& sceneItemTypes, Ve
         itemsOut.pushBack(createSceneItem(sceneItemTypes[i]));
 }
 
-void Scene::getSceneItemsByType(const std::string& sceneItemType, Vector<SceneItem*>& itemsOut) const
+void Scene::createSceneItems(const std::string& sceneItemType, Vector<SceneItem*>& itemsOut, unsigned int numItems)
 {
-    sceneItems.findItem([sceneItemType](Vector<SceneItem*>& items){return items[0]->getSceneItemType() == sceneItemType;}, itemsOut);
+    //The pool is resolved once for the whole batch.
+    SceneItemCreator* creator = SceneItemFactory::getCreator(sceneItemType);
+    if(!creator)
+    {
+        std::cout << "Failed to create scene items. Scene item type " << sceneItemType << " have not been registered." << std::endl;
+        return;
+    }
+
+    SceneItemPoolBase* pool = getSceneItemPool(creator->sceneItemTypeId);
+    pool->reserve(numItems);
+    itemsOut.reserve(itemsOut.size() + numItems);
+
+    for(unsigned int i = 0; i < numItems; ++i)
+        itemsOut.pushBack(initSceneItem(pool->createSceneItem()));
 }
 
-void Scene::getAllRenderItems(Vector<RenderItem>& renderItemsOut) const
+void Scene::reserveSceneItems(const std::string& sceneItemType, unsigned int numItems)
 {
-    Vector<Mesh*> meshes;
-    getSceneItemsByType<Mesh>(meshes);
+    SceneItemCreator* creator = SceneItemFactory::getCreator(sceneItemType);
+    if(creator)
+        getSceneItemPool(creator->sceneItemTypeId)->reserve(numItems);
+}
 
-    for(unsigned int i = 0; i < meshes.size(); ++i)
-        renderItemsOut.pushBack(meshes[i]->getRenderItems());
+void Scene::getAllRenderItems(Vector<RenderItem>& renderItemsOut) const
+{
+    for(auto mesh : getSceneItems<Mesh>())
+        renderItemsOut.pushBack(mesh->getRenderItems());
 }
 
 unsigned int Scene::getNumSceneItemsByType(const std::string& sceneItemType) const
 {
-    Vector<SceneItem*> itemTypeArray;
-    getSceneItemsByType(sceneItemType, itemTypeArray);
-    return itemTypeArray.size();
+    SceneItemCreator* creator = SceneItemFactory::getCreator(sceneItemType);
+    if(!creator || creator->sceneItemTypeId >= sceneItemPools.size() || !sceneItemPools[creator->sceneItemTypeId])
+        return 0;
+
+    return sceneItemPools[creator->sceneItemTypeId]->size();
+}
+
+SceneItem* Scene::getSceneItem(const SceneItemHandle& handle) const
+{
+    if(handle.typeId >= sceneItemPools.size() || !sceneItemPools[handle.typeId])
+        return nullptr;
+
+    return sceneItemPools[handle.typeId]->getSceneItem(handle);
 }
 
 void Scene::setGlobalAmbientLight(const Vector3& ambientLight)
@@ -102,25 +137,147 @@ void Scene::setGlobalAmbientLight(const Vector3& ambientLight)
 
 void Scene::removeSceneItem(SceneItem* sceneItem)
 {
-    if(sceneItem)
+    //A removed item is not removed again, its handle no longer resolves to it.
+    if(sceneItem && getSceneItem(sceneItem->getHandle()) == sceneItem)
     {
-        std::string sceneItemType = sceneItem->getSceneItemType();
-        int index = sceneItems.getIndexToItem([sceneItemType](Vector<SceneItem*>& items){return items[0]->getSceneItemType().compare(sceneItemType) == 0; });
-        sceneItems[index].eraseUnordered(sceneItem);
-        delete sceneItem;
+        if(sceneItem->isSettedForUpdate())
+        {
+            SceneItem* lastItem = dirtySceneItems.back();
+            dirtySceneItems[sceneItem->updateIndex] = lastItem;
+            lastItem->updateIndex = sceneItem->updateIndex;
+            dirtySceneItems.popBack();
+        }
+
+        sceneItemPools[sceneItem->getSceneItemTypeId()]->removeSceneItem(sceneItem);
     }
 }
 
+void Scene::removeSceneItem(const SceneItemHandle& handle)
+{
+    removeSceneItem(getSceneItem(handle));
+}
+
+void Scene::setSceneItemForUpdate(SceneItem* sceneItem)
+{
+    sceneItem->updateIndex = dirtySceneItems.size();
+    dirtySceneItems.pushBack(sceneItem);
+}
+
+void Scene::setTransformForUpdate(SpatialSceneItem* spatialSceneItem)
+{
+    spatialSceneItem->dirtyTransformIndex = dirtyTransformItems.size();
+    dirtyTransformItems.pushBack(spatialSceneItem);
+}
+
+void Scene::removeTransformForUpdate(SpatialSceneItem* spatialSceneItem)
+{
+    //The last item takes the place of the removed one, so the removal needs no search.
+    SpatialSceneItem* lastItem = dirtyTransformItems.back();
+    dirtyTransformItems[spatialSceneItem->dirtyTransformIndex] = lastItem;
+    lastItem->dirtyTransformIndex = spatialSceneItem->dirtyTransformIndex;
+    dirtyTransformItems.popBack();
+}
+
 void Scene::removeAllSceneItem()
 {
-    for(unsigned int i = 0; i < sceneItems.size(); ++i)
+    //The items are no longer in the lists when the pools destroy them, so they must not try to remove themselves from the lists.
+    for(unsigned int i = 0; i < dirtySceneItems.size(); ++i)
+        dirtySceneItems[i]->settedForUpdate = false;
+    for(unsigned int i = 0; i < dirtyTransformItems.size(); ++i)
+        dirtyTransformItems[i]->transformSettedForUpdate = false;
+
+    dirtySceneItems.clear();
+    dirtyTransformItems.clear();
+
+    for(unsigned int i = 0; i < sceneItemPools.size(); ++i)
+    {
+        if(sceneItemPools[i])
+            sceneItemPools[i]->removeAllSceneItems();
+    }
+}
+
+unsigned int Scene::createRenderItemId()
+{
+    if(freeRenderItemIds.empty())
+        return renderItemId++;
+
+    unsigned int id = freeRenderItemIds.back();
+    freeRenderItemIds.popBack();
+    return id;
+}
+
+SceneItem* Scene::createSceneItem(unsigned int sceneItemTypeId)
+{
+    return initSceneItem(getSceneItemPool(sceneItemTypeId)->createSceneItem());
+}
+
+SceneItem* Scene::initSceneItem(SceneItem* sceneItem)
+{
+    sceneItem->setId(getUniqueId());
+    sceneItem->setScene(this);
+    return sceneItem;
+}
+
+SceneItemPoolBase* Scene::getSceneItemPool(unsigned int sceneItemTypeId)
+{
+    while(sceneItemPools.size() <= sceneItemTypeId)
+        sceneItemPools.pushBack(nullptr);
+
+    if(!sceneItemPools[sceneItemTypeId])
+        sceneItemPools[sceneItemTypeId] = SceneItemFactory::getCreator(sceneItemTypeId)->createSceneItemPool();
+
+    return sceneItemPools[sceneItemTypeId];
+}
+
+void Scene::updateTransforms()
+{
+    if(dirtyTransformItems.empty())
+        return;
+
+    PROFILE_ZONE("Scene::updateTransforms");
+
+    //Resolve the world positions, rotations and scales, a parent is resolved before its children.
+    for(unsigned int i = 0; i < dirtyTransformItems.size(); ++i)
+        dirtyTransformItems[i]->updateWorldPositionRotationScale();
+
+    //Gather the items whose transforms have not been updated by other means since they were moved.
+    transformItems.clear();
+    worldPositions.clear();
+    worldRotations.clear();
+    worldScales.clear();
+
+    for(unsigned int i = 0; i < dirtyTransformItems.size(); ++i)
     {
-        for(unsigned int j = 0; j < sceneItems[i].size(); ++j)
+        SpatialSceneItem* item = dirtyTransformItems[i];
+        item->transformSettedForUpdate = false;
+
+        if(item->transformDirty)
         {
-            sceneItems[i].eraseUnordered(sceneItems[i][j]);
-            delete sceneItems[i][j];
+            transformItems.pushBack(item);
+            worldPositions.pushBack(item->worldPosition);
+            worldRotations.pushBack(item->worldRotation);
+            worldScales.pushBack(item->worldScale);
+            item->transformDirty = false;
         }
     }
+
+    dirtyTransformItems.clear();
+
+    unsigned int numItems = transformItems.size();
+    while(worldTransforms.size() < numItems)
+    {
+        worldTransforms.pushBack(Matrix4x4::IDENTITY);
+        inverseWorldTransforms.pushBack(Matrix4x4::IDENTITY);
+    }
+
+    composeTransforms(worldPositions.begin(), worldRotations.begin(), worldScales.begin(), worldTransforms.begin(), numItems);
+    composeInverseTransforms(worldPositions.begin(), worldRotations.begin(), worldScales.begin(), inverseWorldTransforms.begin(), numItems);
+
+    for(unsigned int i = 0; i < numItems; ++i)
+    {
+        transformItems[i]->worldTransform = worldTransforms[i];
+        transformItems[i]->inverseWorldTransform = inverseWorldTransforms[i];
+    }
 }
 
-}
\ No newline at end of file
+}
@@ -23,7 +23,10 @@
 #define Scene_H
 
 #include "Renderer/RenderItem.h"
+#include "Scene/SceneItemPool.h"
 #include "Math/Frustum.h"
+#include "Math/Matrix4x4.h"
+#include "Math/Quaternion.h"
 #include "Util/Vector.h"
 
 namespace Huurre3D
@@ -44,50 +47,77 @@ public:
     SceneItem* createSceneItem(const std::string& sceneItemType);
     void createSceneItems(const Vector<const std::string>& sceneItemTypes, Vector<SceneItem*>& itemsOut);
     void createSceneItems(const std::string& sceneItemType, Vector<SceneItem*>& itemsOut, unsigned int numItems);
-    void getSceneItemsByType(const std::string& sceneItemType, Vector<SceneItem*>& itemsOut) const;
+    void reserveSceneItems(const std::string& sceneItemType, unsigned int numItems);
     void getAllRenderItems(Vector<RenderItem>& renderItemsOut) const;
     void setGlobalAmbientLight(const Vector3& ambientLight);
     unsigned int getNumSceneItemsByType(const std::string& sceneItemType) const;
+    SceneItem* getSceneItem(const SceneItemHandle& handle) const;
     void removeSceneItem(SceneItem* sceneItem);
+    void removeSceneItem(const SceneItemHandle& handle);
     void removeAllSceneItem();
-    void setSceneItemForUpdate(SceneItem* sceneItem) {dirtySceneItems.pushBack(sceneItem);}
+    void setSceneItemForUpdate(SceneItem* sceneItem);
+    void setTransformForUpdate(SpatialSceneItem* spatialSceneItem);
+    void removeTransformForUpdate(SpatialSceneItem* spatialSceneItem);
+    //Ids of the render items added to the meshes. The ids of a removed mesh's items are reused, so the state the stages keep per id
+    //is bounded by the most items alive at once.
+    unsigned int createRenderItemId();
+    void releaseRenderItemId(unsigned int id) {freeRenderItemIds.pushBack(id);}
+    unsigned int getNumRenderItemIds() const {return renderItemId;}
+    //Each update of a dirty item can take a new version, so the renderer can tell which items have changed since a given version.
+    unsigned int createChangeVersion() {return ++changeVersion;}
+    unsigned int getChangeVersion() const {return changeVersion;}
     Camera* getMainCamera() const {return mainCamera;}
     const Vector3& getGlobalAmbientLight() const {return globalAmbientLight;}
-    template<class T> T* createSceneItem() { return static_cast<T*>(createSceneItem(T::getSceneItemTypeStatic())); }
+    template<class T> T* createSceneItem() {return static_cast<T*>(createSceneItem(T::getSceneItemTypeIdStatic()));}
     template<class T> void createSceneItems(Vector<T*>& itemsOut, unsigned int numItems)
     {
+        SceneItemPoolBase* pool = getSceneItemPool(T::getSceneItemTypeIdStatic());
+        pool->reserve(numItems);
+        itemsOut.reserve(itemsOut.size() + numItems);
+
         for(unsigned int i = 0; i < numItems; ++i)
-            itemsOut.pushBack(static_cast<T*>(createSceneItem(T::getSceneItemTypeStatic())));
+            itemsOut.pushBack(static_cast<T*>(initSceneItem(pool->createSceneItem())));
     }
 
-    template<class T> void getSceneItemsByType(Vector<T*>& itemsOut) const
+    template<class T> T* getSceneItem(const SceneItemHandle& handle) const 
     {
-        Vector<SceneItem*> items;
-        getSceneItemsByType(T::getSceneItemTypeStatic(), items);
+        return handle.typeId == T::getSceneItemTypeIdStatic() ? static_cast<T*>(getSceneItem(handle)) : nullptr;
+    }
 
-        for(unsigned int i = 0; i < items.size(); ++i)
-            itemsOut.pushBack(static_cast<T*>(items[i]));
+    //Returns a view to the live items of the type, the view is invalidated when items of the type are created or removed.
+    template<class T> SceneItemView<T> getSceneItems() const
+    {
+        unsigned int typeId = T::getSceneItemTypeIdStatic();
+        return SceneItemView<T>(typeId < sceneItemPools.size() && sceneItemPools[typeId] ? &sceneItemPools[typeId]->getSceneItems() : nullptr);
     }
 
     template<class T> void removeSceneItems(Vector<T*>& sceneItemsToBeRemoved)
     {
         for(unsigned int i = 0; i < sceneItemsToBeRemoved.size(); ++i)
-        {
-            if(sceneItemsToBeRemoved[i])
-            {
-                std::string sceneItemType = sceneItemsToBeRemoved[i]->getSceneItemType();
-                int index = sceneItems.getIndexToItem([sceneItemType](Vector<SceneItem*>& items){return items[0]->getSceneItemType().compare(sceneItemType) == 0; });
-                sceneItems[index].eraseUnordered(sceneItemsToBeRemoved[i]);
-                delete sceneItemsToBeRemoved[i];
-            }
-        }
+            removeSceneItem(sceneItemsToBeRemoved[i]);
     }
 
 private:
     unsigned int getUniqueId() {return uniqueId++;}
+    SceneItem* createSceneItem(unsigned int sceneItemTypeId);
+    SceneItem* initSceneItem(SceneItem* sceneItem);
+    SceneItemPoolBase* getSceneItemPool(unsigned int sceneItemTypeId);
+    void updateTransforms();
     unsigned int uniqueId = 0;
-    Vector<Vector<SceneItem*>> sceneItems;
+    unsigned int renderItemId = 0;
+    Vector<unsigned int> freeRenderItemIds;
+    unsigned int changeVersion = 0;
+    //The pools are indexed by the scene item type id and created when the first item of the type is created.
+    Vector<SceneItemPoolBase*> sceneItemPools;
     Vector<SceneItem*> dirtySceneItems;
+    Vector<SpatialSceneItem*> dirtyTransformItems;
+    //Contiguous arrays of the moved items' world positions, rotations and scales, and of the transforms composed from them.
+    Vector<SpatialSceneItem*> transformItems;
+    Vector<Vector3> worldPositions;
+    Vector<Quaternion> worldRotations;
+    Vector<Vector3> worldScales;
+    Vector<Matrix4x4> worldTransforms;
+    Vector<Matrix4x4> inverseWorldTransforms;
     Camera* mainCamera = nullptr;
     Vector3 globalAmbientLight = Vector3::ONE;
 };
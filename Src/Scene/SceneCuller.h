@@ -25,61 +25,106 @@
 #include "Scene/Scene.h"
 #include "Scene/Light.h"
 #include "Scene/Mesh.h"
+#include "Renderer/RenderView.h"
 
 namespace Huurre3D
 {
 
-template<class BoundingVolume> void cullRenderItems(const Vector<RenderItem>& items, Vector<RenderItem>& result, const BoundingVolume& volume)
+//Counts of the items and lights given to the culling functions and of those that passed.
+struct CullingStatistics
 {
+    unsigned int itemsTested = 0;
+    unsigned int itemsVisible = 0;
+    unsigned int lightsTested = 0;
+    unsigned int lightsVisible = 0;
+    //Items of the visible ones the occlusion culling removed, and the occluders it rasterized.
+    unsigned int itemsOccluded = 0;
+    unsigned int occluders = 0;
+    //Items of the visible ones the contribution culling removed for being too small on the screen or too far from the view.
+    unsigned int itemsTooSmall = 0;
+    unsigned int itemsTooFar = 0;
+    //Changes of the visible items since the previous frame, only counted by the cached culling.
+    unsigned int itemsBecameVisible = 0;
+    unsigned int itemsBecameHidden = 0;
+};
+
+//Diameter of the bounding sphere of the box projected to a view, relative to the view height. The projection scale is the inverse 
+//of the tangent of the half of the vertical field of view. Inside the sphere the box covers the whole view.
+inline float getProjectedSize(const BoundingBox& worldBoundingBox, const Vector3& viewPosition, float projectionScale)
+{
+    float radius = worldBoundingBox.getHalfSize().length();
+    float distance = (worldBoundingBox.getCenter() - viewPosition).length();
+    return distance <= radius ? 1.0f : radius * projectionScale / distance;
+}
+
+template<class BoundingVolume> void cullRenderItems(const Vector<RenderItem>& items, Vector<RenderItem>& result, const BoundingVolume& volume, CullingStatistics* statistics = nullptr)
+{
+    unsigned int numResults = result.size();
+
     for(unsigned int i = 0; i < items.size(); ++i)
     {
-        BoundingBox worlBoundingBox = items[i].geometry->getWorldBoundingBox();
-        if(volume.isInsideNoIntersection(worlBoundingBox))
+        if(volume.isInsideNoIntersection(items[i].worldBoundingBox))
             result.pushBack(items[i]);
     }
+
+    if(statistics)
+    {
+        statistics->itemsTested += items.size();
+        statistics->itemsVisible += result.size() - numResults;
+    }
 }
 
-template<class BoundingVolume> void cullRenderItems(const Scene& scene, Vector<RenderItem>& result, const BoundingVolume& volume)
+//Tests the box of each mesh first, the items of an intersecting mesh are tested one by one.
+template<class BoundingVolume> void cullRenderItems(const RenderView& view, Vector<RenderItem>& result, const BoundingVolume& volume, CullingStatistics* statistics = nullptr)
 {
-    Vector<Mesh*> meshes;
-    scene.getSceneItemsByType<Mesh>(meshes);
+    unsigned int numResults = result.size();
 
-    Matrix4x4 worldTransform;
-    for(unsigned int i = 0; i < meshes.size(); ++i)
+    for(unsigned int i = 0; i < view.renderItemGroups.size(); ++i)
     {
-        worldTransform = meshes[i]->getWorldTransform4x4();
-        auto items = meshes[i]->getRenderItems();
-            
-        //Test if the mesh is inside the bounding volume.
-        switch(volume.isInside(meshes[i]->getBoundingBox().transformed(worldTransform)))
-        {	
-            //case Intersection::Outside:
-                //continue;
+        const RenderItemGroup& group = view.renderItemGroups[i];
+        const RenderItem* items = view.renderItems.begin() + group.firstItem;
+
+        switch(volume.isInside(group.worldBoundingBox))
+        {
             case Intersection::Inside:
-                //If mesh is fully inside the frustum, add all renderItems at once.
-                result.pushBack(items);
+                for(unsigned int j = 0; j < group.numItems; ++j)
+                    result.pushBack(items[j]);
                 break;
             case Intersection::Intersects:
-                //Cull each render item.
-                cullRenderItems(items, result, volume);
+                for(unsigned int j = 0; j < group.numItems; ++j)
+                {
+                    if(volume.isInsideNoIntersection(items[j].worldBoundingBox))
+                        result.pushBack(items[j]);
+                }
                 break;
         }
     }
+
+    if(statistics)
+    {
+        statistics->itemsTested += view.renderItems.size();
+        statistics->itemsVisible += result.size() - numResults;
+    }
 }
 
-template<class BoundingVolume> void cullLights(const Scene& scene, Vector<Light*>& result, const BoundingVolume& volume)
+template<class BoundingVolume> void cullLights(const RenderView& view, Vector<const Light*>& result, const BoundingVolume& volume, CullingStatistics* statistics = nullptr)
 {
-    Vector<Light*> lights;
-    scene.getSceneItemsByType<Light>(lights);
-    //Cull light bounding volumes against the given bounding volume.
-    for(unsigned int i = 0; i < lights.size(); ++i)
+    unsigned int numResults = result.size();
+
+    for(unsigned int i = 0; i < view.lights.size(); ++i)
     {
-        Sphere worldSpaceBoundingSphere(lights[i]->getPosition(FrameOfReference::World), lights[i]->getRadius());
+        Sphere worldSpaceBoundingSphere(view.lights[i].getPosition(FrameOfReference::World), view.lights[i].getRadius());
         if(volume.isInsideNoIntersection(worldSpaceBoundingSphere))
-            result.pushBack(lights[i]);
+            result.pushBack(&view.lights[i]);
+    }
+
+    if(statistics)
+    {
+        statistics->lightsTested += view.lights.size();
+        statistics->lightsVisible += result.size() - numResults;
     }
 }
 
 }
 
-#endif
\ No newline at end of file
+#endif
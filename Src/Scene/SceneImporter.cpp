@@ -29,11 +29,15 @@
 #include "Math/Vector3.h"
 #include "Renderer/Material.h"
 #include "Renderer/Geometry.h"
+#include "Renderer/GeometrySimplifier.h"
 #include <iostream>
 
 namespace Huurre3D
 {
 
+//Levels of detail simplified for every imported geometry, each with half of the triangles of the previous level.
+static const unsigned int MaxImportedLods = 3;
+
 SceneImporter::SceneImporter(Renderer& renderer, Animation& animation) :
 renderer(renderer),
 animation(animation)
@@ -85,7 +89,7 @@ void SceneImporter::importMultipleMeshes(const std::string& fileName, Vector<Mes
         getTransfrom(rootNode->mTransformation, position, rotation, scale);
 
         Vector<Joint*> skeleton;
-        unsigned int numJoints = destMeshes[0]->getScene()->getNumSceneItemsByType("Joint");
+        unsigned int numJoints = destMeshes[0]->getScene()->getSceneItems<Joint>().size();
         destMeshes[0]->getScene()->createSceneItems<Joint>(skeleton, assimpSkeletonData.boneNodes.size());
         readSkeleton(assimpSkeletonData, skeleton);
         readJointWeights(assimpSkeletonData, skeleton, assimpVertexDataVec, numJoints);
@@ -96,8 +100,25 @@ void SceneImporter::importMultipleMeshes(const std::string& fileName, Vector<Mes
         Vector<GeometryDescription> geometryDescriptions;
         geometryDescriptions.reserve(assimpVertexDataVec.size());
         createGeometrydescriptions(assimpVertexDataVec, geometryDescriptions);
+
+        //The levels are simplified before the geometries are created, which can take over the vertex data of the descriptions.
+        GeometrySimplifier geometrySimplifier;
+        Vector<Vector<GeometryDescription>> lodDescriptions(geometryDescriptions.size());
+        for(unsigned int i = 0; i < geometryDescriptions.size(); ++i)
+            geometrySimplifier.generateLods(geometryDescriptions[i], MaxImportedLods, lodDescriptions[i]);
+
         renderer.createRenderItems(materialDescriptions, geometryDescriptions, renderItems, destMeshes.size());
 
+        //The geometries of the meshes are copies of one geometry per description, which share its levels.
+        for(unsigned int i = 0; i < lodDescriptions.size(); ++i)
+        {
+            Vector<Geometry*> geometries;
+            for(unsigned int j = 0; j < renderItems.size(); ++j)
+                geometries.pushBack(renderItems[j][i].geometry);
+
+            renderer.createGeometryLods(lodDescriptions[i], geometries);
+        }
+
         for(unsigned int i = 0; i < destMeshes.size(); ++i)
         {
             destMeshes[i]->setTransform(position, rotation, scale);
@@ -183,6 +204,7 @@ MaterialDescription SceneImporter::createMaterialDescription(const aiMaterial* a
     aiColor3D ambient(1.0f, 1.0f, 1.0f);
     aiColor3D emissive(0.0f, 0.0f, 0.0f);
     aiString textureName;
+    aiString materialName;
     float alpha = 0.0f;
     float roughness = 0.0f;
     float reflectance = 0.0f;
@@ -205,6 +227,9 @@ MaterialDescription SceneImporter::createMaterialDescription(const aiMaterial* a
     /*if(assimpMaterial->Get(AI_MATKEY_SHININESS_STRENGTH, specularStrength)== AI_SUCCESS)
         materialOut->setSpecularPower(specularStrength);*/
 
+    if(assimpMaterial->Get(AI_MATKEY_NAME, materialName) == AI_SUCCESS)
+        description.name = materialName.C_Str();
+
     if(assimpMaterial->Get(AI_MATKEY_OPACITY, alpha) == AI_SUCCESS)
         description.alpha = alpha;
 
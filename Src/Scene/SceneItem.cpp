@@ -29,11 +29,6 @@ void SceneItem::setId(unsigned int id)
     this->id = id;
 }
 
-void SceneItem::setSceneItemType(const std::string& SceneItemType) 
-{
-    this->SceneItemType = SceneItemType;
-}
-
 void SceneItem::setScene(Scene* scene)
 {
     this->scene = scene;
@@ -30,18 +30,23 @@ namespace Huurre3D
 
 class SceneItem
 {
+    friend class SceneItemPoolBase;
+    friend class Scene;
+
 public:
     SceneItem() = default;
     virtual ~SceneItem() = default;
 	
     void setId(unsigned int id);
-    void setSceneItemType(const std::string& SceneItemType);
     void setScene(Scene* scene);
     virtual void updateItem() {settedForUpdate = false;}
     unsigned int getId() {return id;}
     const unsigned int getId() const {return id;}
-    std::string& getSceneItemType() {return SceneItemType;}
+    const std::string& getSceneItemType() const {return SceneItemFactory::getCreator(handle.typeId)->sceneItemType;}
+    unsigned int getSceneItemTypeId() const {return handle.typeId;}
+    const SceneItemHandle& getHandle() const {return handle;}
     Scene* getScene() {return scene;}
+    bool isSettedForUpdate() const {return settedForUpdate;}
 
 protected:
     void setDirty();
@@ -50,7 +55,13 @@ protected:
     bool dirty = false;
     bool settedForUpdate = false;
     Scene* scene = nullptr;
-    std::string SceneItemType;
+
+private:
+    SceneItemHandle handle;
+    //Index of the item in the packed item array of its pool.
+    unsigned int poolIndex = 0;
+    //Index of the item in the scene's list of items to update while settedForUpdate is true.
+    unsigned int updateIndex = 0;
 };
 
 }
@@ -30,14 +30,15 @@ sceneItemType(sceneItemType)
     SceneItemFactory::registerCreator(this);
 }
 
-SceneItem* SceneItemFactory::createSceneItem(const std::string& sceneItemType)
+SceneItemCreator* SceneItemFactory::getCreator(const std::string& sceneItemType)
 {
     int index = getCreatorContainer().getIndexToItem([sceneItemType](const SceneItemCreator* creator){return creator->sceneItemType.compare(sceneItemType) == 0;});
-    return index != -1 ? getCreatorContainer()[index]->createSceneItem() : nullptr;
+    return index != -1 ? getCreatorContainer()[index] : nullptr;
 }
 
 void SceneItemFactory::registerCreator(SceneItemCreator* creator)
 {
+    creator->sceneItemTypeId = getCreatorContainer().size();
     getCreatorContainer().pushBack(creator);
 }
 
@@ -22,6 +22,7 @@
 #ifndef SceneItemFactory_H
 #define SceneItemFactory_H
 
+#include "Scene/SceneItemPool.h"
 #include "Util/Vector.h"
 #include <string>
 
@@ -30,15 +31,16 @@ namespace Huurre3D
 
 class SceneItem;
 
-//Base class for SceneItem creator.
+//Base class for SceneItem creator. The type id is the registration index of the creator.
 class SceneItemCreator
 {
 public:
     SceneItemCreator(const std::string& sceneItemType);
     virtual ~SceneItemCreator() = default;
-    virtual SceneItem* createSceneItem() = 0;
+    virtual SceneItemPoolBase* createSceneItemPool() const = 0;
 
     std::string sceneItemType;
+    unsigned int sceneItemTypeId;
 };
 
 //Template implementation of the SceneItem creator.
@@ -50,23 +52,27 @@ public:
     {}
 
     ~SceneItemCreatorImpl<T>() = default;
-    SceneItem* createSceneItem() override {return new T;}
+    SceneItemPoolBase* createSceneItemPool() const override {return new SceneItemPool<T>(sceneItemTypeId);}
 };
 
 //The actual factory class.
 class SceneItemFactory
 {
 public:
-    static SceneItem* createSceneItem(const std::string& sceneItemType);
+    static SceneItemCreator* getCreator(const std::string& sceneItemType);
+    static SceneItemCreator* getCreator(unsigned int sceneItemTypeId) {return getCreatorContainer()[sceneItemTypeId];}
+    static unsigned int getNumSceneItemTypes() {return getCreatorContainer().size();}
     static void registerCreator(SceneItemCreator* creator);
 private:
     static Vector<SceneItemCreator*>& getCreatorContainer();
 };
 
 //Macro for definining the creator for different types of SceneItems.
+//The type id is resolved once when the creator registers so typed scene queries don't need to look up the type by its name.
 #define SCENEITEM_TYPE(SceneItemType) \
     public: \
     static std::string getSceneItemTypeStatic() {static const std::string type(#SceneItemType); return type;} \
+    static unsigned int getSceneItemTypeIdStatic() {return sceneItemCreator.sceneItemTypeId;} \
     private: \
     static const SceneItemCreatorImpl<SceneItemType> sceneItemCreator;
 
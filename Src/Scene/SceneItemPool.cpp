@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Scene/SceneItemPool.h"
+#include "Scene/SceneItem.h"
+#include <iostream>
+
+namespace Huurre3D
+{
+
+SceneItemPoolBase::SceneItemPoolBase(unsigned int sceneItemTypeId, unsigned int itemSize) :
+sceneItemTypeId(sceneItemTypeId),
+itemSize(itemSize),
+chunks(MemoryTag::Scene),
+generations(MemoryTag::Scene),
+slotItems(MemoryTag::Scene),
+freeSlots(MemoryTag::Scene),
+items(MemoryTag::Scene)
+{}
+
+SceneItemPoolBase::~SceneItemPoolBase()
+{
+    removeAllSceneItems();
+
+    for(unsigned int i = 0; i < chunks.size(); ++i)
+        Memory::deallocate(chunks[i], SceneItemPoolChunkSize * itemSize, MemoryTag::Scene);
+}
+
+SceneItem* SceneItemPoolBase::createSceneItem()
+{
+    unsigned int slot;
+    if(!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.popBack();
+    }
+    else
+    {
+        slot = generations.size();
+        if(slot == chunks.size() * SceneItemPoolChunkSize)
+            chunks.pushBack(Memory::allocate(SceneItemPoolChunkSize * itemSize, MemoryTag::Scene));
+
+        generations.pushBack(1);
+        slotItems.pushBack(nullptr);
+    }
+
+    SceneItem* sceneItem = constructItem(getSlotMemory(slot));
+    sceneItem->handle.typeId = sceneItemTypeId;
+    sceneItem->handle.index = slot;
+    sceneItem->handle.generation = generations[slot];
+    sceneItem->poolIndex = items.size();
+    slotItems[slot] = sceneItem;
+    items.pushBack(sceneItem);
+
+    return sceneItem;
+}
+
+void SceneItemPoolBase::removeSceneItem(SceneItem* sceneItem)
+{
+    unsigned int slot = sceneItem->handle.index;
+    //The slot of a removed item is either empty or holds a newer generation.
+    if(slot >= slotItems.size() || slotItems[slot] != sceneItem || generations[slot] != sceneItem->handle.generation)
+    {
+        std::cout << "Failed to remove scene item. The item is not in the pool" << std::endl;
+        return;
+    }
+
+    unsigned int poolIndex = sceneItem->poolIndex;
+
+    //Move the last live item into the place of the removed one.
+    items[poolIndex] = items.back();
+    items[poolIndex]->poolIndex = poolIndex;
+    items.popBack();
+
+    sceneItem->~SceneItem();
+    slotItems[slot] = nullptr;
+    ++generations[slot];
+    freeSlots.pushBack(slot);
+}
+
+void SceneItemPoolBase::removeAllSceneItems()
+{
+    while(!items.empty())
+        removeSceneItem(items.back());
+}
+
+void SceneItemPoolBase::reserve(unsigned int numItems)
+{
+    unsigned int numSlots = items.size() + numItems;
+    while(chunks.size() * SceneItemPoolChunkSize < numSlots)
+        chunks.pushBack(Memory::allocate(SceneItemPoolChunkSize * itemSize, MemoryTag::Scene));
+
+    generations.reserve(numSlots);
+    slotItems.reserve(numSlots);
+    items.reserve(numSlots);
+}
+
+SceneItem* SceneItemPoolBase::getSceneItem(const SceneItemHandle& handle) const
+{
+    if(handle.typeId != sceneItemTypeId || handle.index >= generations.size() || generations[handle.index] != handle.generation)
+        return nullptr;
+
+    return slotItems[handle.index];
+}
+
+}
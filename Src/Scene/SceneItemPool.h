@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef SceneItemPool_H
+#define SceneItemPool_H
+
+#include "Util/Vector.h"
+#include <new>
+
+namespace Huurre3D
+{
+
+class SceneItem;
+
+static const unsigned int SceneItemPoolChunkSize = 256;
+
+//Generational handle to a pooled scene item. A handle becomes stale when its item is removed, 
+//even if the slot is later reused by another item. Generation 0 is never used by a live item.
+struct SceneItemHandle
+{
+    unsigned int typeId = 0;
+    unsigned int index = 0;
+    unsigned int generation = 0;
+
+    bool isNull() const {return generation == 0;}
+    bool operator == (const SceneItemHandle& rhs) const {return typeId == rhs.typeId && index == rhs.index && generation == rhs.generation;}
+    bool operator != (const SceneItemHandle& rhs) const {return !(*this == rhs);}
+};
+
+//Storage for the scene items of one type. The items are constructed into fixed size chunks so their addresses stay stable,
+//freed slots are reused through a free list. The live items are also kept in a packed array for iteration.
+class SceneItemPoolBase
+{
+public:
+    SceneItemPoolBase(unsigned int sceneItemTypeId, unsigned int itemSize);
+    virtual ~SceneItemPoolBase();
+    SceneItemPoolBase(const SceneItemPoolBase&) = delete;
+    SceneItemPoolBase& operator = (const SceneItemPoolBase&) = delete;
+
+    SceneItem* createSceneItem();
+    void removeSceneItem(SceneItem* sceneItem);
+    void removeAllSceneItems();
+    void reserve(unsigned int numItems);
+    SceneItem* getSceneItem(const SceneItemHandle& handle) const;
+    const Vector<SceneItem*>& getSceneItems() const {return items;}
+    unsigned int size() const {return items.size();}
+
+protected:
+    virtual SceneItem* constructItem(void* memory) const = 0;
+
+private:
+    unsigned char* getSlotMemory(unsigned int slot) const {return chunks[slot / SceneItemPoolChunkSize] + (slot % SceneItemPoolChunkSize) * itemSize;}
+    unsigned int sceneItemTypeId;
+    unsigned int itemSize;
+    Vector<unsigned char*> chunks;
+    Vector<unsigned int> generations;
+    Vector<SceneItem*> slotItems;
+    Vector<unsigned int> freeSlots;
+    Vector<SceneItem*> items;
+};
+
+template<class T> class SceneItemPool : public SceneItemPoolBase
+{
+public:
+    SceneItemPool(unsigned int sceneItemTypeId) :
+    SceneItemPoolBase(sceneItemTypeId, sizeof(T))
+    {}
+    ~SceneItemPool() = default;
+
+protected:
+    SceneItem* constructItem(void* memory) const override {return new(memory) T;}
+};
+
+//Non-copying view to the live items of one type.
+template<class T> class SceneItemView
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator(SceneItem* const* current) :
+        current(current)
+        {}
+
+        T* operator * () const {return static_cast<T*>(*current);}
+        Iterator& operator ++ () {++current; return *this;}
+        bool operator != (const Iterator& rhs) const {return current != rhs.current;}
+
+    private:
+        SceneItem* const* current;
+    };
+
+    SceneItemView(const Vector<SceneItem*>* items) :
+    items(items)
+    {}
+    ~SceneItemView() = default;
+
+    unsigned int size() const {return items ? items->size() : 0;}
+    bool empty() const {return size() == 0;}
+    T* operator [] (unsigned int index) const {return static_cast<T*>((*items)[index]);}
+    Iterator begin() const {return Iterator(items ? items->begin() : nullptr);}
+    Iterator end() const {return Iterator(items ? items->end() : nullptr);}
+
+private:
+    const Vector<SceneItem*>* items;
+};
+
+}
+
+#endif
@@ -0,0 +1,415 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Scene/SceneLoader.h"
+#include "Scene/SceneImporter.h"
+#include "Scene/Scene.h"
+#include "Scene/Mesh.h"
+#include "Scene/Light.h"
+#include "Scene/Camera.h"
+#include "Scene/SkyBox.h"
+#include "Engine/Engine.h"
+#include "Util/JSON.h"
+#include "Util/JSONSchema.h"
+#include "Util/MappedFile.h"
+#include <fstream>
+#include <iostream>
+
+namespace Huurre3D
+{
+
+static const JSONSchema<SceneDescription> sceneSchema = JSONSchema<SceneDescription>("scene")
+    .addField("ambientLight", &SceneDescription::ambientLight)
+    .addField("binary", &SceneDescription::binary)
+    .addField("skyBox", &SceneDescription::skyBox)
+    .addField("camera", &SceneDescription::camera)
+    .addField("models", &SceneDescription::models)
+    .addField("meshes", &SceneDescription::meshes)
+    .addField("lights", &SceneDescription::lights);
+
+static const JSONSchema<CameraDescription> cameraSchema = JSONSchema<CameraDescription>("camera")
+    .addField("position", &CameraDescription::position)
+    .addField("rotation", &CameraDescription::rotation)
+    .addField("fov", &CameraDescription::fov)
+    .addField("nearClipDistance", &CameraDescription::nearClipDistance)
+    .addField("farClipDistance", &CameraDescription::farClipDistance);
+
+static const JSONSchema<MeshBatchDescription> meshBatchSchema = JSONSchema<MeshBatchDescription>("mesh")
+    .addField("name", &MeshBatchDescription::name)
+    .addField("model", &MeshBatchDescription::model, true)
+    .addField("parent", &MeshBatchDescription::parent)
+    .addField("count", &MeshBatchDescription::count)
+    .addField("position", &MeshBatchDescription::position)
+    .addField("rotation", &MeshBatchDescription::rotation)
+    .addField("scale", &MeshBatchDescription::scale)
+    .addField("occluder", &MeshBatchDescription::occluder)
+    .addField("binaryOffset", &MeshBatchDescription::binaryOffset);
+
+static const JSONSchema<LightBatchDescription> lightBatchSchema = JSONSchema<LightBatchDescription>("light")
+    .addField("name", &LightBatchDescription::name)
+    .addField("parent", &LightBatchDescription::parent)
+    .addField("type", &LightBatchDescription::type)
+    .addField("count", &LightBatchDescription::count)
+    .addField("position", &LightBatchDescription::position)
+    .addField("direction", &LightBatchDescription::direction)
+    .addField("color", &LightBatchDescription::color)
+    .addField("radius", &LightBatchDescription::radius)
+    .addField("fallOffExponent", &LightBatchDescription::fallOffExponent)
+    .addField("innerConeAngle", &LightBatchDescription::innerConeAngle)
+    .addField("outerConeAngle", &LightBatchDescription::outerConeAngle)
+    .addField("castShadow", &LightBatchDescription::castShadow)
+    .addField("shadowBias", &LightBatchDescription::shadowBias)
+    .addField("shadowMinDistanceOffset", &LightBatchDescription::shadowMinDistanceOffset)
+    .addField("cascadeSplits", &LightBatchDescription::cascadeSplits)
+    .addField("binaryOffset", &LightBatchDescription::binaryOffset);
+
+static unsigned int getNameHash(const std::string& name)
+{
+    return name.empty() ? 0 : generateHash((const unsigned char*)name.c_str(), name.size());
+}
+
+static Quaternion getRotation(const Vector4& angleAxis)
+{
+    return Quaternion(angleAxis.x, Vector3(angleAxis.y, angleAxis.z, angleAxis.w).normalized());
+}
+
+SceneLoader::SceneLoader(SceneImporter& sceneImporter) :
+sceneImporter(sceneImporter)
+{}
+
+bool SceneLoader::loadScene(const std::string& fileName, Scene* scene)
+{
+    JSON sceneJSON;
+    if(!sceneJSON.parseFromFile(fileName))
+        return false;
+
+    SceneDescription sceneDescription;
+    if(!sceneSchema.read(sceneJSON.getRootValue(), sceneDescription))
+        return false;
+
+    MappedFile binaryFile;
+    if(!sceneDescription.binary.empty())
+    {
+        //The sidecar is located relative to the scene file.
+        const std::string binaryFileName = fileName.substr(0, fileName.find_last_of("/") + 1) + sceneDescription.binary;
+        SceneBinaryHeader header;
+        if(!binaryFile.open(binaryFileName) || binaryFile.getSize() < sizeof(SceneBinaryHeader))
+        {
+            std::cout << "Failed to open scene binary " << binaryFileName << std::endl;
+            return false;
+        }
+
+        memcpy(&header, binaryFile.getData(), sizeof(SceneBinaryHeader));
+        if(header.magic != SceneBinaryMagic || header.version != SceneBinaryVersion || 
+           binaryFile.getSize() < sizeof(SceneBinaryHeader) + header.numFloats * sizeof(float))
+        {
+            std::cout << "Failed to load scene binary " << binaryFileName << ". The file is not a valid scene binary." << std::endl;
+            return false;
+        }
+
+        binaryData = reinterpret_cast<const float*>(binaryFile.getData() + sizeof(SceneBinaryHeader));
+        binaryNumFloats = header.numFloats;
+    }
+
+    scene->setGlobalAmbientLight(sceneDescription.ambientLight);
+
+    if(sceneDescription.skyBox.size() == NumCubeMapFaces)
+    {
+        FixedArray<std::string, NumCubeMapFaces> skyBoxTextureFileNames;
+        for(unsigned int i = 0; i < NumCubeMapFaces; ++i)
+            skyBoxTextureFileNames[i] = Engine::getAssetPath() + sceneDescription.skyBox[i];
+
+        scene->createSceneItem<SkyBox>()->setTextureFiles(skyBoxTextureFileNames);
+    }
+
+    if(!sceneDescription.camera.isNull())
+    {
+        CameraDescription cameraDescription;
+        cameraSchema.read(sceneDescription.camera, cameraDescription);
+        Camera* camera = scene->getMainCamera();
+        camera->setPosition(cameraDescription.position);
+        camera->setRotation(getRotation(cameraDescription.rotation));
+        camera->setFov(cameraDescription.fov);
+        camera->setNearClipDistance(cameraDescription.nearClipDistance);
+        camera->setFarClipDistance(cameraDescription.farClipDistance);
+    }
+
+    createMeshes(sceneDescription.models, sceneDescription.meshes, scene);
+    createLights(sceneDescription.lights, scene);
+    linkBatches();
+
+    batches.clear();
+    meshItems.clear();
+    lightItems.clear();
+    binaryData = nullptr;
+    binaryNumFloats = 0;
+
+    return true;
+}
+
+bool SceneLoader::writeSceneBinary(const std::string& fileName, const Vector<float>& data)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        std::cout << "Failed to write scene binary " << fileName << std::endl;
+        return false;
+    }
+
+    SceneBinaryHeader header;
+    header.numFloats = data.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(SceneBinaryHeader));
+    if(!data.empty())
+        file.write(reinterpret_cast<const char*>(&data[0]), data.size() * sizeof(float));
+
+    return file.good();
+}
+
+bool SceneLoader::readBinaryRecords(int binaryOffset, unsigned int count, unsigned int recordSize, const float*& recordsOut) const
+{
+    if(binaryOffset < 0)
+        return false;
+
+    //Compared by division, the size of the records could overflow.
+    unsigned int offset = static_cast<unsigned int>(binaryOffset);
+    if(!binaryData || offset > binaryNumFloats || count > (binaryNumFloats - offset) / recordSize)
+    {
+        std::cout << "Failed to read " << count << " records from scene binary at offset " << binaryOffset << std::endl;
+        return false;
+    }
+
+    recordsOut = binaryData + offset;
+    return true;
+}
+
+void SceneLoader::createMeshes(const JSONValue& modelsJSON, const JSONValue& meshesJSON, Scene* scene)
+{
+    Vector<MeshBatchDescription> meshBatches;
+    meshBatches.reserve(meshesJSON.getSize());
+    unsigned int numMeshes = 0;
+
+    for(unsigned int i = 0; i < meshesJSON.getSize(); ++i)
+    {
+        MeshBatchDescription meshBatch;
+        if(!meshBatchSchema.read(meshesJSON.getJSONArrayItem(i), meshBatch))
+            continue;
+
+        if(modelsJSON.getJSONValue(meshBatch.model).isNull())
+        {
+            std::cout << "Failed to create mesh " << i << ". The model " << meshBatch.model << " is not declared." << std::endl;
+            continue;
+        }
+
+        numMeshes += meshBatch.count;
+        meshBatches.pushBack(meshBatch);
+    }
+
+    if(!numMeshes)
+        return;
+
+    //All meshes of the scene are created at once.
+    Vector<Mesh*> meshes;
+    scene->createSceneItems<Mesh>(meshes, numMeshes);
+    meshItems.reserve(numMeshes);
+
+    //Every model is imported once for all of its instances.
+    struct ModelInstances
+    {
+        unsigned int modelHash;
+        std::string fileName;
+        Vector<Mesh*> meshes;
+    };
+    Vector<ModelInstances> models;
+
+    unsigned int firstItem = 0;
+    for(unsigned int i = 0; i < meshBatches.size(); ++i)
+    {
+        const MeshBatchDescription& meshBatch = meshBatches[i];
+        unsigned int modelHash = getNameHash(meshBatch.model);
+        int modelIndex = models.getIndexToItem([modelHash](const ModelInstances& model){return model.modelHash == modelHash;});
+        if(modelIndex == -1)
+        {
+            ModelInstances model;
+            model.modelHash = modelHash;
+            model.fileName = Engine::getAssetPath() + modelsJSON.getJSONValue(meshBatch.model).getString();
+            models.pushBack(model);
+            modelIndex = models.size() - 1;
+        }
+
+        models[modelIndex].meshes.pushBack(&meshes[firstItem], meshBatch.count);
+
+        SceneBatch batch = {getNameHash(meshBatch.name), getNameHash(meshBatch.parent), firstItem, meshBatch.count, false};
+        batches.pushBack(batch);
+        firstItem += meshBatch.count;
+    }
+
+    for(unsigned int i = 0; i < models.size(); ++i)
+        sceneImporter.importMultipleMeshes(models[i].fileName, models[i].meshes);
+
+    //The transforms are set after the import because the importer assigns the transform of the model root node.
+    firstItem = 0;
+    for(unsigned int i = 0; i < meshBatches.size(); ++i)
+    {
+        const MeshBatchDescription& meshBatch = meshBatches[i];
+        const float* records = nullptr;
+
+        if(readBinaryRecords(meshBatch.binaryOffset, meshBatch.count, MeshRecordSize, records))
+        {
+            for(unsigned int j = 0; j < meshBatch.count; ++j)
+            {
+                const float* record = records + j * MeshRecordSize;
+                meshes[firstItem + j]->setTransform(Vector3(record), Quaternion(record[3], record[4], record[5], record[6]), Vector3(record + 7));
+            }
+        }
+        else
+        {
+            Quaternion rotation = getRotation(meshBatch.rotation);
+            for(unsigned int j = 0; j < meshBatch.count; ++j)
+                meshes[firstItem + j]->setTransform(meshBatch.position, rotation, meshBatch.scale);
+        }
+
+        for(unsigned int j = 0; j < meshBatch.count; ++j)
+            meshes[firstItem + j]->setOccluder(meshBatch.occluder);
+
+        firstItem += meshBatch.count;
+    }
+
+    for(unsigned int i = 0; i < meshes.size(); ++i)
+        meshItems.pushBack(meshes[i]);
+}
+
+void SceneLoader::createLights(const JSONValue& lightsJSON, Scene* scene)
+{
+    Vector<LightBatchDescription> lightBatches;
+    lightBatches.reserve(lightsJSON.getSize());
+    unsigned int numLights = 0;
+
+    for(unsigned int i = 0; i < lightsJSON.getSize(); ++i)
+    {
+        LightBatchDescription lightBatch;
+        if(lightBatchSchema.read(lightsJSON.getJSONArrayItem(i), lightBatch))
+        {
+            numLights += lightBatch.count;
+            lightBatches.pushBack(lightBatch);
+        }
+    }
+
+    if(!numLights)
+        return;
+
+    Vector<Light*> lights;
+    scene->createSceneItems<Light>(lights, numLights);
+    lightItems.reserve(numLights);
+
+    unsigned int firstItem = 0;
+    for(unsigned int i = 0; i < lightBatches.size(); ++i)
+    {
+        const LightBatchDescription& lightBatch = lightBatches[i];
+        LightType lightType = LightType::Point;
+        if(lightBatch.type.compare("Directional") == 0)
+            lightType = LightType::Directional;
+        else if(lightBatch.type.compare("Spot") == 0)
+            lightType = LightType::Spot;
+
+        const float* records = nullptr;
+        bool hasRecords = readBinaryRecords(lightBatch.binaryOffset, lightBatch.count, LightRecordSize, records);
+
+        for(unsigned int j = 0; j < lightBatch.count; ++j)
+        {
+            Light* light = lights[firstItem + j];
+            light->setLightType(lightType);
+            light->setFallOffExponent(lightBatch.fallOffExponent);
+            light->setCastShadow(lightBatch.castShadow);
+            light->setShadowBias(lightBatch.shadowBias);
+            if(lightBatch.shadowMinDistanceOffset >= 0.0f)
+                light->setShadowMinDistanceOffset(lightBatch.shadowMinDistanceOffset);
+
+            if(lightType == LightType::Spot)
+            {
+                light->setInnerConeAngle(lightBatch.innerConeAngle);
+                light->setOuterConeAngle(lightBatch.outerConeAngle);
+            }
+
+            if(lightType == LightType::Directional && lightBatch.cascadeSplits != Vector4::ZERO)
+            {
+                FixedArray<float, 4> splits = {lightBatch.cascadeSplits.x, lightBatch.cascadeSplits.y, lightBatch.cascadeSplits.z, lightBatch.cascadeSplits.w};
+                light->setCascadeSplits(splits);
+            }
+
+            if(hasRecords)
+            {
+                const float* record = records + j * LightRecordSize;
+                light->setPosition(Vector3(record));
+                light->setDirection(Vector3(record + 3));
+                light->setColor(Vector3(record + 6));
+                if(lightType != LightType::Directional)
+                    light->setRadius(record[9]);
+            }
+            else
+            {
+                light->setPosition(lightBatch.position);
+                light->setDirection(lightBatch.direction);
+                light->setColor(lightBatch.color);
+                if(lightType != LightType::Directional)
+                    light->setRadius(lightBatch.radius);
+            }
+
+            lightItems.pushBack(light);
+        }
+
+        SceneBatch batch = {getNameHash(lightBatch.name), getNameHash(lightBatch.parent), firstItem, lightBatch.count, true};
+        batches.pushBack(batch);
+        firstItem += lightBatch.count;
+    }
+}
+
+void SceneLoader::linkBatches() const
+{
+    //A batch is parented either to a single item or item by item to a batch of the same size.
+    for(unsigned int i = 0; i < batches.size(); ++i)
+    {
+        const SceneBatch& child = batches[i];
+        if(!child.parentHash)
+            continue;
+
+        const SceneBatch* parent = nullptr;
+        for(unsigned int j = 0; j < batches.size() && !parent; ++j)
+        {
+            if(batches[j].nameHash == child.parentHash && j != i)
+                parent = &batches[j];
+        }
+
+        if(!parent || (parent->count != 1 && parent->count != child.count))
+        {
+            std::cout << "Failed to link scene batch " << i << ". The parent is not declared or its count doesn't match." << std::endl;
+            continue;
+        }
+
+        for(unsigned int j = 0; j < child.count; ++j)
+            getBatchItem(*parent, parent->count == 1 ? 0 : j)->addChild(getBatchItem(child, j));
+    }
+}
+
+SpatialSceneItem* SceneLoader::getBatchItem(const SceneBatch& batch, unsigned int index) const
+{
+    return batch.light ? lightItems[batch.firstItem + index] : meshItems[batch.firstItem + index];
+}
+
+}
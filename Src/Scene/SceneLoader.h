@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef SceneLoader_H
+#define SceneLoader_H
+
+#include "Util/Vector.h"
+#include "Util/JSONValue.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include <string>
+
+namespace Huurre3D
+{
+
+class Scene;
+class SceneImporter;
+class SpatialSceneItem;
+
+//Scene binary sidecar: a header followed by numFloats floats. The batches of the scene description refer to it with a float offset.
+//The mesh records are position (3), rotation quaternion w, x, y, z (4) and scale (3).
+//The light records are position (3), direction (3), color (3) and radius (1).
+static const unsigned int SceneBinaryMagic = 0x42533348; //"H3SB"
+static const unsigned int SceneBinaryVersion = 1;
+static const unsigned int MeshRecordSize = 10;
+static const unsigned int LightRecordSize = 10;
+
+struct SceneBinaryHeader
+{
+    unsigned int magic = SceneBinaryMagic;
+    unsigned int version = SceneBinaryVersion;
+    unsigned int numFloats = 0;
+};
+
+struct SceneDescription
+{
+    Vector3 ambientLight = Vector3::ONE;
+    std::string binary;
+    Vector<std::string> skyBox;
+    JSONValue camera;
+    JSONValue models;
+    JSONValue meshes;
+    JSONValue lights;
+};
+
+struct CameraDescription
+{
+    Vector3 position = Vector3::ZERO;
+    //Angle in degrees followed by the rotation axis.
+    Vector4 rotation = Vector4(0.0f, 0.0f, 1.0f, 0.0f);
+    float fov = 45.0f;
+    float nearClipDistance = 0.1f;
+    float farClipDistance = 1000.0f;
+};
+
+//Count items of one model sharing the same description. 
+//If binaryOffset is not negative the per item transforms are read from the binary sidecar.
+struct MeshBatchDescription
+{
+    std::string name;
+    std::string model;
+    std::string parent;
+    unsigned int count = 1;
+    Vector3 position = Vector3::ZERO;
+    Vector4 rotation = Vector4(0.0f, 0.0f, 1.0f, 0.0f);
+    Vector3 scale = Vector3::ONE;
+    bool occluder = false;
+    int binaryOffset = -1;
+};
+
+struct LightBatchDescription
+{
+    std::string name;
+    std::string parent;
+    std::string type = "Point";
+    unsigned int count = 1;
+    Vector3 position = Vector3::ZERO;
+    Vector3 direction = Vector3::UNIT_Z;
+    Vector3 color = Vector3::ONE;
+    float radius = 50.0f;
+    float fallOffExponent = 1.0f;
+    float innerConeAngle = 20.0f;
+    float outerConeAngle = 30.0f;
+    bool castShadow = false;
+    float shadowBias = 0.0006f;
+    float shadowMinDistanceOffset = -1.0f;
+    Vector4 cascadeSplits = Vector4::ZERO;
+    int binaryOffset = -1;
+};
+
+//Instantiates a declarative scene file into a scene. The items of every type are created with one bulk
+//allocation and every model is imported once for all of its instances.
+class SceneLoader
+{
+public:
+    SceneLoader(SceneImporter& sceneImporter);
+    ~SceneLoader() = default;
+
+    bool loadScene(const std::string& fileName, Scene* scene);
+    static bool writeSceneBinary(const std::string& fileName, const Vector<float>& data);
+
+private:
+    struct SceneBatch
+    {
+        unsigned int nameHash;
+        unsigned int parentHash;
+        unsigned int firstItem;
+        unsigned int count;
+        bool light;
+    };
+
+    bool readBinaryRecords(int binaryOffset, unsigned int count, unsigned int recordSize, const float*& recordsOut) const;
+    void createMeshes(const JSONValue& modelsJSON, const JSONValue& meshesJSON, Scene* scene);
+    void createLights(const JSONValue& lightsJSON, Scene* scene);
+    void linkBatches() const;
+    SpatialSceneItem* getBatchItem(const SceneBatch& batch, unsigned int index) const;
+    SceneImporter& sceneImporter;
+    Vector<SceneBatch> batches;
+    Vector<SpatialSceneItem*> meshItems;
+    Vector<SpatialSceneItem*> lightItems;
+    const float* binaryData = nullptr;
+    unsigned int binaryNumFloats = 0;
+};
+
+}
+
+#endif
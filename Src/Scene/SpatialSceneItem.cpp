@@ -25,6 +25,41 @@
 namespace Huurre3D
 {
 
+SpatialSceneItem::SpatialSceneItem(const SpatialSceneItem& other):
+SceneItem(other)
+{
+    scene = nullptr;
+    settedForUpdate = false;
+    copyTransform(other);
+}
+
+SpatialSceneItem& SpatialSceneItem::operator=(const SpatialSceneItem& other)
+{
+    if(this != &other)
+    {
+        if(transformSettedForUpdate)
+            scene->removeTransformForUpdate(this);
+
+        removeParent();
+        for(unsigned int i = 0; i < children.size(); ++i)
+            children[i]->parent = nullptr;
+
+        SceneItem::operator=(other);
+        scene = nullptr;
+        settedForUpdate = false;
+        children.clear();
+        copyTransform(other);
+    }
+
+    return *this;
+}
+
+SpatialSceneItem::~SpatialSceneItem()
+{
+    if(transformSettedForUpdate)
+        scene->removeTransformForUpdate(this);
+}
+
 void SpatialSceneItem::setPosition(const Vector3& position)
 {
     localPosition = position;
@@ -60,17 +95,17 @@ void SpatialSceneItem::setTransform(const Vector3& position, const Quaternion& r
     setScale(scale);
 }
 
-const Vector3& SpatialSceneItem::getPosition(FrameOfReference frame)
+const Vector3& SpatialSceneItem::getPosition(FrameOfReference frame) const
 {
     return frame == FrameOfReference::Local ? localPosition : worldPosition;
 }
 
-const Quaternion& SpatialSceneItem::getRotation(FrameOfReference frame)
+const Quaternion& SpatialSceneItem::getRotation(FrameOfReference frame) const
 {
     return frame == FrameOfReference::Local ? localRotation : worldRotation;
 }
 
-const Vector3& SpatialSceneItem::getScale(FrameOfReference frame)
+const Vector3& SpatialSceneItem::getScale(FrameOfReference frame) const
 {
     return frame == FrameOfReference::Local ? localScale : worldScale;
 }
@@ -140,6 +175,17 @@ void SpatialSceneItem::lookAt(const Vector3& target, const Vector3& upVector, Fr
 void SpatialSceneItem::updateWorldTransform()
 {
     if(transformDirty)
+    {
+        updateWorldPositionRotationScale();
+        worldTransform.setTransform(worldPosition, worldRotation, worldScale);
+        inverseWorldTransform.setInverseTransform(worldPosition, worldRotation, worldScale);
+        transformDirty = false;
+    }
+}
+
+void SpatialSceneItem::updateWorldPositionRotationScale()
+{
+    if(worldPositionRotationScaleDirty)
     {
         if(!parent)
         {
@@ -149,15 +195,13 @@ void SpatialSceneItem::updateWorldTransform()
         }
         else
         {
-            parent->updateWorldTransform();
+            parent->updateWorldPositionRotationScale();
             worldPosition = parent->worldPosition + (parent->worldRotation.rotate(parent->worldScale * localPosition));
             worldRotation = parent->worldRotation * localRotation;
             worldScale = parent->worldScale * localScale;
         }
 
-        worldTransform.setTransform(worldPosition, worldRotation, worldScale);
-        inverseWorldTransform.setInverseTransform(worldPosition, worldRotation, worldScale);
-        transformDirty = false;
+        worldPositionRotationScaleDirty = false;
     }
 }
 
@@ -218,6 +262,13 @@ bool SpatialSceneItem::hasChild(SpatialSceneItem* child, bool recursive)
 void SpatialSceneItem::setTransformDirty()
 {
     transformDirty = true;
+    worldPositionRotationScaleDirty = true;
+
+    if(!transformSettedForUpdate)
+    {
+        scene->setTransformForUpdate(this);
+        transformSettedForUpdate = true;
+    }
 
     for(unsigned int i = 0; i < children.size(); ++i)
         children[i]->setTransformDirty();
@@ -226,4 +277,20 @@ void SpatialSceneItem::setTransformDirty()
         setForUpdate();
 }
 
-}
\ No newline at end of file
+void SpatialSceneItem::copyTransform(const SpatialSceneItem& other)
+{
+    localPosition = other.localPosition;
+    localRotation = other.localRotation;
+    localScale = other.localScale;
+    worldPosition = other.worldPosition;
+    worldRotation = other.worldRotation;
+    worldScale = other.worldScale;
+    worldTransform = other.worldTransform;
+    inverseWorldTransform = other.inverseWorldTransform;
+    //Without the parent the dirty world values could not be resolved anymore.
+    transformDirty = false;
+    worldPositionRotationScaleDirty = false;
+    transformSettedForUpdate = false;
+}
+
+}
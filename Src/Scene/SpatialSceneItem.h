@@ -40,18 +40,23 @@ enum class FrameOfReference
 
 class SpatialSceneItem : public SceneItem
 {
+    friend class Scene;
+
 public:
     SpatialSceneItem() = default;
-    virtual ~SpatialSceneItem() = default;
+    //The copy is detached from the scene and the hierarchy, it keeps the resolved local and world transforms.
+    SpatialSceneItem(const SpatialSceneItem& other);
+    SpatialSceneItem& operator=(const SpatialSceneItem& other);
+    virtual ~SpatialSceneItem();
 	
     void setPosition(const Vector3& position);
     void setRotation(const Quaternion& rotation);
     void setScale(const Vector3& scale);
     void setScale(float scale);
     void setTransform(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
-    const Vector3& getPosition(FrameOfReference frame);
-    const Quaternion& getRotation(FrameOfReference frame);
-    const Vector3& getScale(FrameOfReference frame);
+    const Vector3& getPosition(FrameOfReference frame) const;
+    const Quaternion& getRotation(FrameOfReference frame) const;
+    const Vector3& getScale(FrameOfReference frame) const;
     void translate(const Vector3& delta, FrameOfReference frame);
     void rotate(const Quaternion& delta, FrameOfReference frame);
     void pitch(float angle, FrameOfReference frame);
@@ -73,6 +78,8 @@ public:
 
 protected:
     void setTransformDirty();
+    void updateWorldPositionRotationScale();
+    void copyTransform(const SpatialSceneItem& other);
     SpatialSceneItem* parent = nullptr;
     Vector<SpatialSceneItem*> children;
     Vector3 localPosition = Vector3::ZERO;
@@ -84,6 +91,11 @@ protected:
     Matrix4x4 worldTransform = Matrix4x4::IDENTITY;
     Matrix4x4 inverseWorldTransform = Matrix4x4::IDENTITY;
     bool transformDirty = false;
+    bool worldPositionRotationScaleDirty = false;
+    //True while the item is in the scene's list of items whose world transforms are composed in a batch.
+    bool transformSettedForUpdate = false;
+    //Index of the item in the scene's list while transformSettedForUpdate is true.
+    unsigned int dirtyTransformIndex = 0;
 };
 
 }
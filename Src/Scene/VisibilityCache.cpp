@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Scene/VisibilityCache.h"
+#include <cstring>
+#include <utility>
+
+namespace Huurre3D
+{
+
+void VisibilityCache::cullRenderItems(const RenderView& view, const Frustum& frustum, const Matrix4x4& viewProjection, Vector<RenderItem>& result, CullingStatistics* statistics)
+{
+    unsigned int numTested = 0;
+    unsigned int numGroups = view.renderItemGroups.size();
+    //Compared bitwise, any movement of the camera is a new frustum.
+    bool sameFrustum = valid && memcmp(&this->viewProjection, &viewProjection, sizeof(Matrix4x4)) == 0;
+
+    if(sameFrustum && isLayoutUnchanged(view))
+    {
+        for(unsigned int i = 0; i < numGroups; ++i)
+        {
+            if(view.renderItemGroups[i].updateVersion > sceneVersion)
+                numTested += testGroup(view, i, frustum);
+        }
+    }
+    else
+    {
+        groupMeshIds.clear();
+        groupFirstItems.clear();
+        for(unsigned int i = 0; i < numGroups; ++i)
+        {
+            groupMeshIds.pushBack(view.renderItemGroups[i].meshId);
+            groupFirstItems.pushBack(view.renderItemGroups[i].firstItem);
+        }
+
+        groupNumVisible.resize(numGroups);
+        itemVisibility.resize(view.renderItems.size());
+        for(unsigned int i = 0; i < numGroups; ++i)
+            numTested += testGroup(view, i, frustum);
+
+        this->viewProjection = viewProjection;
+        valid = true;
+    }
+
+    sceneVersion = view.sceneVersion;
+
+    //The visible items are copied from the view, only their visibility is cached.
+    ++cullNumber;
+    unsigned int numResults = result.size();
+    std::swap(previousVisibleItemIds, visibleItemIds);
+    visibleItemIds.clear();
+    itemsBecameVisible.clear();
+    itemsBecameHidden.clear();
+
+    for(unsigned int i = 0; i < numGroups; ++i)
+    {
+        if(groupNumVisible[i] == 0)
+            continue;
+
+        const RenderItemGroup& group = view.renderItemGroups[i];
+        for(unsigned int j = group.firstItem; j < group.firstItem + group.numItems; ++j)
+        {
+            if(!itemVisibility[j])
+                continue;
+
+            const RenderItem& item = view.renderItems[j];
+            while(itemVisibleCulls.size() <= item.id)
+                itemVisibleCulls.pushBack(0);
+
+            if(itemVisibleCulls[item.id] != cullNumber - 1)
+                itemsBecameVisible.pushBack(item.id);
+            itemVisibleCulls[item.id] = cullNumber;
+            visibleItemIds.pushBack(item.id);
+            result.pushBack(item);
+        }
+    }
+
+    for(unsigned int i = 0; i < previousVisibleItemIds.size(); ++i)
+    {
+        if(itemVisibleCulls[previousVisibleItemIds[i]] != cullNumber)
+            itemsBecameHidden.pushBack(previousVisibleItemIds[i]);
+    }
+
+    if(statistics)
+    {
+        statistics->itemsTested += numTested;
+        statistics->itemsVisible += result.size() - numResults;
+        statistics->itemsBecameVisible += itemsBecameVisible.size();
+        statistics->itemsBecameHidden += itemsBecameHidden.size();
+    }
+}
+
+bool VisibilityCache::isLayoutUnchanged(const RenderView& view) const
+{
+    if(view.renderItemGroups.size() != groupMeshIds.size() || view.renderItems.size() != itemVisibility.size())
+        return false;
+
+    for(unsigned int i = 0; i < view.renderItemGroups.size(); ++i)
+    {
+        const RenderItemGroup& group = view.renderItemGroups[i];
+        if(group.meshId != groupMeshIds[i] || group.firstItem != groupFirstItems[i])
+            return false;
+    }
+
+    return true;
+}
+
+unsigned int VisibilityCache::testGroup(const RenderView& view, unsigned int groupIndex, const Frustum& frustum)
+{
+    const RenderItemGroup& group = view.renderItemGroups[groupIndex];
+    unsigned char* visibility = itemVisibility.begin() + group.firstItem;
+    unsigned int numVisible = 0;
+
+    switch(frustum.isInside(group.worldBoundingBox))
+    {
+        case Intersection::Inside:
+            for(unsigned int i = 0; i < group.numItems; ++i)
+                visibility[i] = 1;
+            numVisible = group.numItems;
+            break;
+        case Intersection::Intersects:
+            for(unsigned int i = 0; i < group.numItems; ++i)
+            {
+                visibility[i] = frustum.isInsideNoIntersection(view.renderItems[group.firstItem + i].worldBoundingBox) ? 1 : 0;
+                numVisible += visibility[i];
+            }
+            break;
+        default:
+            for(unsigned int i = 0; i < group.numItems; ++i)
+                visibility[i] = 0;
+            break;
+    }
+
+    groupNumVisible[groupIndex] = numVisible;
+    return group.numItems;
+}
+
+}
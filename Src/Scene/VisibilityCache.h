@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef VisibilityCache_H
+#define VisibilityCache_H
+
+#include "Scene/SceneCuller.h"
+#include "Math/Frustum.h"
+
+namespace Huurre3D
+{
+
+//Visibility of the render items of a view from the previous cull against the same frustum. While the frustum stays the same, only the
+//items of the meshes updated since the previous cull are tested again, the rest keep their cached visibility. A changed frustum, or meshes 
+//added or removed, test every item again. The items which became visible or hidden since the previous cull are kept by their ids.
+class VisibilityCache
+{
+public:
+    VisibilityCache() = default;
+    ~VisibilityCache() = default;
+
+    //The view projection matrix identifies the frustum, the frustum is the same while the matrix is.
+    void cullRenderItems(const RenderView& view, const Frustum& frustum, const Matrix4x4& viewProjection, Vector<RenderItem>& result, CullingStatistics* statistics = nullptr);
+    //The next cull tests every item.
+    void invalidate() {valid = false;}
+    const Vector<unsigned int>& getItemsBecameVisible() const {return itemsBecameVisible;}
+    const Vector<unsigned int>& getItemsBecameHidden() const {return itemsBecameHidden;}
+
+private:
+    bool isLayoutUnchanged(const RenderView& view) const;
+    unsigned int testGroup(const RenderView& view, unsigned int groupIndex, const Frustum& frustum);
+
+    Matrix4x4 viewProjection;
+    unsigned int sceneVersion = 0;
+    bool valid = false;
+    //Layout of the groups and the visible items of each group on the previous cull.
+    Vector<unsigned int> groupMeshIds;
+    Vector<unsigned int> groupFirstItems;
+    Vector<unsigned int> groupNumVisible;
+    Vector<unsigned char> itemVisibility;
+    //The number of the cull on which each item, by its id, was last visible.
+    Vector<unsigned int> itemVisibleCulls;
+    Vector<unsigned int> visibleItemIds;
+    Vector<unsigned int> previousVisibleItemIds;
+    Vector<unsigned int> itemsBecameVisible;
+    Vector<unsigned int> itemsBecameHidden;
+    //Starts from one, so the items never visible, with zero, are not taken as visible on the previous cull of the first one.
+    unsigned int cullNumber = 1;
+};
+
+}
+
+#endif
@@ -20,42 +20,318 @@
 // THE SOFTWARE.
 
 #include "Util/JSON.h"
-#include <fstream>
+#include "Util/MappedFile.h"
+#include "Math/MathFunctions.h"
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
 #include <iostream>
 
 namespace Huurre3D
 {
-    
-JSON::~JSON()
-{
-    if(root.value)
-        cJSON_Delete(root.value);
-}
+
+const unsigned int maxNumberLength = 64;
+const int errorContextLength = 32;
 
 bool JSON::parseFromFile(const std::string& fileName)
 {
-    std::ifstream ifs(fileName);
+    MappedFile file;
     bool success = false;
 
-    if(ifs)
+    if(file.open(fileName))
+        success = parse(file.getData(), file.getSize());
+    else
+        std::cout << "Failed to open file " << fileName << std::endl;
+
+    return success;
+}
+
+bool JSON::parse(const char* text, unsigned int size)
+{
+    nodes.clear();
+    childNodes.clear();
+    strings.clear();
+    childStack.clear();
+    current = text;
+    end = text + size;
+
+    nodes.pushBack(JSONNode());
+    skipWhiteSpace();
+    bool success = parseValue(0);
+
+    if(!success)
+    {
+        std::string errorContext = current ? std::string(current, current + min(static_cast<int>(end - current), errorContextLength)) : "";
+        std::cout << "Failed to parse json file. Error before: " << errorContext << std::endl;
+        nodes.clear();
+    }
+
+    current = nullptr;
+    end = nullptr;
+    return success;
+}
+
+JSONValue JSON::getRootValue() const
+{
+    return nodes.empty() ? JSONValue() : JSONValue(this, 0);
+}
+
+bool JSON::parseValue(unsigned int nodeIndex)
+{
+    if(current == end)
+        return false;
+
+    switch(*current)
     {
-        std::string fileContent((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
-        cJSON* cJSONroot = cJSON_Parse(fileContent.c_str());
-        if(!cJSONroot)
+        case '{':
+            return parseObject(nodeIndex);
+        case '[':
+            return parseArray(nodeIndex);
+        case '"':
+            nodes[nodeIndex].type = JSONType::String;
+            return parseString(nodes[nodeIndex].string);
+        case 't':
+            nodes[nodeIndex].type = JSONType::True;
+            return parseLiteral("true", 4);
+        case 'f':
+            nodes[nodeIndex].type = JSONType::False;
+            return parseLiteral("false", 5);
+        case 'n':
+            nodes[nodeIndex].type = JSONType::Null;
+            return parseLiteral("null", 4);
+        default:
+            return parseNumber(nodeIndex);
+    }
+}
+
+bool JSON::parseObject(unsigned int nodeIndex)
+{
+    nodes[nodeIndex].type = JSONType::Object;
+    unsigned int childStackStart = childStack.size();
+    ++current;
+    skipWhiteSpace();
+
+    if(current != end && *current == '}')
+    {
+        ++current;
+        setChildren(nodeIndex, childStackStart);
+        return true;
+    }
+
+    while(current != end)
+    {
+        if(*current != '"')
+            return false;
+
+        unsigned int childIndex = nodes.size();
+        nodes.pushBack(JSONNode());
+
+        unsigned int name = 0;
+        if(!parseString(name))
+            return false;
+
+        const char* nameString = &strings[name];
+        nodes[childIndex].name = name;
+        nodes[childIndex].nameHash = generateHash((const unsigned char*)nameString, strlen(nameString));
+
+        skipWhiteSpace();
+        if(current == end || *current != ':')
+            return false;
+
+        ++current;
+        skipWhiteSpace();
+        if(!parseValue(childIndex))
+            return false;
+
+        childStack.pushBack(childIndex);
+        skipWhiteSpace();
+
+        if(current == end)
+            return false;
+        if(*current == '}')
         {
-            std::cout << "Failed to parse json file. Error before: " << cJSON_GetErrorPtr() << std::endl;
-            cJSON_Delete(cJSONroot);
+            ++current;
+            setChildren(nodeIndex, childStackStart);
+            return true;
         }
-        else
+        if(*current != ',')
+            return false;
+
+        ++current;
+        skipWhiteSpace();
+    }
+
+    return false;
+}
+
+bool JSON::parseArray(unsigned int nodeIndex)
+{
+    nodes[nodeIndex].type = JSONType::Array;
+    unsigned int childStackStart = childStack.size();
+    ++current;
+    skipWhiteSpace();
+
+    if(current != end && *current == ']')
+    {
+        ++current;
+        setChildren(nodeIndex, childStackStart);
+        return true;
+    }
+
+    while(current != end)
+    {
+        unsigned int childIndex = nodes.size();
+        nodes.pushBack(JSONNode());
+
+        if(!parseValue(childIndex))
+            return false;
+
+        childStack.pushBack(childIndex);
+        skipWhiteSpace();
+
+        if(current == end)
+            return false;
+        if(*current == ']')
         {
-            root.value = cJSONroot;
-            success = true;
+            ++current;
+            setChildren(nodeIndex, childStackStart);
+            return true;
         }
+        if(*current != ',')
+            return false;
+
+        ++current;
+        skipWhiteSpace();
     }
-    else
-        std::cout << "Failed to open file " << fileName << std::endl;
 
-    return success;
+    return false;
+}
+
+bool JSON::parseString(unsigned int& stringOut)
+{
+    stringOut = strings.size();
+    ++current;
+
+    while(current != end && *current != '"')
+    {
+        //Copy the unescaped part at once.
+        const char* start = current;
+        while(current != end && *current != '"' && *current != '\\')
+            ++current;
+
+        strings.pushBack(start, current - start);
+
+        if(current != end && *current == '\\')
+        {
+            if(++current == end)
+                return false;
+
+            switch(*current)
+            {
+                case 'b': strings.pushBack('\b'); break;
+                case 'f': strings.pushBack('\f'); break;
+                case 'n': strings.pushBack('\n'); break;
+                case 'r': strings.pushBack('\r'); break;
+                case 't': strings.pushBack('\t'); break;
+                case 'u':
+                {
+                    if(end - current < 5)
+                        return false;
+
+                    unsigned int codePoint = strtoul(std::string(current + 1, current + 5).c_str(), nullptr, 16);
+                    current += 4;
+
+                    //Combine the surrogate pair.
+                    if(codePoint >= 0xD800 && codePoint <= 0xDBFF && end - current >= 7 && current[1] == '\\' && current[2] == 'u')
+                    {
+                        unsigned int lowSurrogate = strtoul(std::string(current + 3, current + 7).c_str(), nullptr, 16);
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                        current += 6;
+                    }
+
+                    appendUTF8(codePoint);
+                    break;
+                }
+                default: strings.pushBack(*current); break;
+            }
+            ++current;
+        }
+    }
+
+    if(current == end)
+        return false;
+
+    ++current;
+    strings.pushBack('\0');
+    return true;
+}
+
+bool JSON::parseNumber(unsigned int nodeIndex)
+{
+    //The mapped file is not null terminated, so the number is copied before the conversion.
+    char number[maxNumberLength];
+    unsigned int length = 0;
+
+    while(current != end && length < maxNumberLength - 1 && (isdigit(*current) || *current == '-' || *current == '+' || *current == '.' || *current == 'e' || *current == 'E'))
+        number[length++] = *current++;
+
+    if(length == 0)
+        return false;
+
+    number[length] = '\0';
+    nodes[nodeIndex].type = JSONType::Number;
+    nodes[nodeIndex].number = strtod(number, nullptr);
+    return true;
+}
+
+bool JSON::parseLiteral(const char* literal, unsigned int length)
+{
+    if(static_cast<unsigned int>(end - current) < length || strncmp(current, literal, length) != 0)
+        return false;
+
+    current += length;
+    return true;
 }
 
-}
\ No newline at end of file
+void JSON::setChildren(unsigned int nodeIndex, unsigned int childStackStart)
+{
+    unsigned int numChildren = childStack.size() - childStackStart;
+    nodes[nodeIndex].firstChild = childNodes.size();
+    nodes[nodeIndex].numChildren = numChildren;
+    childNodes.pushBack(&childStack[childStackStart], numChildren);
+
+    for(unsigned int i = 0; i < numChildren; ++i)
+        childStack.popBack();
+}
+
+void JSON::skipWhiteSpace()
+{
+    while(current != end && static_cast<unsigned char>(*current) <= ' ')
+        ++current;
+}
+
+void JSON::appendUTF8(unsigned int codePoint)
+{
+    if(codePoint < 0x80)
+        strings.pushBack(static_cast<char>(codePoint));
+    else if(codePoint < 0x800)
+    {
+        strings.pushBack(static_cast<char>(0xC0 | (codePoint >> 6)));
+        strings.pushBack(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if(codePoint < 0x10000)
+    {
+        strings.pushBack(static_cast<char>(0xE0 | (codePoint >> 12)));
+        strings.pushBack(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        strings.pushBack(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        strings.pushBack(static_cast<char>(0xF0 | (codePoint >> 18)));
+        strings.pushBack(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        strings.pushBack(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        strings.pushBack(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+}
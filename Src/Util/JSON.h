@@ -23,23 +23,46 @@
 #define JSON_H
 
 #include "Util/JSONValue.h"
+#include "Util/Vector.h"
 
 namespace Huurre3D
 {
 
+//JSON document parsed into a flat node array. The storage is kept between the parses,
+//so reloading a document of the same size does not allocate.
 class JSON
 {
+    friend class JSONValue;
+
 public:
     JSON() = default;
-    ~JSON();
+    ~JSON() = default;
 
+    //Parses the file directly from a memory mapping of it.
     bool parseFromFile(const std::string& fileName);
-    const JSONValue& getRootValue() const {return root;}
+    bool parse(const char* text, unsigned int size);
+    JSONValue getRootValue() const;
 
 private:
-    JSONValue root;
+    bool parseValue(unsigned int nodeIndex);
+    bool parseObject(unsigned int nodeIndex);
+    bool parseArray(unsigned int nodeIndex);
+    bool parseString(unsigned int& stringOut);
+    bool parseNumber(unsigned int nodeIndex);
+    bool parseLiteral(const char* literal, unsigned int length);
+    void setChildren(unsigned int nodeIndex, unsigned int childStackStart);
+    void skipWhiteSpace();
+    void appendUTF8(unsigned int codePoint);
+
+    Vector<JSONNode> nodes;
+    Vector<unsigned int> childNodes;
+    Vector<char> strings;
+    //Children of the arrays and objects being parsed, moved into childNodes when the array or object ends.
+    Vector<unsigned int> childStack;
+    const char* current = nullptr;
+    const char* end = nullptr;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef JSONSchema_H
+#define JSONSchema_H
+
+#include "Util/JSONValue.h"
+#include "Util/EnumClassDeclaration.h"
+#include "Util/Vector.h"
+#include "Math/MathFunctions.h"
+#include <functional>
+#include <iostream>
+#include <assert.h>
+
+namespace Huurre3D
+{
+
+inline void readJSONValue(const JSONValue& valueJSON, int& valueOut) {valueOut = valueJSON.getInt();}
+inline void readJSONValue(const JSONValue& valueJSON, unsigned int& valueOut) {valueOut = static_cast<unsigned int>(valueJSON.getInt());}
+inline void readJSONValue(const JSONValue& valueJSON, bool& valueOut) {valueOut = valueJSON.getBool();}
+inline void readJSONValue(const JSONValue& valueJSON, float& valueOut) {valueOut = valueJSON.getFloat();}
+inline void readJSONValue(const JSONValue& valueJSON, std::string& valueOut) {valueOut = valueJSON.getString();}
+inline void readJSONValue(const JSONValue& valueJSON, Vector2& valueOut) {valueOut = valueJSON.getVector2();}
+inline void readJSONValue(const JSONValue& valueJSON, Vector3& valueOut) {valueOut = valueJSON.getVector3();}
+inline void readJSONValue(const JSONValue& valueJSON, Vector4& valueOut) {valueOut = valueJSON.getVector4();}
+inline void readJSONValue(const JSONValue& valueJSON, Matrix4x4& valueOut) {valueOut = valueJSON.getMatrix4x4();}
+inline void readJSONValue(const JSONValue& valueJSON, FixedArray<int, 2>& valueOut) {valueOut = valueJSON.getInt2();}
+inline void readJSONValue(const JSONValue& valueJSON, FixedArray<int, 3>& valueOut) {valueOut = valueJSON.getInt3();}
+inline void readJSONValue(const JSONValue& valueJSON, FixedArray<int, 4>& valueOut) {valueOut = valueJSON.getInt4();}
+//Nested values that are bound later by their own schema.
+inline void readJSONValue(const JSONValue& valueJSON, JSONValue& valueOut) {valueOut = valueJSON;}
+
+inline void readJSONValue(const JSONValue& valueJSON, Vector<std::string>& valueOut)
+{
+    for(unsigned int i = 0; i < valueJSON.getSize(); ++i)
+        valueOut.pushBack(valueJSON.getJSONArrayItem(i).getString());
+}
+
+template<class T> typename std::enable_if<std::is_enum<T>::value>::type readJSONValue(const JSONValue& valueJSON, T& valueOut)
+{
+    valueOut = enumFromString<T>(valueJSON.getString());
+}
+
+//Typed binding of a JSON object to a description struct. The members of the object are visited once and matched
+//to the fields by their name hashes and names, members without a field are ignored.
+template<class T> class JSONSchema
+{
+public:
+    JSONSchema(const std::string& name) :
+    name(name)
+    {}
+    ~JSONSchema() = default;
+
+    template<class M> JSONSchema<T>& addField(const std::string& fieldName, M T::*member, bool mandatory = false)
+    {
+        assert(fields.size() < MaxFields);
+
+        Field field;
+        field.name = fieldName;
+        field.nameHash = generateHash((const unsigned char*)fieldName.c_str(), fieldName.size());
+        field.mandatory = mandatory;
+        field.read = [member](const JSONValue& valueJSON, T& description){readJSONValue(valueJSON, description.*member);};
+        fields.pushBack(field);
+        return *this;
+    }
+
+    //Fields missing from the object keep their values. Returns false if any of the mandatory fields is missing.
+    bool read(const JSONValue& objectJSON, T& descriptionOut) const
+    {
+        unsigned long long foundFields = 0;
+
+        for(unsigned int i = 0; i < objectJSON.getSize(); ++i)
+        {
+            JSONValue memberJSON = objectJSON.getJSONArrayItem(i);
+            unsigned int nameHash = memberJSON.getNameHash();
+
+            for(unsigned int j = 0; j < fields.size(); ++j)
+            {
+                if(fields[j].nameHash == nameHash && fields[j].name.compare(memberJSON.getName()) == 0)
+                {
+                    fields[j].read(memberJSON, descriptionOut);
+                    foundFields |= 1ull << j;
+                    break;
+                }
+            }
+        }
+
+        std::string missingFields;
+        for(unsigned int j = 0; j < fields.size(); ++j)
+        {
+            if(fields[j].mandatory && (foundFields & (1ull << j)) == 0)
+                missingFields += (missingFields.empty() ? "" : ", ") + fields[j].name;
+        }
+
+        if(!missingFields.empty())
+        {
+            std::cout << "Failed to read " << name << " from JSON. The mandatory values: " << missingFields << " are missing" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static const unsigned int MaxFields = 64;
+
+    struct Field
+    {
+        std::string name;
+        unsigned int nameHash;
+        bool mandatory;
+        std::function<void(const JSONValue&, T&)> read;
+    };
+
+    std::string name;
+    Vector<Field> fields;
+};
+
+}
+
+#endif
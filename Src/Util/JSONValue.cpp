@@ -19,135 +19,158 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include "JSONValue.h"
+#include "Util/JSONValue.h"
+#include "Util/JSON.h"
+#include "Math/MathFunctions.h"
 
 namespace Huurre3D
 {
 
-JSONValue::JSONValue(cJSON* value) :
-value(value)
+JSONValue::JSONValue(const JSON* document, unsigned int node) :
+document(document),
+node(node)
 {
 }
 
-JSONValue& JSONValue::operator = (const JSONValue& rhs)
+JSONValue JSONValue::getJSONValue(const std::string& name) const
 {
-    value = rhs.value;
-    return *this;
+    if(document)
+    {
+        const JSONNode& objectNode = getNode();
+        if(objectNode.type == JSONType::Object)
+        {
+            unsigned int nameHash = generateHash((const unsigned char*)name.c_str(), name.size());
+            const unsigned int* children = &document->childNodes[objectNode.firstChild];
+            for(unsigned int i = 0; i < objectNode.numChildren; ++i)
+            {
+                const JSONNode& childNode = document->nodes[children[i]];
+                //The hash only rejects, the name decides the match.
+                if(childNode.nameHash == nameHash && name.compare(&document->strings[childNode.name]) == 0)
+                    return JSONValue(document, children[i]);
+            }
+        }
+    }
+
+    return JSONValue();
 }
 
-void JSONValue::setJSONValue(const JSONValue& valueJSON)
+JSONValue JSONValue::getJSONArrayItem(const unsigned int index) const
 {
-    cJSON_AddItemReferenceToObject(value, valueJSON.value->string, valueJSON.value);
+    return index < getSize() ? JSONValue(document, document->childNodes[getNode().firstChild + index]) : JSONValue();
 }
 
-JSONValue JSONValue::getJSONValue(const std::string& name) const
+unsigned int JSONValue::getSize() const
 {
-    return JSONValue(cJSON_GetObjectItem(value, name.c_str()));
+    return document ? getNode().numChildren : 0;
 }
 
-JSONValue JSONValue::getJSONArrayItem(const unsigned int index) const
+const char* JSONValue::getName() const
 {
-    return JSONValue(cJSON_GetArrayItem(value, index));
+    return &document->strings[getNode().name];
 }
 
-unsigned int JSONValue::getSize() const
+unsigned int JSONValue::getNameHash() const
+{
+    return getNode().nameHash;
+}
+
+JSONType JSONValue::getType() const
 {
-    return cJSON_GetArraySize(value);
+    return document ? getNode().type : JSONType::Null;
 }
 
 int JSONValue::getInt() const
 {
-    return value->valueint;
+    return static_cast<int>(getNode().number);
 }
 
 FixedArray<int, 2> JSONValue::getInt2() const
 {
     FixedArray<int, 2> data;
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-        data[i] = cJSON_GetArrayItem(value, i)->valueint;
-
+    getInts(data.data(), 2);
     return data;
 }
 
 FixedArray<int, 3> JSONValue::getInt3() const
 {
     FixedArray<int, 3> data;
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-        data[i] = cJSON_GetArrayItem(value, i)->valueint;
-
+    getInts(data.data(), 3);
     return data;
 }
 
 FixedArray<int, 4> JSONValue::getInt4() const
 {
     FixedArray<int, 4> data;
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-        data[i] = cJSON_GetArrayItem(value, i)->valueint;
-
+    getInts(data.data(), 4);
     return data;
 }
 
 bool JSONValue::getBool() const
 {
-    return value->type != 0;
+    return getNode().type != JSONType::False;
 }
 
 float JSONValue::getFloat() const
 {
-    return static_cast<float>(value->valuedouble);
+    return static_cast<float>(getNode().number);
 }
 
 Vector2 JSONValue::getVector2() const
 {
     float data[2];
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-    {
-        cJSON* subitem = cJSON_GetArrayItem(value, i);
-        data[i] = static_cast<float>(subitem->valuedouble);
-    }
-
+    getFloats(data, 2);
     return Vector2(data);
 }
 
 Vector3 JSONValue::getVector3() const
 {
     float data[3];
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-    {
-        cJSON* subitem = cJSON_GetArrayItem(value, i);
-        data[i] = static_cast<float>(subitem->valuedouble);
-    }
-
+    getFloats(data, 3);
     return Vector3(data);
 }
 
 Vector4 JSONValue::getVector4() const
 {
     float data[4];
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-    {
-        cJSON* subitem = cJSON_GetArrayItem(value, i);
-        data[i] = static_cast<float>(subitem->valuedouble);
-    }
-
+    getFloats(data, 4);
     return Vector4(data);
 }
 
 Matrix4x4 JSONValue::getMatrix4x4() const
 {
     float data[16];
-    for(int i = 0; i < cJSON_GetArraySize(value); i++)
-    {
-        cJSON* subitem = cJSON_GetArrayItem(value, i);
-        data[i] = static_cast<float>(subitem->valuedouble);
-    }
-
+    getFloats(data, 16);
     return Matrix4x4(Vector4(&data[0]), Vector4(&data[4]), Vector4(&data[8]), Vector4(&data[12]));
 }
 
 const std::string JSONValue::getString() const
 {
-    return std::string(value->valuestring);
+    return std::string(getCString());
+}
+
+const char* JSONValue::getCString() const
+{
+    const JSONNode& stringNode = getNode();
+    return stringNode.type == JSONType::String ? &document->strings[stringNode.string] : "";
 }
 
-}
\ No newline at end of file
+const JSONNode& JSONValue::getNode() const
+{
+    return document->nodes[node];
+}
+
+void JSONValue::getFloats(float* data, unsigned int numFloats) const
+{
+    const JSONNode& arrayNode = getNode();
+    for(unsigned int i = 0; i < numFloats; ++i)
+        data[i] = i < arrayNode.numChildren ? static_cast<float>(document->nodes[document->childNodes[arrayNode.firstChild + i]].number) : 0.0f;
+}
+
+void JSONValue::getInts(int* data, unsigned int numInts) const
+{
+    const JSONNode& arrayNode = getNode();
+    for(unsigned int i = 0; i < numInts; ++i)
+        data[i] = i < arrayNode.numChildren ? static_cast<int>(document->nodes[document->childNodes[arrayNode.firstChild + i]].number) : 0;
+}
+
+}
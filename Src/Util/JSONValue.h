@@ -24,27 +24,56 @@
 
 #include "Math/Matrix4x4.h"
 #include "Util/FixedArray.h"
-#include "ThirdParty/cJSON/cJSON.h"
 #include <string>
 
 namespace Huurre3D
 {
 
+class JSON;
+
+enum class JSONType
+{
+    Null,
+    False,
+    True,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+//Node of the flat document. Strings and names are offsets to the string storage of the document,
+//the children of arrays and objects are stored contiguously as node indices.
+//A value initialized node is a null value.
+struct JSONNode
+{
+    JSONType type;
+    unsigned int nameHash;
+    unsigned int name;
+    unsigned int string;
+    double number;
+    unsigned int firstChild;
+    unsigned int numChildren;
+};
+
 class JSONValue
 {
     friend class JSON;
 
 public:
     JSONValue() = default;
-    JSONValue(cJSON* value);
     ~JSONValue() = default;
 
-    JSONValue& operator = (const JSONValue& rhs);
-    void setJSONValue(const JSONValue& valueJSON);
+    //Object member lookup, compares the hashes of the member names and then the names.
     JSONValue getJSONValue(const std::string& name) const;
+    //Returns an array item, or a member of an object in the declaration order.
     JSONValue getJSONArrayItem(const unsigned int index) const;
-    //Returns array size.
+    //Returns array size, or the number of members of an object.
     unsigned int getSize() const;
+    //Name of the value when it is a member of an object.
+    const char* getName() const;
+    unsigned int getNameHash() const;
+    JSONType getType() const;
     int getInt() const;
     FixedArray<int, 2> getInt2() const;
     FixedArray<int, 3> getInt3() const;
@@ -56,12 +85,19 @@ public:
     Vector4 getVector4() const;
     Matrix4x4 getMatrix4x4() const;
     const std::string getString() const;
-    bool isNull() const { return value == nullptr; }
+    const char* getCString() const;
+    bool isNull() const {return document == nullptr;}
 
 private:
-    cJSON* value = nullptr;
+    JSONValue(const JSON* document, unsigned int node);
+    const JSONNode& getNode() const;
+    void getFloats(float* data, unsigned int numFloats) const;
+    void getInts(int* data, unsigned int numInts) const;
+
+    const JSON* document = nullptr;
+    unsigned int node = 0;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Util/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Huurre3D
+{
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    fileHandle = file;
+    size = static_cast<unsigned int>(GetFileSize(file, NULL));
+
+    //Empty files can not be mapped, they are left open with no data.
+    if(size == 0)
+        return true;
+
+    mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mappingHandle)
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+    if(!data)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(data)
+        UnmapViewOfFile(data);
+    if(mappingHandle)
+        CloseHandle(mappingHandle);
+    if(fileHandle)
+        CloseHandle(fileHandle);
+
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+    fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if(fileDescriptor < 0)
+        return false;
+
+    struct stat fileStatus;
+    if(fstat(fileDescriptor, &fileStatus) != 0)
+    {
+        close();
+        return false;
+    }
+
+    size = static_cast<unsigned int>(fileStatus.st_size);
+
+    //Empty files can not be mapped, they are left open with no data.
+    if(size == 0)
+        return true;
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if(mapping == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+
+    data = static_cast<const char*>(mapping);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(data)
+        munmap(const_cast<char*>(data), size);
+    if(fileDescriptor >= 0)
+        ::close(fileDescriptor);
+
+    data = nullptr;
+    size = 0;
+    fileDescriptor = -1;
+}
+
+#endif
+
+}
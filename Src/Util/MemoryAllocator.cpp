@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Util/MemoryAllocator.h"
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <stdlib.h>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace Huurre3D
+{
+
+struct AtomicTagStatistics
+{
+    std::atomic<unsigned int> currentBytes;
+    std::atomic<unsigned int> peakBytes;
+    std::atomic<unsigned int> numAllocations;
+    std::atomic<unsigned int> totalAllocations;
+};
+
+//The counters are only statistics, so relaxed ordering is enough for them.
+//Zero initialized as static data before any dynamic initialization, so allocations of other statics are accounted correctly.
+static AtomicTagStatistics tagStatistics[static_cast<int>(MemoryTag::NumTags)];
+static MemoryAllocator* currentAllocator = nullptr;
+static const char* memoryTagNames[] = {"General", "Geometry", "Texture", "ShaderParameters", "LightGrid", "Animation", "Scene"};
+
+static void addBytes(AtomicTagStatistics& statistics, unsigned int size)
+{
+    unsigned int currentBytes = statistics.currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    unsigned int peakBytes = statistics.peakBytes.load(std::memory_order_relaxed);
+    while(currentBytes > peakBytes && !statistics.peakBytes.compare_exchange_weak(peakBytes, currentBytes, std::memory_order_relaxed));
+}
+
+//The heaps of the 64-bit platforms return 16-byte aligned memory already.
+#if defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__)
+#define HEAP_MEMORY_ALIGNED
+#endif
+
+static unsigned char* allocateAligned(unsigned int size)
+{
+#if defined(HEAP_MEMORY_ALIGNED)
+    return static_cast<unsigned char*>(malloc(size));
+#elif defined(_MSC_VER)
+    return static_cast<unsigned char*>(_aligned_malloc(size, MemoryAlignment));
+#else
+    void* data = nullptr;
+    return posix_memalign(&data, MemoryAlignment, size) == 0 ? static_cast<unsigned char*>(data) : nullptr;
+#endif
+}
+
+static void deallocateAligned(unsigned char* data)
+{
+#if defined(HEAP_MEMORY_ALIGNED)
+    free(data);
+#elif defined(_MSC_VER)
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+//The header of a block is padded so the allocations after it stay aligned.
+static const unsigned int arenaBlockHeaderSize = (sizeof(void*) + 2 * sizeof(unsigned int) + MemoryAlignment - 1) & ~(MemoryAlignment - 1);
+
+ArenaAllocator::ArenaAllocator(unsigned int blockSize):
+blockSize(blockSize)
+{
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    ArenaBlock* block = firstBlock;
+    while(block)
+    {
+        ArenaBlock* next = block->next;
+        deallocateAligned(reinterpret_cast<unsigned char*>(block));
+        block = next;
+    }
+}
+
+unsigned char* ArenaAllocator::allocate(unsigned int size, MemoryTag tag)
+{
+    size = (size + MemoryAlignment - 1) & ~(MemoryAlignment - 1);
+
+    while(currentBlock && currentBlock->used + size > currentBlock->size)
+        currentBlock = currentBlock->next;
+
+    if(!currentBlock)
+    {
+        unsigned int newBlockSize = size > blockSize ? size : blockSize;
+        unsigned char* blockData = allocateAligned(arenaBlockHeaderSize + newBlockSize);
+        if(!blockData)
+            return nullptr;
+
+        currentBlock = reinterpret_cast<ArenaBlock*>(blockData);
+        currentBlock->next = nullptr;
+        currentBlock->size = newBlockSize;
+        currentBlock->used = 0;
+        if(lastBlock)
+            lastBlock->next = currentBlock;
+        else
+            firstBlock = currentBlock;
+
+        lastBlock = currentBlock;
+    }
+
+    unsigned char* data = reinterpret_cast<unsigned char*>(currentBlock) + arenaBlockHeaderSize + currentBlock->used;
+    currentBlock->used += size;
+    numBytesAllocated += size;
+    return data;
+}
+
+void ArenaAllocator::reset()
+{
+    for(ArenaBlock* block = firstBlock; block; block = block->next)
+        block->used = 0;
+
+    currentBlock = firstBlock;
+    numBytesAllocated = 0;
+}
+
+unsigned char* Memory::allocate(unsigned int size, MemoryTag tag, MemoryAllocator* allocator)
+{
+    AtomicTagStatistics& statistics = tagStatistics[static_cast<int>(tag)];
+    addBytes(statistics, size);
+    statistics.numAllocations.fetch_add(1, std::memory_order_relaxed);
+    statistics.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(!allocator)
+        allocator = currentAllocator;
+
+    unsigned char* data = allocator ? allocator->allocate(size, tag) : allocateAligned(size);
+    if(!data && size)
+    {
+        statistics.currentBytes.fetch_sub(size, std::memory_order_relaxed);
+        statistics.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+        std::cout << "Failed to allocate " << size << " bytes of " << memoryTagNames[static_cast<int>(tag)] << " memory" << std::endl;
+        throw std::bad_alloc();
+    }
+
+    return data;
+}
+
+void Memory::deallocate(unsigned char* data, unsigned int size, MemoryTag tag, MemoryAllocator* allocator)
+{
+    if(!data)
+        return;
+
+    AtomicTagStatistics& statistics = tagStatistics[static_cast<int>(tag)];
+    statistics.currentBytes.fetch_sub(size, std::memory_order_relaxed);
+    statistics.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+    if(!allocator)
+        allocator = currentAllocator;
+
+    if(allocator)
+        allocator->deallocate(data, size, tag);
+    else
+        deallocateAligned(data);
+}
+
+void Memory::retag(unsigned int size, MemoryTag oldTag, MemoryTag newTag)
+{
+    if(oldTag == newTag)
+        return;
+
+    AtomicTagStatistics& oldStatistics = tagStatistics[static_cast<int>(oldTag)];
+    AtomicTagStatistics& newStatistics = tagStatistics[static_cast<int>(newTag)];
+    oldStatistics.currentBytes -= size;
+    --oldStatistics.numAllocations;
+    addBytes(newStatistics, size);
+    ++newStatistics.numAllocations;
+}
+
+void Memory::setAllocator(MemoryAllocator* allocator)
+{
+    currentAllocator = allocator;
+}
+
+MemoryTagStatistics Memory::getStatistics(MemoryTag tag)
+{
+    const AtomicTagStatistics& statistics = tagStatistics[static_cast<int>(tag)];
+    MemoryTagStatistics result;
+    result.currentBytes = statistics.currentBytes.load();
+    result.peakBytes = statistics.peakBytes.load();
+    result.numAllocations = statistics.numAllocations.load();
+    result.totalAllocations = statistics.totalAllocations.load();
+    return result;
+}
+
+const char* Memory::getTagName(MemoryTag tag)
+{
+    return memoryTagNames[static_cast<int>(tag)];
+}
+
+void Memory::logStatistics()
+{
+    for(int i = 0; i < static_cast<int>(MemoryTag::NumTags); ++i)
+    {
+        MemoryTagStatistics statistics = getStatistics(static_cast<MemoryTag>(i));
+        std::cout << memoryTagNames[i] << ": " << statistics.currentBytes << " bytes (peak " << statistics.peakBytes << "), "
+            << statistics.numAllocations << " allocations (" << statistics.totalAllocations << " total)" << std::endl;
+    }
+}
+
+}
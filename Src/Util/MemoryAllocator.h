@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MemoryAllocator_H
+#define MemoryAllocator_H
+
+namespace Huurre3D
+{
+
+//Alignment of the default allocations, enough for 4-wide SIMD loads of the math types.
+static const unsigned int MemoryAlignment = 16;
+
+//The subsystem an allocation is accounted to.
+enum class MemoryTag
+{
+    General,
+    Geometry,
+    Texture,
+    ShaderParameters,
+    LightGrid,
+    Animation,
+    Scene,
+    NumTags
+};
+
+struct MemoryTagStatistics
+{
+    unsigned int currentBytes = 0;
+    unsigned int peakBytes = 0;
+    //Allocations alive at the moment and all allocations made.
+    unsigned int numAllocations = 0;
+    unsigned int totalAllocations = 0;
+};
+
+//Interface for replacing the heap allocations of the MemoryBuffers, and so of every Vector.
+//An allocator is either set for all the buffers with Memory::setAllocator, before anything is allocated since the buffers are freed
+//with the allocator active at the time, or for a single buffer or Vector with its setAllocator.
+class MemoryAllocator
+{
+public:
+    MemoryAllocator() = default;
+    virtual ~MemoryAllocator() = default;
+    virtual unsigned char* allocate(unsigned int size, MemoryTag tag) = 0;
+    virtual void deallocate(unsigned char* data, unsigned int size, MemoryTag tag) = 0;
+};
+
+//Allocates from blocks by bumping an offset. Deallocation does nothing and reset() makes all the memory available again,
+//so the arena suits containers that are thrown away together, like per frame scratch data. Not thread safe.
+class ArenaAllocator : public MemoryAllocator
+{
+public:
+    explicit ArenaAllocator(unsigned int blockSize = 65536);
+    ~ArenaAllocator();
+    unsigned char* allocate(unsigned int size, MemoryTag tag) override;
+    void deallocate(unsigned char* data, unsigned int size, MemoryTag tag) override {}
+    //Nothing allocated from the arena may be used after this.
+    void reset();
+    unsigned int getNumBytesAllocated() const {return numBytesAllocated;}
+
+private:
+    struct ArenaBlock
+    {
+        ArenaBlock* next;
+        unsigned int size;
+        unsigned int used;
+    };
+
+    unsigned int blockSize;
+    unsigned int numBytesAllocated = 0;
+    ArenaBlock* firstBlock = nullptr;
+    ArenaBlock* lastBlock = nullptr;
+    ArenaBlock* currentBlock = nullptr;
+};
+
+//Entry point of all the tagged allocations. Keeps the per tag statistics, thread safe.
+class Memory
+{
+public:
+    //A null allocator uses the one set with setAllocator. Reports a failed allocation and throws std::bad_alloc like new does.
+    static unsigned char* allocate(unsigned int size, MemoryTag tag, MemoryAllocator* allocator = nullptr);
+    static void deallocate(unsigned char* data, unsigned int size, MemoryTag tag, MemoryAllocator* allocator = nullptr);
+    //Moves the accounting of an allocation from a tag to another.
+    static void retag(unsigned int size, MemoryTag oldTag, MemoryTag newTag);
+    //Null restores the default allocator, which returns MemoryAlignment aligned memory.
+    static void setAllocator(MemoryAllocator* allocator);
+    static MemoryTagStatistics getStatistics(MemoryTag tag);
+    static const char* getTagName(MemoryTag tag);
+    static void logStatistics();
+};
+
+}
+
+#endif
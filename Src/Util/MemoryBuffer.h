@@ -22,31 +22,60 @@
 #ifndef MemoryBuffer_H
 #define MemoryBuffer_H
 
+#include "Util/MemoryAllocator.h"
 #include <string>
 
 namespace Huurre3D
 {
 
+//A constructed buffer takes the memory tag and the allocator of the buffer it is constructed from, an assigned buffer keeps its own tag.
+//The allocator travels with the memory: a buffer that takes over the memory of another one by a move also takes its allocator.
+//A buffer can be given inline storage that is used until the data outgrows it, the inline storage is never freed by the buffer.
 class MemoryBuffer
 {
 public:
     MemoryBuffer() = default;
-    MemoryBuffer(MemoryBuffer&& buffer) {*this = std::move(buffer);}
+    explicit MemoryBuffer(MemoryTag tag):
+    tag(tag)
+    {}
+    MemoryBuffer(MemoryBuffer&& buffer):
+    tag(buffer.tag),
+    allocator(buffer.allocator)
+    {
+        *this = std::move(buffer);
+    }
     ~MemoryBuffer() {resetBuffer();}
     MemoryBuffer& operator = (const MemoryBuffer& rhs) 
     {
-        bufferData(rhs.getData(), rhs.getSizeInBytes());
+        if(this != &rhs)
+            bufferData(rhs.getData(), rhs.getSizeInBytes());
         return *this;
     }
     MemoryBuffer& operator = (MemoryBuffer&& rhs)
     {
+        if(this == &rhs)
+            return *this;
+
+        //Data in inline storage can't be taken over, it's copied instead.
+        if(rhs.isInline())
+        {
+            bufferData(rhs.data, rhs.sizeInBytes);
+            rhs.sizeInBytes = 0;
+            return *this;
+        }
+
         this->resetBuffer();
-        data = rhs.data;
-        capacity = rhs.capacity;
-        sizeInBytes = rhs.sizeInBytes;
-        rhs.capacity = 0;
+        if(rhs.data)
+        {
+            Memory::retag(rhs.capacity, rhs.tag, tag);
+            data = rhs.data;
+            capacity = rhs.capacity;
+            sizeInBytes = rhs.sizeInBytes;
+            allocator = rhs.allocator;
+            rhs.data = rhs.inlineStorage;
+            rhs.capacity = rhs.inlineCapacity;
+        }
         rhs.sizeInBytes = 0;
-        rhs.data = nullptr;
         return *this;
     }
 
@@ -54,13 +83,48 @@ public:
     unsigned int getSizeInBytes() const {return sizeInBytes;}
     unsigned int getCapacity() const {return capacity;}
     bool isNull() const {return data == nullptr;}
+    bool isInline() const {return data && data == inlineStorage;}
+    MemoryTag getMemoryTag() const {return tag;}
+    void setMemoryTag(MemoryTag newTag)
+    {
+        if(data && !isInline())
+            Memory::retag(capacity, tag, newTag);
+        tag = newTag;
+    }
+    MemoryAllocator* getAllocator() const {return allocator;}
+    //The data is moved into memory from the new allocator if there is any.
+    void setAllocator(MemoryAllocator* newAllocator)
+    {
+        if(newAllocator == allocator)
+            return;
+
+        if(data && !isInline())
+        {
+            unsigned char* newData = Memory::allocate(capacity, tag, newAllocator);
+            copyData(newData, data, sizeInBytes);
+            Memory::deallocate(data, capacity, tag, allocator);
+            data = newData;
+        }
+        allocator = newAllocator;
+    }
+    //Uses the given storage until the data outgrows it. Can only be set for an empty buffer without memory.
+    void setInlineStorage(unsigned char* storage, unsigned int storageCapacity)
+    {
+        if(!data)
+        {
+            inlineStorage = storage;
+            inlineCapacity = storageCapacity;
+            data = storage;
+            capacity = storageCapacity;
+        }
+    }
     void clearBuffer() {sizeInBytes = 0;}
     void resetBuffer()
     {
         sizeInBytes = 0;
-        capacity = 0;
-        delete[] data;
-        data = nullptr;
+        freeData();
+        capacity = inlineCapacity;
+        data = inlineStorage;
     }
 
     template<typename T> void bufferData(const T* data, unsigned int dataSize)
@@ -80,22 +144,16 @@ public:
     {
         if(newSize > capacity)
         {
-            if(capacity)
+            unsigned int newCapacity = capacity;
+            if(newCapacity)
             {
-                while(capacity < newSize)
-                    capacity += capacity;
+                while(newCapacity < newSize)
+                    newCapacity += newCapacity;
             }
             else
-                capacity = newSize;
+                newCapacity = newSize;
 
-            unsigned char* newData = allocate(capacity);
-            //Move the data into the new buffer and delete the old
-            if(data)
-            {
-                copyData(newData, data, sizeInBytes);
-                delete[] data;
-            }
-            data = newData;
+            reallocate(newCapacity);
         }
         sizeInBytes = newSize;
     }
@@ -103,30 +161,37 @@ public:
     void reserve(unsigned int newCapacity)
     {
         if(newCapacity > capacity)
-        {
-            unsigned char* newData = nullptr;
-            capacity = newCapacity;
-
-            if(capacity)
-            {
-                newData = allocate(capacity);
-                //Move the data into the new buffer
-                copyData(newData, data, sizeInBytes);
-            }
-
-            // Delete the old buffer
-            delete[] data;
-            data = newData;
-        }
+            reallocate(newCapacity);
     }
 
 private:
-    unsigned char* allocate(unsigned int size) const {return new unsigned char[size];}
     template<typename T> void copyData(unsigned char* destination, const T* source, unsigned int size) {memcpy(destination, source, size);}
 
+    //Moves the data into a new allocation.
+    void reallocate(unsigned int newCapacity)
+    {
+        unsigned char* newData = Memory::allocate(newCapacity, tag, allocator);
+        if(data)
+            copyData(newData, data, sizeInBytes);
+
+        freeData();
+        data = newData;
+        capacity = newCapacity;
+    }
+
+    void freeData()
+    {
+        if(!isInline())
+            Memory::deallocate(data, capacity, tag, allocator);
+    }
+
     unsigned char* data = nullptr;
     unsigned int sizeInBytes = 0;
     unsigned int capacity = 0;
+    MemoryTag tag = MemoryTag::General;
+    MemoryAllocator* allocator = nullptr;
+    unsigned char* inlineStorage = nullptr;
+    unsigned int inlineCapacity = 0;
 };
 
 }
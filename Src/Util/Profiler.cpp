@@ -0,0 +1,334 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Util/Profiler.h"
+#include "Math/MathFunctions.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL thread_local
+#endif
+
+namespace Huurre3D
+{
+
+//Must be a power of two.
+static const unsigned int ProfileThreadBufferSize = 1 << 16;
+
+struct ProfileEvent
+{
+    const char* name;
+    long long startTime;
+    long long endTime;
+    unsigned int depth;
+};
+
+struct ProfileThreadBuffer
+{
+    std::string threadName;
+    unsigned int threadIndex = 0;
+    unsigned int readIndex = 0;
+    std::atomic<unsigned int> writeIndex;
+    ProfileEvent events[ProfileThreadBufferSize];
+
+    ProfileThreadBuffer()
+    {
+        writeIndex = 0;
+    }
+};
+
+struct ProfilerData
+{
+    std::mutex access;
+    Vector<ProfileThreadBuffer*> threadBuffers;
+    Vector<ProfileZoneStatistics> zoneStatistics;
+    //Index of the statistics of every name pointer seen so far.
+    std::unordered_map<const char*, unsigned int> zoneIndices;
+    Vector<ProfileEvent> copiedEvents;
+    std::string traceFileName;
+    long long startTime = Profiler::getTimeStamp();
+    unsigned int frameCount = 0;
+
+    ~ProfilerData()
+    {
+        for(unsigned int i = 0; i < threadBuffers.size(); ++i)
+            delete threadBuffers[i];
+    }
+};
+
+static ProfilerData profilerData;
+static PROFILER_THREAD_LOCAL ProfileThreadBuffer* threadBuffer = nullptr;
+static PROFILER_THREAD_LOCAL unsigned int threadZoneDepth = 0;
+
+static ProfileThreadBuffer* getThreadBuffer()
+{
+    if(!threadBuffer)
+    {
+        threadBuffer = new ProfileThreadBuffer();
+        std::lock_guard<std::mutex> lock(profilerData.access);
+        threadBuffer->threadIndex = profilerData.threadBuffers.size();
+        threadBuffer->threadName = "Thread " + std::to_string(threadBuffer->threadIndex);
+        profilerData.threadBuffers.pushBack(threadBuffer);
+    }
+
+    return threadBuffer;
+}
+
+static ProfileZoneStatistics& findZoneStatistics(const char* name)
+{
+    Vector<ProfileZoneStatistics>& zoneStatistics = profilerData.zoneStatistics;
+    auto zoneIndex = profilerData.zoneIndices.find(name);
+    if(zoneIndex != profilerData.zoneIndices.end())
+        return zoneStatistics[zoneIndex->second];
+
+    //The same name literal can have a different address in different translation units,
+    //so a new name pointer is compared by its string once.
+    int index = zoneStatistics.getIndexToItem([name](const ProfileZoneStatistics& statistics){return strcmp(statistics.name, name) == 0;});
+    if(index == -1)
+    {
+        ProfileZoneStatistics statistics;
+        statistics.name = name;
+        statistics.frameTimes = Vector<float>(ProfileStatisticsWindow);
+        statistics.frameTimes.fill(0.0f);
+        zoneStatistics.pushBack(statistics);
+        index = zoneStatistics.size() - 1;
+    }
+
+    profilerData.zoneIndices[name] = index;
+    return zoneStatistics[index];
+}
+
+//Copies the events of a thread buffer from the first index up to its write index. The writer can wrap around onto the slots
+//while they are copied, so the write index is read again after the copy and the events whose slots it has reached are skipped.
+//Returns the index of the first intact event in the copied events.
+static unsigned int copyThreadEvents(const ProfileThreadBuffer* buffer, unsigned int firstIndex, unsigned int& writeIndexOut, Vector<ProfileEvent>& eventsOut)
+{
+    unsigned int writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+    if(writeIndex - firstIndex > ProfileThreadBufferSize)
+        firstIndex = writeIndex - ProfileThreadBufferSize;
+
+    eventsOut.clear();
+    for(unsigned int i = firstIndex; i != writeIndex; ++i)
+        eventsOut.pushBack(buffer->events[i & (ProfileThreadBufferSize - 1)]);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    unsigned int lastWriteIndex = buffer->writeIndex.load(std::memory_order_relaxed);
+    //The writer may be writing the event of the last write index, which takes the slot of the event a buffer size before it.
+    int numOverwritten = static_cast<int>(lastWriteIndex - firstIndex) + 1 - static_cast<int>(ProfileThreadBufferSize);
+
+    writeIndexOut = writeIndex;
+    return static_cast<unsigned int>(clampInt(numOverwritten, 0, static_cast<int>(eventsOut.size())));
+}
+
+static void writeJSONString(std::ostream& stream, const char* string)
+{
+    stream << '"';
+    for(const char* c = string; *c; ++c)
+    {
+        if(*c == '"' || *c == '\\')
+            stream << '\\' << *c;
+        else if(static_cast<unsigned char>(*c) < 0x20)
+        {
+            const char* hexDigits = "0123456789abcdef";
+            stream << "\\u00" << hexDigits[(*c >> 4) & 0xf] << hexDigits[*c & 0xf];
+        }
+        else
+            stream << *c;
+    }
+    stream << '"';
+}
+
+long long Profiler::getTimeStamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    buffer->threadName = name;
+}
+
+unsigned int Profiler::beginZone()
+{
+    return threadZoneDepth++;
+}
+
+void Profiler::endZone(const char* name, long long startTime, unsigned int depth)
+{
+    long long endTime = getTimeStamp();
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+    threadZoneDepth = depth;
+
+    unsigned int index = buffer->writeIndex.load(std::memory_order_relaxed);
+    //Orders the stored write index before the event, which can overwrite an event the collector is copying.
+    std::atomic_thread_fence(std::memory_order_release);
+    ProfileEvent& event = buffer->events[index & (ProfileThreadBufferSize - 1)];
+    event.name = name;
+    event.startTime = startTime;
+    event.endTime = endTime;
+    event.depth = depth;
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame()
+{
+    std::unique_lock<std::mutex> lock(profilerData.access);
+    Vector<ProfileZoneStatistics>& zoneStatistics = profilerData.zoneStatistics;
+    unsigned int frameSlot = profilerData.frameCount % ProfileStatisticsWindow;
+
+    for(unsigned int i = 0; i < zoneStatistics.size(); ++i)
+    {
+        zoneStatistics[i].numCalls = 0;
+        zoneStatistics[i].frameTime = 0.0f;
+    }
+
+    for(unsigned int i = 0; i < profilerData.threadBuffers.size(); ++i)
+    {
+        ProfileThreadBuffer* buffer = profilerData.threadBuffers[i];
+        Vector<ProfileEvent>& events = profilerData.copiedEvents;
+        unsigned int firstEvent = copyThreadEvents(buffer, buffer->readIndex, buffer->readIndex, events);
+
+        for(unsigned int j = firstEvent; j < events.size(); ++j)
+        {
+            const ProfileEvent& event = events[j];
+            ProfileZoneStatistics& statistics = findZoneStatistics(event.name);
+            ++statistics.numCalls;
+            statistics.frameTime += float(event.endTime - event.startTime) * 1.0e-6f;
+        }
+    }
+
+    unsigned int numFrames = profilerData.frameCount < ProfileStatisticsWindow ? profilerData.frameCount + 1 : ProfileStatisticsWindow;
+    for(unsigned int i = 0; i < zoneStatistics.size(); ++i)
+    {
+        ProfileZoneStatistics& statistics = zoneStatistics[i];
+        statistics.frameTimes[frameSlot] = statistics.frameTime;
+        statistics.minTime = statistics.frameTimes[0];
+        statistics.maxTime = statistics.frameTimes[0];
+        float totalTime = 0.0f;
+
+        for(unsigned int j = 0; j < numFrames; ++j)
+        {
+            statistics.minTime = min(statistics.minTime, statistics.frameTimes[j]);
+            statistics.maxTime = max(statistics.maxTime, statistics.frameTimes[j]);
+            totalTime += statistics.frameTimes[j];
+        }
+
+        statistics.averageTime = totalTime / float(numFrames);
+    }
+
+    ++profilerData.frameCount;
+
+    if(!profilerData.traceFileName.empty())
+    {
+        std::string fileName = profilerData.traceFileName;
+        profilerData.traceFileName.clear();
+        lock.unlock();
+        writeChromeTrace(fileName);
+    }
+}
+
+void Profiler::requestChromeTrace(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    profilerData.traceFileName = fileName;
+}
+
+bool Profiler::writeChromeTrace(const std::string& fileName)
+{
+    std::ofstream traceFile(fileName);
+    if(!traceFile.is_open())
+    {
+        std::cout << "Failed to open profiler trace file " << fileName << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    bool firstEvent = true;
+    traceFile << "{\"displayTimeUnit\" : \"ns\", \"traceEvents\" : [" << std::endl;
+
+    for(unsigned int i = 0; i < profilerData.threadBuffers.size(); ++i)
+    {
+        const ProfileThreadBuffer* buffer = profilerData.threadBuffers[i];
+        Vector<ProfileEvent>& events = profilerData.copiedEvents;
+        unsigned int writeIndex = 0;
+        unsigned int firstIndex = copyThreadEvents(buffer, 0, writeIndex, events);
+
+        traceFile << (firstEvent ? "" : ",\n") << "{\"name\" : \"thread_name\", \"ph\" : \"M\", \"pid\" : 0, \"tid\" : " << buffer->threadIndex
+                  << ", \"args\" : {\"name\" : ";
+        writeJSONString(traceFile, buffer->threadName.c_str());
+        traceFile << "}}";
+        firstEvent = false;
+
+        for(unsigned int j = firstIndex; j < events.size(); ++j)
+        {
+            const ProfileEvent& event = events[j];
+            //Chrome trace timestamps are microseconds.
+            traceFile << ",\n{\"name\" : ";
+            writeJSONString(traceFile, event.name);
+            traceFile << ", \"ph\" : \"X\", \"pid\" : 0, \"tid\" : " << buffer->threadIndex
+                      << ", \"ts\" : " << double(event.startTime - profilerData.startTime) * 1.0e-3
+                      << ", \"dur\" : " << double(event.endTime - event.startTime) * 1.0e-3 << "}";
+        }
+    }
+
+    traceFile << std::endl << "]}" << std::endl;
+    std::cout << "Wrote profiler trace " << fileName << std::endl;
+
+    return true;
+}
+
+void Profiler::logZoneStatistics()
+{
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    const Vector<ProfileZoneStatistics>& zoneStatistics = profilerData.zoneStatistics;
+
+    unsigned int numFrames = profilerData.frameCount < ProfileStatisticsWindow ? profilerData.frameCount : ProfileStatisticsWindow;
+    std::cout << "Profiler zones over " << numFrames << " frames (ms): average, min, max, calls on last frame" << std::endl;
+    for(unsigned int i = 0; i < zoneStatistics.size(); ++i)
+    {
+        const ProfileZoneStatistics& statistics = zoneStatistics[i];
+        std::cout << "    " << statistics.name << ": " << statistics.averageTime << ", " << statistics.minTime << ", " << statistics.maxTime << ", " << statistics.numCalls << std::endl;
+    }
+}
+
+void Profiler::getZoneStatistics(Vector<ProfileZoneStatistics>& statisticsOut)
+{
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    statisticsOut = profilerData.zoneStatistics;
+}
+
+unsigned int Profiler::getFrameCount()
+{
+    std::lock_guard<std::mutex> lock(profilerData.access);
+    return profilerData.frameCount;
+}
+
+}
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef Profiler_H
+#define Profiler_H
+
+#include "Util/Vector.h"
+#include <string>
+
+namespace Huurre3D
+{
+
+//Number of frames the rolling zone statistics are calculated from.
+static const unsigned int ProfileStatisticsWindow = 120;
+
+struct ProfileZoneStatistics
+{
+    const char* name = nullptr;
+    //Calls and time in milliseconds of the zone on the last frame.
+    unsigned int numCalls = 0;
+    float frameTime = 0.0f;
+    //Time in milliseconds per frame over the statistics window.
+    float averageTime = 0.0f;
+    float minTime = 0.0f;
+    float maxTime = 0.0f;
+    Vector<float> frameTimes;
+};
+
+//Scoped CPU profiler. Every thread writes the finished zones into its own ring buffer with nanosecond timestamps,
+//the buffers are collected into the rolling statistics at the end of every frame, when no zones are open on the worker threads.
+//Zones are declared with the PROFILE_ZONE macro, which is compiled out when USE_PROFILER is not defined.
+class Profiler
+{
+public:
+    static long long getTimeStamp();
+    static void setThreadName(const char* name);
+    static unsigned int beginZone();
+    static void endZone(const char* name, long long startTime, unsigned int depth);
+    //Collects the zones of the frame into the statistics and writes a requested trace.
+    static void endFrame();
+    //Writes the zones still held in the thread buffers as chrome://tracing or Perfetto JSON at the end of the current frame.
+    static void requestChromeTrace(const std::string& fileName);
+    static bool writeChromeTrace(const std::string& fileName);
+    static void logZoneStatistics();
+    //Copies the statistics, which the end of the next frame updates.
+    static void getZoneStatistics(Vector<ProfileZoneStatistics>& statisticsOut);
+    static unsigned int getFrameCount();
+};
+
+class ProfileZone
+{
+public:
+    ProfileZone(const char* name):
+    name(name),
+    depth(Profiler::beginZone()),
+    startTime(Profiler::getTimeStamp())
+    {}
+
+    ~ProfileZone()
+    {
+        Profiler::endZone(name, startTime, depth);
+    }
+
+private:
+    const char* name;
+    unsigned int depth;
+    long long startTime;
+};
+
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef USE_PROFILER
+#define PROFILE_ZONE(name) Huurre3D::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Huurre3D::Profiler::setThreadName(name)
+#define PROFILE_END_FRAME() Huurre3D::Profiler::endFrame()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+#define PROFILE_END_FRAME()
+#endif
+
+#endif
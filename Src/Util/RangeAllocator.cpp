@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Util/RangeAllocator.h"
+
+namespace Huurre3D
+{
+
+RangeAllocator::RangeAllocator(unsigned int size)
+{
+    grow(size);
+}
+
+unsigned int RangeAllocator::allocate(unsigned int size)
+{
+    if(size == 0 || size > numFreeUnits)
+        return InvalidRangeOffset;
+
+    int bestFit = -1;
+    for(unsigned int i = 0; i < freeRanges.size(); ++i)
+    {
+        unsigned int rangeSize = freeRanges[i].size;
+        if(rangeSize >= size && (bestFit == -1 || rangeSize < freeRanges[bestFit].size))
+        {
+            bestFit = i;
+            if(rangeSize == size)
+                break;
+        }
+    }
+
+    if(bestFit == -1)
+        return InvalidRangeOffset;
+
+    Range& range = freeRanges[bestFit];
+    unsigned int offset = range.offset;
+    range.offset += size;
+    range.size -= size;
+    if(range.size == 0)
+        freeRanges.erase(bestFit);
+
+    numFreeUnits -= size;
+    return offset;
+}
+
+void RangeAllocator::free(unsigned int offset, unsigned int size)
+{
+    if(size == 0)
+        return;
+
+    //Index of the first free range after the freed one.
+    unsigned int next = 0;
+    unsigned int count = freeRanges.size();
+    while(count > 0)
+    {
+        unsigned int step = count / 2;
+        if(freeRanges[next + step].offset < offset)
+        {
+            next += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+
+    bool mergeWithPrevious = next > 0 && freeRanges[next - 1].offset + freeRanges[next - 1].size == offset;
+    bool mergeWithNext = next < freeRanges.size() && offset + size == freeRanges[next].offset;
+
+    if(mergeWithPrevious && mergeWithNext)
+    {
+        freeRanges[next - 1].size += size + freeRanges[next].size;
+        freeRanges.erase(next);
+    }
+    else if(mergeWithPrevious)
+        freeRanges[next - 1].size += size;
+    else if(mergeWithNext)
+    {
+        freeRanges[next].offset = offset;
+        freeRanges[next].size += size;
+    }
+    else
+        freeRanges.insert(next, Range(offset, size));
+
+    numFreeUnits += size;
+}
+
+void RangeAllocator::grow(unsigned int newSize)
+{
+    if(newSize > size)
+    {
+        unsigned int oldSize = size;
+        size = newSize;
+        free(oldSize, newSize - oldSize);
+    }
+}
+
+void RangeAllocator::reset(unsigned int usedSize)
+{
+    freeRanges.clear();
+    numFreeUnits = 0;
+    if(usedSize < size)
+        free(usedSize, size - usedSize);
+}
+
+unsigned int RangeAllocator::getLargestFreeRange() const
+{
+    unsigned int largest = 0;
+    for(unsigned int i = 0; i < freeRanges.size(); ++i)
+        largest = freeRanges[i].size > largest ? freeRanges[i].size : largest;
+
+    return largest;
+}
+
+}
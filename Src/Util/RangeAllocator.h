@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RangeAllocator_H
+#define RangeAllocator_H
+
+#include "Util/Vector.h"
+
+namespace Huurre3D
+{
+
+static const unsigned int InvalidRangeOffset = 0xffffffff;
+
+//Hands out ranges of a linear space, such as the elements of a buffer. The free ranges are kept sorted by their offset 
+//and a freed range is merged with its free neighbours, so the number of free ranges stays low.
+class RangeAllocator
+{
+public:
+    RangeAllocator() = default;
+    explicit RangeAllocator(unsigned int size);
+    ~RangeAllocator() = default;
+
+    //Returns the offset of the smallest free range the size fits in, or InvalidRangeOffset when there is no such range.
+    unsigned int allocate(unsigned int size);
+    void free(unsigned int offset, unsigned int size);
+    //Adds free space to the end.
+    void grow(unsigned int newSize);
+    //Marks the first usedSize units used and the rest free. Used after the allocations have been compacted to the beginning.
+    void reset(unsigned int usedSize);
+    unsigned int getSize() const {return size;}
+    unsigned int getNumFreeUnits() const {return numFreeUnits;}
+    unsigned int getNumFreeRanges() const {return freeRanges.size();}
+    unsigned int getLargestFreeRange() const;
+
+private:
+    struct Range
+    {
+        Range() = default;
+        Range(unsigned int offset, unsigned int size):
+        offset(offset),
+        size(size)
+        {}
+
+        unsigned int offset = 0;
+        unsigned int size = 0;
+    };
+
+    Vector<Range> freeRanges;
+    unsigned int size = 0;
+    unsigned int numFreeUnits = 0;
+};
+
+}
+
+#endif
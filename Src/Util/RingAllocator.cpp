@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Util/RingAllocator.h"
+
+namespace Huurre3D
+{
+
+RingAllocator::RingAllocator(unsigned int size)
+{
+    reset(size);
+}
+
+void RingAllocator::reset(unsigned int size)
+{
+    this->size = size;
+    head = tail = usedSize = currentFrameSize = 0;
+    frames.clear();
+}
+
+unsigned int RingAllocator::allocate(unsigned int size, unsigned int alignment)
+{
+    if(size == 0 || size > this->size || usedSize == this->size)
+        return InvalidRingOffset;
+
+    //An empty ring starts over from the beginning to have all of its space in one piece.
+    if(usedSize == 0)
+        head = tail = 0;
+
+    unsigned int offset = alignment > 1 ? (head + alignment - 1) / alignment * alignment : head;
+    unsigned int allocatedSize = 0;
+
+    if(head >= tail)
+    {
+        //The free space is after the head and before the tail.
+        if(offset + size <= this->size)
+            allocatedSize = offset + size - head;
+        else if(size <= tail)
+        {
+            allocatedSize = this->size - head + size;
+            offset = 0;
+        }
+        else
+            return InvalidRingOffset;
+    }
+    else
+    {
+        //The free space is between the head and the tail.
+        if(offset + size <= tail)
+            allocatedSize = offset + size - head;
+        else
+            return InvalidRingOffset;
+    }
+
+    head = offset + size;
+    usedSize += allocatedSize;
+    currentFrameSize += allocatedSize;
+    return offset;
+}
+
+void RingAllocator::endFrame(unsigned int fence)
+{
+    frames.pushBack(Frame(fence, currentFrameSize));
+    currentFrameSize = 0;
+}
+
+void RingAllocator::releaseOldestFrame()
+{
+    if(frames.empty())
+        return;
+
+    if(size > 0)
+        tail = (tail + frames[0].size) % size;
+    usedSize -= frames[0].size;
+    frames.erase(0);
+}
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef RingAllocator_H
+#define RingAllocator_H
+
+#include "Util/Vector.h"
+
+namespace Huurre3D
+{
+
+static const unsigned int InvalidRingOffset = 0xffffffff;
+
+//Hands out aligned ranges of a ring for data which is written once per frame, such as the shader parameters.
+//The ranges of a frame are freed together when the fence that ended the frame has been released, the fences themselves
+//belong to the user of the ring.
+class RingAllocator
+{
+public:
+    RingAllocator() = default;
+    explicit RingAllocator(unsigned int size);
+    ~RingAllocator() = default;
+
+    //Frees everything and sets the size of the ring.
+    void reset(unsigned int size);
+    //Returns the offset of the range, or InvalidRingOffset when the frames in flight leave no room for it.
+    unsigned int allocate(unsigned int size, unsigned int alignment);
+    //The ranges allocated since the previous frame stay in use until the frame is released.
+    void endFrame(unsigned int fence);
+    void releaseOldestFrame();
+    bool hasFramesInFlight() const {return !frames.empty();}
+    unsigned int getOldestFence() const {return frames[0].fence;}
+    unsigned int getNumFramesInFlight() const {return frames.size();}
+    unsigned int getSize() const {return size;}
+    //Includes the alignment padding and the unused end of the ring skipped when the allocations wrap around.
+    unsigned int getUsedSize() const {return usedSize;}
+
+private:
+    struct Frame
+    {
+        Frame() = default;
+        Frame(unsigned int fence, unsigned int size):
+        fence(fence),
+        size(size)
+        {}
+
+        unsigned int fence = 0;
+        unsigned int size = 0;
+    };
+
+    Vector<Frame> frames;
+    unsigned int size = 0;
+    unsigned int head = 0;
+    unsigned int tail = 0;
+    unsigned int usedSize = 0;
+    unsigned int currentFrameSize = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SmallVector_H
+#define SmallVector_H
+
+#include "Util/Vector.h"
+
+namespace Huurre3D
+{
+
+//Vector with storage for N items inside the object, the heap is used only when it grows past N items.
+//Can be used wherever a Vector is expected.
+template<class T, unsigned int N> class SmallVector : public Vector<T>
+{
+public:
+    SmallVector()
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+    }
+
+    explicit SmallVector(MemoryTag tag):
+    Vector<T>(tag)
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+    }
+
+    SmallVector(const Vector<T>& vector):
+    Vector<T>(vector.getMemoryTag())
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+        this->pushBack(vector);
+    }
+
+    SmallVector(const SmallVector<T, N>& vector):
+    Vector<T>(vector.getMemoryTag())
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+        this->pushBack(vector);
+    }
+
+    SmallVector(SmallVector<T, N>&& vector):
+    Vector<T>(vector.getMemoryTag())
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+        Vector<T>::operator = (std::move(vector));
+    }
+
+    SmallVector(std::initializer_list<T> list)
+    {
+        this->setInlineStorage(reinterpret_cast<unsigned char*>(&storage), N);
+        const T* iter = list.begin();
+        while(iter != list.end())
+        {
+            this->pushBack(*iter);
+            ++iter;
+        }
+    }
+
+    //The items are destructed here while the storage is still alive, the Vector destructor has nothing left to do.
+    ~SmallVector()
+    {
+        this->reset();
+    }
+
+    SmallVector<T, N>& operator = (const Vector<T>& rhs)
+    {
+        Vector<T>::operator = (rhs);
+        return *this;
+    }
+
+    SmallVector<T, N>& operator = (const SmallVector<T, N>& rhs)
+    {
+        Vector<T>::operator = (rhs);
+        return *this;
+    }
+
+    SmallVector<T, N>& operator = (Vector<T>&& rhs)
+    {
+        Vector<T>::operator = (std::move(rhs));
+        return *this;
+    }
+
+    SmallVector<T, N>& operator = (SmallVector<T, N>&& rhs)
+    {
+        Vector<T>::operator = (std::move(rhs));
+        return *this;
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T) * N, std::alignment_of<T>::value>::type storage;
+};
+
+}
+
+#endif
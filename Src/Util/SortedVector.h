@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SortedVector_H
+#define SortedVector_H
+
+#include "Util/Vector.h"
+#include <functional>
+
+namespace Huurre3D
+{
+
+//Vector that keeps its items in the order given by Less, the lookups are binary searches.
+//Lookups take any key type that Less can compare with the items in both orders.
+//Items with equal keys are kept in the order they were inserted and the lookups find the first of them.
+template<class T, class Less = std::less<T>> class SortedVector
+{
+public:
+    SortedVector() = default;
+    explicit SortedVector(MemoryTag tag):
+    items(tag)
+    {}
+
+    //Returns the index of the inserted item.
+    unsigned int insert(const T& item)
+    {
+        unsigned int index = upperBound(item);
+        items.insert(index, item);
+        return index;
+    }
+
+    template<class K> int getIndexToItem(const K& key) const
+    {
+        unsigned int index = lowerBound(key);
+        return index < items.size() && !less(key, items[index]) ? static_cast<int>(index) : -1;
+    }
+
+    //The key of the returned item must not be modified. Returns null if the item is not found.
+    template<class K> T* findItem(const K& key)
+    {
+        int index = getIndexToItem(key);
+        return index != -1 ? &items[index] : nullptr;
+    }
+
+    template<class K> const T* findItem(const K& key) const
+    {
+        int index = getIndexToItem(key);
+        return index != -1 ? &items[index] : nullptr;
+    }
+
+    template<class K> bool containsItem(const K& key) const {return getIndexToItem(key) != -1;}
+
+    template<class K> bool eraseItem(const K& key)
+    {
+        int index = getIndexToItem(key);
+        if(index != -1)
+            items.erase(index);
+
+        return index != -1;
+    }
+
+    void erase(unsigned int index) {items.erase(index);}
+    void clear() {items.clear();}
+    void reset() {items.reset();}
+    void reserve(unsigned int numItems) {items.reserve(numItems);}
+    const T& operator [] (unsigned int index) const {return items[index];}
+    bool empty() const {return items.empty();}
+    unsigned int size() const {return items.size();}
+    const T* begin() const {return items.begin();}
+    const T* end() const {return items.end();}
+    const Vector<T>& getItems() const {return items;}
+
+private:
+    //Index of the first item not less than the key. The halving doesn't branch on the comparison, which keeps short lookups as fast as a linear search.
+    template<class K> unsigned int lowerBound(const K& key) const
+    {
+        if(items.empty())
+            return 0;
+
+        const T* first = items.begin();
+        unsigned int numItems = items.size();
+        while(numItems > 1)
+        {
+            unsigned int half = numItems / 2;
+            first = less(first[half], key) ? first + half : first;
+            numItems -= half;
+        }
+        return static_cast<unsigned int>(first - items.begin()) + (less(*first, key) ? 1 : 0);
+    }
+
+    //Index of the first item greater than the key.
+    template<class K> unsigned int upperBound(const K& key) const
+    {
+        unsigned int first = 0;
+        unsigned int numItems = items.size();
+        while(numItems > 0)
+        {
+            unsigned int half = numItems / 2;
+            if(!less(key, items[first + half]))
+            {
+                first += half + 1;
+                numItems -= half + 1;
+            }
+            else
+                numItems = half;
+        }
+        return first;
+    }
+
+    Vector<T> items;
+    Less less;
+};
+
+}
+
+#endif
@@ -29,35 +29,55 @@
 namespace Huurre3D
 {
 
+//Size of the first allocation of a growing vector, unless more is needed. Short vectors of small items grow without reallocations.
+static const unsigned int VectorMinimumCapacityInBytes = 64;
+
+//Items are relocated with memcpy if T is POD and with move construction otherwise.
+//The capacity grows by the growth factor when set, or by a factor that shrinks as the vector gets larger.
 template<class T> class Vector
 {
 public:
     Vector():
-    pod(std::is_pod<T>::value),
-    count(0)
+    count(0),
+    pod(std::is_pod<T>::value)
     {}
 
     Vector(unsigned int numItems):
-    pod(std::is_pod<T>::value),
-    count(numItems)
+    count(0),
+    pod(std::is_pod<T>::value)
     {
-        data.resize(numItems * sizeof(T));
-        if(!pod)
-            constructItems(items(), count);
+        resize(numItems);
     }
 
+    explicit Vector(MemoryTag tag):
+    count(0),
+    pod(std::is_pod<T>::value),
+    data(tag)
+    {}
+
     Vector(const Vector<T>& vector):
+    count(0),
     pod(vector.pod),
-    count(0)
+    growthFactor(vector.growthFactor),
+    data(vector.data.getMemoryTag())
     {
-        clear();
         pushBack(vector);
     }
 
+    Vector(Vector<T>&& vector):
+    count(0),
+    pod(vector.pod),
+    growthFactor(vector.growthFactor),
+    data(vector.data.getMemoryTag())
+    {
+        *this = std::move(vector);
+    }
+
     Vector(std::initializer_list<T> list) :
-    pod(std::is_pod<T>::value),
-    count(0)
+    count(0),
+    pod(std::is_pod<T>::value)
     {
+        reserve(static_cast<unsigned int>(list.size()));
         const T* iter = list.begin();
         while(iter != list.end())
         {
@@ -74,37 +94,67 @@ public:
 
     Vector<T>& operator = (const Vector<T>& rhs)
     {
-        pod = rhs.pod;
-        clear();
-        pushBack(rhs);
+        if(this != &rhs)
+        {
+            clear();
+            pushBack(rhs);
+        }
         return *this;
     }
 
     Vector<T>& operator = (Vector<T>&& rhs)
     {
-        pod = rhs.pod;
+        if(this == &rhs)
+            return *this;
+
         clear();
-        count = rhs.count;
-        data = std::move(rhs.data);
+        if(rhs.data.isInline())
+        {
+            //Items in inline storage can't be taken over, they are moved one by one.
+            reserve(rhs.count);
+            relocateItems(items(), rhs.items(), rhs.count);
+            data.resize(rhs.count * sizeof(T));
+            count = rhs.count;
+            rhs.data.clearBuffer();
+        }
+        else
+        {
+            data = std::move(rhs.data);
+            count = rhs.count;
+        }
+        rhs.count = 0;
         return *this;
     }
 
     void pushBack(const T& item) 
     {
-        pod ? data.append(&item, sizeof(T)) : appendAndCopyConstruct(&item, 1);
-        ++count;
+        if(count == capacity())
+        {
+            //The item may be in this vector, copy it before the items are relocated.
+            T itemCopy(item);
+            grow(1);
+            new(items() + count)T(std::move(itemCopy));
+        }
+        else
+            new(items() + count)T(item);
+
+        setCount(count + 1);
     }
 
     void pushBack(T&& item)
     {
-        pod ? data.append(&item, sizeof(T)) : appendAndMoveConstruct(std::move(item), 1);
-        ++count;
+        if(count == capacity())
+            grow(1);
+
+        new(items() + count)T(std::move(item));
+        setCount(count + 1);
     }
 
     void pushBack(const T* items, unsigned int numItems)
     {
         if(items)
         {
+            grow(numItems);
             pod ? data.append(items, sizeof(T) * numItems) : appendAndCopyConstruct(items, numItems);
             count += numItems;
         }
@@ -114,6 +164,7 @@ public:
     {
         if(!vector.empty())
         {
+            grow(vector.size());
             pod ? data.append(vector.items(), vector.getSizeInBytes()) : appendAndCopyConstruct(vector.items(), vector.size());
             count += vector.size();
         }
@@ -123,21 +174,68 @@ public:
     {
         if(!empty())
         {
-            data.resize(data.getSizeInBytes() - sizeof(T));
             if(!pod)
                 destructItems(end() - 1, 1);
 
+            data.resize(data.getSizeInBytes() - sizeof(T));
             --count;
         }
     }
 
+    //Inserts the item before the item at the index, the items after it are moved by one.
+    void insert(unsigned int index, const T& item)
+    {
+        if(index >= count)
+        {
+            pushBack(item);
+            return;
+        }
+
+        //Copy the item first, it may be an item of this vector.
+        T itemCopy(item);
+        grow(1);
+        T* iter = items();
+        if(pod)
+        {
+            memmove(iter + index + 1, iter + index, (count - index) * sizeof(T));
+            iter[index] = itemCopy;
+        }
+        else
+        {
+            new(iter + count)T(std::move(iter[count - 1]));
+            for(unsigned int i = count - 1; i > index; --i)
+                iter[i] = std::move(iter[i - 1]);
+            iter[index] = std::move(itemCopy);
+        }
+        data.resize(data.getSizeInBytes() + sizeof(T));
+        ++count;
+    }
+
+    //Preserves the order of the items, the items after the index are moved by one.
+    void erase(unsigned int index)
+    {
+        if(index < count)
+        {
+            T* iter = items();
+            if(pod)
+                memmove(iter + index, iter + index + 1, (count - index - 1) * sizeof(T));
+            else
+            {
+                for(unsigned int i = index; i < count - 1; ++i)
+                    iter[i] = std::move(iter[i + 1]);
+            }
+
+            popBack();
+        }
+    }
+
     //Doesn't resize the vector nor preserve the order of the items.
     void eraseUnordered(const T& item)
     {
         T* iter = findItem(item);
         if(iter != end())
         {
-            if(*iter != back())
+            if(iter != end() - 1)
                 *iter = std::move(*(end() - 1));
 
             popBack();
@@ -149,7 +247,7 @@ public:
         if(index < count)
         {
             T* iter = items();
-            if (iter[index] != back())
+            if(index != count - 1)
                 iter[index] = std::move(*(end() - 1));
 
             popBack();
@@ -215,7 +313,7 @@ public:
         }
     }
 
-    int getIndexToItem(const T& item)
+    int getIndexToItem(const T& item) const
     {
         T* iter = items();
         int index = 0;
@@ -232,7 +330,7 @@ public:
         return -1;
     }
 
-    template<class F>  int getIndexToItem(const F& function)
+    template<class F>  int getIndexToItem(const F& function) const
     {
         T* iter = items();
         int index = 0;
@@ -270,6 +368,22 @@ public:
         count = 0;
     }
 
+    //New items are default constructed, POD items are left uninitialized.
+    void resize(unsigned int numItems)
+    {
+        if(numItems > count)
+        {
+            reserve(numItems);
+            if(!pod)
+                constructItems(end(), numItems - count);
+        }
+        else if(!pod)
+            destructItems(items() + numItems, count - numItems);
+
+        data.resize(numItems * sizeof(T));
+        count = numItems;
+    }
+
     void fill(const T& value)
     {
         T* iter = items();
@@ -285,6 +399,7 @@ public:
     bool containsItem(const T& item) const {return findItem(item) != end();}
     bool empty() const { return count == 0;}
     unsigned int size() const {return count;}
+    unsigned int capacity() const {return data.getCapacity() / sizeof(T);}
     T* begin() {return items();}
     T* end() {return items() + count;}
     const T* begin() const {return items();}
@@ -295,53 +410,103 @@ public:
     const T& back() const {return items()[count - 1];}
     T* getData() const {return items();}
     unsigned int getSizeInBytes() const {return data.getSizeInBytes();}
-    void reserve(unsigned int numItems) {data.reserve(numItems * sizeof(T));}
+    void reserve(unsigned int numItems)
+    {
+        if(numItems * sizeof(T) > data.getCapacity())
+            reallocate(numItems, data.getAllocator());
+    }
     MemoryBuffer& getMemoryBuffer() {return data;}
+    MemoryTag getMemoryTag() const {return data.getMemoryTag();}
+    void setMemoryTag(MemoryTag tag) {data.setMemoryTag(tag);}
+    MemoryAllocator* getAllocator() const {return data.getAllocator();}
+    //Existing items are moved into memory from the new allocator.
+    void setAllocator(MemoryAllocator* allocator)
+    {
+        if(data.isNull() || data.isInline())
+            data.setAllocator(allocator);
+        else if(allocator != data.getAllocator())
+            reallocate(capacity(), allocator);
+    }
+    //A factor of 0 or less restores the default growth.
+    void setGrowthFactor(float factor) {growthFactor = factor;}
+    float getGrowthFactor() const {return growthFactor;}
+
+protected:
+    //Used by SmallVector to give the vector storage inside the object. Only valid for an empty vector without memory.
+    void setInlineStorage(unsigned char* storage, unsigned int numItems) {data.setInlineStorage(storage, numItems * sizeof(T));}
 
 private:
     unsigned int count;
     bool pod;
+    float growthFactor = 0.0f;
     MemoryBuffer data;
     T* items() const { return reinterpret_cast<T*>(data.getData()); }
 
     void appendAndCopyConstruct(const T* itemData, unsigned int numItems)
     {
-        append(numItems);
         copyConstructItems(end(), itemData, numItems);
+        data.resize(data.getSizeInBytes() + numItems * sizeof(T));
     }
 
-    void appendAndMoveConstruct(T&& itemData, unsigned int numItems)
+    //The capacity must be enough for the count.
+    void setCount(unsigned int newCount)
     {
-        append(numItems);
-        new(end())T(std::move(itemData));
+        count = newCount;
+        data.resize(newCount * sizeof(T));
     }
 
-    void append(unsigned int numItems)
+    //Makes room for numItems more items.
+    void grow(unsigned int numItems)
     {
-        unsigned int dataCapacityInbytes = data.getCapacity();
-        unsigned int newDataSizeInBytes = data.getSizeInBytes() + numItems * sizeof(T);
+        unsigned int newCount = count + numItems;
+        unsigned int currentCapacity = capacity();
 
-        if(newDataSizeInBytes > dataCapacityInbytes)
+        if(newCount > currentCapacity)
         {
-            MemoryBuffer newData;
-            dataCapacityInbytes = dataCapacityInbytes == 0 ? newDataSizeInBytes : dataCapacityInbytes;
-            //Start growing aggressively and then slow down to avoid excessive memory consumption.
-            float growFactor = 3.0f;
-            if(dataCapacityInbytes > 64000)
-                growFactor = 2.0f;
-            else if(dataCapacityInbytes > 500000)
-                growFactor = 1.5f;
-            else if(dataCapacityInbytes > 5000000)
-                growFactor = 1.2f;
-
-            unsigned int newSize = static_cast<unsigned int>(float(dataCapacityInbytes) * growFactor);
-            newData.reserve(newSize);
-            moveConstructItems(reinterpret_cast<T*>(newData.getData()), items(), count);
-            destructItems(items(), count);
-            data = std::move(newData);
+            float factor = growthFactor;
+            if(factor <= 0.0f)
+            {
+                //Start growing aggressively and then slow down to avoid excessive memory consumption.
+                unsigned int capacityInBytes = currentCapacity * sizeof(T);
+                factor = 3.0f;
+                if(capacityInBytes > 5000000)
+                    factor = 1.2f;
+                else if(capacityInBytes > 500000)
+                    factor = 1.5f;
+                else if(capacityInBytes > 64000)
+                    factor = 2.0f;
+            }
+
+            unsigned int newCapacity = currentCapacity ? static_cast<unsigned int>(float(currentCapacity) * factor) : VectorMinimumCapacityInBytes / sizeof(T);
+            reallocate(newCapacity > newCount ? newCapacity : newCount, data.getAllocator());
+        }
+    }
+
+    //Moves the items into a new allocation of numItems items from the allocator.
+    void reallocate(unsigned int numItems, MemoryAllocator* allocator)
+    {
+        MemoryBuffer newData(data.getMemoryTag());
+        newData.setAllocator(allocator);
+        newData.reserve(numItems * sizeof(T));
+        relocateItems(reinterpret_cast<T*>(newData.getData()), items(), count);
+        newData.resize(count * sizeof(T));
+        data.clearBuffer();
+        data = std::move(newData);
+    }
+
+    //Moves the items to uninitialized memory and destructs the originals.
+    void relocateItems(T* destination, T* source, unsigned int numItems)
+    {
+        if(pod)
+        {
+            if(numItems)
+                memcpy(destination, source, numItems * sizeof(T));
+        }
+        else
+        {
+            moveConstructItems(destination, source, numItems);
+            destructItems(source, numItems);
         }
-        //Set current size.
-        data.resize(newDataSizeInBytes);
     }
 
     void constructItems(T* items, unsigned int numItems)
@@ -356,7 +521,7 @@ private:
             new(items + i)T(constructData[i]);
     }
 
-    void moveConstructItems(T* items, const T* constructData, unsigned int numItems)
+    void moveConstructItems(T* items, T* constructData, unsigned int numItems)
     {
         for(unsigned int i = 0; i < numItems; ++i)
             new(items + i)T(std::move(constructData[i]));
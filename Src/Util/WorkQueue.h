@@ -24,6 +24,7 @@
 
 #include "Util/Vector.h"
 #include "Util/FixedArray.h"
+#include "Util/Profiler.h"
 #include <queue>
 #include <thread>
 #include <condition_variable>
@@ -44,7 +45,10 @@ public:
 
     ~WorkQueue()
     {
-        stop = true;
+        {
+            std::unique_lock<std::mutex> lock(access);
+            stop = true;
+        }
         condition.notify_all();
         for(unsigned int i = 0; i < workers.size(); ++i)
             workers[i].join();
@@ -69,17 +73,20 @@ private:
         {
             std::thread worker([this]()
             {
-                while(!stop)
+                PROFILE_THREAD("WorkQueue");
+                for(;;)
                 {
                     std::unique_lock<std::mutex> lock(access);
                     condition.wait(lock, [this]{return this->stop || !this->tasks.empty();});
 
-                    if(!this->stop && !this->tasks.empty())
-                    {
-                        std::function<void()> task = std::move(this->tasks.front());
-                        this->tasks.pop();
-                        task();
-                    }
+                    if(this->stop)
+                        return;
+
+                    std::function<void()> task = std::move(this->tasks.front());
+                    this->tasks.pop();
+                    //The task runs without the lock, otherwise the workers would run their tasks one at a time.
+                    lock.unlock();
+                    task();
                 }
             });
             workers[i] = std::move(worker);
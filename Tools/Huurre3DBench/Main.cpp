@@ -0,0 +1,994 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Renderer/Renderer.h"
+#include "Renderer/RenderStage.h"
+#include "Renderer/GeometrySimplifier.h"
+#include "Scene/Scene.h"
+#include "Scene/Camera.h"
+#include "Scene/Light.h"
+#include "Scene/Mesh.h"
+#include "Scene/Joint.h"
+#include "Util/JSON.h"
+#include "Util/SmallVector.h"
+#include "Util/SortedVector.h"
+#include "Util/Profiler.h"
+#include "Util/Timer.h"
+#include "Math/Frustum.h"
+#include "Math/TransformKernels.h"
+#include "Math/MathFunctions.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace Huurre3D;
+
+//Headless renderer benchmark. Built against the null graphics back-end, so it measures only the CPU side of the renderer:
+//Scene::update, the update and execute of every render stage and the submit loop, which is the sum of the stage executes.
+//The results are written as JSON with the median and the 99th percentile of every measurement in milliseconds.
+
+static const std::string defaultBenchConfigFile = "../DefaultHuurre3DConfig.json";
+
+struct BenchSettings
+{
+    std::string configFile = defaultBenchConfigFile;
+    std::string outputFile;
+    //Chrome trace of the profiler zones of the last frames, needs a build with USE_PROFILER.
+    std::string traceFile;
+    unsigned int numMeshes = 1000;
+    unsigned int numLights = 64;
+    unsigned int numSkinnedCharacters = 10;
+    unsigned int numJointsPerCharacter = 16;
+    unsigned int numShadowCasters = 4;
+    //Walls in a ring around the camera, marked as occluders.
+    unsigned int numOccluders = 0;
+    //Segments around a sphere the meshes are made of instead of boxes, with simplified levels of detail, zero keeps the boxes.
+    unsigned int numSphereSegments = 0;
+    unsigned int numFrames = 300;
+    unsigned int numWarmupFrames = 30;
+    unsigned int seed = 1;
+    //Fraction of the meshes that are moved on every frame.
+    float movingMeshFraction = 0.1f;
+    //Meshes whose materials change their diffuse color on every frame.
+    unsigned int numAnimatedMaterials = 0;
+    //Degrees the camera turns on every frame, zero keeps the camera still.
+    float cameraRotation = 0.25f;
+    //Iterations of each math kernel microbenchmark, zero skips them.
+    unsigned int numMathIterations = 0;
+    //Iterations of each container microbenchmark, zero skips them.
+    unsigned int numContainerIterations = 0;
+    //Overrides the frame latency of the config when not negative.
+    int frameLatency = -1;
+    //Resizes the render targets of the stages to the resolution when not zero.
+    unsigned int width = 0;
+    unsigned int height = 0;
+};
+
+struct BenchSample
+{
+    std::string name;
+    Vector<float> times;
+};
+
+struct MicroBenchResult
+{
+    std::string name;
+    float nanosecondsPerOperation;
+};
+
+struct BenchScene
+{
+    Vector<Mesh*> meshes;
+    Vector<Light*> lights;
+    Vector<Vector<Joint*>> skeletons;
+    Vector<Vector3> meshVelocities;
+};
+
+static const float sceneExtent = 100.0f;
+static const float jointSegmentHeight = 0.5f;
+
+static bool readArguments(int argc, const char* argv[], BenchSettings& settings)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cout << "Failed to read argument " << argument << ", value is missing." << std::endl;
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if(argument == "--config")
+            settings.configFile = value;
+        else if(argument == "--output")
+            settings.outputFile = value;
+        else if(argument == "--trace")
+            settings.traceFile = value;
+        else if(argument == "--meshes")
+            settings.numMeshes = std::stoul(value);
+        else if(argument == "--lights")
+            settings.numLights = std::stoul(value);
+        else if(argument == "--skinned")
+            settings.numSkinnedCharacters = std::stoul(value);
+        else if(argument == "--joints")
+            settings.numJointsPerCharacter = std::max(1ul, std::stoul(value));
+        else if(argument == "--shadowCasters")
+            settings.numShadowCasters = std::stoul(value);
+        else if(argument == "--occluders")
+            settings.numOccluders = std::stoul(value);
+        else if(argument == "--sphereSegments")
+            settings.numSphereSegments = std::min(std::stoul(value), 128ul);
+        else if(argument == "--frames")
+            settings.numFrames = std::max(1ul, std::stoul(value));
+        else if(argument == "--warmup")
+            settings.numWarmupFrames = std::stoul(value);
+        else if(argument == "--seed")
+            settings.seed = std::stoul(value);
+        else if(argument == "--animatedMaterials")
+            settings.numAnimatedMaterials = std::stoul(value);
+        else if(argument == "--cameraRotation")
+            settings.cameraRotation = std::stof(value);
+        else if(argument == "--movingMeshes")
+            settings.movingMeshFraction = std::stof(value);
+        else if(argument == "--math")
+            settings.numMathIterations = std::stoul(value);
+        else if(argument == "--containers")
+            settings.numContainerIterations = std::stoul(value);
+        else if(argument == "--frameLatency")
+            settings.frameLatency = std::stoi(value);
+        else if(argument == "--resolution")
+        {
+            std::size_t separator = value.find('x');
+            if(separator == std::string::npos)
+            {
+                std::cout << "Failed to read the resolution " << value << ", expected widthxheight." << std::endl;
+                return false;
+            }
+            settings.width = std::stoul(value.substr(0, separator));
+            settings.height = std::stoul(value.substr(separator + 1));
+        }
+        else
+        {
+            std::cout << "Unknown argument " << argument << std::endl;
+            return false;
+        }
+    }
+
+    settings.numShadowCasters = std::min(settings.numShadowCasters, settings.numLights);
+    settings.numAnimatedMaterials = std::min(settings.numAnimatedMaterials, settings.numMeshes);
+
+    return true;
+}
+
+//Appends a box with per face normals. With skinning every vertex of the box is bound to the given joint.
+static void appendBox(const Vector3& center, const Vector3& halfSize, bool skinned, float jointIndex, GeometryDescription& geometryDescription)
+{
+    static const float faceNormals[6][3] = {{1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}};
+
+    for(unsigned int face = 0; face < 6; ++face)
+    {
+        Vector3 normal(faceNormals[face][0], faceNormals[face][1], faceNormals[face][2]);
+        Vector3 tangent = abs(normal.y) > 0.5f ? Vector3::UNIT_X : Vector3::UNIT_Y;
+        Vector3 bitangent = normal.cross(tangent);
+        unsigned short firstVertex = static_cast<unsigned short>(geometryDescription.numVertices);
+
+        for(unsigned int corner = 0; corner < 4; ++corner)
+        {
+            float u = (corner == 1 || corner == 2) ? 1.0f : -1.0f;
+            float v = corner >= 2 ? 1.0f : -1.0f;
+            Vector3 offset = normal + tangent * u + bitangent * v;
+            Vector3 position = center + Vector3(offset.x * halfSize.x, offset.y * halfSize.y, offset.z * halfSize.z);
+
+            geometryDescription.vertexData.append(&position.x, 3 * sizeof(float));
+            geometryDescription.vertexData.append(&normal.x, 3 * sizeof(float));
+            if(skinned)
+            {
+                float jointIndices[4] = {jointIndex, 0.0f, 0.0f, 0.0f};
+                float jointWeights[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+                geometryDescription.vertexData.append(jointIndices, 4 * sizeof(float));
+                geometryDescription.vertexData.append(jointWeights, 4 * sizeof(float));
+            }
+            geometryDescription.boundingBox.mergePoint(position);
+            ++geometryDescription.numVertices;
+        }
+
+        unsigned short faceIndices[6] = {0, 1, 2, 0, 2, 3};
+        for(unsigned int i = 0; i < 6; ++i)
+            faceIndices[i] += firstVertex;
+
+        geometryDescription.indices.append(faceIndices, 6 * sizeof(unsigned short));
+        geometryDescription.numIndices += 6;
+    }
+}
+
+//Appends a sphere with shared vertices, which the simplifier can reduce since it has no seams. The segments around are twice the rings.
+static void appendSphere(float radius, unsigned int numSegments, GeometryDescription& geometryDescription)
+{
+    unsigned int numRings = std::max(2u, numSegments / 2);
+    unsigned short firstVertex = static_cast<unsigned short>(geometryDescription.numVertices);
+
+    //The poles are single vertices, between them the rings of vertices from the top down.
+    for(unsigned int ring = 0; ring <= numRings; ++ring)
+    {
+        float polarAngle = PI * float(ring) / float(numRings);
+        unsigned int numRingVertices = (ring == 0 || ring == numRings) ? 1 : numSegments;
+        for(unsigned int segment = 0; segment < numRingVertices; ++segment)
+        {
+            float azimuth = 2.0f * PI * float(segment) / float(numSegments);
+            Vector3 normal(sin(polarAngle) * cos(azimuth), cos(polarAngle), sin(polarAngle) * sin(azimuth));
+            Vector3 position = normal * radius;
+            geometryDescription.vertexData.append(&position.x, 3 * sizeof(float));
+            geometryDescription.vertexData.append(&normal.x, 3 * sizeof(float));
+            geometryDescription.boundingBox.mergePoint(position);
+            ++geometryDescription.numVertices;
+        }
+    }
+
+    unsigned short bottomPole = static_cast<unsigned short>(geometryDescription.numVertices - 1);
+    for(unsigned int ring = 0; ring < numRings; ++ring)
+    {
+        for(unsigned int segment = 0; segment < numSegments; ++segment)
+        {
+            unsigned int nextSegment = (segment + 1) % numSegments;
+            unsigned short upper0 = static_cast<unsigned short>(ring == 0 ? firstVertex : firstVertex + 1 + (ring - 1) * numSegments + segment);
+            unsigned short upper1 = static_cast<unsigned short>(ring == 0 ? firstVertex : firstVertex + 1 + (ring - 1) * numSegments + nextSegment);
+            unsigned short lower0 = static_cast<unsigned short>(ring == numRings - 1 ? bottomPole : firstVertex + 1 + ring * numSegments + segment);
+            unsigned short lower1 = static_cast<unsigned short>(ring == numRings - 1 ? bottomPole : firstVertex + 1 + ring * numSegments + nextSegment);
+
+            //The triangles are counter-clockwise seen from the outside.
+            if(ring != 0)
+            {
+                unsigned short triangle[3] = {upper0, upper1, lower0};
+                geometryDescription.indices.append(triangle, 3 * sizeof(unsigned short));
+                geometryDescription.numIndices += 3;
+            }
+            if(ring != numRings - 1)
+            {
+                unsigned short triangle[3] = {upper1, lower1, lower0};
+                geometryDescription.indices.append(triangle, 3 * sizeof(unsigned short));
+                geometryDescription.numIndices += 3;
+            }
+        }
+    }
+}
+
+static void initBoxGeometryDescription(bool skinned, GeometryDescription& geometryDescription)
+{
+    int floatSize = attributeSize[static_cast<int>(AttributeType::Float)];
+    geometryDescription.indexType = IndexType::Short;
+    geometryDescription.attributeDescriptions.pushBack({AttributeType::Float, AttributeSemantic::Position, 3, 3 * floatSize, false});
+    geometryDescription.attributeDescriptions.pushBack({AttributeType::Float, AttributeSemantic::Normal, 3, 3 * floatSize, false});
+
+    if(skinned)
+    {
+        geometryDescription.attributeDescriptions.pushBack({AttributeType::Float, AttributeSemantic::JointIndices, 4, 4 * floatSize, false});
+        geometryDescription.attributeDescriptions.pushBack({AttributeType::Float, AttributeSemantic::JointWeights, 4, 4 * floatSize, false});
+    }
+}
+
+static Vector3 randomVector(std::mt19937& engine, float min, float max)
+{
+    std::uniform_real_distribution<float> distribution(min, max);
+    float x = distribution(engine);
+    float y = distribution(engine);
+    float z = distribution(engine);
+    return Vector3(x, y, z);
+}
+
+static void createMeshes(const BenchSettings& settings, Renderer& renderer, Scene* scene, std::mt19937& engine, BenchScene& benchScene)
+{
+    if(settings.numMeshes == 0)
+        return;
+
+    Vector<MaterialDescription> materialDescriptions(1);
+    Vector<GeometryDescription> geometryDescriptions(1);
+    materialDescriptions[0].diffuseColor = Vector3(0.8f, 0.6f, 0.4f);
+    initBoxGeometryDescription(false, geometryDescriptions[0]);
+    if(settings.numSphereSegments > 0)
+        appendSphere(0.5f, settings.numSphereSegments, geometryDescriptions[0]);
+    else
+        appendBox(Vector3::ZERO, Vector3(0.5f, 0.5f, 0.5f), false, 0.0f, geometryDescriptions[0]);
+
+    Vector<GeometryDescription> lodDescriptions;
+    GeometrySimplifier geometrySimplifier;
+    geometrySimplifier.generateLods(geometryDescriptions[0], 3, lodDescriptions);
+
+    Vector<Vector<RenderItem>> renderItems;
+    renderer.createRenderItems(materialDescriptions, geometryDescriptions, renderItems, settings.numMeshes);
+
+    Vector<Geometry*> geometries;
+    for(unsigned int i = 0; i < renderItems.size(); ++i)
+        geometries.pushBack(renderItems[i][0].geometry);
+    renderer.createGeometryLods(lodDescriptions, geometries);
+    scene->createSceneItems<Mesh>(benchScene.meshes, settings.numMeshes);
+
+    std::uniform_real_distribution<float> angleDistribution(0.0f, 360.0f);
+    for(unsigned int i = 0; i < benchScene.meshes.size(); ++i)
+    {
+        Mesh* mesh = benchScene.meshes[i];
+        float angle = angleDistribution(engine);
+        Vector3 position = randomVector(engine, -sceneExtent, sceneExtent);
+        position.y = abs(position.y) * 0.1f;
+        mesh->setTransform(position, Quaternion(angle, Vector3::UNIT_Y), Vector3(1.0f, 1.0f, 1.0f));
+        mesh->addRenderItems(renderItems[i]);
+        benchScene.meshVelocities.pushBack(randomVector(engine, -1.0f, 1.0f));
+    }
+}
+
+//The walls leave small gaps between them, so some of the meshes behind them stay visible.
+static void createOccluders(const BenchSettings& settings, Renderer& renderer, Scene* scene)
+{
+    if(settings.numOccluders == 0)
+        return;
+
+    static const float ringRadius = 15.0f;
+    float wallHalfWidth = ringRadius * tan(PI / float(settings.numOccluders)) * 0.9f;
+    Vector<MaterialDescription> materialDescriptions(1);
+    Vector<GeometryDescription> geometryDescriptions(1);
+    materialDescriptions[0].diffuseColor = Vector3(0.5f, 0.5f, 0.5f);
+    initBoxGeometryDescription(false, geometryDescriptions[0]);
+    appendBox(Vector3::ZERO, Vector3(wallHalfWidth, 15.0f, 0.5f), false, 0.0f, geometryDescriptions[0]);
+
+    Vector<Vector<RenderItem>> renderItems;
+    renderer.createRenderItems(materialDescriptions, geometryDescriptions, renderItems, settings.numOccluders);
+    Vector<Mesh*> walls;
+    scene->createSceneItems<Mesh>(walls, settings.numOccluders);
+
+    for(unsigned int i = 0; i < walls.size(); ++i)
+    {
+        float angle = 360.0f * float(i) / float(settings.numOccluders);
+        Quaternion rotation(angle, Vector3::UNIT_Y);
+        walls[i]->setTransform(rotation.rotate(Vector3(0.0f, 0.0f, ringRadius)) + Vector3(0.0f, 10.0f, 0.0f), rotation, Vector3(1.0f, 1.0f, 1.0f));
+        walls[i]->addRenderItems(renderItems[i]);
+        walls[i]->setOccluder(true);
+    }
+}
+
+//Every character gets its own joint chain, so the joint indices in the vertex data are unique for every character geometry.
+static void createSkinnedCharacters(const BenchSettings& settings, Renderer& renderer, Scene* scene, std::mt19937& engine, BenchScene& benchScene)
+{
+    if(settings.numSkinnedCharacters == 0)
+        return;
+
+    Vector<MaterialDescription> materialDescriptions(settings.numSkinnedCharacters);
+    Vector<GeometryDescription> geometryDescriptions(settings.numSkinnedCharacters);
+
+    for(unsigned int i = 0; i < settings.numSkinnedCharacters; ++i)
+    {
+        unsigned int firstJoint = scene->getSceneItems<Joint>().size();
+        Vector<Joint*> skeleton;
+        scene->createSceneItems<Joint>(skeleton, settings.numJointsPerCharacter);
+
+        materialDescriptions[i].diffuseColor = Vector3(0.4f, 0.6f, 0.8f);
+        materialDescriptions[i].skinned = true;
+        GeometryDescription& geometryDescription = geometryDescriptions[i];
+        initBoxGeometryDescription(true, geometryDescription);
+
+        for(unsigned int j = 0; j < skeleton.size(); ++j)
+        {
+            Vector3 bindPosition(0.0f, float(j) * jointSegmentHeight, 0.0f);
+            appendBox(bindPosition + Vector3(0.0f, jointSegmentHeight * 0.5f, 0.0f), Vector3(0.2f, jointSegmentHeight * 0.5f, 0.2f), true, float(firstJoint + j), geometryDescription);
+            skeleton[j]->setOffsetMatrix(-bindPosition, Quaternion::IDENTITY, Vector3(1.0f, 1.0f, 1.0f));
+
+            if(j > 0)
+            {
+                skeleton[j]->setPosition(Vector3(0.0f, jointSegmentHeight, 0.0f));
+                skeleton[j - 1]->addChild(skeleton[j]);
+            }
+        }
+
+        Vector3 position = randomVector(engine, -sceneExtent, sceneExtent);
+        position.y = 0.0f;
+        skeleton[0]->setPosition(position);
+
+        benchScene.skeletons.pushBack(skeleton);
+    }
+
+    Vector<RenderItem> renderItems;
+    renderer.createRenderItems(materialDescriptions, geometryDescriptions, renderItems);
+    Vector<Mesh*> characters;
+    scene->createSceneItems<Mesh>(characters, settings.numSkinnedCharacters);
+
+    for(unsigned int i = 0; i < characters.size(); ++i)
+    {
+        characters[i]->setSkeleton(benchScene.skeletons[i]);
+        characters[i]->addRenderItem(renderItems[i]);
+    }
+}
+
+static void createLights(const BenchSettings& settings, Scene* scene, std::mt19937& engine, BenchScene& benchScene)
+{
+    scene->createSceneItems<Light>(benchScene.lights, settings.numLights);
+    std::uniform_real_distribution<float> radiusDistribution(5.0f, 20.0f);
+
+    for(unsigned int i = 0; i < benchScene.lights.size(); ++i)
+    {
+        Light* light = benchScene.lights[i];
+        Vector3 position = randomVector(engine, -sceneExtent, sceneExtent);
+        position.y = abs(position.y) * 0.1f + 2.0f;
+        light->setLightType(LightType::Point);
+        light->setPosition(position);
+        light->setColor(randomVector(engine, 0.2f, 1.0f));
+        light->setRadius(radiusDistribution(engine));
+
+        if(i < settings.numShadowCasters)
+        {
+            light->setCastShadow(true);
+            light->setShadowOcclusionMask(1 << i);
+        }
+    }
+}
+
+static void animateScene(const BenchSettings& settings, unsigned int frame, Scene* scene, BenchScene& benchScene)
+{
+    float time = float(frame) / 60.0f;
+    float sinTime = sin(time * 2.0f);
+
+    if(settings.cameraRotation != 0.0f)
+        scene->getMainCamera()->rotate(Quaternion(settings.cameraRotation, Vector3::UNIT_Y), FrameOfReference::World);
+
+    unsigned int numMovingMeshes = static_cast<unsigned int>(float(benchScene.meshes.size()) * settings.movingMeshFraction);
+    for(unsigned int i = 0; i < numMovingMeshes; ++i)
+        benchScene.meshes[i]->translate(benchScene.meshVelocities[i] * (sinTime * 0.05f), FrameOfReference::World);
+
+    //Each animated material has a color of its own, so it is moved to a parameter slot of its own.
+    for(unsigned int i = 0; i < settings.numAnimatedMaterials; ++i)
+        benchScene.meshes[i]->getRenderItems()[0].material->setDiffuseColor(0.5f + 0.5f * sin(time + float(i) * 0.05f), 0.6f, 0.4f);
+
+    for(unsigned int i = 0; i < benchScene.lights.size(); ++i)
+        benchScene.lights[i]->translate(Vector3(sinTime * 0.1f, 0.0f, 0.0f), FrameOfReference::World);
+
+    for(unsigned int i = 0; i < benchScene.skeletons.size(); ++i)
+    {
+        const Vector<Joint*>& skeleton = benchScene.skeletons[i];
+        for(unsigned int j = 1; j < skeleton.size(); ++j)
+            skeleton[j]->setRotation(Quaternion(sinTime * 10.0f, Vector3::UNIT_Z));
+    }
+}
+
+//Microbenchmarks of the math kernels on the hot paths. Build with USE_SCALAR_MATH to compare against the scalar implementation.
+static void runMathBenchmarks(const BenchSettings& settings, std::mt19937& engine, Vector<MicroBenchResult>& results)
+{
+    static const unsigned int numValues = 1024;
+    std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> positionDistribution(-sceneExtent, sceneExtent);
+
+    Vector<Matrix4x4> matrices(numValues);
+    Vector<Vector4> vectors(numValues);
+    Vector<Quaternion> quaternions(numValues);
+    Vector<BoundingBox> boxes(numValues);
+    Vector<Vector3> positions(numValues);
+    Vector<Vector3> scales(numValues);
+    for(unsigned int i = 0; i < numValues; ++i)
+    {
+        Vector3 position(positionDistribution(engine), positionDistribution(engine), positionDistribution(engine));
+        Quaternion rotation = Quaternion(unitDistribution(engine), unitDistribution(engine), unitDistribution(engine), unitDistribution(engine)).normalized();
+        positions[i] = position;
+        scales[i] = Vector3(1.0f + 0.5f * unitDistribution(engine), 1.0f + 0.5f * unitDistribution(engine), 1.0f + 0.5f * unitDistribution(engine));
+        matrices[i].setTransform(position, rotation, Vector3::ONE);
+        vectors[i] = Vector4(position, 1.0f);
+        quaternions[i] = rotation;
+        boxes[i] = BoundingBox(position - Vector3::ONE, position + Vector3::ONE);
+    }
+
+    Matrix4x4 projection;
+    Matrix4x4 view;
+    projection.setPerspective(60.0f, 16.0f / 9.0f, 0.1f, sceneExtent);
+    view.setLookAt(Vector3(0.0f, 10.0f, 0.0f), Vector3(0.0f, 0.0f, -sceneExtent), Vector3::UNIT_Y);
+    Frustum frustum(projection * view);
+
+    unsigned int iterations = settings.numMathIterations;
+    float sink = 0.0f;
+    Timer timer;
+
+    timer.start();
+    Matrix4x4 matrixProduct = Matrix4x4::ZERO;
+    for(unsigned int i = 0; i < iterations; ++i)
+        matrixProduct += matrices[i % numValues] * matrices[(i + 1) % numValues];
+    sink += matrixProduct[3].x;
+    results.pushBack(MicroBenchResult{"Matrix4x4*Matrix4x4", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    timer.start();
+    Vector4 vectorProduct = Vector4::ZERO;
+    for(unsigned int i = 0; i < iterations; ++i)
+        vectorProduct += matrices[i % numValues] * vectors[(i + 1) % numValues];
+    sink += vectorProduct.x;
+    results.pushBack(MicroBenchResult{"Matrix4x4*Vector4", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    timer.start();
+    Quaternion quaternionProduct = Quaternion::ZERO;
+    for(unsigned int i = 0; i < iterations; ++i)
+        quaternionProduct += quaternions[i % numValues] * quaternions[(i + 1) % numValues];
+    sink += quaternionProduct.w;
+    results.pushBack(MicroBenchResult{"Quaternion*Quaternion", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    timer.start();
+    Matrix4x4 transposed = Matrix4x4::ZERO;
+    for(unsigned int i = 0; i < iterations; ++i)
+        transposed += matrices[i % numValues].transpose();
+    sink += transposed[0].w;
+    results.pushBack(MicroBenchResult{"Matrix4x4::transpose", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    timer.start();
+    unsigned int numInside = 0;
+    for(unsigned int i = 0; i < iterations; ++i)
+        numInside += frustum.isInsideNoIntersection(boxes[i % numValues]) ? 1 : 0;
+    sink += float(numInside);
+    results.pushBack(MicroBenchResult{"Frustum::isInsideNoIntersection(BoundingBox)", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    timer.start();
+    unsigned int numIntersecting = 0;
+    for(unsigned int i = 0; i < iterations; ++i)
+        numIntersecting += frustum.isInside(boxes[i % numValues]) == Intersection::Intersects ? 1 : 0;
+    sink += float(numIntersecting);
+    results.pushBack(MicroBenchResult{"Frustum::isInside(BoundingBox)", timer.getElapsedTime() * 1.0e9f / float(iterations)});
+
+    //Per-item transform work of the scene update against the batched kernels, timed per item.
+    unsigned int numBatches = std::max(iterations / numValues, 1u);
+    Vector<Matrix4x4> transforms(numValues);
+    Vector<Matrix4x4> inverseTransforms(numValues);
+    Vector<BoundingBox> transformedBoxes(numValues);
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        for(unsigned int j = 0; j < numValues; ++j)
+        {
+            transforms[j].setTransform(positions[j], quaternions[j], scales[j]);
+            inverseTransforms[j].setInverseTransform(positions[j], quaternions[j], scales[j]);
+        }
+        sink += transforms[i % numValues][3].x + inverseTransforms[i % numValues][3].x;
+    }
+    results.pushBack(MicroBenchResult{"Matrix4x4::setTransform+setInverseTransform", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        composeTransforms(positions.begin(), quaternions.begin(), scales.begin(), transforms.begin(), numValues);
+        composeInverseTransforms(positions.begin(), quaternions.begin(), scales.begin(), inverseTransforms.begin(), numValues);
+        sink += transforms[i % numValues][3].x + inverseTransforms[i % numValues][3].x;
+    }
+    results.pushBack(MicroBenchResult{"composeTransforms+composeInverseTransforms", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        for(unsigned int j = 0; j < numValues; ++j)
+            inverseTransforms[j] = transforms[j].inverse();
+        sink += inverseTransforms[i % numValues][3].x;
+    }
+    results.pushBack(MicroBenchResult{"Matrix4x4::inverse", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        invertAffineTransforms(transforms.begin(), inverseTransforms.begin(), numValues);
+        sink += inverseTransforms[i % numValues][3].x;
+    }
+    results.pushBack(MicroBenchResult{"invertAffineTransforms", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        for(unsigned int j = 0; j < numValues; ++j)
+            transformedBoxes[j] = boxes[j].transformed(transforms[j]);
+        sink += transformedBoxes[i % numValues].getMin().x;
+    }
+    results.pushBack(MicroBenchResult{"BoundingBox::transformed", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numBatches; ++i)
+    {
+        transformBoundingBoxes(boxes.begin(), transforms.begin(), transformedBoxes.begin(), numValues);
+        sink += transformedBoxes[i % numValues].getMin().x;
+    }
+    results.pushBack(MicroBenchResult{"transformBoundingBoxes", timer.getElapsedTime() * 1.0e9f / float(numBatches * numValues)});
+
+    //Keeps the results alive so the kernels are not optimized away.
+    if(isNaN(sink))
+        std::cout << "Math benchmark produced NaN" << std::endl;
+}
+
+//Description looked up by its name hash, like the shader parameter descriptions.
+struct HashedItem
+{
+    unsigned int nameHash;
+    std::string name;
+};
+
+struct HashedItemLess
+{
+    bool operator()(const HashedItem& lhs, const HashedItem& rhs) const {return lhs.nameHash < rhs.nameHash;}
+    bool operator()(const HashedItem& lhs, unsigned int rhs) const {return lhs.nameHash < rhs;}
+    bool operator()(unsigned int lhs, const HashedItem& rhs) const {return lhs < rhs.nameHash;}
+};
+
+//The engine's containers against std::vector on the access patterns of the renderer, timed per item.
+static void runContainerBenchmarks(const BenchSettings& settings, std::mt19937& engine, Vector<MicroBenchResult>& results)
+{
+    static const unsigned int numQueueItems = 1024;
+    static const unsigned int numStrings = 64;
+    static const unsigned int numPassTextures = 4;
+    static const unsigned int numDescriptions = 32;
+    unsigned int iterations = std::max(settings.numContainerIterations / numQueueItems, 1u);
+    //Only the pointer values are stored.
+    Material* material = nullptr;
+    Geometry* geometry = nullptr;
+    Texture* texture = nullptr;
+    unsigned int sink = 0;
+    Timer timer;
+
+    //Render queue: reserved once, cleared and filled on every frame.
+    Vector<RenderItem> queue;
+    queue.reserve(numQueueItems);
+    timer.start();
+    for(unsigned int i = 0; i < iterations; ++i)
+    {
+        queue.clear();
+        for(unsigned int j = 0; j < numQueueItems; ++j)
+            queue.pushBack(RenderItem(material, geometry));
+        sink += queue.size();
+    }
+    results.pushBack(MicroBenchResult{"Vector::pushBack(RenderItem)", timer.getElapsedTime() * 1.0e9f / float(iterations * numQueueItems)});
+
+    std::vector<RenderItem> stdQueue;
+    stdQueue.reserve(numQueueItems);
+    timer.start();
+    for(unsigned int i = 0; i < iterations; ++i)
+    {
+        stdQueue.clear();
+        for(unsigned int j = 0; j < numQueueItems; ++j)
+            stdQueue.push_back(RenderItem(material, geometry));
+        sink += static_cast<unsigned int>(stdQueue.size());
+    }
+    results.pushBack(MicroBenchResult{"std::vector::push_back(RenderItem)", timer.getElapsedTime() * 1.0e9f / float(iterations * numQueueItems)});
+
+    //Growth of non-POD items without a reserve, like shader defines and file names.
+    std::string longString = "a string long enough to be allocated on the heap";
+    timer.start();
+    for(unsigned int i = 0; i < iterations; ++i)
+    {
+        Vector<std::string> strings;
+        for(unsigned int j = 0; j < numStrings; ++j)
+            strings.pushBack(longString);
+        sink += strings.size();
+    }
+    results.pushBack(MicroBenchResult{"Vector::pushBack(std::string)", timer.getElapsedTime() * 1.0e9f / float(iterations * numStrings)});
+
+    timer.start();
+    for(unsigned int i = 0; i < iterations; ++i)
+    {
+        std::vector<std::string> strings;
+        for(unsigned int j = 0; j < numStrings; ++j)
+            strings.push_back(longString);
+        sink += static_cast<unsigned int>(strings.size());
+    }
+    results.pushBack(MicroBenchResult{"std::vector::push_back(std::string)", timer.getElapsedTime() * 1.0e9f / float(iterations * numStrings)});
+
+    //Short texture lists of the shader passes, built and copied per material.
+    unsigned int passIterations = iterations * numQueueItems / numPassTextures;
+    timer.start();
+    for(unsigned int i = 0; i < passIterations; ++i)
+    {
+        Vector<Texture*> textures;
+        for(unsigned int j = 0; j < numPassTextures; ++j)
+            textures.pushBack(texture);
+        Vector<Texture*> copy(textures);
+        sink += copy.size();
+    }
+    results.pushBack(MicroBenchResult{"Vector<Texture*> build+copy", timer.getElapsedTime() * 1.0e9f / float(passIterations)});
+
+    timer.start();
+    for(unsigned int i = 0; i < passIterations; ++i)
+    {
+        SmallVector<Texture*, 8> textures;
+        for(unsigned int j = 0; j < numPassTextures; ++j)
+            textures.pushBack(texture);
+        SmallVector<Texture*, 8> copy(textures);
+        sink += copy.size();
+    }
+    results.pushBack(MicroBenchResult{"SmallVector<Texture*, 8> build+copy", timer.getElapsedTime() * 1.0e9f / float(passIterations)});
+
+    timer.start();
+    for(unsigned int i = 0; i < passIterations; ++i)
+    {
+        std::vector<Texture*> textures;
+        for(unsigned int j = 0; j < numPassTextures; ++j)
+            textures.push_back(texture);
+        std::vector<Texture*> copy(textures);
+        sink += static_cast<unsigned int>(copy.size());
+    }
+    results.pushBack(MicroBenchResult{"std::vector<Texture*> build+copy", timer.getElapsedTime() * 1.0e9f / float(passIterations)});
+
+    //Lookups by name hash, like the shader parameters set for every draw.
+    Vector<HashedItem> descriptions;
+    SortedVector<HashedItem, HashedItemLess> sortedDescriptions;
+    std::vector<HashedItem> stdDescriptions;
+    Vector<unsigned int> hashes;
+    for(unsigned int i = 0; i < numDescriptions; ++i)
+    {
+        HashedItem item = {static_cast<unsigned int>(engine()), "parameter" + std::to_string(i)};
+        descriptions.pushBack(item);
+        sortedDescriptions.insert(item);
+        stdDescriptions.push_back(item);
+        hashes.pushBack(item.nameHash);
+    }
+
+    unsigned int numLookups = iterations * numQueueItems;
+    timer.start();
+    for(unsigned int i = 0; i < numLookups; ++i)
+    {
+        unsigned int hash = hashes[i % numDescriptions];
+        sink += descriptions.getIndexToItem([hash](const HashedItem& item){return item.nameHash == hash;});
+    }
+    results.pushBack(MicroBenchResult{"Vector::getIndexToItem(hash)", timer.getElapsedTime() * 1.0e9f / float(numLookups)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numLookups; ++i)
+        sink += sortedDescriptions.getIndexToItem(hashes[i % numDescriptions]);
+    results.pushBack(MicroBenchResult{"SortedVector::getIndexToItem(hash)", timer.getElapsedTime() * 1.0e9f / float(numLookups)});
+
+    timer.start();
+    for(unsigned int i = 0; i < numLookups; ++i)
+    {
+        unsigned int hash = hashes[i % numDescriptions];
+        sink += static_cast<unsigned int>(std::find_if(stdDescriptions.begin(), stdDescriptions.end(), [hash](const HashedItem& item){return item.nameHash == hash;}) - stdDescriptions.begin());
+    }
+    results.pushBack(MicroBenchResult{"std::find_if(hash)", timer.getElapsedTime() * 1.0e9f / float(numLookups)});
+
+    //Keeps the results alive so the loops are not optimized away.
+    if(sink == 0)
+        std::cout << "Container benchmark produced no items" << std::endl;
+}
+
+static void writeStatistics(std::ostream& stream, const std::string& name, Vector<float>& times, bool lastItem)
+{
+    std::sort(times.begin(), times.end());
+    unsigned int p99Index = std::min(times.size() - 1, static_cast<unsigned int>(float(times.size()) * 0.99f));
+    float total = 0.0f;
+    for(unsigned int i = 0; i < times.size(); ++i)
+        total += times[i];
+
+    stream << "        \"" << name << "\" : {\"medianMs\" : " << times[times.size() / 2] * 1000.0f
+           << ", \"p99Ms\" : " << times[p99Index] * 1000.0f
+           << ", \"meanMs\" : " << total / float(times.size()) * 1000.0f
+           << ", \"maxMs\" : " << times.back() * 1000.0f << "}" << (lastItem ? "" : ",") << std::endl;
+}
+
+static void writeCounters(std::ostream& stream, const std::string& name, const GraphicStatistics& statistics, const CullingStatistics& culling, const LodStatistics& lods, const DrawRecordStatistics& drawRecords, bool lastItem)
+{
+    stream << "        \"" << name << "\" : {\"drawCalls\" : " << statistics.drawCalls + statistics.instancedDrawCalls + statistics.indirectDrawCalls
+           << ", \"indirectDraws\" : " << statistics.indirectDraws
+           << ", \"programBinds\" : " << statistics.programBinds << ", \"filteredProgramBinds\" : " << statistics.filteredProgramBinds
+           << ", \"textureBinds\" : " << statistics.textureBinds << ", \"filteredTextureBinds\" : " << statistics.filteredTextureBinds
+           << ", \"blockBinds\" : " << statistics.parameterBlockBinds << ", \"filteredBlockBinds\" : " << statistics.filteredParameterBlockBinds
+           << ", \"vertexDataBinds\" : " << statistics.vertexDataBinds << ", \"filteredVertexDataBinds\" : " << statistics.filteredVertexDataBinds
+           << ", \"uniformBytes\" : " << statistics.uniformBytesUploaded << ", \"streamedParameterBytes\" : " << statistics.streamedParameterBytes
+           << ", \"parameterRingStalls\" : " << statistics.parameterRingStalls
+           << ", \"itemsTested\" : " << culling.itemsTested << ", \"itemsVisible\" : " << culling.itemsVisible
+           << ", \"itemsOccluded\" : " << culling.itemsOccluded << ", \"itemsTooSmall\" : " << culling.itemsTooSmall << ", \"itemsTooFar\" : " << culling.itemsTooFar
+           << ", \"itemsBecameVisible\" : " << culling.itemsBecameVisible << ", \"itemsBecameHidden\" : " << culling.itemsBecameHidden
+           << ", \"lodItemsReduced\" : " << lods.itemsReduced << ", \"lodLevelChanges\" : " << lods.levelChanges
+           << ", \"lodSourceIndices\" : " << lods.sourceIndices << ", \"lodSelectedIndices\" : " << lods.selectedIndices
+           << ", \"drawRecordsRebuilt\" : " << drawRecords.recordsRebuilt << ", \"drawRecordTransformsUpdated\" : " << drawRecords.transformsUpdated << "}" << (lastItem ? "" : ",") << std::endl;
+}
+
+static void writeMicroBenchResults(std::ostream& stream, const std::string& name, const Vector<MicroBenchResult>& results)
+{
+    if(results.empty())
+        return;
+
+    stream << "    }," << std::endl;
+    stream << "    \"" << name << "\" :" << std::endl << "    {" << std::endl;
+    for(unsigned int i = 0; i < results.size(); ++i)
+    {
+        stream << "        \"" << results[i].name << "\" : {\"nsPerOperation\" : " << results[i].nanosecondsPerOperation << "}"
+               << (i == results.size() - 1 ? "" : ",") << std::endl;
+    }
+}
+
+static void writeResults(std::ostream& stream, const BenchSettings& settings, Vector<BenchSample>& samples, const Vector<MicroBenchResult>& mathResults,
+                         const Vector<MicroBenchResult>& containerResults, const Renderer& renderer)
+{
+    stream << "{" << std::endl;
+    stream << "    \"scene\" :" << std::endl << "    {" << std::endl;
+    stream << "        \"meshes\" : " << settings.numMeshes << "," << std::endl;
+    stream << "        \"lights\" : " << settings.numLights << "," << std::endl;
+    stream << "        \"skinnedCharacters\" : " << settings.numSkinnedCharacters << "," << std::endl;
+    stream << "        \"jointsPerCharacter\" : " << settings.numJointsPerCharacter << "," << std::endl;
+    stream << "        \"shadowCasters\" : " << settings.numShadowCasters << "," << std::endl;
+    stream << "        \"occluders\" : " << settings.numOccluders << "," << std::endl;
+    stream << "        \"sphereSegments\" : " << settings.numSphereSegments << "," << std::endl;
+    stream << "        \"frames\" : " << settings.numFrames << "," << std::endl;
+    stream << "        \"warmupFrames\" : " << settings.numWarmupFrames << "," << std::endl;
+    stream << "        \"frameLatency\" : " << renderer.getFrameLatency() << std::endl;
+    stream << "    }," << std::endl;
+    stream << "    \"timings\" :" << std::endl << "    {" << std::endl;
+
+    for(unsigned int i = 0; i < samples.size(); ++i)
+        writeStatistics(stream, samples[i].name, samples[i].times, i == samples.size() - 1);
+
+    //Counters of the last frame.
+    stream << "    }," << std::endl;
+    stream << "    \"counters\" :" << std::endl << "    {" << std::endl;
+
+    const Vector<RenderStage*>& renderStages = renderer.getRenderStages();
+    for(unsigned int i = 0; i < renderStages.size(); ++i)
+        writeCounters(stream, renderStages[i]->getName(), renderStages[i]->getStatistics().graphics, renderStages[i]->getStatistics().culling, renderStages[i]->getStatistics().lods, renderStages[i]->getStatistics().drawRecords, false);
+
+    writeCounters(stream, "frame", renderer.getFrameStatistics(), CullingStatistics(), LodStatistics(), DrawRecordStatistics(), true);
+    stream << "    }," << std::endl;
+
+    const RenderGraphStatistics& renderGraph = renderer.getRenderGraph().getStatistics();
+    stream << "    \"renderGraph\" :" << std::endl << "    {" << std::endl;
+    stream << "        \"passes\" : " << renderGraph.numPasses << "," << std::endl;
+    stream << "        \"culledPasses\" : " << renderGraph.numCulledPasses << "," << std::endl;
+    stream << "        \"undeclaredPasses\" : " << renderGraph.numUndeclaredPasses << "," << std::endl;
+    stream << "        \"buffers\" : " << renderGraph.numResources << "," << std::endl;
+    stream << "        \"aliasedBuffers\" : " << renderGraph.numAliasedResources << "," << std::endl;
+    stream << "        \"renderTargetBytes\" : " << renderGraph.renderTargetBytes << "," << std::endl;
+    stream << "        \"aliasedRenderTargetBytes\" : " << renderGraph.aliasedRenderTargetBytes << std::endl;
+    stream << "    }," << std::endl;
+
+    //Resident CPU memory per subsystem at the end of the run.
+    stream << "    \"memory\" :" << std::endl << "    {" << std::endl;
+    for(int i = 0; i < static_cast<int>(MemoryTag::NumTags); ++i)
+    {
+        MemoryTagStatistics memory = Memory::getStatistics(static_cast<MemoryTag>(i));
+        stream << "        \"" << Memory::getTagName(static_cast<MemoryTag>(i)) << "\" : {\"currentBytes\" : " << memory.currentBytes << ", \"peakBytes\" : " << memory.peakBytes
+               << ", \"allocations\" : " << memory.numAllocations << ", \"totalAllocations\" : " << memory.totalAllocations << "}"
+               << (i == static_cast<int>(MemoryTag::NumTags) - 1 ? "" : ",") << std::endl;
+    }
+
+    writeMicroBenchResults(stream, "math", mathResults);
+    writeMicroBenchResults(stream, "containers", containerResults);
+
+    stream << "    }" << std::endl << "}" << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    BenchSettings settings;
+    if(!readArguments(argc, argv, settings))
+    {
+        std::cout << "Usage: Huurre3DBench [--config file] [--output file] [--trace file] [--meshes n] [--lights n] [--skinned n] [--joints n] "
+                  << "[--shadowCasters n] [--occluders n] [--sphereSegments n] [--frames n] [--warmup n] [--seed n] [--movingMeshes fraction] [--animatedMaterials n] [--cameraRotation degrees] [--math iterations] [--containers iterations] [--frameLatency n] [--resolution widthxheight]" << std::endl;
+        return 1;
+    }
+
+    PROFILE_THREAD("Main");
+    JSON configJSON;
+    if(!configJSON.parseFromFile(settings.configFile))
+    {
+        std::cout << "Failed to read the config: " << settings.configFile << std::endl;
+        return 1;
+    }
+
+    JSONValue rendererJSON = configJSON.getRootValue().getJSONValue("renderer");
+    Renderer renderer;
+    if(rendererJSON.isNull() || !renderer.init(rendererJSON))
+    {
+        std::cout << "Failed to init the renderer from config: " << settings.configFile << std::endl;
+        return 1;
+    }
+
+    if(settings.frameLatency >= 0)
+        renderer.setFrameLatency(settings.frameLatency);
+    if(settings.width > 0 && settings.height > 0)
+        renderer.resizeRenderWindow(settings.width, settings.height);
+
+    std::mt19937 engine(settings.seed);
+    Vector<MicroBenchResult> mathResults;
+    if(settings.numMathIterations > 0)
+        runMathBenchmarks(settings, engine, mathResults);
+
+    Vector<MicroBenchResult> containerResults;
+    if(settings.numContainerIterations > 0)
+        runContainerBenchmarks(settings, engine, containerResults);
+
+    Scene* scene = new Scene();
+    BenchScene benchScene;
+    createMeshes(settings, renderer, scene, engine, benchScene);
+    createOccluders(settings, renderer, scene);
+    createSkinnedCharacters(settings, renderer, scene, engine, benchScene);
+    createLights(settings, scene, engine, benchScene);
+
+    Camera* camera = scene->getMainCamera();
+    camera->setAspectRatio(float(renderer.getGraphicWindow().getWidth()) / float(renderer.getGraphicWindow().getHeight()));
+    camera->setPosition(Vector3(0.0f, 10.0f, 0.0f));
+    camera->setFarClipDistance(sceneExtent * 2.0f);
+
+    const Vector<RenderStage*>& renderStages = renderer.getRenderStages();
+    const Vector<RenderStageTiming>& stageTimings = renderer.getRenderStageTimings();
+
+    //Samples: scene update, the update, record and execute of every stage, submit and the whole frame.
+    Vector<BenchSample> samples(renderStages.size() * 3 + 3);
+    samples[0].name = "sceneUpdate";
+    for(unsigned int i = 0; i < renderStages.size(); ++i)
+    {
+        samples[1 + i * 3].name = renderStages[i]->getName() + ".update";
+        samples[2 + i * 3].name = renderStages[i]->getName() + ".record";
+        samples[3 + i * 3].name = renderStages[i]->getName() + ".execute";
+    }
+    samples[samples.size() - 2].name = "submit";
+    samples[samples.size() - 1].name = "frame";
+
+    for(unsigned int i = 0; i < samples.size(); ++i)
+        samples[i].times.reserve(settings.numFrames);
+
+    Timer timer;
+    for(unsigned int frame = 0; frame < settings.numWarmupFrames + settings.numFrames; ++frame)
+    {
+        animateScene(settings, frame, scene, benchScene);
+
+        timer.start();
+        scene->update();
+        float sceneUpdateTime = timer.getElapsedTime();
+        renderer.renderScene(scene);
+        float frameTime = timer.getElapsedTime();
+        PROFILE_END_FRAME();
+
+        if(frame < settings.numWarmupFrames)
+            continue;
+
+        float submitTime = 0.0f;
+        samples[0].times.pushBack(sceneUpdateTime);
+        for(unsigned int i = 0; i < stageTimings.size(); ++i)
+        {
+            samples[1 + i * 3].times.pushBack(stageTimings[i].updateTime);
+            samples[2 + i * 3].times.pushBack(stageTimings[i].recordTime);
+            samples[3 + i * 3].times.pushBack(stageTimings[i].executeTime);
+            submitTime += stageTimings[i].executeTime;
+        }
+        samples[samples.size() - 2].times.pushBack(submitTime);
+        samples[samples.size() - 1].times.pushBack(frameTime);
+    }
+
+    //The statistics written below are of the last executed frame.
+    renderer.flushFrames();
+
+    if(!settings.traceFile.empty())
+        Profiler::writeChromeTrace(settings.traceFile);
+
+    if(settings.outputFile.empty())
+        writeResults(std::cout, settings, samples, mathResults, containerResults, renderer);
+    else
+    {
+        std::ofstream outputStream(settings.outputFile);
+        if(!outputStream.is_open())
+        {
+            std::cout << "Failed to open the output file: " << settings.outputFile << std::endl;
+            delete scene;
+            return 1;
+        }
+
+        writeResults(outputStream, settings, samples, mathResults, containerResults, renderer);
+        std::cout << "Wrote benchmark results to " << settings.outputFile << std::endl;
+    }
+
+    delete scene;
+
+    return 0;
+}
@@ -0,0 +1,640 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "Graphics/GraphicSystem.h"
+#include "Graphics/DrawCommandBuffer.h"
+#include "Renderer/IndirectDrawBatcher.h"
+#include "Scene/Scene.h"
+#include "Scene/Light.h"
+#include "Scene/OcclusionCuller.h"
+#include "Renderer/RenderView.h"
+#include "Math/Frustum.h"
+#include "Math/Quaternion.h"
+#include "Util/RingAllocator.h"
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace Huurre3D;
+
+//Headless checks of the engine parts whose policies can be verified without a GPU. Built against the null graphics back-end.
+//Runs the named check groups, or all of them without arguments, and returns non-zero when a check fails.
+
+static unsigned int numChecks = 0;
+static unsigned int numFailedChecks = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static void check(bool passed, const char* condition, const char* file, int line)
+{
+    ++numChecks;
+    if(!passed)
+    {
+        ++numFailedChecks;
+        std::cout << "Failed check " << condition << " at " << file << ":" << line << std::endl;
+    }
+}
+
+static void checkRingAllocator()
+{
+    //The ranges are aligned and follow each other.
+    RingAllocator ring(1024);
+    CHECK(ring.allocate(10, 256) == 0);
+    CHECK(ring.allocate(10, 256) == 256);
+    CHECK(ring.allocate(16, 1) == 266);
+    CHECK(ring.getUsedSize() == 282);
+    ring.endFrame(1);
+
+    //The end of the ring is skipped when the range doesn't fit before it, the skipped bytes count as used.
+    ring.reset(1024);
+    CHECK(ring.allocate(600, 1) == 0);
+    ring.endFrame(1);
+    CHECK(ring.allocate(300, 1) == 600);
+    ring.endFrame(2);
+    CHECK(ring.allocate(400, 1) == InvalidRingOffset);
+    ring.releaseOldestFrame();
+    CHECK(ring.getNumFramesInFlight() == 1);
+    CHECK(ring.getOldestFence() == 2);
+    CHECK(ring.allocate(400, 1) == 0);
+    CHECK(ring.getUsedSize() == 300 + 124 + 400);
+    ring.endFrame(3);
+
+    //A range never overlaps the frames in flight, the free space is between the head and the frame of fence 2.
+    CHECK(ring.allocate(201, 1) == InvalidRingOffset);
+    ring.releaseOldestFrame();
+    CHECK(ring.getOldestFence() == 3);
+    CHECK(ring.allocate(200, 1) == 400);
+
+    //The fences are released in order, and an empty ring starts over from the beginning.
+    ring.endFrame(4);
+    ring.releaseOldestFrame();
+    ring.releaseOldestFrame();
+    CHECK(!ring.hasFramesInFlight());
+    CHECK(ring.getUsedSize() == 0);
+    CHECK(ring.allocate(1024, 256) == 0);
+    CHECK(ring.allocate(1, 1) == InvalidRingOffset);
+    CHECK(ring.allocate(2048, 1) == InvalidRingOffset);
+    CHECK(ring.allocate(0, 1) == InvalidRingOffset);
+}
+
+static void checkParameterRingStalls()
+{
+    //The null back-end has an alignment of 256 bytes, so the ring holds four blocks.
+    GraphicSystem graphicSystem;
+    graphicSystem.setParameterRingSize(1024);
+    ShaderProgram* program = graphicSystem.createShaderProgram(graphicSystem.createShader(ShaderType::Vertex, "Check.vert"), graphicSystem.createShader(ShaderType::Fragment, "Check.frag"));
+    graphicSystem.setShaderProgram(program);
+    ShaderParameterBlock* block = graphicSystem.createShaderParameterBlock(sp_cameraParameters);
+    block->setStreamed(true);
+
+    graphicSystem.beginFrame();
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        block->addParameter(Matrix4x4::IDENTITY);
+        graphicSystem.setShaderParameterBlock(block);
+    }
+    //The blocks of 64 to 256 bytes take a range of 256 bytes each.
+    CHECK(graphicSystem.getParameterRing().getUsedSize() == 1024);
+    CHECK(graphicSystem.getStatistics().parameterRingStalls == 0);
+
+    //Within a frame a full ring falls back to the buffer of the block, as there are no frames in flight to wait for.
+    block->addParameter(Matrix4x4::IDENTITY);
+    graphicSystem.setShaderParameterBlock(block);
+    CHECK(graphicSystem.getStatistics().parameterRingStalls == 0);
+    CHECK(graphicSystem.getParameterRing().getUsedSize() == 1024);
+    graphicSystem.endFrame();
+
+    //The frame in flight is waited for when the next write doesn't fit, which counts as a stall.
+    block->addParameter(Matrix4x4::IDENTITY);
+    graphicSystem.setShaderParameterBlock(block);
+    CHECK(graphicSystem.getStatistics().parameterRingStalls == 1);
+    CHECK(!graphicSystem.getParameterRing().hasFramesInFlight());
+    graphicSystem.endFrame();
+
+    //Beginning a frame releases the frames whose fences have been passed without a stall.
+    graphicSystem.beginFrame();
+    CHECK(!graphicSystem.getParameterRing().hasFramesInFlight());
+    block->addParameter(Matrix4x4::IDENTITY);
+    graphicSystem.setShaderParameterBlock(block);
+    CHECK(graphicSystem.getStatistics().parameterRingStalls == 1);
+    CHECK(graphicSystem.getStatistics().streamedParameterBytes == 64 + 128 + 192 + 256 + 384 + 448);
+}
+
+static ShaderPass createCheckDrawPass(ShaderProgram* program, VertexData* vertexData, unsigned int firstIndex, unsigned int numIndices, unsigned int baseVertex)
+{
+    ShaderPass pass;
+    pass.program = program;
+    pass.vertexData = vertexData;
+    pass.firstIndex = firstIndex;
+    pass.numIndices = numIndices;
+    pass.baseVertex = baseVertex;
+    return pass;
+}
+
+static void checkIndirectDrawBatcher()
+{
+    GraphicSystem graphicSystem;
+    ShaderProgram* program = graphicSystem.createShaderProgram(graphicSystem.createShader(ShaderType::Vertex, "Check.vert"), graphicSystem.createShader(ShaderType::Fragment, "Check.frag"));
+    ShaderProgram* otherProgram = graphicSystem.createShaderProgram(graphicSystem.createShader(ShaderType::Vertex, "Other.vert"), graphicSystem.createShader(ShaderType::Fragment, "Other.frag"));
+    VertexData* vertexData = graphicSystem.createVertexData(PrimitiveType::Triangles, 64);
+    vertexData->setIndexBuffer(graphicSystem.createIndexBuffer(IndexType::Int, 1024, false));
+    IndirectDrawBatcher batcher(graphicSystem);
+    batcher.reserve(2);
+    Vector<ShaderPass> shaderPasses;
+
+    //The draws of the same state go to one batch pass, each command gets its range and its index as the base instance.
+    Matrix4x4 transform = Matrix4x4::IDENTITY;
+    transform[3].x = 5.0f;
+    CHECK(batcher.addDraw(shaderPasses, createCheckDrawPass(program, vertexData, 0, 36, 0), Matrix4x4::IDENTITY, 3));
+    CHECK(batcher.addDraw(shaderPasses, createCheckDrawPass(program, vertexData, 36, 12, 24), transform, 7));
+    CHECK(shaderPasses.size() == 1);
+    DrawCommandBuffer* drawCommands = shaderPasses[0].drawCommands;
+    CHECK(drawCommands && drawCommands->getNumCommands() == 2);
+    if(!drawCommands || drawCommands->getNumCommands() != 2)
+        return;
+
+    const DrawIndexedCommand& command = drawCommands->getCommand(1);
+    CHECK(command.numIndices == 12 && command.firstIndex == 36 && command.baseVertex == 24 && command.numInstances == 1 && command.baseInstance == 1);
+    CHECK(drawCommands->getCommand(0).baseInstance == 0);
+
+    //The per-draw parameters are the world transform and the material index of each draw, laid out as the DrawParameters of the shaders.
+    ShaderParameterBlock* drawParameters = shaderPasses[0].shaderParameterBlocks.back();
+    unsigned int drawSize = sizeof(Matrix4x4) + 4 * sizeof(int);
+    CHECK(drawParameters->getSizeInBytes() == 2 * drawSize);
+    const unsigned char* secondDraw = drawParameters->getGraphicData() + drawSize;
+    CHECK(memcmp(secondDraw, transform.toArray(), sizeof(Matrix4x4)) == 0);
+    CHECK(*reinterpret_cast<const int*>(secondDraw + sizeof(Matrix4x4)) == 7);
+
+    //A draw of another program opens the second batch, and with the batches in use the draw is left to the caller.
+    CHECK(batcher.addDraw(shaderPasses, createCheckDrawPass(otherProgram, vertexData, 0, 36, 0), Matrix4x4::IDENTITY, 0));
+    CHECK(shaderPasses.size() == 2 && batcher.getNumUsedBatches() == 2);
+    CHECK(!batcher.addDraw(shaderPasses, createCheckDrawPass(program, vertexData, 0, 36, 0), Matrix4x4::IDENTITY, 0));
+    CHECK(shaderPasses.size() == 2);
+
+    //The reset empties the batches and creates the ones the frame ran short of.
+    batcher.reset();
+    CHECK(batcher.getNumUsedBatches() == 0 && batcher.getNumBatches() >= 3);
+    CHECK(drawCommands->getNumCommands() == 0 && drawParameters->getSizeInBytes() == 0);
+
+    //A full command buffer opens a new batch even for the same state.
+    shaderPasses.clear();
+    for(unsigned int i = 0; i < MaxDrawCommands + 1; ++i)
+        batcher.addDraw(shaderPasses, createCheckDrawPass(program, vertexData, i * 3, 3, 0), Matrix4x4::IDENTITY, 0);
+    CHECK(shaderPasses.size() == 2);
+    CHECK(shaderPasses[0].drawCommands->getNumCommands() == MaxDrawCommands && shaderPasses[1].drawCommands->getNumCommands() == 1);
+
+    //The passes with different textures are not merged.
+    shaderPasses.clear();
+    batcher.reset();
+    Texture* texture = graphicSystem.createTexture(TextureTargetMode::Texture2D, TextureWrapMode::Repeat, TextureFilterMode::Nearest, TexturePixelFormat::Rgba8, 4, 4);
+    ShaderPass texturedPass = createCheckDrawPass(program, vertexData, 0, 3, 0);
+    texturedPass.textures.pushBack(texture);
+    batcher.addDraw(shaderPasses, createCheckDrawPass(program, vertexData, 0, 3, 0), Matrix4x4::IDENTITY, 0);
+    batcher.addDraw(shaderPasses, texturedPass, Matrix4x4::IDENTITY, 0);
+    batcher.addDraw(shaderPasses, texturedPass, Matrix4x4::IDENTITY, 0);
+    CHECK(shaderPasses.size() == 2 && shaderPasses[1].drawCommands->getNumCommands() == 2);
+
+    //The multi-draw of a batch pass is counted as one call of its commands.
+    graphicSystem.resetStatistics();
+    graphicSystem.setVertexData(vertexData);
+    graphicSystem.drawIndexedIndirect(shaderPasses[1].drawCommands);
+    CHECK(graphicSystem.getStatistics().indirectDrawCalls == 1 && graphicSystem.getStatistics().indirectDraws == 2);
+}
+
+static bool isSameFloats(const float* lhs, const float* rhs, unsigned int count)
+{
+    return memcmp(lhs, rhs, count * sizeof(float)) == 0;
+}
+
+//The scalar references below add the products in the order the 4-wide implementation does,
+//so the SIMD and the scalar builds both must match them exactly.
+static float referenceDot4(const float* lhs, const float* rhs)
+{
+    return (lhs[0] * rhs[0] + lhs[2] * rhs[2]) + (lhs[1] * rhs[1] + lhs[3] * rhs[3]);
+}
+
+static Vector4 referenceTransform(const Matrix4x4& matrix, const Vector4& vector)
+{
+    Vector4 result;
+    for(unsigned int i = 0; i < 4; ++i)
+        result.toArray()[i] = ((matrix[0].toArray()[i] * vector.x + matrix[1].toArray()[i] * vector.y) + matrix[2].toArray()[i] * vector.z) + matrix[3].toArray()[i] * vector.w;
+
+    return result;
+}
+
+static Quaternion referenceHamiltonProduct(const Quaternion& lhs, const Quaternion& rhs)
+{
+    return Quaternion(lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z,
+                      lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+                      lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+                      lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w);
+}
+
+static float referencePlaneDistance(const Plane& plane, const Vector3& point)
+{
+    const Vector3& normal = plane.getNormal();
+    return ((normal.x * point.x + plane.getOffset()) + normal.y * point.y) + normal.z * point.z;
+}
+
+static Intersection referenceIsInside(const Plane* planes, const BoundingBox& box)
+{
+    Vector3 center = box.getCenter();
+    Vector3 edge = center - box.getMin();
+    Intersection result = Intersection::Inside;
+    for(unsigned int i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        const Vector3& normal = planes[i].getNormal();
+        float dist = referencePlaneDistance(planes[i], center);
+        float absDot = (fabs(normal.x * edge.x) + fabs(normal.y * edge.y)) + fabs(normal.z * edge.z);
+        if(dist < -absDot)
+            return Intersection::Outside;
+        else if(dist < absDot)
+            result = Intersection::Intersects;
+    }
+
+    return result;
+}
+
+static Intersection referenceIsInside(const Plane* planes, const Sphere& sphere)
+{
+    Intersection result = Intersection::Inside;
+    for(unsigned int i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        float dist = referencePlaneDistance(planes[i], sphere.getCenter());
+        if(dist < -sphere.getRadius())
+            return Intersection::Outside;
+        else if(dist < sphere.getRadius())
+            result = Intersection::Intersects;
+    }
+
+    return result;
+}
+
+//Build with USE_SCALAR_MATH to run these on the scalar implementation.
+static void checkMathExactness()
+{
+    std::mt19937 engine(1);
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+    auto randomVector = [&](){return Vector4(value(engine), value(engine), value(engine), value(engine));};
+    bool vectorsMatch = true;
+    bool matricesMatch = true;
+    bool quaternionsMatch = true;
+
+    for(unsigned int i = 0; i < 1000; ++i)
+    {
+        Vector4 lhs = randomVector();
+        Vector4 rhs = randomVector();
+        float weight = value(engine) * 0.1f;
+        Vector4 sum = lhs + rhs;
+        Vector4 scaled = lhs * weight;
+        Vector4 lerped = lhs.lerp(rhs, weight);
+        float dot = lhs.dot(rhs);
+        float expectedSum[4] = {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w};
+        float expectedScaled[4] = {lhs.x * weight, lhs.y * weight, lhs.z * weight, lhs.w * weight};
+        float expectedLerped[4] = {rhs.x * weight + lhs.x * (1.0f - weight), rhs.y * weight + lhs.y * (1.0f - weight), rhs.z * weight + lhs.z * (1.0f - weight), rhs.w * weight + lhs.w * (1.0f - weight)};
+        float expectedDot = referenceDot4(lhs.toArray(), rhs.toArray());
+        vectorsMatch = vectorsMatch && isSameFloats(sum.toArray(), expectedSum, 4) && isSameFloats(scaled.toArray(), expectedScaled, 4) &&
+            isSameFloats(lerped.toArray(), expectedLerped, 4) && isSameFloats(&dot, &expectedDot, 1);
+
+        Matrix4x4 lhsMatrix(randomVector(), randomVector(), randomVector(), randomVector());
+        Matrix4x4 rhsMatrix(randomVector(), randomVector(), randomVector(), randomVector());
+        Matrix4x4 product = lhsMatrix * rhsMatrix;
+        Matrix4x4 transposed = lhsMatrix.transpose();
+        Vector4 transformed = lhsMatrix * rhs;
+        Vector4 expectedTransformed = referenceTransform(lhsMatrix, rhs);
+        matricesMatch = matricesMatch && isSameFloats(transformed.toArray(), expectedTransformed.toArray(), 4);
+        for(int col = 0; col < 4; ++col)
+        {
+            Vector4 expectedColumn = referenceTransform(lhsMatrix, rhsMatrix[col]);
+            matricesMatch = matricesMatch && isSameFloats(product[col].toArray(), expectedColumn.toArray(), 4);
+            for(int row = 0; row < 4; ++row)
+                matricesMatch = matricesMatch && transposed[col].toArray()[row] == lhsMatrix[row].toArray()[col];
+        }
+
+        Quaternion lhsQuaternion(lhs.x, lhs.y, lhs.z, lhs.w);
+        Quaternion rhsQuaternion(rhs.x, rhs.y, rhs.z, rhs.w);
+        Quaternion quaternionProduct = lhsQuaternion * rhsQuaternion;
+        Quaternion expectedProduct = referenceHamiltonProduct(lhsQuaternion, rhsQuaternion);
+        float lengthSquared = lhsQuaternion.lengthSquared();
+        float expectedLengthSquared = referenceDot4(&lhsQuaternion.w, &lhsQuaternion.w);
+        quaternionsMatch = quaternionsMatch && isSameFloats(&quaternionProduct.w, &expectedProduct.w, 4) && isSameFloats(&lengthSquared, &expectedLengthSquared, 1);
+    }
+
+    CHECK(vectorsMatch);
+    CHECK(matricesMatch);
+    CHECK(quaternionsMatch);
+
+    //The frustum tests four planes at once, the results of the boxes and spheres must be the ones of testing the planes one by one.
+    Matrix4x4 projection;
+    Matrix4x4 view;
+    projection.setPerspective(60.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    view.setInverseTransform(Vector3(3.0f, 2.0f, 10.0f), Quaternion(30.0f, Vector3(0.0f, 1.0f, 0.0f)), Vector3(1.0f, 1.0f, 1.0f));
+    Matrix4x4 viewProjection = projection * view;
+    Frustum frustum(viewProjection);
+    Plane planes[NUM_FRUSTUM_PLANES];
+    planes[LEFT_PLANE].set(viewProjection[3] + viewProjection[0]);
+    planes[RIGHT_PLANE].set(viewProjection[3] - viewProjection[0]);
+    planes[BOTTOM_PLANE].set(viewProjection[3] + viewProjection[1]);
+    planes[TOP_PLANE].set(viewProjection[3] - viewProjection[1]);
+    planes[NEAR_PLANE].set(viewProjection[3] + viewProjection[2]);
+    planes[FAR_PLANE].set(viewProjection[3] - viewProjection[2]);
+    for(unsigned int i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+        planes[i].normalize();
+
+    bool frustumMatches = true;
+    unsigned int numResults[3] = {0, 0, 0};
+    std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+    std::uniform_real_distribution<float> size(0.1f, 8.0f);
+    for(unsigned int i = 0; i < 20000; ++i)
+    {
+        Vector3 center(position(engine), position(engine) * 0.25f, position(engine));
+        Vector3 extent(size(engine), size(engine), size(engine));
+        BoundingBox box(center - extent, center + extent);
+        Intersection expectedBox = referenceIsInside(planes, box);
+        Intersection boxResult = frustum.isInside(box);
+        frustumMatches = frustumMatches && boxResult == expectedBox && frustum.isInsideNoIntersection(box) == (expectedBox != Intersection::Outside);
+        ++numResults[static_cast<int>(boxResult)];
+
+        Sphere sphere(center, extent.x);
+        Intersection expectedSphere = referenceIsInside(planes, sphere);
+        frustumMatches = frustumMatches && frustum.isInside(sphere) == expectedSphere && frustum.isInsideNoIntersection(sphere) == (expectedSphere != Intersection::Outside);
+    }
+
+    CHECK(frustumMatches);
+    //The boxes cover every result, so each of the comparisons above was made.
+    CHECK(numResults[0] > 0 && numResults[1] > 0 && numResults[2] > 0);
+}
+
+//Slab test of the segment, the end point itself does not block.
+static bool isSegmentBlocked(const Vector3& from, const Vector3& to, const BoundingBox& box)
+{
+    float enter = 0.0f;
+    float exit = 0.9999f;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        float origin = from.toArray()[axis];
+        float direction = to.toArray()[axis] - origin;
+        float min = box.getMin().toArray()[axis];
+        float max = box.getMax().toArray()[axis];
+        if(fabs(direction) < 1e-7f)
+        {
+            if(origin < min || origin > max)
+                return false;
+            continue;
+        }
+
+        float t0 = (min - origin) / direction;
+        float t1 = (max - origin) / direction;
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+
+    return enter <= exit;
+}
+
+//A box is visible when a point on its faces is in the frustum and the segment from the camera to it misses the wall.
+static bool isBoxVisible(const BoundingBox& box, const BoundingBox& wall, const Vector3& cameraPosition, const Frustum& frustum)
+{
+    const unsigned int numSteps = 6;
+    const Vector3& min = box.getMin();
+    Vector3 size = box.getMax() - min;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        int uAxis = (axis + 1) % 3;
+        int vAxis = (axis + 2) % 3;
+        for(unsigned int side = 0; side < 2; ++side)
+        {
+            for(unsigned int u = 0; u <= numSteps; ++u)
+            {
+                for(unsigned int v = 0; v <= numSteps; ++v)
+                {
+                    Vector3 point = min;
+                    point.toArray()[axis] += side * size.toArray()[axis];
+                    point.toArray()[uAxis] += size.toArray()[uAxis] * u / numSteps;
+                    point.toArray()[vAxis] += size.toArray()[vAxis] * v / numSteps;
+                    if(frustum.isInside(point) == Intersection::Inside && !isSegmentBlocked(cameraPosition, point, wall))
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+//The occlusion culler against the exact visibility of boxes behind a wall. The depth buffer rasterized four texels at a time
+//is compared with the scalar depths of the wall hit by the rays through the texel centers.
+static void checkOcclusionCuller()
+{
+    Scene scene;
+    Camera* camera = scene.getMainCamera();
+    camera->setAspectRatio(2.0f);
+    camera->setNearClipDistance(0.5f);
+    camera->setFarClipDistance(200.0f);
+    camera->setPosition(Vector3(1.0f, 0.5f, 0.0f));
+    scene.update();
+
+    RenderView view;
+    view.camera = *camera;
+    OccluderBox wall;
+    wall.worldTransform = Matrix4x4::IDENTITY;
+    wall.worldTransform[3] = Vector4(0.0f, 0.0f, -20.0f, 1.0f);
+    wall.boundingBox = BoundingBox(Vector3(-6.0f, -3.0f, -0.5f), Vector3(6.0f, 3.0f, 0.5f));
+    view.occluders.pushBack(wall);
+    BoundingBox worldWall = wall.boundingBox.transformed(wall.worldTransform);
+
+    OcclusionCuller culler;
+    culler.setResolution(256, 128);
+    CHECK(culler.setupOccluders(view) == 1);
+    for(unsigned int band = 0; band < culler.getNumBands(); ++band)
+        culler.rasterizeBand(band);
+    culler.buildHierarchy();
+
+    //The texels whose neighbours are all on the wall or all off it, the edges are left out.
+    Matrix4x4 viewProjection = view.camera.getViewProjectionMatrix();
+    Matrix4x4 inverseViewProjection = viewProjection.inverse();
+    Vector3 cameraPosition = view.camera.getPosition(FrameOfReference::World);
+    unsigned int width = culler.getWidth();
+    unsigned int height = culler.getHeight();
+    Vector<float> expectedDepths(width * height);
+    for(unsigned int y = 0; y < height; ++y)
+    {
+        for(unsigned int x = 0; x < width; ++x)
+        {
+            Vector4 farPoint = inverseViewProjection * Vector4((x + 0.5f) / width * 2.0f - 1.0f, (y + 0.5f) / height * 2.0f - 1.0f, 1.0f, 1.0f);
+            Vector3 direction = farPoint.project3D() - cameraPosition;
+            //The wall faces the camera, the ray hits its front plane inside its rectangle or misses it.
+            float t = (worldWall.getMax().z - cameraPosition.z) / direction.z;
+            Vector3 hit = cameraPosition + direction * t;
+            bool onWall = hit.x >= worldWall.getMin().x && hit.x <= worldWall.getMax().x && hit.y >= worldWall.getMin().y && hit.y <= worldWall.getMax().y;
+            expectedDepths[y * width + x] = onWall ? 1.0f / (viewProjection * Vector4(hit, 1.0f)).w : 0.0f;
+        }
+    }
+
+    bool depthsMatch = true;
+    unsigned int numCompared = 0;
+    const Vector<float>& depthBuffer = culler.getDepthBuffer();
+    for(unsigned int y = 1; y + 1 < height; ++y)
+    {
+        for(unsigned int x = 1; x + 1 < width; ++x)
+        {
+            unsigned int index = y * width + x;
+            bool onWall = expectedDepths[index] > 0.0f;
+            if(onWall != (expectedDepths[index - 1] > 0.0f) || onWall != (expectedDepths[index + 1] > 0.0f) ||
+               onWall != (expectedDepths[index - width] > 0.0f) || onWall != (expectedDepths[index + width] > 0.0f))
+                continue;
+
+            depthsMatch = depthsMatch && fabs(depthBuffer[index] - expectedDepths[index]) <= expectedDepths[index] * 0.001f;
+            ++numCompared;
+        }
+    }
+
+    CHECK(depthsMatch);
+    CHECK(numCompared > width * height / 2);
+
+    //A visible box must never be culled. Some of the hidden boxes are kept, the test is conservative.
+    Frustum frustum = view.camera.getViewFrustumInWorldSpace();
+    std::mt19937 engine(2);
+    std::uniform_real_distribution<float> positionX(-14.0f, 14.0f);
+    std::uniform_real_distribution<float> positionY(-7.0f, 7.0f);
+    std::uniform_real_distribution<float> positionZ(-60.0f, -5.0f);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+    unsigned int numVisibleCulled = 0;
+    unsigned int numHidden = 0;
+    unsigned int numHiddenCulled = 0;
+    for(unsigned int i = 0; i < 20000; ++i)
+    {
+        Vector3 center(positionX(engine), positionY(engine), positionZ(engine));
+        Vector3 extent(size(engine), size(engine), size(engine));
+        BoundingBox box(center - extent, center + extent);
+        if(!frustum.isInsideNoIntersection(box))
+            continue;
+
+        bool occluded = culler.isOccluded(box);
+        if(isBoxVisible(box, worldWall, cameraPosition, frustum))
+            numVisibleCulled += occluded ? 1 : 0;
+        else
+        {
+            ++numHidden;
+            numHiddenCulled += occluded ? 1 : 0;
+        }
+    }
+
+    CHECK(numVisibleCulled == 0);
+    CHECK(numHiddenCulled > numHidden / 2);
+}
+
+//The parameters are recorded by value, a parameter changed in place after it was recorded is not taken for the recorded one.
+static void checkCommandListParameters()
+{
+    CommandList commandList;
+    ShaderParameter parameter(sp_worldTransform, Matrix4x4::IDENTITY);
+    commandList.setShaderParameter(parameter);
+    commandList.setShaderParameter(parameter);
+    CHECK(commandList.getStatistics().recordedCommands == 1 && commandList.getStatistics().filteredCommands == 1);
+
+    parameter.value[0] ^= 1;
+    commandList.setShaderParameter(parameter);
+    CHECK(commandList.getStatistics().recordedCommands == 2);
+
+    unsigned int offset = 0;
+    ShaderParameterCommand first;
+    ShaderParameterCommand second;
+    CHECK(commandList.readType(offset) == CommandType::SetShaderParameter);
+    commandList.read(offset, first);
+    CHECK(commandList.readType(offset) == CommandType::SetShaderParameter);
+    commandList.read(offset, second);
+    CHECK(first.nameHash == parameter.nameHash && memcmp(first.value, Matrix4x4::IDENTITY.toArray(), sizeof(Matrix4x4)) == 0);
+    CHECK(memcmp(second.value, parameter.value, sizeof(parameter.value)) == 0);
+    CHECK(offset == commandList.getSizeInBytes());
+}
+
+//Items moved or changed since the last update are in the update lists of the scene, they leave the lists when they are removed.
+static void checkSceneItemRemoval()
+{
+    Scene* scene = new Scene();
+    Vector<Light*> lights;
+    scene->createSceneItems<Light>(lights, 4);
+    scene->update();
+
+    //A moved item removed alone, and removed again through its stale pointer.
+    Light* removedLight = lights[1];
+    SceneItemHandle removedHandle = removedLight->getHandle();
+    lights[0]->setPosition(Vector3(1.0f, 0.0f, 0.0f));
+    removedLight->setPosition(Vector3(2.0f, 0.0f, 0.0f));
+    scene->removeSceneItem(removedLight);
+    scene->removeSceneItem(removedLight);
+    CHECK(scene->getSceneItem(removedHandle) == nullptr);
+    CHECK(scene->getNumSceneItemsByType("Light") == 3);
+
+    scene->update();
+    CHECK(lights[0]->getPosition(FrameOfReference::World) == Vector3(1.0f, 0.0f, 0.0f));
+
+    //Moved items removed all at once, and moved items left to the destructor of the scene.
+    lights[2]->setPosition(Vector3(3.0f, 0.0f, 0.0f));
+    scene->removeAllSceneItem();
+    CHECK(scene->getNumSceneItemsByType("Light") == 0);
+
+    lights.clear();
+    scene->createSceneItems<Light>(lights, 4);
+    lights[3]->setPosition(Vector3(4.0f, 0.0f, 0.0f));
+    scene->update();
+    lights[3]->setPosition(Vector3(5.0f, 0.0f, 0.0f));
+    delete scene;
+}
+
+struct CheckGroup
+{
+    const char* name;
+    void (*run)();
+};
+
+static const CheckGroup checkGroups[] =
+{
+    {"ring", checkRingAllocator},
+    {"ringStalls", checkParameterRingStalls},
+    {"indirect", checkIndirectDrawBatcher},
+    {"commandList", checkCommandListParameters},
+    {"math", checkMathExactness},
+    {"occlusion", checkOcclusionCuller},
+    {"scene", checkSceneItemRemoval}
+};
+
+int main(int argc, const char* argv[])
+{
+    unsigned int numGroups = sizeof(checkGroups) / sizeof(checkGroups[0]);
+    for(unsigned int i = 0; i < numGroups; ++i)
+    {
+        bool selected = argc < 2;
+        for(int j = 1; j < argc; ++j)
+            selected = selected || std::string(argv[j]) == checkGroups[i].name;
+
+        if(selected)
+        {
+            unsigned int numFailedBefore = numFailedChecks;
+            checkGroups[i].run();
+            std::cout << checkGroups[i].name << ": " << (numFailedChecks == numFailedBefore ? "passed" : "failed") << std::endl;
+        }
+    }
+
+    std::cout << numChecks - numFailedChecks << "/" << numChecks << " checks passed" << std::endl;
+    return numFailedChecks > 0 ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2013-2015 Antti Karhu.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "Engine/Engine.h"
+#include <iostream>
+
+using namespace Huurre3D;
+
+//Fills the shader cache with every material shader permutation, so that the applications find the programs from the cache at load time.
+//The engine config is given as the first argument, the renderer section of it defines the material shaders and the cache directory.
+int main(int argc, const char* argv[])
+{
+    Engine engine;
+    std::string configFile = argc > 1 ? argv[1] : defaultConfigFile;
+
+    if(!engine.init(configFile))
+    {
+        std::cout << "Failed to init the engine from config: " << configFile << std::endl;
+        return 1;
+    }
+
+    unsigned int numPrograms = engine.getRenderer().precompileMaterialShaders();
+    std::cout << "Precompiled " << numPrograms << " material shader programs" << std::endl;
+
+    return 0;
+}